@@ -21,6 +21,7 @@ internal static class NativeMethods
         EnumFailed = -4,
         InvalidIndex = -5,
         NullPointer = -6,
+        Partial = -10,
         Unknown = -99
     }
 
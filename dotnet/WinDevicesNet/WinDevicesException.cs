@@ -44,6 +44,11 @@ public enum WinDevicesErrorCode
     /// </summary>
     NullPointer = -6,
     
+    /// <summary>
+    /// Some hubs could not be enumerated; the devices on the others are available
+    /// </summary>
+    Partial = -10,
+    
     /// <summary>
     /// Unknown error
     /// </summary>
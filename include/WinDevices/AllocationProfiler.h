@@ -0,0 +1,147 @@
+#pragma once
+
+// ============================================================================
+// Allocation Profiler
+// ============================================================================
+// Counts heap allocations made by the library and attributes them to the
+// enumeration phase that was active on the allocating thread.
+//
+// The counting operator new/delete hook is only compiled in when the library
+// is built with ENABLE_ALLOCATION_PROFILER=ON (WINDEVICES_ALLOCATION_PROFILER).
+// In regular builds the phase scopes still compile, but nothing is recorded
+// and AllocationProfiler::IsAvailable() returns false.
+//
+// Usage:
+//   KDM::AllocationProfiler::Start();
+//   manager.EnumerateUsbDevices();
+//   auto report = KDM::AllocationProfiler::Stop(manager.GetDeviceCount());
+//   report.AllocationsPerDevice(KDM::AllocationPhase::Correlation);
+// ============================================================================
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace KDM
+{
+	/// <summary>
+	/// Enumeration phases allocations are attributed to.
+	/// </summary>
+	enum class AllocationPhase : uint8_t
+	{
+		Other = 0,          // Outside of any phase scope
+		Traversal,          // Host controller / hub IOCTLs and port enumeration
+		DescriptorFetch,    // Configuration and string descriptor retrieval
+		Correlation,        // Matching hub ports with SetupAPI device nodes
+		Export,             // Copying results out to callers (C API, snapshots)
+		Count
+	};
+
+	/// <summary>
+	/// Allocation counters of a single phase.
+	/// </summary>
+	struct AllocationCounters
+	{
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+	};
+
+	/// <summary>
+	/// Result of a profiling session: per-phase counters plus the number of
+	/// devices the session produced, for per-device normalization.
+	/// </summary>
+	struct AllocationReport
+	{
+		std::array<AllocationCounters, static_cast<size_t>(AllocationPhase::Count)> phases{};
+		size_t deviceCount = 0;
+
+		[[nodiscard]] const AllocationCounters& operator[](AllocationPhase phase) const noexcept
+		{
+			return phases[static_cast<size_t>(phase)];
+		}
+
+		/// @brief Sum of all phases.
+		[[nodiscard]] AllocationCounters Total() const noexcept;
+
+		/// @brief Allocations per produced device (all phases), 0 if no devices.
+		[[nodiscard]] double AllocationsPerDevice() const noexcept;
+
+		/// @brief Allocations per produced device for one phase, 0 if no devices.
+		[[nodiscard]] double AllocationsPerDevice(AllocationPhase phase) const noexcept;
+
+		/// @brief Bytes per produced device (all phases), 0 if no devices.
+		[[nodiscard]] double BytesPerDevice() const noexcept;
+
+		/// @brief Bytes per produced device for one phase, 0 if no devices.
+		[[nodiscard]] double BytesPerDevice(AllocationPhase phase) const noexcept;
+	};
+
+	/// <summary>
+	/// Process-wide allocation counter. All methods are static and thread-safe.
+	/// Only one profiling session can be active at a time.
+	/// </summary>
+	class AllocationProfiler
+	{
+	public:
+		// Delete constructor - this is a static utility class
+		AllocationProfiler() = delete;
+
+		/// @brief Returns true if the counting allocator hook is compiled in.
+		[[nodiscard]] static constexpr bool IsAvailable() noexcept
+		{
+#ifdef WINDEVICES_ALLOCATION_PROFILER
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		/// @brief Resets all counters and starts recording.
+		static void Start() noexcept;
+
+		/// @brief Stops recording and returns the collected counters.
+		/// @param deviceCount Number of devices produced during the session.
+		[[nodiscard]] static AllocationReport Stop(size_t deviceCount) noexcept;
+
+		/// @brief Returns true while a session is recording.
+		[[nodiscard]] static bool IsRecording() noexcept;
+
+		/// @brief Records one allocation against the calling thread's current phase.
+		/// Called by the counting operator new hook.
+		static void RecordAllocation(size_t bytes) noexcept;
+
+		/// @brief Returns the calling thread's current phase.
+		[[nodiscard]] static AllocationPhase CurrentPhase() noexcept;
+
+		/// @brief Sets the calling thread's current phase.
+		/// @return The previously active phase.
+		static AllocationPhase SetPhase(AllocationPhase phase) noexcept;
+	};
+
+	/// <summary>
+	/// RAII scope that attributes allocations on the current thread to a phase.
+	/// Scopes nest: the previous phase is restored on destruction.
+	/// </summary>
+	class AllocationPhaseScope
+	{
+	public:
+		explicit AllocationPhaseScope(AllocationPhase phase) noexcept
+			: _previous{ AllocationProfiler::SetPhase(phase) }
+		{
+		}
+
+		~AllocationPhaseScope()
+		{
+			AllocationProfiler::SetPhase(_previous);
+		}
+
+		// Non-copyable, non-movable
+		AllocationPhaseScope(const AllocationPhaseScope&) = delete;
+		AllocationPhaseScope& operator=(const AllocationPhaseScope&) = delete;
+		AllocationPhaseScope(AllocationPhaseScope&&) = delete;
+		AllocationPhaseScope& operator=(AllocationPhaseScope&&) = delete;
+
+	private:
+		AllocationPhase _previous;
+	};
+}
@@ -1,39 +1,71 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <Windows.h>
 #include <SetupAPI.h>
+#include "HardwareId.h"
 
 namespace KDM
 {
 	/// <summary>
 	/// Wrapper around Windows SP_DEVINFO_DATA with additional device properties.
+	/// Hardware and compatible IDs are parsed once when set, so matching compares
+	/// VID/PID and class codes as integers. Strings and parsed IDs are allocated
+	/// through the allocator given at construction (the default resource otherwise).
 	/// </summary>
 	class DevInfoData
 	{
 	public:
+		using allocator_type = std::pmr::polymorphic_allocator<wchar_t>;
+
 		// HDEVINFO DevInfo, SP_DEVINFO_DATA DevInfoData
-		DevInfoData(const HDEVINFO DevInfo, const SP_DEVINFO_DATA DevInfoData);
-		SP_DEVINFO_DATA GetDevInfoData();
+		DevInfoData(const HDEVINFO DevInfo, const SP_DEVINFO_DATA DevInfoData, const allocator_type& allocator = {});
+
+		DevInfoData(const DevInfoData&) = default;
+		DevInfoData(DevInfoData&&) noexcept = default;
+		DevInfoData& operator=(const DevInfoData&) = default;
+		DevInfoData& operator=(DevInfoData&&) = default;
+
+		// Copies or moves other into storage obtained through allocator
+		DevInfoData(const DevInfoData& other, const allocator_type& allocator);
+		DevInfoData(DevInfoData&& other, const allocator_type& allocator);
+
+		[[nodiscard]] allocator_type get_allocator() const noexcept { return _driverKeyName.get_allocator(); }
+		const SP_DEVINFO_DATA& GetDevInfoData() const noexcept { return _devInfoData; }
 		void SetDriverKeyName(const std::wstring& driverKeyName);
 		void SetHardwareId(const std::wstring& hardwareId);
+		void SetHardwareIds(const std::vector<std::wstring>& hardwareIds);
+		void SetCompatibleIds(const std::vector<std::wstring>& compatibleIds);
 		void SetPowerState(const DEVICE_POWER_STATE PowerState);
 		void SetDeviceDescription(const std::wstring& value);
+		void SetContainerId(const std::wstring& containerId);
+
+		// String accessors return views into this object, valid until it is changed or destroyed
+		DEVICE_POWER_STATE GetPowerState() const noexcept { return _powerState; }
+		std::wstring_view GetPowerStateAsString() const noexcept;
+		std::wstring_view GetDriverKeyName() const noexcept { return _driverKeyName; }
+		std::wstring_view GetHardwareId() const noexcept { return _hardwareId; }
+		const std::pmr::vector<HardwareId>& GetHardwareIds() const noexcept { return _hardwareIds; }
+		const std::pmr::vector<HardwareId>& GetCompatibleIds() const noexcept { return _compatibleIds; }
 
-		DEVICE_POWER_STATE GetPowerState();
-		std::wstring GetPowerStateAsString();
-		std::wstring GetDriverKeyName() const { return _driverKeyName; }
-		std::wstring GetHardwareId() const { return _hardwareId; }
-		std::wstring GetDeviceDescription() const;
+		// True if any hardware ID carries this VID and PID
+		bool MatchesVidPid(uint16_t vendorId, uint16_t productId) const noexcept;
+		std::wstring_view GetDeviceDescription() const noexcept { return _deviceDescription; }
 		GUID GetClassGuid() const { return _devInfoData.ClassGuid; }
+		std::wstring_view GetContainerId() const noexcept { return _containerId; }
 
 	private:
 		HDEVINFO _devInfo = nullptr;
 		SP_DEVINFO_DATA _devInfoData = {};
-		std::wstring _classGuid;
-		std::wstring _driverKeyName;
-		std::wstring _hardwareId;
+		std::pmr::wstring _driverKeyName;
+		std::pmr::wstring _hardwareId;
+		std::pmr::vector<HardwareId> _hardwareIds;
+		std::pmr::vector<HardwareId> _compatibleIds;
 		DEVICE_POWER_STATE _powerState = PowerDeviceUnspecified;
-		std::wstring _deviceDescription;
+		std::pmr::wstring _deviceDescription;
+		std::pmr::wstring _containerId;
 	};
 }
\ No newline at end of file
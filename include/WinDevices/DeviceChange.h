@@ -0,0 +1,48 @@
+#pragma once
+
+#include "DeviceResultantInfo.h"
+#include "DeviceSnapshot.h"
+#include <cstdint>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Kind of difference between two device snapshots.
+	/// </summary>
+	enum class DeviceChangeType : uint8_t
+	{
+		Arrived = 1,
+		Removed = 2,
+		Changed = 3     // same device (see DeviceKeyOf), different properties
+	};
+
+	/// <summary>
+	/// One difference between two snapshots, carrying the full device record
+	/// (the new properties for Arrived/Changed, the last known ones for Removed).
+	/// </summary>
+	struct DeviceChange
+	{
+		uint64_t sequence = 0;          // assigned by DeviceChangeJournal; 0 = not journaled
+		uint64_t snapshotVersion = 0;   // DeviceSnapshot::version that produced the change
+		uint64_t deviceKey = 0;
+		DeviceChangeType type = DeviceChangeType::Arrived;
+		DeviceResultantInfo device;
+	};
+
+	/// @brief Identity of a device across scans: a hash of its device path,
+	/// instance id, serial number, VID/PID and location key.
+	[[nodiscard]] uint64_t DeviceKeyOf(const DeviceResultantInfo& device) noexcept;
+
+	/// @brief Hash of every field of a device; records that compare equal hash equal.
+	[[nodiscard]] uint64_t DeviceContentHashOf(const DeviceResultantInfo& device) noexcept;
+
+	/// @brief Computes the changes that turn previous into current.
+	///
+	/// Devices are matched by DeviceKeyOf as a multiset, so two identical devices on
+	/// different ports count separately; devices sharing a key are paired with an
+	/// identical previous device if there is one, otherwise with the earliest
+	/// unpaired one. Removals come first (in previous order), then arrivals and
+	/// property changes (in current order).
+	[[nodiscard]] std::vector<DeviceChange> DiffSnapshots(const DeviceSnapshot& previous, const DeviceSnapshot& current);
+}
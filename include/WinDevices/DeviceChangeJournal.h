@@ -0,0 +1,117 @@
+#pragma once
+
+#include "DeviceChange.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Retention and persistence settings of a DeviceChangeJournal.
+	/// </summary>
+	struct JournalPolicy
+	{
+		/// Change records kept before the oldest are folded into the baseline
+		/// (0 = never compact). Compaction keeps the newest half.
+		size_t compactionThreshold = 1024;
+
+		/// File the journal is appended to and reloaded from (empty = in memory only).
+		std::wstring filePath;
+	};
+
+	/// <summary>
+	/// Answer to DeviceChangeJournal::GetChangesSince.
+	/// </summary>
+	struct DeviceChangeSet
+	{
+		/// The requested sequence was compacted away: rebuild the device list from
+		/// baseline, then apply changes.
+		bool resync = false;
+
+		std::vector<DeviceResultantInfo> baseline;      // devices at baseSequence (resync only)
+		uint64_t baseSequence = 0;
+		std::vector<DeviceChange> changes;              // ordered by sequence
+		uint64_t lastSequence = 0;                      // pass to the next GetChangesSince call
+	};
+
+	/// @brief Append-only log of device changes keyed by a monotonically increasing
+	/// sequence number.
+	///
+	/// A consumer that remembers the last sequence it processed asks for
+	/// GetChangesSince(sequence) after a pause instead of fetching a full snapshot.
+	/// When more than compactionThreshold records accumulate, the oldest are folded
+	/// into a baseline device list; a consumer whose sequence predates the baseline
+	/// receives the baseline plus the remaining changes (resync).
+	///
+	/// With a file path, every record is appended to the file and the journal is
+	/// reloaded from it on construction, so sequence numbers keep increasing across
+	/// restarts. Compaction rewrites the file. A truncated last record (e.g. after a
+	/// crash) is ignored. A change is taken only once it is on file, so the journal
+	/// in memory never runs ahead of the one on disk.
+	///
+	/// All members are thread-safe.
+	class DeviceChangeJournal
+	{
+	public:
+		/// @throws DeviceIoException if the journal file cannot be created.
+		explicit DeviceChangeJournal(JournalPolicy policy = {});
+
+		DeviceChangeJournal(const DeviceChangeJournal&) = delete;
+		DeviceChangeJournal& operator=(const DeviceChangeJournal&) = delete;
+
+		/// @brief Assigns sequence numbers to the changes and appends them.
+		/// @return The sequence of the last record (unchanged if changes is empty).
+		/// @throws DeviceIoException if the changes cannot be written to the file; the
+		/// journal is left as it was and the next call rewrites the whole file.
+		uint64_t Append(std::vector<DeviceChange> changes);
+
+		/// @brief Appends the changes that turn the journaled device list into current.
+		///
+		/// Used when a journal is attached to an existing inventory or reloaded after a
+		/// restart, so the journal describes the devices that are actually present.
+		/// Must not run concurrently with Append().
+		/// @return The sequence of the last record.
+		/// @throws DeviceIoException as Append().
+		uint64_t Synchronize(const DeviceSnapshot& current);
+
+		/// @brief Returns every change with a sequence greater than sequence.
+		/// A sequence older than the baseline, or newer than the last record, yields a resync.
+		[[nodiscard]] DeviceChangeSet GetChangesSince(uint64_t sequence) const;
+
+		[[nodiscard]] uint64_t GetLastSequence() const;
+
+		/// @brief Sequence up to which changes have been folded into the baseline.
+		[[nodiscard]] uint64_t GetBaseSequence() const;
+
+		/// @brief Number of change records currently retained.
+		[[nodiscard]] size_t GetRecordCount() const;
+
+		/// @brief Folds all retained changes into the baseline.
+		/// @throws DeviceIoException if the file cannot be rewritten. The journal is
+		/// compacted in memory regardless; the file keeps the same devices as
+		/// uncompacted records.
+		void Compact();
+
+	private:
+		void CompactLocked(size_t keep);
+		static void ApplyChange(std::multimap<uint64_t, DeviceResultantInfo>& state, const DeviceChange& change);
+
+		void LoadFile();
+		void RewriteFileLocked(const std::vector<DeviceChange>* pending = nullptr);
+		void AppendToFileLocked(const std::vector<DeviceChange>& changes);
+
+		const JournalPolicy _policy;
+
+		mutable std::mutex _mutex;
+		uint64_t _baseSequence = 0;
+		uint64_t _lastSequence = 0;
+		std::multimap<uint64_t, DeviceResultantInfo> _baseline;    // by device key
+		std::deque<DeviceChange> _changes;
+		bool _rewritePending = false;       // last file write failed; replace the file instead of appending
+	};
+}
@@ -26,6 +26,10 @@ namespace KDM
 	/// - IOCTL_USB_GET_DESCRIPTOR_FROM_NODE_CONNECTION: USB descriptors
 	/// - IOCTL_USB_GET_PORT_CONNECTOR_PROPERTIES: USB 3.0 port properties
 	///
+	/// The handle is opened for overlapped I/O. A request still pending when the deadline
+	/// set by SetIoLimits() passes, or when its cancellation is requested, is cancelled with
+	/// CancelIoEx and fails with ERROR_TIMEOUT or ERROR_OPERATION_ABORTED.
+	///
 	/// @note This class is move-only due to managing a unique file handle.
 	/// Implements IDeviceCommunication for dependency injection and testing.
 	///
@@ -129,10 +133,27 @@ namespace KDM
 
 		/// @brief Returns the underlying file handle.
 		/// @return The device file handle.
-		/// @note The handle is owned by this object; do not close it.
+		/// @note The handle is owned by this object; do not close it. It is opened for
+		///       overlapped I/O, so issue requests through Ioctl() rather than DeviceIoControl.
 		[[nodiscard]] HANDLE GetFileHandle() override;
 
+		/// @brief Bounds the IOCTLs issued from now on by options.deadline and options.cancellation.
+		/// @note A driver that does not honour CancelIoEx still holds the call until it completes
+		///       the request, since the buffers must stay valid until then.
+		void SetIoLimits(const EnumerationOptions& options) override;
+
+		/// @brief DeviceIoControl on this handle, waiting for completion within the I/O limits.
+		/// @return FALSE with GetLastError() set on failure, like DeviceIoControl; ERROR_TIMEOUT
+		///         or ERROR_OPERATION_ABORTED if the request was cancelled.
+		BOOL Ioctl(DWORD ioControlCode, void* inBuffer, DWORD inBufferSize,
+			void* outBuffer, DWORD outBufferSize, DWORD* bytesReturned);
+
 	private:
+		DWORD AwaitIo(OVERLAPPED& overlapped);
+
 		wil::unique_hfile _hFile;
+		wil::unique_event _ioEvent;     // completion event of the single request in flight
+		std::optional<std::chrono::steady_clock::time_point> _ioDeadline;
+		CancellationToken _ioCancellation;
 	};
 }
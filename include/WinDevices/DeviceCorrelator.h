@@ -0,0 +1,72 @@
+#pragma once
+
+#include "DevInfoData.h"
+#include "EnumerationOptions.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// SetupAPI nodes linked to one connected hub port by DeviceCorrelator::Join.
+	/// </summary>
+	struct PortCorrelation
+	{
+		const DevInfoData* busNode = nullptr;       // USB bus-layer node (driver key match)
+		const DevInfoData* functionNode = nullptr;  // node whose setup class describes the device
+		CorrelationRule rule = CorrelationRule::None;
+	};
+
+	/// @brief Hash join between the ports of a USB scan and the SetupAPI device nodes.
+	///
+	/// The constructor indexes the nodes once per scan by driver key, by the VID/PID of
+	/// their parsed hardware IDs (whole-device nodes first, then by MI interface number),
+	/// by container ID and by description. Join() then links a port with a few lookups:
+	///
+	/// 1. the bus-layer node whose driver key equals the port's;
+	/// 2. a function node with the port's VID/PID and a setup class other than the
+	///    bus-layer node's (interface and HID children of composite devices);
+	/// 3. for non-hub ports, such a node in the bus-layer node's container whose
+	///    hardware IDs carry no VID/PID or the port's own (e.g. USBSTOR disks);
+	/// 4. otherwise the bus-layer node itself, any VID/PID node, or a node whose
+	///    description equals the product string.
+	///
+	/// The rule that supplied the function node is reported per port and counted in
+	/// GetStats(). The correlator refers to the indexed nodes, which must outlive it.
+	class DeviceCorrelator
+	{
+	public:
+		explicit DeviceCorrelator(const std::vector<DevInfoData>& nodes);
+
+		DeviceCorrelator(const DeviceCorrelator&) = delete;
+		DeviceCorrelator& operator=(const DeviceCorrelator&) = delete;
+
+		/// @brief Links one connected port to its nodes and counts the outcome.
+		/// @param productName USB product string of the device, used only as a last resort.
+		[[nodiscard]] PortCorrelation Join(std::wstring_view driverKey, uint16_t vendorId, uint16_t productId,
+			bool isHub, std::wstring_view productName);
+
+		[[nodiscard]] const CorrelationStats& GetStats() const noexcept { return _stats; }
+
+	private:
+		[[nodiscard]] const DevInfoData* FindFunction(const std::vector<uint32_t>* candidates,
+			const DevInfoData* busNode, uint16_t vendorId, uint16_t productId, bool requireVidPidOrNone) const;
+
+		void Count(const PortCorrelation& correlation) noexcept;
+
+		[[nodiscard]] static uint32_t VidPidKey(uint16_t vendorId, uint16_t productId) noexcept
+		{
+			return (static_cast<uint32_t>(vendorId) << 16) | productId;
+		}
+
+		const std::vector<DevInfoData>& _nodes;
+		std::unordered_map<std::wstring_view, uint32_t> _byDriverKey;     // views into _nodes
+		std::unordered_map<uint32_t, std::vector<uint32_t>> _byVidPid;
+		std::unordered_map<std::wstring_view, std::vector<uint32_t>> _byContainerId;     // views into _nodes
+		std::unordered_map<std::wstring_view, uint32_t> _byDescription;     // views into _nodes
+		CorrelationStats _stats;
+	};
+}
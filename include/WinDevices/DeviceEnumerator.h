@@ -2,6 +2,7 @@
 
 #include "DevInfoData.h"
 #include "IDeviceEnumerator.h"
+#include <functional>
 
 namespace KDM
 {
@@ -68,6 +69,14 @@ namespace KDM
 		/// @throws wil::ResultException if enumeration fails (other than ERROR_NO_MORE_ITEMS).
 		[[nodiscard]] std::vector<DevInfoData> GetDeviceInstances() override;
 
+		/// @brief Visits every device instance in the set without reading any properties.
+		///
+		/// SetupDiEnumDeviceInfo already fills SP_DEVINFO_DATA::ClassGuid, so callers can
+		/// filter by setup class before paying for registry reads.
+		/// @param callback Invoked once per device, in enumeration order.
+		/// @throws wil::ResultException if enumeration fails (other than ERROR_NO_MORE_ITEMS).
+		void ForEachDevice(const std::function<void(const SP_DEVINFO_DATA&)>& callback);
+
 	private:
 		using unique_hdevinfo = wil::unique_any<HDEVINFO,
 			decltype(&::SetupDiDestroyDeviceInfoList),
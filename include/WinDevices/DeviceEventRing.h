@@ -0,0 +1,147 @@
+#pragma once
+
+#include "DeviceChange.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace KDM
+{
+	/// <summary>
+	/// Kind of change reported by a DeviceEvent.
+	/// </summary>
+	enum class DeviceEventType : uint8_t
+	{
+		Arrived = 1,
+		Removed = 2,
+		Changed = 3
+	};
+
+	/// <summary>
+	/// Compact, fixed-size record of one device change. Trivially copyable so it can
+	/// be handed to C and .NET callers without conversion.
+	/// </summary>
+	struct DeviceEvent
+	{
+		uint64_t sequence = 0;          // position in the ring, starting at 1; assigned by Publish()
+		uint64_t snapshotVersion = 0;   // DeviceSnapshot::version that produced the event
+		uint64_t deviceKey = 0;         // identity of the device across scans (see DeviceKeyOf)
+		int64_t timestampMs = 0;        // wall clock, milliseconds since the Unix epoch
+		uint16_t vendorId = 0;
+		uint16_t productId = 0;
+		uint8_t deviceClass = 0;
+		uint8_t interfaceClass = 0;
+		DeviceEventType type = DeviceEventType::Arrived;
+		uint8_t reserved = 0;
+	};
+
+	static_assert(std::is_trivially_copyable_v<DeviceEvent>, "DeviceEvent is copied as raw words");
+	static_assert(sizeof(DeviceEvent) % sizeof(uint64_t) == 0, "DeviceEvent is copied as raw words");
+
+	class DeviceEventSubscriber;
+
+	/// @brief Bounded multi-producer / multi-consumer broadcast ring of DeviceEvents.
+	///
+	/// Producers never wait for consumers: when a subscriber falls more than
+	/// capacity events behind, the oldest events are overwritten and counted as
+	/// dropped for that subscriber. Every subscriber has its own cursor and sees
+	/// every event published after it subscribed. Slots are guarded by a sequence
+	/// stamp (seqlock), so neither side takes a lock.
+	///
+	/// @code
+	/// auto subscriber = manager.SubscribeEvents();
+	/// DeviceEvent events[64];
+	/// size_t count = subscriber->Poll(events, 64);
+	/// @endcode
+	class DeviceEventRing
+	{
+	public:
+		static constexpr size_t DefaultCapacity = 1024;
+
+		/// @param capacity Number of slots, rounded up to a power of two.
+		/// @throws InvalidDeviceArgumentException if capacity is 0.
+		explicit DeviceEventRing(size_t capacity = DefaultCapacity);
+		~DeviceEventRing() = default;
+
+		DeviceEventRing(const DeviceEventRing&) = delete;
+		DeviceEventRing& operator=(const DeviceEventRing&) = delete;
+
+		/// @brief Appends an event, overwriting the oldest one when the ring is full.
+		/// @return The sequence number assigned to the event.
+		uint64_t Publish(DeviceEvent event) noexcept;
+
+		/// @brief Creates a subscriber positioned after the last published event.
+		/// The subscriber must not outlive the ring.
+		[[nodiscard]] std::unique_ptr<DeviceEventSubscriber> Subscribe() const;
+
+		[[nodiscard]] size_t GetCapacity() const noexcept { return _mask + 1; }
+
+		/// @brief Number of events published so far (= sequence of the last one).
+		[[nodiscard]] uint64_t GetPublishedCount() const noexcept;
+
+	private:
+		friend class DeviceEventSubscriber;
+
+		static constexpr size_t WordsPerEvent = sizeof(DeviceEvent) / sizeof(uint64_t);
+
+		// stamp: 0 = empty, 2*pos+1 = being written, 2*pos+2 = holds the event at pos
+		struct alignas(64) Slot
+		{
+			std::atomic<uint64_t> stamp{ 0 };
+			std::array<std::atomic<uint64_t>, WordsPerEvent> words{};
+		};
+
+		enum class ReadResult
+		{
+			Ready,
+			NotPublished,   // the producer of this position has not finished yet
+			Overwritten     // a later event already took the slot
+		};
+
+		ReadResult TryRead(uint64_t position, DeviceEvent& event) const noexcept;
+
+		std::unique_ptr<Slot[]> _slots;
+		size_t _mask = 0;
+		alignas(64) std::atomic<uint64_t> _head{ 0 };   // next position to claim
+	};
+
+	/// @brief Cursor of one consumer into a DeviceEventRing.
+	///
+	/// Poll() may be called from several threads; each event is then delivered to
+	/// exactly one of them.
+	class DeviceEventSubscriber
+	{
+	public:
+		DeviceEventSubscriber(const DeviceEventSubscriber&) = delete;
+		DeviceEventSubscriber& operator=(const DeviceEventSubscriber&) = delete;
+
+		/// @brief Copies up to maxEvents pending events, oldest first.
+		/// @return Number of events written to events.
+		size_t Poll(DeviceEvent* events, size_t maxEvents) noexcept;
+
+		/// @brief Events that were overwritten before this subscriber read them.
+		[[nodiscard]] uint64_t GetDroppedCount() const noexcept;
+
+		/// @brief Events published but not yet polled (at most the ring capacity).
+		[[nodiscard]] uint64_t GetPendingCount() const noexcept;
+
+	private:
+		friend class DeviceEventRing;
+
+		DeviceEventSubscriber(const DeviceEventRing& ring, uint64_t position) noexcept :
+			_ring(ring), _cursor(position)
+		{
+		}
+
+		const DeviceEventRing& _ring;
+		alignas(64) std::atomic<uint64_t> _cursor;
+		std::atomic<uint64_t> _dropped{ 0 };
+	};
+
+	/// @brief Publishes one event per change, in order.
+	/// @return Number of events published.
+	size_t PublishChanges(DeviceEventRing& ring, const std::vector<DeviceChange>& changes);
+}
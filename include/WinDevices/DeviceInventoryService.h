@@ -0,0 +1,133 @@
+#pragma once
+
+#include "DeviceSnapshot.h"
+#include "DevicesManager.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace KDM
+{
+	class IUsbBackend;
+
+	/// <summary>
+	/// Refresh cadence of a DeviceInventoryService.
+	/// </summary>
+	struct InventoryRefreshPolicy
+	{
+		/// Interval after a refresh that changed the inventory.
+		std::chrono::milliseconds fastInterval{ 250 };
+
+		/// Upper bound the interval grows to (doubling per unchanged refresh) while idle.
+		std::chrono::milliseconds slowInterval{ 5000 };
+
+		/// Time budget of one scan (0 = unbounded).
+		std::chrono::milliseconds scanTimeout{ 10000 };
+
+		/// Publish scans that skipped hubs or ports. Off by default so a hub that
+		/// times out does not look like its devices were unplugged.
+		bool publishPartialScans = false;
+	};
+
+	/// <summary>
+	/// Counters of a DeviceInventoryService.
+	/// </summary>
+	struct InventoryStats
+	{
+		uint64_t refreshes = 0;            // scans attempted
+		uint64_t changes = 0;              // scans that published a new inventory
+		uint64_t incompleteScans = 0;      // scans not published because parts were skipped
+		uint64_t failures = 0;             // scans that threw
+		std::chrono::milliseconds currentInterval{ 0 };
+		std::string lastError;
+	};
+
+	/// @brief Keeps a USB device inventory fresh on a background thread.
+	///
+	/// The service owns a DevicesManager and rescans the bus on its own thread.
+	/// The interval adapts: fastInterval right after the inventory changed,
+	/// doubling on every unchanged scan up to slowInterval. A new snapshot is
+	/// published only when the device list differs from the current one. It is
+	/// the manager's snapshot of that scan, shared rather than copied, so it keeps
+	/// its topology and string arena; its version increases with every change but
+	/// can skip the numbers of unchanged scans.
+	///
+	/// Callers never enumerate on their own thread: GetDevices() returns the
+	/// current snapshot, waking the refresh thread and waiting for its scan
+	/// only when the snapshot is older than the caller accepts.
+	///
+	/// The bus is reached through an IUsbBackend, so the service runs against
+	/// a simulated bus in tests. All members are thread-safe.
+	///
+	/// @code
+	/// KDM::DeviceInventoryService inventory;
+	/// auto devices = inventory.GetDevices(std::chrono::seconds(2));
+	/// auto next = inventory.WaitForChange(devices->version, std::chrono::seconds(30));
+	/// @endcode
+	class DeviceInventoryService
+	{
+	public:
+		/// @brief Starts a service scanning the system bus.
+		explicit DeviceInventoryService(InventoryRefreshPolicy policy = {});
+
+		/// @brief Starts a service scanning through the given backend.
+		/// @throws InvalidDeviceArgumentException if fastInterval is not positive or
+		/// exceeds slowInterval. A null backend is rejected by DevicesManager.
+		DeviceInventoryService(std::unique_ptr<IUsbBackend> backend, InventoryRefreshPolicy policy = {});
+
+		/// @brief Stops the refresh thread (waits for a running scan to finish).
+		~DeviceInventoryService();
+
+		DeviceInventoryService(const DeviceInventoryService&) = delete;
+		DeviceInventoryService& operator=(const DeviceInventoryService&) = delete;
+		DeviceInventoryService(DeviceInventoryService&&) = delete;
+		DeviceInventoryService& operator=(DeviceInventoryService&&) = delete;
+
+		/// @brief Returns an inventory at most maxAge old.
+		///
+		/// If the last successful scan is older, the refresh thread is woken and the
+		/// call waits for that scan. When the scan fails or is incomplete the current
+		/// (older) snapshot is returned; compare publishedAt if that matters.
+		/// @return Never null; version 0 until the first scan has been published.
+		[[nodiscard]] DeviceSnapshotPtr GetDevices(std::chrono::milliseconds maxAge);
+
+		/// @brief Returns the current inventory without waiting.
+		[[nodiscard]] DeviceSnapshotPtr GetSnapshot() const;
+
+		/// @brief Waits until an inventory newer than sinceVersion is published.
+		/// @return The new snapshot, or nullptr on timeout or when the service stops.
+		[[nodiscard]] DeviceSnapshotPtr WaitForChange(uint64_t sinceVersion, std::chrono::milliseconds timeout);
+
+		/// @brief Wakes the refresh thread to scan now (e.g. on a device arrival notification).
+		void RequestRefresh();
+
+		/// @brief Stops the refresh thread and releases waiters. Idempotent.
+		void Stop();
+
+		[[nodiscard]] InventoryStats GetStats() const;
+
+	private:
+		void Run();
+		void Refresh();
+
+		const InventoryRefreshPolicy _policy;
+		DevicesManager _manager;                    // used by the refresh thread only
+
+		mutable std::mutex _mutex;
+		std::condition_variable _wake;              // refresh thread: stop or refresh requested
+		std::condition_variable _refreshed;         // callers: a scan finished
+		DeviceSnapshotPtr _current;
+		std::chrono::steady_clock::time_point _lastRefresh{};   // last published or confirmed scan
+		uint64_t _startedScans = 0;
+		uint64_t _completedScans = 0;
+		bool _refreshRequested = false;
+		bool _stopping = false;
+		InventoryStats _stats;
+
+		std::thread _thread;                        // last member: started once the rest is initialised
+	};
+}
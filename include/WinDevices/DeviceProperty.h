@@ -1,12 +1,16 @@
 #pragma once
 
+#include "DevicePropertyReader.h"
+#include "IDevicePropertySource.h"
+
 namespace KDM
 {
 	/// @brief Retrieves device properties from Windows registry via SetupAPI.
 	///
 	/// This class wraps SetupDiGetDeviceRegistryProperty to provide a convenient
 	/// interface for querying device properties such as driver key, hardware ID,
-	/// device description, and power state.
+	/// device description, and power state. Decoding is done by DevicePropertyReader,
+	/// for which this class is the SetupAPI property source.
 	///
 	/// @note Some properties may not be available for certain device types.
 	/// GetStringProperty returns false (rather than throwing) when a property
@@ -15,11 +19,13 @@ namespace KDM
 	/// @example
 	/// @code
 	/// DeviceProperty propReader(hDevInfo, devInfoData);
-	/// if (std::wstring driverKey; propReader.GetStringProperty(SPDRP_DRIVER, driverKey)) {
-	///     // Use driverKey
+	/// DeviceProperties properties = propReader.GetProperties(
+	///     DevicePropertyMask::DriverKey | DevicePropertyMask::HardwareId);
+	/// if (properties.Has(DevicePropertyMask::DriverKey)) {
+	///     // Use properties.driverKey
 	/// }
 	/// @endcode
-	class DeviceProperty
+	class DeviceProperty : public IDevicePropertySource
 	{
 	public:
 		/// @brief Constructs a DeviceProperty reader for a specific device.
@@ -29,8 +35,8 @@ namespace KDM
 
 		/// @brief Retrieves a string property from the device registry.
 		///
-		/// Uses a two-phase query: first to determine required buffer size,
-		/// then to retrieve the actual property value.
+		/// Reads into a stack buffer first and queries again only if the value
+		/// does not fit (ERROR_INSUFFICIENT_BUFFER).
 		///
 		/// @param property The SPDRP_* property identifier (e.g., SPDRP_DRIVER, SPDRP_DEVICEDESC).
 		/// @param[out] resultValue Receives the property value if successful.
@@ -45,6 +51,11 @@ namespace KDM
 		/// @return The device's power state, or PowerDeviceUnspecified if unavailable.
 		DEVICE_POWER_STATE GetPowerState();
 
+		/// @brief Reads every property selected by mask (DevicePropertyMask bits) in one call.
+		[[nodiscard]] DeviceProperties GetProperties(uint32_t mask);
+
+		[[nodiscard]] DWORD ReadProperty(DWORD property, BYTE* buffer, DWORD size, DWORD& requiredSize) override;
+
 	private:
 		HDEVINFO _deviceInfo;
 		SP_DEVINFO_DATA _deviceInfoData;
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "IDevicePropertySource.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+	/// @brief Bits selecting the properties DevicePropertyReader::GetProperties reads.
+	namespace DevicePropertyMask
+	{
+		constexpr uint32_t Description = 1u << 0;     // SPDRP_DEVICEDESC
+		constexpr uint32_t FriendlyName = 1u << 1;    // SPDRP_FRIENDLYNAME
+		constexpr uint32_t Manufacturer = 1u << 2;    // SPDRP_MFG
+		constexpr uint32_t HardwareId = 1u << 3;      // SPDRP_HARDWAREID (all entries)
+		constexpr uint32_t DriverKey = 1u << 4;       // SPDRP_DRIVER
+		constexpr uint32_t PowerState = 1u << 5;      // SPDRP_DEVICE_POWER_DATA
+		constexpr uint32_t CompatibleIds = 1u << 6;   // SPDRP_COMPATIBLEIDS (all entries)
+		constexpr uint32_t ContainerId = 1u << 7;     // SPDRP_BASE_CONTAINERID
+	}
+
+	/// <summary>
+	/// Properties of one device read by DevicePropertyReader::GetProperties.
+	/// A field is meaningful only if its DevicePropertyMask bit is set in present.
+	/// </summary>
+	struct DeviceProperties
+	{
+		uint32_t present = 0;
+		std::wstring description;
+		std::wstring friendlyName;
+		std::wstring manufacturer;
+		std::wstring hardwareId;                    // first entry of hardwareIds
+		std::vector<std::wstring> hardwareIds;      // most specific first
+		std::vector<std::wstring> compatibleIds;
+		std::wstring driverKey;
+		std::wstring containerId;                   // {GUID} shared by all nodes of one physical device
+		DEVICE_POWER_STATE powerState = PowerDeviceUnspecified;
+
+		[[nodiscard]] bool Has(uint32_t mask) const noexcept { return (present & mask) == mask; }
+	};
+
+	/// @brief Decodes registry properties of one device read through an IDevicePropertySource.
+	///
+	/// Each property is read straight into a stack buffer, so a value that fits costs a
+	/// single source call. Only when the source reports ERROR_INSUFFICIENT_BUFFER is the
+	/// value read again into an overflow buffer, which is kept for the reader's lifetime
+	/// and reused by later oversized properties.
+	///
+	/// @code
+	/// DeviceProperties properties = DevicePropertyReader(source).GetProperties(
+	///     DevicePropertyMask::Description | DevicePropertyMask::HardwareId);
+	/// @endcode
+	///
+	/// Not thread-safe.
+	class DevicePropertyReader
+	{
+	public:
+		static constexpr DWORD StackBufferSize = 512;
+
+		explicit DevicePropertyReader(IDevicePropertySource& source) noexcept;
+
+		/// @brief Reads a string property; for REG_MULTI_SZ values, the first string.
+		/// @return false if the property doesn't exist or is inaccessible for this device.
+		bool GetStringProperty(DWORD property, std::wstring& resultValue);
+
+		/// @brief Reads a REG_MULTI_SZ property (SPDRP_HARDWAREID, SPDRP_COMPATIBLEIDS) entry by entry.
+		/// @param[out] resultValues Replaced by the non-empty entries, in registry order.
+		/// @return false if the property doesn't exist or is inaccessible for this device.
+		bool GetMultiStringProperty(DWORD property, std::vector<std::wstring>& resultValues);
+
+		/// @brief Retrieves the current power state of the device.
+		/// @return The device's power state, or PowerDeviceUnspecified if unavailable.
+		DEVICE_POWER_STATE GetPowerState();
+
+		/// @brief Reads every property selected by mask (DevicePropertyMask bits).
+		[[nodiscard]] DeviceProperties GetProperties(uint32_t mask);
+
+	private:
+		// Reads property into stackBuffer, or _overflow if it does not fit; on success data
+		// points at the value and size is its length in bytes
+		bool Read(DWORD property, BYTE* stackBuffer, const BYTE*& data, DWORD& size);
+
+		IDevicePropertySource& _source;
+		std::vector<BYTE> _overflow;
+	};
+}
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <Windows.h>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 /// @brief Encapsulates device information retrieved from USB or device class enumeration.
 ///
@@ -11,64 +16,87 @@
 /// (device path, setup class GUID, friendly name).
 ///
 /// **USB Enumeration Fields** (populated by EnumerateUsbDevices):
-/// - manufacturer_: From USB string descriptor (iManufacturer)
-/// - product_: From USB string descriptor (iProduct)
-/// - serialNumber_: From USB string descriptor (iSerialNumber)
+/// - Manufacturer: From USB string descriptor (iManufacturer)
+/// - Product: From USB string descriptor (iProduct)
+/// - SerialNumber: From USB string descriptor (iSerialNumber)
 /// - vendorId_/productId_: From USB device descriptor
 /// - deviceClass_: From USB device descriptor (bDeviceClass)
 /// - interfaceClass_: From USB interface descriptor (bInterfaceClass)
-/// - vendorName_: Looked up from USB-IF vendor database
-/// - interfaceClassName_: Human-readable name for the interface class
+/// - VendorName: Looked up from USB-IF vendor database
+/// - InterfaceClassName: Human-readable name for the interface class
+/// - locationKey_: Controller and port chain the device is attached to (see UsbLocation)
 ///
 /// **Device Class Enumeration Fields** (populated by EnumerateByDeviceClass):
-/// - description_: From SPDRP_DEVICEDESC registry property
-/// - friendlyName_: From SPDRP_FRIENDLYNAME registry property
-/// - manufacturer_: From SPDRP_MFG registry property
-/// - deviceId_: Hardware ID from SPDRP_HARDWAREID
-/// - devicePath_: Windows device path for DeviceIoControl access
+/// - Description: From SPDRP_DEVICEDESC registry property
+/// - FriendlyName: From SPDRP_FRIENDLYNAME registry property
+/// - Manufacturer: From SPDRP_MFG registry property
+/// - DeviceId: Hardware ID from SPDRP_HARDWAREID
+/// - DevicePath: Windows device path for DeviceIoControl access
 /// - setupClassGuid_: Windows Device Setup Class GUID
 ///
+/// The nine strings share one buffer: each field is a range of blob_ whose end is kept
+/// in ends_, so a populated record costs a single allocation and a copy copies one
+/// buffer. Getters return views into that buffer, which a setter call may invalidate.
+/// Fields hold at most MaxStringLength characters together.
+///
+/// The buffer is allocated from the memory resource given at construction (the default
+/// resource otherwise), so a scan can place all of its results in one arena. Copies use
+/// the default resource unless another one is passed to the allocator-extended copy
+/// constructor; moves keep the source's resource.
+///
 /// @note This class uses value semantics and is fully copyable/movable.
 class DeviceResultantInfo
 {
 public:
+	using allocator_type = std::pmr::polymorphic_allocator<wchar_t>;
+
+	/// @brief Largest total length, in characters, of all string fields of one record.
+	static constexpr size_t MaxStringLength = UINT16_MAX;
+
 	DeviceResultantInfo() = default;
 
+	/// @brief Creates an empty record whose strings are allocated through allocator.
+	explicit DeviceResultantInfo(const allocator_type& allocator);
+
+	/// @brief Copies or moves other into storage obtained through allocator.
+	DeviceResultantInfo(const DeviceResultantInfo& other, const allocator_type& allocator);
+	DeviceResultantInfo(DeviceResultantInfo&& other, const allocator_type& allocator);
+
 	// Value semantics - fully copyable and movable
 	DeviceResultantInfo(const DeviceResultantInfo&) = default;
 	DeviceResultantInfo& operator=(const DeviceResultantInfo&) = default;
 	DeviceResultantInfo(DeviceResultantInfo&&) noexcept = default;
-	DeviceResultantInfo& operator=(DeviceResultantInfo&&) noexcept = default;
+	DeviceResultantInfo& operator=(DeviceResultantInfo&&) = default;     // copies when the resources differ
 	~DeviceResultantInfo() = default;
 
 	// ==================== String Getters ====================
 
 	/// @brief Returns the manufacturer name (from USB descriptor or registry).
-	[[nodiscard]] const std::wstring& GetManufacturer() const noexcept { return manufacturer_; }
+	[[nodiscard]] std::wstring_view GetManufacturer() const noexcept { return Get(Manufacturer); }
 
 	/// @brief Returns the product name (from USB descriptor or registry fallback).
-	[[nodiscard]] const std::wstring& GetProduct() const noexcept { return product_; }
+	[[nodiscard]] std::wstring_view GetProduct() const noexcept { return Get(Product); }
 
 	/// @brief Returns the serial number (from USB string descriptor).
-	[[nodiscard]] const std::wstring& GetSerialNumber() const noexcept { return serialNumber_; }
+	[[nodiscard]] std::wstring_view GetSerialNumber() const noexcept { return Get(SerialNumber); }
 
 	/// @brief Returns the device description (from Windows registry SPDRP_DEVICEDESC).
-	[[nodiscard]] const std::wstring& GetDescription() const noexcept { return description_; }
+	[[nodiscard]] std::wstring_view GetDescription() const noexcept { return Get(Description); }
 
 	/// @brief Returns the hardware ID (e.g., "USB\\VID_0951&PID_172B").
-	[[nodiscard]] const std::wstring& GetDeviceId() const noexcept { return deviceId_; }
+	[[nodiscard]] std::wstring_view GetDeviceId() const noexcept { return Get(DeviceId); }
 
 	/// @brief Returns the friendly name (from Windows registry SPDRP_FRIENDLYNAME).
-	[[nodiscard]] const std::wstring& GetFriendlyName() const noexcept { return friendlyName_; }
+	[[nodiscard]] std::wstring_view GetFriendlyName() const noexcept { return Get(FriendlyName); }
 
 	/// @brief Returns the Windows device path for DeviceIoControl access.
-	[[nodiscard]] const std::wstring& GetDevicePath() const noexcept { return devicePath_; }
+	[[nodiscard]] std::wstring_view GetDevicePath() const noexcept { return Get(DevicePath); }
 
 	/// @brief Returns the USB-IF registered vendor name (looked up by VID).
-	[[nodiscard]] const std::wstring& GetVendorName() const noexcept { return vendorName_; }
+	[[nodiscard]] std::wstring_view GetVendorName() const noexcept { return Get(VendorName); }
 
 	/// @brief Returns the human-readable USB interface class name.
-	[[nodiscard]] const std::wstring& GetInterfaceClassName() const noexcept { return interfaceClassName_; }
+	[[nodiscard]] std::wstring_view GetInterfaceClassName() const noexcept { return Get(InterfaceClassName); }
 
 	// ==================== Numeric/Boolean Getters ====================
 
@@ -95,42 +123,76 @@ public:
 	/// @brief Returns true if the device is currently connected.
 	[[nodiscard]] bool IsConnected() const noexcept { return isConnected_; }
 
+	/// @brief Returns the packed physical location (KDM::UsbLocation), or 0 if unknown.
+	[[nodiscard]] uint64_t GetLocationKey() const noexcept { return locationKey_; }
+
 	// ==================== Setters ====================
 
-	void SetManufacturer(std::wstring value) { manufacturer_ = std::move(value); }
-	void SetProduct(std::wstring value) { product_ = std::move(value); }
-	void SetSerialNumber(std::wstring value) { serialNumber_ = std::move(value); }
-	void SetDescription(std::wstring value) { description_ = std::move(value); }
-	void SetDeviceId(std::wstring value) { deviceId_ = std::move(value); }
-	void SetFriendlyName(std::wstring value) { friendlyName_ = std::move(value); }
-	void SetDevicePath(std::wstring value) { devicePath_ = std::move(value); }
-	void SetVendorName(std::wstring value) { vendorName_ = std::move(value); }
-	void SetInterfaceClassName(std::wstring value) { interfaceClassName_ = std::move(value); }
+	void SetManufacturer(std::wstring_view value) { Set(Manufacturer, value); }
+	void SetProduct(std::wstring_view value) { Set(Product, value); }
+	void SetSerialNumber(std::wstring_view value) { Set(SerialNumber, value); }
+	void SetDescription(std::wstring_view value) { Set(Description, value); }
+	void SetDeviceId(std::wstring_view value) { Set(DeviceId, value); }
+	void SetFriendlyName(std::wstring_view value) { Set(FriendlyName, value); }
+	void SetDevicePath(std::wstring_view value) { Set(DevicePath, value); }
+	void SetVendorName(std::wstring_view value) { Set(VendorName, value); }
+	void SetInterfaceClassName(std::wstring_view value) { Set(InterfaceClassName, value); }
 
 	void SetDeviceClass(UCHAR value) noexcept { deviceClass_ = value; }
 	void SetInterfaceClass(UCHAR value) noexcept { interfaceClass_ = value; }
 	void SetSetupClassGuid(const GUID& value) noexcept { setupClassGuid_ = value; }
-	void SetVendorId(unsigned int value) noexcept { vendorId_ = value; }
-	void SetProductId(unsigned int value) noexcept { productId_ = value; }
+	void SetVendorId(uint16_t value) noexcept { vendorId_ = value; }
+	void SetProductId(uint16_t value) noexcept { productId_ = value; }
 	void SetIsUsbDevice(bool value) noexcept { isUsbDevice_ = value; }
 	void SetIsConnected(bool value) noexcept { isConnected_ = value; }
+	void SetLocationKey(uint64_t value) noexcept { locationKey_ = value; }
+
+	/// @brief Returns the allocator the strings of this record are allocated through.
+	[[nodiscard]] allocator_type get_allocator() const noexcept { return blob_.get_allocator(); }
+
+	// ==================== Comparison ====================
+
+	/// @brief Field-wise equality; used to detect inventory changes between scans.
+	[[nodiscard]] bool operator==(const DeviceResultantInfo& other) const;
+
+	[[nodiscard]] bool operator!=(const DeviceResultantInfo& other) const { return !(*this == other); }
 
 private:
-	std::wstring manufacturer_;
-	std::wstring product_;
-	std::wstring serialNumber_;
-	std::wstring description_;
-	std::wstring deviceId_;
-	std::wstring friendlyName_;
-	std::wstring devicePath_;
-	std::wstring vendorName_;
-	std::wstring interfaceClassName_;
+	enum Field : uint8_t
+	{
+		Manufacturer, Product, SerialNumber, Description, DeviceId,
+		FriendlyName, DevicePath, VendorName, InterfaceClassName, FieldCount
+	};
+
+	[[nodiscard]] std::wstring_view Get(Field field) const noexcept
+	{
+		const size_t begin = field == 0 ? 0 : ends_[field - 1];
+		return std::wstring_view(blob_).substr(begin, ends_[field] - begin);
+	}
+
+	// Replaces the range of field in blob_ and shifts the ends of the fields after it
+	void Set(Field field, std::wstring_view value);
+
+	std::pmr::wstring blob_;
+	uint16_t ends_[FieldCount] = {};
 
+	// Scalars ordered by size so the record packs without interior padding
+	GUID setupClassGuid_ = { 0 };
+	uint64_t locationKey_ = 0;     // 0 = unknown
+	uint16_t vendorId_ = 0;
+	uint16_t productId_ = 0;
 	UCHAR deviceClass_ = 0;
 	UCHAR interfaceClass_ = 0xFF;  // 0xFF = not set
-	GUID setupClassGuid_ = { 0 };
-	unsigned int vendorId_ = 0;
-	unsigned int productId_ = 0;
 	bool isUsbDevice_ = false;
 	bool isConnected_ = false;
 };
+
+// blob_ and ends_ compare equal exactly when every string field does
+inline bool DeviceResultantInfo::operator==(const DeviceResultantInfo& other) const
+{
+	return blob_ == other.blob_ && std::equal(std::begin(ends_), std::end(ends_), std::begin(other.ends_)) &&
+		IsEqualGUID(setupClassGuid_, other.setupClassGuid_) && locationKey_ == other.locationKey_ &&
+		vendorId_ == other.vendorId_ && productId_ == other.productId_ &&
+		deviceClass_ == other.deviceClass_ && interfaceClass_ == other.interfaceClass_ &&
+		isUsbDevice_ == other.isUsbDevice_ && isConnected_ == other.isConnected_;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "DeviceResultantInfo.h"
+#include "UsbTopology.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Immutable device inventory published by DevicesManager after each enumeration.
+	/// A snapshot is never modified once published; a new enumeration publishes a new
+	/// snapshot, so readers holding an older one keep a consistent view for as long as
+	/// they hold it.
+	/// </summary>
+	struct DeviceSnapshot
+	{
+		/// Arena holding the strings of devices, if the publisher allocated them from one.
+		/// Declared first so that it is released after the devices; discarding the
+		/// snapshot then frees the strings of every device in one step.
+		std::shared_ptr<std::pmr::memory_resource> arena;
+
+		/// Increases with every publication of the owning manager; 0 = nothing published yet.
+		uint64_t version = 0;
+
+		/// When the snapshot was published.
+		std::chrono::steady_clock::time_point publishedAt{};
+
+		std::vector<DeviceResultantInfo> devices;
+
+		/// Bus structure found by a USB scan; empty for snapshots not produced by one.
+		UsbTopology topology;
+	};
+
+	using DeviceSnapshotPtr = std::shared_ptr<const DeviceSnapshot>;
+}
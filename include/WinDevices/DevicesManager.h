@@ -2,14 +2,20 @@
 #define _WIN32_WINNT _WIN32_WINNT_WIN7
 
 #include <Windows.h>
+#include "DeviceChangeJournal.h"
+#include "DeviceEventRing.h"
+#include "DeviceSnapshot.h"
+#include "EnumerationOptions.h"
+#include "HubHealthTracker.h"
+#include "SharedInventory.h"
 #include <memory>
+#include <string>
 #include <vector>
 
-// Forward declaration - DeviceResultantInfo is in global namespace
-class DeviceResultantInfo;
-
 namespace KDM
 {
+	class IUsbBackend;
+
 	/// @brief High-level manager for enumerating and accessing USB devices.
 	///
 	/// DevicesManager provides a simple interface for discovering USB devices
@@ -24,16 +30,25 @@ namespace KDM
 	///
 	/// 2. **Device Class Enumeration** (EnumerateByDeviceClass): Uses Windows SetupAPI
 	///    to enumerate devices by their Device Setup Class GUID (e.g., keyboard, mouse,
-	///    disk drive, network adapter).
+	///    disk drive, network adapter). EnumerateByDeviceClasses collects several classes
+	///    in a single pass.
+	///
+	/// Results are published as immutable DeviceSnapshot objects swapped in atomically
+	/// when an enumeration completes. Any number of threads may call GetSnapshot(),
+	/// GetDeviceCount() and GetHubHealth() while another thread enumerates: readers never
+	/// wait for the scan, and a snapshot they hold is never modified. Enumerations,
+	/// AddDeviceInfo() and ClearDevices() are serialized against each other.
 	///
 	/// @note This class uses the PIMPL idiom for ABI stability and to hide
-	/// implementation details. It is move-only due to owning internal resources.
+	/// implementation details. It is move-only due to owning internal resources;
+	/// moving a manager while other threads use it is not thread-safe.
 	///
 	/// @example USB device enumeration:
 	/// @code
 	/// KDM::DevicesManager manager;
 	/// manager.EnumerateUsbDevices();
-	/// for (const auto& device : manager.GetDevices()) {
+	/// DeviceSnapshotPtr snapshot = manager.GetDevices();
+	/// for (const auto& device : snapshot->devices) {
 	///     std::wcout << L"Product: " << device.GetProduct()
 	///                << L" VID: " << std::hex << device.GetVendorId()
 	///                << L" PID: " << device.GetProductId() << std::endl;
@@ -44,7 +59,8 @@ namespace KDM
 	/// @code
 	/// KDM::DevicesManager manager;
 	/// manager.EnumerateByDeviceClass(GUID_DEVCLASS_KEYBOARD);
-	/// for (const auto& device : manager.GetDevices()) {
+	/// DeviceSnapshotPtr snapshot = manager.GetDevices();
+	/// for (const auto& device : snapshot->devices) {
 	///     std::wcout << L"Keyboard: " << device.GetDescription() << std::endl;
 	/// }
 	/// @endcode
@@ -54,6 +70,12 @@ namespace KDM
 		/// @brief Constructs a new DevicesManager instance.
 		DevicesManager();
 
+		/// @brief Constructs a DevicesManager that traverses the bus through the given backend.
+		///
+		/// Used to run full USB scans against a simulated bus (unit tests, profiling).
+		/// @param backend Platform services used by EnumerateUsbDevices() (must not be null).
+		explicit DevicesManager(std::unique_ptr<IUsbBackend> backend);
+
 		/// @brief Destructor (defined in .cpp for PIMPL).
 		~DevicesManager();
 
@@ -72,12 +94,36 @@ namespace KDM
 		/// 4. Retrieves USB descriptors (device, configuration, string)
 		/// 5. Correlates devices with Windows SetupAPI information
 		///
-		/// Results are stored internally and can be accessed via GetDevices().
-		/// Calling this method clears any previously enumerated devices.
+		/// Results are published as a new snapshot, replacing the previously enumerated
+		/// devices. If the enumeration throws, the previous snapshot stays published.
 		///
 		/// @note This operation may take some time on systems with many USB devices.
 		void EnumerateUsbDevices();
 
+		/// @brief Enumerates USB devices within a time budget and/or until cancelled.
+		///
+		/// The deadline and cancellation token are checked before each hub is opened and
+		/// before each connected port is queried. When either fires, the remaining hubs and
+		/// ports are not visited; devices found so far stay available via GetDevices() and
+		/// the unvisited hubs/ports are listed in the returned status.
+		///
+		/// @note A hub IOCTL still pending at the deadline or on cancellation is cancelled
+		/// (CancelIoEx) and its hub reported as timed out / cancelled. Only a driver that
+		/// ignores the cancellation can hold the call past the deadline.
+		/// Hubs that fail after all retries, or whose circuit is open, are listed with
+		/// SkipReason::HubFailed / SkipReason::CircuitOpen (see SetHubHealthPolicy).
+		///
+		/// Concurrent calls are coalesced: a call made while another thread's scan is
+		/// running does not start a second walk of the bus but waits for that scan and
+		/// returns its status (EnumerationStatus::coalesced). The running scan uses the
+		/// deadline and cancellation token of the call that started it; a joining call
+		/// only stops waiting early when its own deadline passes or it is cancelled.
+		/// With options.maxStaleness set, a recent enough previous scan is returned
+		/// without scanning (EnumerationStatus::servedFromCache).
+		/// @param options Deadline and cancellation token.
+		/// @return Which parts of the tree were skipped and why.
+		[[nodiscard]] EnumerationStatus EnumerateUsbDevices(const EnumerationOptions& options);
+
 		/// @brief Enumerates devices by Windows Device Setup Class GUID.
 		///
 		/// This method uses SetupAPI to enumerate devices belonging to a specific
@@ -94,21 +140,98 @@ namespace KDM
 		/// @see https://docs.microsoft.com/en-us/windows-hardware/drivers/install/system-defined-device-setup-classes-available-to-vendors
 		void EnumerateByDeviceClass(const GUID& deviceClassGuid);
 
+		/// @brief Enumerates devices of several Device Setup Classes in one SetupAPI pass.
+		///
+		/// Walks all present devices once (DIGCF_ALLCLASSES) and buckets them by the class
+		/// GUID SetupAPI reports with each device; properties are read only for devices of a
+		/// requested class. Equivalent to calling EnumerateByDeviceClass for each GUID and
+		/// concatenating the results, without re-opening the device set per class.
+		///
+		/// @param deviceClassGuids Classes to collect; results are grouped in this order.
+		///        Duplicates are ignored; an empty list publishes an empty snapshot.
+		void EnumerateByDeviceClasses(const std::vector<GUID>& deviceClassGuids);
+
 		/// @brief Manually adds a device to the internal device list.
+		///
+		/// Publishes a new snapshot containing the current devices plus the added one.
 		/// @param deviceResultantInfo Device information to add (moved).
 		void AddDeviceInfo(DeviceResultantInfo deviceResultantInfo);
 
-		/// @brief Returns a const reference to the enumerated devices.
-		/// @return Reference to the internal device vector (avoids copy).
-		[[nodiscard]] const std::vector<DeviceResultantInfo>& GetDevices() const noexcept;
+		/// @brief Returns the currently published device snapshot.
+		///
+		/// Lock-free for the caller with respect to enumerations: the snapshot is loaded
+		/// atomically and stays valid (and unchanged) for as long as it is held.
+		/// @return Never null; version 0 until the first publication.
+		[[nodiscard]] DeviceSnapshotPtr GetSnapshot() const noexcept;
+
+		/// @brief Subscribes to the Arrived/Removed events derived from every publication.
+		///
+		/// Each publication is compared with the previous snapshot and the differences are
+		/// appended to a bounded ring (DeviceEventRing::DefaultCapacity events). Enumeration
+		/// never waits for subscribers; a subscriber that falls a full ring behind loses the
+		/// oldest events (DeviceEventSubscriber::GetDroppedCount).
+		/// @return Subscriber positioned after the last published event. Must not outlive the manager.
+		[[nodiscard]] std::unique_ptr<DeviceEventSubscriber> SubscribeEvents() const;
+
+		/// @brief Returns the arrivals, removals and property changes journaled after sequence.
+		///
+		/// Every publication appends its differences to a change journal (see
+		/// DeviceChangeJournal). A consumer that stores DeviceChangeSet::lastSequence can
+		/// catch up after a pause without copying the full snapshot; if its sequence was
+		/// compacted away the result is a resync (baseline + changes). If the journal
+		/// file cannot be written, the publication still succeeds and the journal catches
+		/// up with the devices present at the next one.
+		[[nodiscard]] DeviceChangeSet GetChangesSince(uint64_t sequence) const;
+
+		/// @brief Replaces the change journal, e.g. to make it file-backed.
+		///
+		/// A file-backed journal is reloaded and then brought up to date with the
+		/// current snapshot, so sequence numbers continue across restarts.
+		/// @throws DeviceIoException if the journal file cannot be opened or created.
+		void SetJournalPolicy(JournalPolicy policy);
+
+		/// @brief Mirrors every publication into a named shared-memory region.
+		///
+		/// Other processes read the inventory through SharedInventoryReader or
+		/// WD_OpenSharedInventory without enumerating themselves. The current snapshot
+		/// is written immediately; a previous region of this manager is closed.
+		/// @param name Kernel object name, e.g. L"Local\\KDM.Inventory".
+		/// @param capacity Devices per publication; further devices are counted but not stored.
+		/// @throws DeviceIoException if the region cannot be created.
+		void EnableSharedInventory(const std::wstring& name,
+			uint32_t capacity = SharedInventoryLayout::DefaultCapacity);
+
+		/// @brief Stops mirroring publications; readers keep the last inventory until they close.
+		void DisableSharedInventory();
+
+		/// @brief Returns the published snapshot holding the enumerated devices.
+		///
+		/// Same as GetSnapshot(): snapshot->devices stays valid and unchanged for as long
+		/// as the pointer is held, whatever other threads publish in the meantime.
+		/// @return Never null.
+		[[nodiscard]] DeviceSnapshotPtr GetDevices() const noexcept;
 
 		/// @brief Returns the number of enumerated devices.
 		/// @return Device count.
 		[[nodiscard]] size_t GetDeviceCount() const noexcept;
 
-		/// @brief Clears all enumerated devices from the internal list.
+		/// @brief Publishes an empty snapshot.
 		void ClearDevices() noexcept;
 
+		/// @brief Replaces the retry and circuit breaker policy applied to every hub.
+		///
+		/// Opening and reading a hub is retried with bounded exponential backoff. A hub
+		/// that fails failureThreshold scans in a row is skipped (SkipReason::CircuitOpen)
+		/// until the cooldown has elapsed. Replacing the policy forgets all hub state.
+		/// @throws InvalidDeviceArgumentException if the policy is invalid.
+		void SetHubHealthPolicy(HubHealthPolicy policy);
+
+		/// @brief Returns breaker state and failure counters of every hub seen so far.
+		[[nodiscard]] std::vector<HubHealthStats> GetHubHealth() const;
+
+		/// @brief Closes all circuits and clears the hub health counters.
+		void ResetHubHealth();
+
 	private:
 		class Impl;
 		std::unique_ptr<Impl> pImpl;
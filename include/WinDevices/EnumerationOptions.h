@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Windows.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Cooperative cancellation flag shared between the caller and a running enumeration.
+	/// Copies share the same state, so a copy handed to another thread can cancel the scan.
+	/// </summary>
+	class CancellationToken
+	{
+	public:
+		CancellationToken() : _cancelled{ std::make_shared<std::atomic<bool>>(false) } {}
+
+		/// @brief Requests cancellation; the traversal stops at its next hub or port boundary.
+		void Cancel() noexcept
+		{
+			_cancelled->store(true, std::memory_order_release);
+		}
+
+		/// @brief Clears a previous cancellation request so the token can be reused.
+		void Reset() noexcept
+		{
+			_cancelled->store(false, std::memory_order_release);
+		}
+
+		[[nodiscard]] bool IsCancellationRequested() const noexcept
+		{
+			return _cancelled->load(std::memory_order_acquire);
+		}
+
+	private:
+		std::shared_ptr<std::atomic<bool>> _cancelled;
+	};
+
+	/// <summary>
+	/// Time budget, cancellation and result reuse for DevicesManager::EnumerateUsbDevices.
+	/// </summary>
+	struct EnumerationOptions
+	{
+		/// Point in time after which no further hub or port is visited (none = unbounded).
+		/// A call that joins another caller's scan stops waiting at this point.
+		std::optional<std::chrono::steady_clock::time_point> deadline;
+
+		CancellationToken cancellation;
+
+		/// Serve the last USB scan without scanning if it was published at most this long
+		/// ago and nothing else has been published since (none = always scan or join).
+		std::optional<std::chrono::milliseconds> maxStaleness;
+
+		/// @brief Options with a deadline of now + timeout.
+		[[nodiscard]] static EnumerationOptions WithTimeout(std::chrono::milliseconds timeout)
+		{
+			EnumerationOptions options;
+			options.deadline = std::chrono::steady_clock::now() + timeout;
+			return options;
+		}
+	};
+
+	/// <summary>
+	/// Why a part of the USB tree is missing from an enumeration result.
+	/// </summary>
+	enum class SkipReason : uint8_t
+	{
+		TimedOut = 0,
+		Cancelled,
+		HubFailed,      // every attempt to open or read the hub failed
+		CircuitOpen     // the hub's circuit breaker is open (see HubHealthTracker)
+	};
+
+	/// <summary>
+	/// A hub, or a single port of a hub, that was not enumerated.
+	/// </summary>
+	struct SkippedNode
+	{
+		std::wstring hubPath;
+		ULONG portNumber = 0;                   // 0 = the whole hub
+		SkipReason reason = SkipReason::TimedOut;
+	};
+
+	/// <summary>
+	/// How a connected hub port was linked to the SetupAPI device nodes describing it.
+	/// </summary>
+	enum class CorrelationRule : uint8_t
+	{
+		None = 0,       // no node found
+		DriverKey,      // only the USB bus-layer node, which has the port's driver key
+		VidPid,         // a function node whose hardware IDs carry the port's VID/PID
+		ContainerId,    // a function node in the bus-layer node's container
+		ProductName     // a node whose description equals the product string
+	};
+
+	/// @brief Short name of a rule for logs and exports ("driverKey", "vidPid", ...).
+	[[nodiscard]] inline const char* CorrelationRuleToString(CorrelationRule rule) noexcept
+	{
+		switch (rule)
+		{
+		case CorrelationRule::DriverKey: return "driverKey";
+		case CorrelationRule::VidPid: return "vidPid";
+		case CorrelationRule::ContainerId: return "containerId";
+		case CorrelationRule::ProductName: return "productName";
+		default: return "none";
+		}
+	}
+
+	/// <summary>
+	/// Counters of the correlation stage of one USB scan: how many ports were joined
+	/// against the SetupAPI nodes, and by which rule.
+	/// </summary>
+	struct CorrelationStats
+	{
+		size_t indexedNodes = 0;        // SetupAPI nodes in the join tables
+		size_t ports = 0;               // connected ports joined
+		size_t busNodes = 0;            // ports whose bus-layer node was found by driver key
+		size_t byDriverKey = 0;
+		size_t byVidPid = 0;
+		size_t byContainerId = 0;
+		size_t byProductName = 0;
+		size_t unmatched = 0;
+	};
+
+	/// <summary>
+	/// Outcome of a bounded enumeration. Devices found before the budget ran out
+	/// are still reported by GetDevices(); everything not visited is listed in skipped.
+	/// </summary>
+	struct EnumerationStatus
+	{
+		bool timedOut = false;
+		bool cancelled = false;
+		std::chrono::milliseconds elapsed{ 0 };
+		std::vector<SkippedNode> skipped;
+
+		/// The result was produced by a scan another caller had already started.
+		bool coalesced = false;
+
+		/// The call stopped waiting for another caller's scan (deadline or cancellation)
+		/// before it finished; nothing was published for this call.
+		bool stoppedWaiting = false;
+
+		/// The result is the previous scan, reused under EnumerationOptions::maxStaleness.
+		bool servedFromCache = false;
+
+		/// How the ports visited by this scan were matched to SetupAPI nodes.
+		CorrelationStats correlation;
+
+		[[nodiscard]] bool IsComplete() const noexcept
+		{
+			return skipped.empty() && !timedOut && !cancelled;
+		}
+	};
+}
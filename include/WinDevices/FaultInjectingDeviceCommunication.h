@@ -0,0 +1,189 @@
+#pragma once
+
+#include "IDeviceCommunication.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+
+namespace KDM
+{
+	/// <summary>
+	/// IDeviceCommunication operations that can be targeted by fault injection.
+	/// </summary>
+	enum class CommunicationOperation : uint8_t
+	{
+		HubNodeInformation = 0,
+		HubNodeInformationEx,
+		HubNodeCapabilitiesEx,
+		ExternalHubName,
+		EnumeratePorts,
+		EnumeratePortsConnectionInfo,
+		DriverKeyName,
+		ConfigDescriptor,
+		StringDescriptor,
+		Count
+	};
+
+	/// <summary>
+	/// Latency added to an operation: a fixed base, a uniform jitter on top of it,
+	/// and an occasional stall modelling a hub that stops responding.
+	/// </summary>
+	struct LatencyProfile
+	{
+		std::chrono::microseconds base{ 0 };
+		std::chrono::microseconds jitter{ 0 };      // uniform in [0, jitter]
+		double stallProbability = 0.0;              // 0.0 - 1.0
+		std::chrono::microseconds stall{ 0 };       // added when a stall is drawn
+	};
+
+	/// <summary>
+	/// Faults injected into a single operation.
+	/// </summary>
+	struct OperationFaults
+	{
+		LatencyProfile latency;
+		double errorRate = 0.0;                     // 0.0 - 1.0
+	};
+
+	/// <summary>
+	/// Configuration of FaultInjectingDeviceCommunication.
+	/// Identical configuration and seed produce an identical fault sequence.
+	/// </summary>
+	struct FaultInjectionConfig
+	{
+		uint64_t seed = 0;
+		std::array<OperationFaults, static_cast<size_t>(CommunicationOperation::Count)> operations{};
+
+		/// Probability that a connected port reported by EnumeratePortsConnectionInfo
+		/// is unplugged before its descriptors are read.
+		double disconnectRate = 0.0;
+
+		/// Delay implementation; defaults to std::this_thread::sleep_for.
+		/// Tests can substitute a recorder to avoid real waiting.
+		std::function<void(std::chrono::microseconds)> delay;
+
+		[[nodiscard]] OperationFaults& operator[](CommunicationOperation operation) noexcept
+		{
+			return operations[static_cast<size_t>(operation)];
+		}
+
+		[[nodiscard]] const OperationFaults& operator[](CommunicationOperation operation) const noexcept
+		{
+			return operations[static_cast<size_t>(operation)];
+		}
+	};
+
+	/// <summary>
+	/// Counters of the faults actually injected.
+	/// </summary>
+	struct FaultInjectionStats
+	{
+		uint64_t calls = 0;
+		uint64_t injectedErrors = 0;
+		uint64_t injectedDisconnects = 0;
+		uint64_t stalls = 0;
+		std::chrono::microseconds injectedLatency{ 0 };
+	};
+
+	/// <summary>
+	/// Live counters behind FaultInjectionStats. Can be shared by several
+	/// decorators (e.g. all hubs of one FaultInjectingUsbBackend).
+	/// </summary>
+	struct FaultInjectionCounters
+	{
+		std::atomic<uint64_t> calls{ 0 };
+		std::atomic<uint64_t> injectedErrors{ 0 };
+		std::atomic<uint64_t> injectedDisconnects{ 0 };
+		std::atomic<uint64_t> stalls{ 0 };
+		std::atomic<int64_t> injectedLatencyUs{ 0 };
+
+		[[nodiscard]] FaultInjectionStats Snapshot() const noexcept;
+	};
+
+	/// @brief Decorator that injects latency, errors and disconnect races into
+	/// another IDeviceCommunication.
+	///
+	/// Injected errors follow the failure modes of DeviceCommunication:
+	/// descriptor reads return nullptr, every other operation throws
+	/// DeviceIoException (ERROR_GEN_FAILURE).
+	///
+	/// A disconnect race marks a port as unplugged right after
+	/// EnumeratePortsConnectionInfo reported it connected; later driver key and
+	/// descriptor requests for that port fail as for a removed device
+	/// (ERROR_NO_SUCH_DEVICE / nullptr).
+	///
+	/// Random draws come from a std::mt19937_64 seeded from the configuration,
+	/// so a single-threaded traversal sees a reproducible fault sequence.
+	///
+	/// @code
+	/// FaultInjectionConfig config;
+	/// config.seed = 42;
+	/// config[CommunicationOperation::HubNodeInformation].latency.stall = 500ms;
+	/// config[CommunicationOperation::HubNodeInformation].latency.stallProbability = 0.1;
+	/// config[CommunicationOperation::StringDescriptor].errorRate = 0.05;
+	/// UsbHub hub(path, std::make_unique<FaultInjectingDeviceCommunication>(
+	///     std::make_unique<DeviceCommunication>(path), config));
+	/// @endcode
+	class FaultInjectingDeviceCommunication : public IDeviceCommunication
+	{
+	public:
+		/// @param counters Counters to record into; a private set is created if null.
+		/// @throws InvalidDeviceArgumentException if inner is null or a rate is outside [0, 1].
+		FaultInjectingDeviceCommunication(std::unique_ptr<IDeviceCommunication> inner, FaultInjectionConfig config,
+			std::shared_ptr<FaultInjectionCounters> counters = nullptr);
+		~FaultInjectingDeviceCommunication() override = default;
+
+		// Non-copyable, non-movable (owns a mutex)
+		FaultInjectingDeviceCommunication(const FaultInjectingDeviceCommunication&) = delete;
+		FaultInjectingDeviceCommunication& operator=(const FaultInjectingDeviceCommunication&) = delete;
+		FaultInjectingDeviceCommunication(FaultInjectingDeviceCommunication&&) = delete;
+		FaultInjectingDeviceCommunication& operator=(FaultInjectingDeviceCommunication&&) = delete;
+
+		void GetUsbHubNodeInformation(HubNodeInfo& nodeInfo) override;
+		void GetUsbHubNodeInformationEx(HubNodeInfoEx& nodeInfo) override;
+		void GetUsbHubNodeCapabilitiesEx(HubNodeCapabilitiesEx& nodeInfo) override;
+		void GetUsbExternalHubName(DWORD index, std::wstring& hubName) override;
+
+		void EnumeratePorts(ULONG numberOfPorts,
+			std::map<size_t, HubPortInfo>& portConnectorPropsList) override;
+		void EnumeratePortsConnectionInfo(ULONG numberOfPorts,
+			std::map<size_t, HubConnectionInfo>& hubConnectionInfoList) override;
+
+		[[nodiscard]] std::wstring GetDriverKeyName(ULONG connectionIndex) override;
+		[[nodiscard]] PUSB_DESCRIPTOR_REQUEST GetConfigDescriptor(ULONG connectionIndex, UCHAR descriptorIndex) override;
+		[[nodiscard]] PSTRING_DESCRIPTOR_NODE GetStringDescriptor(ULONG connectionIndex, UCHAR descriptorIndex, USHORT languageId) override;
+
+		[[nodiscard]] HANDLE GetFileHandle() override;
+		void SetIoLimits(const EnumerationOptions& options) override;
+
+		/// @brief Returns a snapshot of the injected fault counters.
+		[[nodiscard]] FaultInjectionStats GetStats() const noexcept;
+
+		/// @brief Returns true if the port was unplugged by an injected disconnect race.
+		[[nodiscard]] bool IsDisconnected(ULONG connectionIndex) const;
+
+	private:
+		/// Applies latency and draws the error decision for one call.
+		/// @return true if the call must fail.
+		[[nodiscard]] bool BeginOperation(CommunicationOperation operation);
+
+		[[nodiscard]] bool Draw(double probability);
+
+		void ThrowInjectedError(const char* operation) const;
+
+		std::unique_ptr<IDeviceCommunication> _inner;
+		FaultInjectionConfig _config;
+
+		mutable std::mutex _mutex;          // guards _random and _disconnectedPorts
+		std::mt19937_64 _random;
+		std::set<ULONG> _disconnectedPorts;
+
+		std::shared_ptr<FaultInjectionCounters> _counters;
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "IUsbBackend.h"
+#include "FaultInjectingDeviceCommunication.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace KDM
+{
+	/// @brief IUsbBackend decorator that wraps every opened hub in a
+	/// FaultInjectingDeviceCommunication.
+	///
+	/// Each hub gets its own random stream, seeded from the configured seed and
+	/// the hub path, so the faults a hub sees do not depend on the order in
+	/// which hubs are opened. Reopening the same hub (e.g. a retry) advances to
+	/// a new stream, so a transient fault is not replayed on every attempt.
+	/// All hubs record into one set of counters.
+	///
+	/// @code
+	/// FaultInjectionConfig faults;
+	/// faults.seed = 7;
+	/// faults.disconnectRate = 0.01;
+	/// DevicesManager manager(std::make_unique<FaultInjectingUsbBackend>(
+	///     std::make_unique<UsbBackend>(), faults));
+	/// @endcode
+	class FaultInjectingUsbBackend : public IUsbBackend
+	{
+	public:
+		/// @throws InvalidDeviceArgumentException if inner is null.
+		FaultInjectingUsbBackend(std::unique_ptr<IUsbBackend> inner, FaultInjectionConfig config);
+		~FaultInjectingUsbBackend() override = default;
+
+		[[nodiscard]] std::vector<DevInfoData> GetDeviceInstances() override;
+		[[nodiscard]] std::vector<std::wstring> GetRootHubPaths() override;
+
+		/// @brief Opens the hub through the inner backend and wraps it in the fault injector.
+		[[nodiscard]] std::unique_ptr<IDeviceCommunication> OpenHub(const std::wstring& hubPath) override;
+
+		[[nodiscard]] std::wstring GetHubDevicePath(const DevInfoData& hubDevice) override;
+
+		/// @brief Returns the fault counters accumulated over all opened hubs.
+		[[nodiscard]] FaultInjectionStats GetStats() const noexcept;
+
+	private:
+		std::unique_ptr<IUsbBackend> _inner;
+		FaultInjectionConfig _config;
+		std::shared_ptr<FaultInjectionCounters> _counters;
+
+		std::mutex _mutex;                              // guards _openCounts
+		std::map<std::wstring, uint64_t> _openCounts;
+	};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace KDM
+{
+	/// @brief 64-bit FNV-1a, for hashes that must not change between runs, processes
+	/// or standard library implementations (device keys, delta base digests, fault
+	/// injection seeds). Not collision resistant against crafted input.
+	namespace Fnv1a
+	{
+		constexpr uint64_t OffsetBasis = 14695981039346656037ull;
+		constexpr uint64_t Prime = 1099511628211ull;
+
+		/// @brief Continues hash over size bytes at data.
+		inline void HashBytes(uint64_t& hash, const void* data, size_t size) noexcept
+		{
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= Prime;
+			}
+		}
+
+		/// @brief Continues hash over the code units of value and a terminator, so that
+		/// consecutive strings cannot run into each other ("ab" + "c" != "a" + "bc").
+		inline void HashString(uint64_t& hash, std::wstring_view value) noexcept
+		{
+			HashBytes(hash, value.data(), value.size() * sizeof(wchar_t));
+			HashBytes(hash, L"", sizeof(wchar_t));
+		}
+
+		/// @brief Hash of value alone.
+		[[nodiscard]] inline uint64_t Of(std::wstring_view value) noexcept
+		{
+			uint64_t hash = OffsetBasis;
+			HashString(hash, value);
+			return hash;
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace KDM
+{
+	/// <summary>
+	/// Numeric fields of one PnP hardware or compatible ID, such as
+	/// USB\VID_046D&amp;PID_C52B&amp;REV_1201&amp;MI_00 or USB\Class_03&amp;SubClass_01&amp;Prot_01.
+	/// A field is meaningful only if its Has* bit is set in fields.
+	/// </summary>
+	struct HardwareId
+	{
+		static constexpr uint32_t HasVendorId = 1u << 0;      // VID_xxxx
+		static constexpr uint32_t HasProductId = 1u << 1;     // PID_xxxx
+		static constexpr uint32_t HasRevision = 1u << 2;      // REV_xxxx
+		static constexpr uint32_t HasInterface = 1u << 3;     // MI_xx
+		static constexpr uint32_t HasClass = 1u << 4;         // Class_xx
+		static constexpr uint32_t HasSubClass = 1u << 5;      // SubClass_xx
+		static constexpr uint32_t HasProtocol = 1u << 6;      // Prot_xx
+
+		uint32_t fields = 0;
+		uint16_t vendorId = 0;
+		uint16_t productId = 0;
+		uint16_t revision = 0;          // BCD, as bcdDevice (REV_1201 -> 0x1201)
+		uint8_t interfaceNumber = 0;
+		uint8_t deviceClass = 0;
+		uint8_t deviceSubClass = 0;
+		uint8_t deviceProtocol = 0;
+
+		[[nodiscard]] bool Has(uint32_t mask) const noexcept { return (fields & mask) == mask; }
+
+		[[nodiscard]] bool MatchesVidPid(uint16_t vid, uint16_t pid) const noexcept
+		{
+			return Has(HasVendorId | HasProductId) && vendorId == vid && productId == pid;
+		}
+	};
+
+	/// @brief Parses the &-separated fields after the enumerator prefix (USB\, HID\, ...).
+	///
+	/// Field names are case-insensitive; unknown or malformed fields are skipped, so IDs
+	/// of other buses parse to an empty HardwareId. Does not allocate.
+	[[nodiscard]] HardwareId ParseHardwareId(std::wstring_view id) noexcept;
+}
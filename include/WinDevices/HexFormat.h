@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Windows.h>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace KDM
+{
+	/// <summary>
+	/// Zero-terminated text of at most Capacity characters held inline, as returned by
+	/// the formatters below. Use view() (or the implicit conversion) while the object
+	/// is alive; nothing is allocated.
+	/// </summary>
+	template <typename Char, size_t Capacity>
+	class InlineString
+	{
+	public:
+		[[nodiscard]] constexpr std::basic_string_view<Char> view() const noexcept { return { _chars, _size }; }
+		[[nodiscard]] constexpr const Char* c_str() const noexcept { return _chars; }
+		[[nodiscard]] constexpr size_t size() const noexcept { return _size; }
+
+		constexpr operator std::basic_string_view<Char>() const noexcept { return view(); }
+
+		constexpr void push_back(Char c) noexcept
+		{
+			if (_size < Capacity) {
+				_chars[_size++] = c;
+			}
+		}
+
+	private:
+		Char _chars[Capacity + 1]{};
+		size_t _size = 0;
+	};
+
+	/// @brief Allocation-free hex formatting of USB IDs and GUIDs.
+	namespace HexFormat
+	{
+		constexpr size_t MaxIdDigits = 16;
+		constexpr size_t GuidLength = 38;       // {XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}
+
+		constexpr char LowerDigits[] = "0123456789abcdef";
+		constexpr char UpperDigits[] = "0123456789ABCDEF";
+
+		template <typename Char, size_t Capacity>
+		constexpr void AppendHex(InlineString<Char, Capacity>& out, uint64_t value, size_t digits, const char* table) noexcept
+		{
+			while (digits-- > 0) {
+				out.push_back(static_cast<Char>(table[(value >> (4 * digits)) & 0xF]));
+			}
+		}
+
+		/// @brief "0x" and value in lowercase hex, zero-padded to minDigits (at most
+		/// MaxIdDigits); the same text as swprintf's L"0x%0*x", e.g. Id(0x0951, 4) is L"0x0951".
+		template <typename Char = wchar_t>
+		[[nodiscard]] constexpr InlineString<Char, 2 + MaxIdDigits> Id(uint64_t value, size_t minDigits) noexcept
+		{
+			size_t digits = 1;
+			while (digits < MaxIdDigits && (value >> (4 * digits)) != 0) {
+				++digits;
+			}
+			if (minDigits > digits) {
+				digits = minDigits < MaxIdDigits ? minDigits : MaxIdDigits;
+			}
+
+			InlineString<Char, 2 + MaxIdDigits> out;
+			out.push_back(static_cast<Char>('0'));
+			out.push_back(static_cast<Char>('x'));
+			AppendHex(out, value, digits, LowerDigits);
+			return out;
+		}
+
+		/// @brief Registry form of guid, uppercase in braces; the same text as StringFromGUID2.
+		template <typename Char = wchar_t>
+		[[nodiscard]] constexpr InlineString<Char, GuidLength> Guid(const GUID& guid) noexcept
+		{
+			InlineString<Char, GuidLength> out;
+			out.push_back(static_cast<Char>('{'));
+			AppendHex(out, guid.Data1, 8, UpperDigits);
+			out.push_back(static_cast<Char>('-'));
+			AppendHex(out, guid.Data2, 4, UpperDigits);
+			out.push_back(static_cast<Char>('-'));
+			AppendHex(out, guid.Data3, 4, UpperDigits);
+			out.push_back(static_cast<Char>('-'));
+			for (size_t i = 0; i < 8; ++i) {
+				if (i == 2) {
+					out.push_back(static_cast<Char>('-'));
+				}
+				AppendHex(out, guid.Data4[i], 2, UpperDigits);
+			}
+			out.push_back(static_cast<Char>('}'));
+			return out;
+		}
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Circuit breaker state of a single hub.
+	/// </summary>
+	enum class CircuitState : uint8_t
+	{
+		Closed = 0,     // hub is opened normally
+		Open,           // hub is skipped until the cooldown has elapsed
+		HalfOpen        // cooldown elapsed; the next scan makes a single trial attempt
+	};
+
+	/// <summary>
+	/// Retry and circuit breaker settings applied to every hub by DevicesManager.
+	/// </summary>
+	struct HubHealthPolicy
+	{
+		/// Attempts to open and read a hub within one scan (1 = no retry).
+		uint32_t maxAttempts = 3;
+
+		/// Delay before the first retry; doubled for every further retry up to maxBackoff.
+		std::chrono::milliseconds initialBackoff{ 10 };
+		std::chrono::milliseconds maxBackoff{ 200 };
+
+		/// Consecutive failed scans of a hub after which its circuit opens (0 = never).
+		uint32_t failureThreshold = 3;
+
+		/// How long an open circuit skips the hub before a trial attempt is allowed.
+		std::chrono::milliseconds cooldown{ 30000 };
+
+		/// Clock and delay implementations; default to std::chrono::steady_clock::now
+		/// and std::this_thread::sleep_for. Tests can substitute a fake clock.
+		std::function<std::chrono::steady_clock::time_point()> clock;
+		std::function<void(std::chrono::milliseconds)> delay;
+	};
+
+	/// <summary>
+	/// Health counters and breaker state of one hub path.
+	/// </summary>
+	struct HubHealthStats
+	{
+		std::wstring hubPath;
+		CircuitState state = CircuitState::Closed;
+		uint32_t consecutiveFailures = 0;
+		uint64_t successes = 0;
+		uint64_t failures = 0;             // scans in which every attempt failed
+		uint64_t retries = 0;              // attempts beyond the first
+		uint64_t skippedWhileOpen = 0;
+		uint64_t timesOpened = 0;
+		std::string lastError;
+	};
+
+	/// @brief Tracks the health of hubs across scans and decides whether a hub is
+	/// attempted, retried or skipped.
+	///
+	/// A hub whose scans fail failureThreshold times in a row has its circuit
+	/// opened and is skipped for the cooldown. After the cooldown one trial
+	/// attempt is made (half-open): success closes the circuit, failure opens it
+	/// again for another cooldown. State is keyed by hub device path.
+	///
+	/// All members are thread-safe.
+	class HubHealthTracker
+	{
+	public:
+		/// @throws InvalidDeviceArgumentException if maxAttempts is 0 or initialBackoff exceeds maxBackoff.
+		explicit HubHealthTracker(HubHealthPolicy policy = {});
+
+		/// @brief Returns how many attempts the hub gets in the current scan: the
+		/// policy's maxAttempts while closed, one while half-open, and 0 while open.
+		/// An open circuit whose cooldown has elapsed moves to half-open; a refused
+		/// hub is counted in skippedWhileOpen.
+		[[nodiscard]] uint32_t BeginScan(const std::wstring& hubPath);
+
+		/// @brief Backoff to wait before the given retry (1 = first retry).
+		[[nodiscard]] std::chrono::milliseconds BackoffFor(uint32_t retry) const noexcept;
+
+		/// @brief Waits for the backoff of the given retry and counts it.
+		void WaitBeforeRetry(const std::wstring& hubPath, uint32_t retry);
+
+		void RecordSuccess(const std::wstring& hubPath);
+		void RecordFailure(const std::wstring& hubPath, const std::string& error);
+
+		[[nodiscard]] CircuitState GetState(const std::wstring& hubPath) const;
+
+		/// @brief Returns the health of every hub seen so far, ordered by hub path.
+		[[nodiscard]] std::vector<HubHealthStats> GetStats() const;
+
+		/// @brief Forgets all hub state (e.g. after the bus topology changed).
+		void Reset();
+
+		[[nodiscard]] const HubHealthPolicy& GetPolicy() const noexcept { return _policy; }
+
+	private:
+		struct HubState
+		{
+			HubHealthStats stats;
+			std::chrono::steady_clock::time_point openedAt{};
+		};
+
+		[[nodiscard]] std::chrono::steady_clock::time_point Now() const;
+
+		HubState& StateOf(const std::wstring& hubPath);
+
+		HubHealthPolicy _policy;
+
+		mutable std::mutex _mutex;
+		std::map<std::wstring, HubState> _hubs;
+	};
+}
@@ -5,6 +5,7 @@
 #include <map>
 #include <string>
 #include "usbdesc.h"
+#include "EnumerationOptions.h"
 
 namespace KDM
 {
@@ -51,6 +52,10 @@ namespace KDM
 
         [[nodiscard]] virtual HANDLE GetFileHandle() = 0;
 
+        // Bounds the IOCTLs issued from now on by options.deadline and options.cancellation.
+        // The default ignores them, for implementations that never block.
+        virtual void SetIoLimits(const EnumerationOptions& options) { (void)options; }
+
     protected:
         // Protected default constructor - only derived classes can instantiate
         IDeviceCommunication() = default;
@@ -0,0 +1,32 @@
+#pragma once
+
+namespace KDM
+{
+	/// <summary>
+	/// Interface for reading raw registry properties (SPDRP_*) of one device node.
+	/// DevicePropertyReader decodes properties only through this interface, so the
+	/// decoding and buffering logic can run against fixture data.
+	/// </summary>
+	class IDevicePropertySource
+	{
+	public:
+		virtual ~IDevicePropertySource() = default;
+
+		// Prevent copying (interface should be used via pointer/reference)
+		IDevicePropertySource(const IDevicePropertySource&) = delete;
+		IDevicePropertySource& operator=(const IDevicePropertySource&) = delete;
+
+		// Allow moving for derived classes
+		IDevicePropertySource(IDevicePropertySource&&) noexcept = default;
+		IDevicePropertySource& operator=(IDevicePropertySource&&) noexcept = default;
+
+		// Copies the property into buffer (size bytes) with SetupDiGetDeviceRegistryProperty
+		// semantics: returns ERROR_SUCCESS, ERROR_INSUFFICIENT_BUFFER or the error that made
+		// the property unavailable; requiredSize receives the size of the value in bytes
+		[[nodiscard]] virtual DWORD ReadProperty(DWORD property, BYTE* buffer, DWORD size, DWORD& requiredSize) = 0;
+
+	protected:
+		// Protected default constructor - only derived classes can instantiate
+		IDevicePropertySource() = default;
+	};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+	// Forward declarations
+	class DevInfoData;
+	class IDeviceCommunication;
+
+	/// <summary>
+	/// Interface for the platform services used by USB bus traversal.
+	/// DevicesManager reaches host controllers, hubs and SetupAPI device nodes
+	/// only through this interface, so a full scan can run against a mock backend.
+	/// </summary>
+	class IUsbBackend
+	{
+	public:
+		virtual ~IUsbBackend() = default;
+
+		// Prevent copying (interface should be used via pointer/reference)
+		IUsbBackend(const IUsbBackend&) = delete;
+		IUsbBackend& operator=(const IUsbBackend&) = delete;
+
+		// Allow moving for derived classes
+		IUsbBackend(IUsbBackend&&) noexcept = default;
+		IUsbBackend& operator=(IUsbBackend&&) noexcept = default;
+
+		// SetupAPI device nodes used to correlate hub ports with Windows devices
+		[[nodiscard]] virtual std::vector<DevInfoData> GetDeviceInstances() = 0;
+
+		// Device paths of the root hubs of all present USB host controllers
+		[[nodiscard]] virtual std::vector<std::wstring> GetRootHubPaths() = 0;
+
+		// Opens IOCTL communication with the hub at the given device path
+		[[nodiscard]] virtual std::unique_ptr<IDeviceCommunication> OpenHub(const std::wstring& hubPath) = 0;
+
+		// Resolves the device path of an external hub from its USB bus layer device node
+		[[nodiscard]] virtual std::wstring GetHubDevicePath(const DevInfoData& hubDevice) = 0;
+
+	protected:
+		// Protected default constructor - only derived classes can instantiate
+		IUsbBackend() = default;
+	};
+}
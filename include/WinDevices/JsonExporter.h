@@ -0,0 +1,81 @@
+#pragma once
+
+#include "DeviceChange.h"
+#include "DeviceEventRing.h"
+#include "DeviceSnapshot.h"
+#include "JsonWriter.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Output shape of a JsonExporter.
+	/// </summary>
+	enum class JsonFormat
+	{
+		Document,   // one JSON value per call, e.g. {"version":3,"devices":[...]}
+		NdJson      // one JSON object per line (device, event or change)
+	};
+
+	/// @brief Streams snapshots, events and changes as UTF-8 JSON without building a DOM.
+	///
+	/// Values are escaped and UTF-16 strings transcoded in a single pass directly
+	/// into the fixed output buffer of a JsonWriter, which is handed to the sink
+	/// whenever it fills and on Flush(). The buffer is allocated once and reused for
+	/// every call, so an export allocates nothing per device.
+	///
+	/// @code
+	/// JsonExporter exporter([&](const char* data, size_t size) { out.write(data, size); }, JsonFormat::NdJson);
+	/// exporter.WriteSnapshot(*manager.GetSnapshot());
+	/// exporter.Flush();
+	/// @endcode
+	///
+	/// Not thread-safe. The sink may throw to abort an export; the exporter stays usable.
+	class JsonExporter
+	{
+	public:
+		static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+		/// @throws InvalidDeviceArgumentException if sink is empty or bufferSize is below 64 bytes.
+		JsonExporter(JsonSink sink, JsonFormat format, size_t bufferSize = DefaultBufferSize);
+
+		JsonExporter(const JsonExporter&) = delete;
+		JsonExporter& operator=(const JsonExporter&) = delete;
+
+		/// @brief Document: {"version":...,"devices":[...]}; NdJson: one line per device.
+		void WriteSnapshot(const DeviceSnapshot& snapshot);
+
+		/// @brief Same as WriteSnapshot for a device list that is not held in a snapshot.
+		void WriteDevices(const std::vector<DeviceResultantInfo>& devices, uint64_t snapshotVersion);
+
+		/// @brief Document: an array of events; NdJson: one line per event.
+		void WriteEvents(const DeviceEvent* events, size_t count);
+
+		/// @brief Document: an array of changes; NdJson: one line per change.
+		void WriteChanges(const std::vector<DeviceChange>& changes);
+
+		/// @brief Hands everything buffered so far to the sink.
+		void Flush();
+
+		/// @brief Total bytes produced (flushed or still buffered).
+		[[nodiscard]] uint64_t GetBytesWritten() const noexcept { return _writer.GetBytesWritten(); }
+
+	private:
+		void WriteDevice(const DeviceResultantInfo& device);
+		void WriteEvent(const DeviceEvent& event);
+		void WriteChange(const DeviceChange& change);
+
+		template <typename Item, typename WriteItem>
+		void WriteSequence(const Item* items, size_t count, WriteItem writeItem);
+
+		void Key(std::string_view key);
+		void Guid(const GUID& guid);
+		void Location(uint64_t location);
+
+		JsonWriter _writer;
+		JsonFormat _format;
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace KDM
+{
+	/// @brief Receives consecutive chunks of UTF-8 output.
+	using JsonSink = std::function<void(const char* data, size_t size)>;
+
+	/// @brief Fixed output buffer behind JsonExporter and TopologyExporter.
+	///
+	/// Text is appended straight into a buffer that is allocated once and handed to
+	/// the sink whenever it fills and on Flush(). Strings are transcoded from UTF-16
+	/// and escaped in the same pass; lone surrogates become U+FFFD.
+	///
+	/// Not thread-safe. The sink may throw to abort an export; the writer stays usable.
+	class JsonWriter
+	{
+	public:
+		static constexpr size_t MinBufferSize = 64;
+
+		/// @param owner Prefix of the exception messages, e.g. "JsonExporter".
+		/// @throws InvalidDeviceArgumentException if sink is empty or bufferSize is below MinBufferSize.
+		JsonWriter(JsonSink sink, size_t bufferSize, std::string_view owner);
+
+		JsonWriter(const JsonWriter&) = delete;
+		JsonWriter& operator=(const JsonWriter&) = delete;
+
+		/// @brief Hands everything buffered so far to the sink.
+		void Flush();
+
+		/// @brief Total bytes produced (flushed or still buffered).
+		[[nodiscard]] uint64_t GetBytesWritten() const noexcept { return _flushed + _used; }
+
+		/// @brief Appends text as is; it must already be valid UTF-8 in the target syntax.
+		void Raw(std::string_view text);
+		void Char(char c);
+
+		/// @brief Appends value as a quoted JSON string.
+		void String(std::wstring_view value);
+
+		/// @brief Appends value as the inside of a quoted Graphviz label: quote and backslash
+		/// are escaped, control characters become spaces.
+		void DotLabel(std::wstring_view value);
+
+		void Unsigned(uint64_t value);
+		void Signed(int64_t value);
+
+		/// @brief Appends the low digits hex digits of value, upper case, without prefix.
+		void Hex(uint64_t value, int digits);
+
+		/// @brief Appends the UsbLocation text form, e.g. 2-1.4.3; nothing if unknown.
+		void Location(uint64_t location);
+
+	private:
+		void Escaped(std::wstring_view value, bool json);
+		char* Reserve(size_t bytes);
+
+		JsonSink _sink;
+		std::vector<char> _buffer;
+		size_t _used = 0;
+		uint64_t _flushed = 0;
+	};
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <Windows.h>
+#include "DeviceSnapshot.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Fixed binary layout of a shared-memory device inventory.
+	///
+	/// The region holds a RegionHeader followed by two buffers, each a BufferHeader
+	/// plus capacity DeviceRecords. The publisher writes the inactive buffer under
+	/// its sequence counter (odd while writing) and then advances the generation,
+	/// which selects the active buffer (generation % 2). Readers copy the active
+	/// buffer and retry if its sequence changed meanwhile, so they never block the
+	/// publisher and never see a half-written inventory.
+	///
+	/// All integers are native byte order; strings are zero-terminated UTF-8,
+	/// truncated at a character boundary.
+	/// </summary>
+	namespace SharedInventoryLayout
+	{
+		constexpr uint32_t Magic = 0x534D444B;          // "KDMS"
+		constexpr uint32_t LayoutVersion = 2;      // 2: DeviceRecord::locationKey
+		constexpr uint32_t DefaultCapacity = 512;
+
+		struct DeviceRecord
+		{
+			char manufacturer[128];
+			char product[128];
+			char serialNumber[128];
+			char description[128];
+			char deviceId[256];
+			char friendlyName[128];
+			char devicePath[256];
+			char vendorName[64];
+			char interfaceClassName[64];
+			GUID setupClassGuid;
+			uint64_t deviceKey;             // DeviceKeyOf
+			uint64_t locationKey;           // UsbLocation
+			uint32_t vendorId;
+			uint32_t productId;
+			uint8_t deviceClass;
+			uint8_t interfaceClass;
+			uint8_t isUsbDevice;
+			uint8_t isConnected;
+			uint32_t reserved;
+		};
+
+		struct alignas(64) BufferHeader
+		{
+			std::atomic<uint64_t> sequence;     // odd while the publisher writes this buffer
+			uint64_t snapshotVersion;
+			int64_t publishedAtMs;              // wall clock, milliseconds since the Unix epoch
+			uint32_t deviceCount;               // records stored (at most capacity)
+			uint32_t totalDevices;              // devices in the snapshot (> deviceCount if truncated)
+		};
+
+		struct alignas(64) RegionHeader
+		{
+			uint32_t magic;
+			uint32_t layoutVersion;
+			uint32_t capacity;                  // records per buffer
+			uint32_t recordSize;                // sizeof(DeviceRecord)
+			uint64_t regionSize;
+			uint64_t bufferOffset[2];
+			std::atomic<uint64_t> generation;   // publications so far; active buffer = generation % 2
+			uint32_t publisherProcessId;
+			uint32_t reserved;
+		};
+
+		static_assert(sizeof(DeviceRecord) == 1328, "DeviceRecord is part of the shared binary layout");
+		static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be address-free");
+
+		/// @brief Bytes needed for a region holding capacity devices per buffer.
+		[[nodiscard]] size_t RegionSize(uint32_t capacity) noexcept;
+
+		/// @brief Formats an empty region (generation 0, no devices).
+		void InitializeRegion(void* region, uint32_t capacity) noexcept;
+
+		/// @brief True if region of size bytes carries a compatible header.
+		[[nodiscard]] bool IsValidRegion(const void* region, size_t size) noexcept;
+
+		/// @brief Writes snapshot into the inactive buffer and makes it active.
+		/// Devices beyond the capacity are dropped (BufferHeader::totalDevices keeps the count).
+		/// Only one writer may publish into a region at a time. Does not allocate, so a
+		/// buffer is never left marked as being written.
+		void WriteSnapshot(void* region, const DeviceSnapshot& snapshot) noexcept;
+	}
+
+	/// <summary>
+	/// Consistent copy of a shared inventory.
+	/// </summary>
+	struct SharedInventoryContents
+	{
+		uint64_t generation = 0;            // 0 = nothing published yet
+		uint64_t snapshotVersion = 0;
+		int64_t publishedAtMs = 0;
+		uint32_t totalDevices = 0;
+		std::vector<SharedInventoryLayout::DeviceRecord> devices;
+	};
+
+	/// @brief Copies the active buffer of a region.
+	/// @return false if the publisher kept overwriting it for every retry.
+	[[nodiscard]] bool ReadSharedInventory(const void* region, SharedInventoryContents& contents);
+
+	/// @brief Creates a named shared-memory region and publishes snapshots into it.
+	///
+	/// Other processes open the region with SharedInventoryReader (or the
+	/// WD_OpenSharedInventory C API) and read the inventory without enumerating.
+	/// Names follow the kernel object namespace rules, e.g. L"Local\\KDM.Inventory".
+	class SharedInventoryPublisher
+	{
+	public:
+		/// @throws DeviceIoException if the mapping cannot be created or mapped, or an
+		/// existing region with the same name has an incompatible layout.
+		/// @throws InvalidDeviceArgumentException if name is empty or capacity is 0.
+		SharedInventoryPublisher(const std::wstring& name, uint32_t capacity = SharedInventoryLayout::DefaultCapacity);
+
+		SharedInventoryPublisher(const SharedInventoryPublisher&) = delete;
+		SharedInventoryPublisher& operator=(const SharedInventoryPublisher&) = delete;
+
+		/// @brief Publishes snapshot; readers see it once the call returns.
+		void Publish(const DeviceSnapshot& snapshot) noexcept;
+
+		[[nodiscard]] const std::wstring& GetName() const noexcept { return _name; }
+
+	private:
+		std::wstring _name;
+		wil::unique_handle _mapping;
+		wil::unique_mapview_ptr<void> _view;
+	};
+
+	/// @brief Read-only view of a region created by SharedInventoryPublisher.
+	class SharedInventoryReader
+	{
+	public:
+		/// @throws DeviceIoException if no region with this name exists or its layout is incompatible.
+		explicit SharedInventoryReader(const std::wstring& name);
+
+		SharedInventoryReader(const SharedInventoryReader&) = delete;
+		SharedInventoryReader& operator=(const SharedInventoryReader&) = delete;
+
+		/// @brief Number of publications so far; cheap enough to poll for changes.
+		[[nodiscard]] uint64_t GetGeneration() const noexcept;
+
+		/// @brief Copies the current inventory (see ReadSharedInventory).
+		[[nodiscard]] bool Read(SharedInventoryContents& contents) const;
+
+	private:
+		wil::unique_handle _mapping;
+		wil::unique_mapview_ptr<void> _view;
+	};
+}
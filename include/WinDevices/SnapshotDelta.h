@@ -0,0 +1,34 @@
+#pragma once
+
+#include "DeviceSnapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace KDM
+{
+	/// @brief Encodes target as a compact delta against base.
+	///
+	/// The delta is an edit script in target order. Runs of devices that are
+	/// unchanged in base are copied by (base index, count). Modified devices carry
+	/// only their changed fields, and added devices carry all of them. Base devices
+	/// the script does not reference are removed. Strings go into a deduplicated
+	/// dictionary and records refer to them by index. All integers are LEB128
+	/// varints, so an unchanged inventory encodes to about 20 bytes.
+	///
+	/// Devices are matched by DeviceKeyOf, as in DiffSnapshots. Strings are stored
+	/// as UTF-8, so only well-formed UTF-16 round-trips exactly.
+	[[nodiscard]] std::vector<uint8_t> EncodeSnapshotDelta(const DeviceSnapshot& base, const DeviceSnapshot& target);
+
+	/// @brief Rebuilds the target snapshot from base and a delta produced by EncodeSnapshotDelta.
+	///
+	/// The result has the target's version and devices in the target's order.
+	/// @throws DeviceIoException (ERROR_INVALID_DATA) if the delta is malformed or
+	/// was encoded against a different base.
+	[[nodiscard]] DeviceSnapshot DecodeSnapshotDelta(const DeviceSnapshot& base, const uint8_t* data, size_t size);
+
+	[[nodiscard]] inline DeviceSnapshot DecodeSnapshotDelta(const DeviceSnapshot& base, const std::vector<uint8_t>& delta)
+	{
+		return DecodeSnapshotDelta(base, delta.data(), delta.size());
+	}
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <Windows.h>
+#include "DeviceSnapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Versioned, offset-based binary snapshot format that is read in place.
+	///
+	/// A file is a FileHeader, deviceCount fixed-size Records and a string heap of
+	/// UTF-16LE code units. Records refer to their strings by (offset, length) into
+	/// the heap, so a reader maps the file and hands out std::wstring_views without
+	/// copying or decoding anything. All integers are little-endian (the byte order
+	/// of every Windows target); all offsets are relative to the start of the file.
+	/// </summary>
+	namespace SnapshotFormat
+	{
+		constexpr uint32_t Magic = 0x424D444B;          // "KDMB"
+		constexpr uint32_t FormatVersion = 2;      // 2: Record::locationKey
+
+		struct StringRef
+		{
+			uint32_t offset;        // in UTF-16 code units from the start of the string heap
+			uint32_t length;        // in UTF-16 code units, no terminator
+		};
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t formatVersion;
+			uint32_t headerSize;    // sizeof(FileHeader)
+			uint32_t recordSize;    // sizeof(Record)
+			uint64_t snapshotVersion;
+			int64_t createdAtMs;    // wall clock, milliseconds since the Unix epoch
+			uint64_t deviceCount;
+			uint64_t recordsOffset;
+			uint64_t stringsOffset;
+			uint64_t stringsSize;   // in bytes
+			uint64_t fileSize;
+		};
+
+		struct Record
+		{
+			StringRef manufacturer;
+			StringRef product;
+			StringRef serialNumber;
+			StringRef description;
+			StringRef deviceId;
+			StringRef friendlyName;
+			StringRef devicePath;
+			StringRef vendorName;
+			StringRef interfaceClassName;
+			GUID setupClassGuid;
+			uint64_t deviceKey;     // DeviceKeyOf
+			uint64_t locationKey;   // UsbLocation
+			uint32_t vendorId;
+			uint32_t productId;
+			uint8_t deviceClass;
+			uint8_t interfaceClass;
+			uint8_t isUsbDevice;
+			uint8_t isConnected;
+			uint32_t reserved;
+		};
+
+		static_assert(sizeof(FileHeader) == 72, "FileHeader is part of the file format");
+		static_assert(sizeof(Record) == 120, "Record is part of the file format");
+		static_assert(sizeof(wchar_t) == sizeof(uint16_t), "the string heap stores wchar_t as UTF-16");
+	}
+
+	/// @brief Serializes snapshots into the SnapshotFormat.
+	class SnapshotFileWriter
+	{
+	public:
+		SnapshotFileWriter() = delete;
+
+		/// @brief Encodes snapshot into a single buffer (one allocation).
+		[[nodiscard]] static std::vector<uint8_t> Serialize(const DeviceSnapshot& snapshot);
+
+		/// @brief Writes snapshot to path through a temporary file, replacing path atomically.
+		/// @throws DeviceIoException if the file cannot be written.
+		static void WriteFile(const std::wstring& path, const DeviceSnapshot& snapshot);
+	};
+
+	/// @brief One device record of a SnapshotFileView; strings point into the view.
+	class SnapshotDeviceView
+	{
+	public:
+		[[nodiscard]] std::wstring_view GetManufacturer() const noexcept { return String(_record->manufacturer); }
+		[[nodiscard]] std::wstring_view GetProduct() const noexcept { return String(_record->product); }
+		[[nodiscard]] std::wstring_view GetSerialNumber() const noexcept { return String(_record->serialNumber); }
+		[[nodiscard]] std::wstring_view GetDescription() const noexcept { return String(_record->description); }
+		[[nodiscard]] std::wstring_view GetDeviceId() const noexcept { return String(_record->deviceId); }
+		[[nodiscard]] std::wstring_view GetFriendlyName() const noexcept { return String(_record->friendlyName); }
+		[[nodiscard]] std::wstring_view GetDevicePath() const noexcept { return String(_record->devicePath); }
+		[[nodiscard]] std::wstring_view GetVendorName() const noexcept { return String(_record->vendorName); }
+		[[nodiscard]] std::wstring_view GetInterfaceClassName() const noexcept { return String(_record->interfaceClassName); }
+
+		[[nodiscard]] const SnapshotFormat::Record& GetRecord() const noexcept { return *_record; }
+
+		/// @brief Copies the record into an owning DeviceResultantInfo.
+		[[nodiscard]] DeviceResultantInfo ToDeviceResultantInfo() const;
+
+	private:
+		friend class SnapshotFileView;
+
+		SnapshotDeviceView(const SnapshotFormat::Record* record, const wchar_t* strings) noexcept :
+			_record(record), _strings(strings)
+		{
+		}
+
+		[[nodiscard]] std::wstring_view String(const SnapshotFormat::StringRef& ref) const noexcept
+		{
+			return std::wstring_view(_strings + ref.offset, ref.length);
+		}
+
+		const SnapshotFormat::Record* _record;
+		const wchar_t* _strings;
+	};
+
+	/// @brief Read-only view of an encoded snapshot held in memory the caller owns.
+	///
+	/// The constructor checks the header and that every record and string lies
+	/// inside the buffer; after that, access is plain pointer arithmetic.
+	class SnapshotFileView
+	{
+	public:
+		/// @param data Start of the encoded snapshot, aligned to 8 bytes.
+		/// @throws DeviceIoException (ERROR_INVALID_DATA) if the data is not a valid snapshot.
+		SnapshotFileView(const void* data, size_t size);
+
+		[[nodiscard]] size_t size() const noexcept { return static_cast<size_t>(_header->deviceCount); }
+		[[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+		[[nodiscard]] SnapshotDeviceView operator[](size_t index) const noexcept
+		{
+			return SnapshotDeviceView(_records + index, _strings);
+		}
+
+		[[nodiscard]] uint64_t GetSnapshotVersion() const noexcept { return _header->snapshotVersion; }
+		[[nodiscard]] int64_t GetCreatedAtMs() const noexcept { return _header->createdAtMs; }
+
+		/// @brief Copies every record into an owning DeviceSnapshot.
+		[[nodiscard]] DeviceSnapshot ToSnapshot() const;
+
+	private:
+		const SnapshotFormat::FileHeader* _header;
+		const SnapshotFormat::Record* _records;
+		const wchar_t* _strings;
+	};
+
+	/// @brief Maps a snapshot file read-only and exposes it as a SnapshotFileView.
+	class SnapshotFileReader
+	{
+	public:
+		/// @throws DeviceIoException if the file cannot be opened or mapped, or is not a valid snapshot.
+		explicit SnapshotFileReader(const std::wstring& path);
+
+		SnapshotFileReader(const SnapshotFileReader&) = delete;
+		SnapshotFileReader& operator=(const SnapshotFileReader&) = delete;
+
+		/// @brief The mapped snapshot; valid for the lifetime of the reader.
+		[[nodiscard]] const SnapshotFileView& GetView() const noexcept { return *_view; }
+
+	private:
+		wil::unique_hfile _file;
+		wil::unique_handle _mapping;
+		wil::unique_mapview_ptr<void> _data;
+		std::optional<SnapshotFileView> _view;
+	};
+}
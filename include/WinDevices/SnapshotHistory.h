@@ -0,0 +1,118 @@
+#pragma once
+
+#include "DeviceSnapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Retention limits of a SnapshotHistory. When a limit is exceeded, the oldest
+	/// snapshots are evicted first; the newest snapshot is always kept.
+	/// </summary>
+	struct SnapshotHistoryPolicy
+	{
+		/// Estimated bytes the history may hold (0 = unlimited). See SnapshotHistoryFootprint::bytes.
+		size_t byteBudget = 16 * 1024 * 1024;
+
+		/// Snapshots kept (0 = unlimited).
+		size_t maxSnapshots = 0;
+	};
+
+	/// <summary>
+	/// Memory use of a SnapshotHistory, as returned by SnapshotHistory::GetFootprint.
+	/// </summary>
+	struct SnapshotHistoryFootprint
+	{
+		size_t snapshots = 0;
+		size_t deviceReferences = 0;        // devices over all retained snapshots
+		size_t uniqueDevices = 0;           // distinct records actually stored
+		size_t topologyNodes = 0;
+
+		/// Estimated heap bytes held: records, their strings, snapshot tables and topologies.
+		size_t bytes = 0;
+
+		/// Estimate of the same snapshots with one record per device reference.
+		size_t bytesWithoutSharing = 0;
+
+		uint64_t evictedSnapshots = 0;      // since construction
+	};
+
+	/// @brief Bounded store of past device snapshots for change auditing.
+	///
+	/// A device that is identical in consecutive snapshots, which is most of them, is
+	/// stored once: records are shared by content hash (every field, see
+	/// DeviceContentHashOf), and a snapshot keeps only references to them. Records
+	/// are copied to the default resource on Add, so the history does not keep the
+	/// scan arena of a snapshot alive.
+	///
+	/// After each Add, the oldest snapshots are evicted while the policy is
+	/// exceeded, and records no longer referenced are freed. Byte figures are
+	/// estimates from object sizes and string lengths, without allocator overhead.
+	///
+	/// All members are thread-safe.
+	class SnapshotHistory
+	{
+	public:
+		explicit SnapshotHistory(SnapshotHistoryPolicy policy = {});
+
+		SnapshotHistory(const SnapshotHistory&) = delete;
+		SnapshotHistory& operator=(const SnapshotHistory&) = delete;
+
+		/// @brief Retains snapshot, then evicts as the policy requires.
+		///
+		/// A snapshot whose version is not newer than the newest retained one is
+		/// ignored, so the same publication can be offered more than once.
+		/// @return True if snapshot was retained.
+		bool Add(const DeviceSnapshot& snapshot);
+
+		/// @brief Rebuilds the retained snapshot with this version.
+		/// @return The snapshot, or nullptr if it was never added or has been evicted.
+		[[nodiscard]] DeviceSnapshotPtr Get(uint64_t version) const;
+
+		/// @brief Versions of the retained snapshots, oldest first.
+		[[nodiscard]] std::vector<uint64_t> GetVersions() const;
+
+		[[nodiscard]] SnapshotHistoryFootprint GetFootprint() const;
+
+		/// @brief Replaces the limits and evicts immediately if the new ones are exceeded.
+		void SetPolicy(SnapshotHistoryPolicy policy);
+
+		void Clear();
+
+	private:
+		struct Record
+		{
+			DeviceResultantInfo device;
+			size_t references = 0;              // device slots of retained snapshots pointing here
+			size_t stringBytes = 0;
+			uint64_t hash = 0;
+		};
+
+		struct Entry
+		{
+			uint64_t version = 0;
+			std::chrono::steady_clock::time_point publishedAt{};
+			std::vector<Record*> devices;       // nodes of _records, which never move
+			UsbTopology topology;
+			size_t bytes = 0;                   // entry, reference table and topology; not the records
+		};
+
+		Record* Intern(const DeviceResultantInfo& device);
+		void Release(Record* record) noexcept;
+		void EvictLocked();
+
+		SnapshotHistoryPolicy _policy;
+
+		mutable std::mutex _mutex;
+		std::deque<Entry> _entries;
+		std::unordered_multimap<uint64_t, Record> _records;    // by content hash
+		size_t _bytes = 0;
+		size_t _deviceReferences = 0;
+		uint64_t _evicted = 0;
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "DeviceSnapshot.h"
+#include "JsonWriter.h"
+#include "UsbTopology.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Output shape of a TopologyExporter.
+	/// </summary>
+	enum class TopologyFormat
+	{
+		Dot,    // Graphviz digraph, one statement per node and per edge
+		Json    // {"nodes":[...]} adjacency list: every node with its parent and children
+	};
+
+	/// @brief Streams a UsbTopology as a Graphviz graph or a JSON adjacency list.
+	///
+	/// Every node carries its kind and location; hubs and devices add VID/PID,
+	/// class, speed and open pipe count, and hubs add how many of their ports are
+	/// in use. Output goes through the same JsonWriter buffer as JsonExporter,
+	/// and nodes are written in the topology's pre-order in a single pass.
+	///
+	/// @code
+	/// TopologyExporter exporter([&](const char* data, size_t size) { out.write(data, size); }, TopologyFormat::Dot);
+	/// exporter.Write(*manager.GetSnapshot());
+	/// exporter.Flush();
+	/// @endcode
+	///
+	/// Not thread-safe. The sink may throw to abort an export; the exporter stays usable.
+	class TopologyExporter
+	{
+	public:
+		static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+		/// @throws InvalidDeviceArgumentException if sink is empty or bufferSize is below 64 bytes.
+		TopologyExporter(JsonSink sink, TopologyFormat format, size_t bufferSize = DefaultBufferSize);
+
+		TopologyExporter(const TopologyExporter&) = delete;
+		TopologyExporter& operator=(const TopologyExporter&) = delete;
+
+		/// @brief Writes snapshot.topology, labelling device nodes with their product names.
+		void Write(const DeviceSnapshot& snapshot);
+
+		/// @brief Writes topology; device nodes are labelled by VID/PID only.
+		void Write(const UsbTopology& topology);
+
+		/// @brief Hands everything buffered so far to the sink.
+		void Flush();
+
+		/// @brief Total bytes produced (flushed or still buffered).
+		[[nodiscard]] uint64_t GetBytesWritten() const noexcept { return _writer.GetBytesWritten(); }
+
+	private:
+		struct PortUsage
+		{
+			uint32_t total = 0;
+			uint32_t inUse = 0;
+		};
+
+		void Write(const UsbTopology& topology, const std::vector<DeviceResultantInfo>* devices);
+		void WriteDotNode(const UsbTopology& topology, uint32_t node, const DeviceResultantInfo* device);
+		void WriteJsonNode(const UsbTopology& topology, uint32_t node, const DeviceResultantInfo* device);
+
+		[[nodiscard]] static PortUsage PortsOf(const UsbTopology& topology, uint32_t hub) noexcept;
+
+		JsonWriter _writer;
+		TopologyFormat _format;
+	};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "IUsbBackend.h"
+#include <memory>
+
+namespace KDM
+{
+	class DeviceEnumerator;
+
+	/// @brief Windows implementation of IUsbBackend (SetupAPI + hub IOCTLs).
+	///
+	/// Root hubs are discovered through the USB host controller interface class,
+	/// hubs are opened with DeviceCommunication, and external hub paths are resolved
+	/// from the device information set of the last GetDeviceInstances() call.
+	///
+	/// @note GetHubDevicePath() requires a prior GetDeviceInstances() call because
+	/// the returned DevInfoData entries reference that device information set.
+	class UsbBackend : public IUsbBackend
+	{
+	public:
+		UsbBackend();
+		~UsbBackend() override;
+
+		// Move-only semantics (owns the HDEVINFO of the last device snapshot)
+		UsbBackend(const UsbBackend&) = delete;
+		UsbBackend& operator=(const UsbBackend&) = delete;
+		UsbBackend(UsbBackend&&) noexcept;
+		UsbBackend& operator=(UsbBackend&&) noexcept;
+
+		/// @brief Enumerates all present USB device nodes with their registry properties.
+		/// @throws wil::ResultException if SetupAPI enumeration fails.
+		[[nodiscard]] std::vector<DevInfoData> GetDeviceInstances() override;
+
+		/// @brief Queries every USB host controller for its root hub name.
+		/// @return Root hub device paths in "\\\\.\\USB#ROOT_HUB30#..." form.
+		/// @throws wil::ResultException if a controller cannot be queried.
+		[[nodiscard]] std::vector<std::wstring> GetRootHubPaths() override;
+
+		/// @brief Opens a DeviceCommunication handle to the hub.
+		/// @throws wil::ResultException if CreateFileW fails.
+		[[nodiscard]] std::unique_ptr<IDeviceCommunication> OpenHub(const std::wstring& hubPath) override;
+
+		/// @brief Resolves the hub interface device path of a USB bus layer device node.
+		/// @throws wil::ResultException if the device exposes no hub interface.
+		[[nodiscard]] std::wstring GetHubDevicePath(const DevInfoData& hubDevice) override;
+
+	private:
+		std::unique_ptr<DeviceEnumerator> _allDevicesEnumerator;
+	};
+}
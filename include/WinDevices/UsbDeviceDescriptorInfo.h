@@ -1,6 +1,8 @@
 #pragma once
 
 #include <optional>
+#include <string>
+#include <string_view>
 
 /// <summary>
 /// Stores USB device descriptor string information retrieved from USB string descriptors.
@@ -24,10 +26,10 @@ public:
 
 	void SetInterfaceClass(UCHAR interfaceClass) { _interfaceClass = interfaceClass; }
 
-	// Legacy getters (return copy for backward compatibility)
-	[[nodiscard]] std::wstring GetManufacturer() const { return _manufacturer; }
-	[[nodiscard]] std::wstring GetProduct() const { return _product; }
-	[[nodiscard]] std::wstring GetSerialNumber() const { return _serialNumber; }
+	// Views into this object, valid until SetUsbDeviceInfo or destruction
+	[[nodiscard]] std::wstring_view GetManufacturer() const noexcept { return _manufacturer; }
+	[[nodiscard]] std::wstring_view GetProduct() const noexcept { return _product; }
+	[[nodiscard]] std::wstring_view GetSerialNumber() const noexcept { return _serialNumber; }
 
 	/// <summary>
 	/// Gets the USB interface class code.
@@ -23,8 +23,8 @@ namespace KDM
 		UsbHostController(UsbHostController&&) = delete;
 		UsbHostController& operator=(UsbHostController&&) = delete;
 
-		std::wstring GetDriverKeyName(HANDLE hFile);
-		std::wstring GetRootHubNameByHandle(HANDLE HostController);
+		std::wstring GetDriverKeyName(DeviceCommunication& hostController);
+		std::wstring GetRootHubNameByHandle(DeviceCommunication& hostController);
 		std::wstring GetRootHubName();
 		void PopulateInfo();
 
@@ -50,6 +50,7 @@ namespace KDM
 		void PopulateInfo();
 		
 		[[nodiscard]] IDeviceCommunication* GetDeviceCommunication() const noexcept;
+		[[nodiscard]] ULONG GetNumberOfPorts() const noexcept;
 
 		void FillConfigDescriptor(USB_DEVICE_DESCRIPTOR* UsbDeviceDescriptor,
 			ULONG   ConnectionIndex, UCHAR   DescriptorIndex);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace KDM
+{
+	/// @brief Packed physical location of a USB hub or device: controller index plus port chain.
+	///
+	/// The top byte holds the 1-based controller index and the following bytes the
+	/// port numbers from the root hub down, most significant first, with zero bytes
+	/// after the last port. USB allows at most 255 ports per hub and six ports in a
+	/// chain (seven tiers), so every reachable location fits. 0 means unknown.
+	///
+	/// Keys compare like their port chains: a hub sorts directly before the devices
+	/// below it and ports of the same hub sort by number.
+	namespace UsbLocation
+	{
+		constexpr uint64_t Unknown = 0;
+		constexpr uint32_t MaxControllers = 255;
+		constexpr uint32_t MaxPorts = 255;
+		constexpr uint32_t MaxChainLength = 7;
+
+		/// @brief Location of the root hub of the controllerIndex-th (1-based) controller;
+		/// Unknown if the index does not fit.
+		[[nodiscard]] constexpr uint64_t ForController(uint32_t controllerIndex) noexcept
+		{
+			return controllerIndex == 0 || controllerIndex > MaxControllers
+				? Unknown : static_cast<uint64_t>(controllerIndex) << 56;
+		}
+
+		/// @brief index-th (0-based) port of the chain, counted from the root hub; 0 past the end.
+		[[nodiscard]] constexpr uint32_t PortAt(uint64_t location, uint32_t index) noexcept
+		{
+			return index < MaxChainLength ? static_cast<uint32_t>((location >> (48 - 8 * index)) & 0xFF) : 0;
+		}
+
+		/// @brief Number of ports in the chain of location (0 for a root hub or Unknown).
+		[[nodiscard]] constexpr uint32_t ChainLength(uint64_t location) noexcept
+		{
+			uint32_t length = 0;
+			while (PortAt(location, length) != 0) {
+				++length;
+			}
+			return length;
+		}
+
+		/// @brief Location of whatever is attached to port of the hub at location;
+		/// Unknown if location is Unknown, port is out of range or the chain is full.
+		[[nodiscard]] constexpr uint64_t AppendPort(uint64_t location, uint32_t port) noexcept
+		{
+			const uint32_t length = ChainLength(location);
+			if (location == Unknown || port == 0 || port > MaxPorts || length == MaxChainLength) {
+				return Unknown;
+			}
+			return location | (static_cast<uint64_t>(port) << (48 - 8 * length));
+		}
+
+		/// @brief 1-based controller index of location (0 for Unknown).
+		[[nodiscard]] constexpr uint32_t ControllerOf(uint64_t location) noexcept
+		{
+			return static_cast<uint32_t>(location >> 56);
+		}
+
+		/// @brief Text form "controller-port.port...", e.g. L"2-1.4.3"; a root hub is L"2",
+		/// Unknown is an empty string.
+		[[nodiscard]] std::wstring Format(uint64_t location);
+
+		/// @brief Inverse of Format; Unknown if text is not a valid location.
+		[[nodiscard]] uint64_t Parse(std::wstring_view text) noexcept;
+	}
+}
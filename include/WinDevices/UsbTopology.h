@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace KDM
+{
+	/// <summary>
+	/// Kind of a node in a UsbTopology.
+	/// </summary>
+	enum class UsbTopologyNodeKind : uint8_t
+	{
+		Controller,     // host controller; always a root
+		Hub,            // root hub (child of a controller) or external hub (child of a port)
+		Port,           // downstream port of a hub, connected or not
+		Device          // non-hub device attached to a port
+	};
+
+	/// <summary>
+	/// One node of a UsbTopology. Hubs and devices attached to a port carry the
+	/// connection data reported for that port.
+	/// </summary>
+	struct UsbTopologyNode
+	{
+		static constexpr uint32_t NoNode = (std::numeric_limits<uint32_t>::max)();
+
+		UsbTopologyNodeKind kind = UsbTopologyNodeKind::Device;
+
+		/// Hubs between the controller and this node, counting the node itself if it is a hub
+		/// (root hub = 1, its ports and devices = 1, an external hub on a root port = 2).
+		uint8_t hubDepth = 0;
+
+		uint8_t speed = 0;                  // USB_DEVICE_SPEED of the attached hub or device
+		uint8_t deviceClass = 0;            // bDeviceClass of the attached hub or device
+		uint16_t vendorId = 0;
+		uint16_t productId = 0;
+		uint16_t deviceAddress = 0;
+		uint32_t openPipes = 0;             // open pipes of the attached hub or device
+		uint8_t correlation = 0;            // CorrelationRule that linked the attached hub or device to SetupAPI
+		uint32_t portNumber = 0;            // 1-based port on the parent hub; 0 for controllers and root hubs
+		uint64_t locationKey = 0;           // UsbLocation; attached hubs and devices share their port's key
+
+		uint32_t parent = NoNode;
+		uint32_t subtreeEnd = 0;            // one past the last descendant
+		uint32_t deviceIndex = NoNode;      // Device: index into DeviceSnapshot::devices, if one was built
+
+		std::wstring path;                  // Hub: device path used to open the hub
+	};
+
+	/// @brief USB bus structure (controllers, hubs, ports and devices) captured during a scan.
+	///
+	/// Nodes are stored in one flat array in depth-first pre-order, so the subtree of
+	/// node i is the contiguous range [i, subtreeEnd). Parent, first child and next
+	/// sibling are all O(1) index computations, and walking a subtree touches nothing
+	/// outside it.
+	///
+	/// Nodes are appended in pre-order: a node's parent must be the last node added or
+	/// one of its ancestors. A topology is immutable once published in a snapshot.
+	class UsbTopology
+	{
+	public:
+		static constexpr uint32_t NoNode = UsbTopologyNode::NoNode;
+
+		/// @brief Contiguous range of nodes, e.g. a subtree.
+		class Range
+		{
+		public:
+			Range(const UsbTopologyNode* first, const UsbTopologyNode* last) noexcept : _first(first), _last(last) {}
+
+			[[nodiscard]] const UsbTopologyNode* begin() const noexcept { return _first; }
+			[[nodiscard]] const UsbTopologyNode* end() const noexcept { return _last; }
+			[[nodiscard]] size_t size() const noexcept { return static_cast<size_t>(_last - _first); }
+			[[nodiscard]] bool empty() const noexcept { return _first == _last; }
+
+		private:
+			const UsbTopologyNode* _first;
+			const UsbTopologyNode* _last;
+		};
+
+		/// @brief Appends node under node.parent (NoNode for a root) and returns its index.
+		///
+		/// subtreeEnd, hubDepth and locationKey are computed; they and deviceIndex are
+		/// ignored in node (link devices with SetDeviceIndex). Controllers are numbered
+		/// 1, 2, ... in the order they are added.
+		/// @throws InvalidDeviceArgumentException if the parent does not exist or its
+		/// subtree is already closed (the append would break pre-order).
+		uint32_t Add(UsbTopologyNode node);
+
+		/// @brief Links a Device node to its entry in DeviceSnapshot::devices.
+		/// @throws InvalidDeviceArgumentException if node is out of range.
+		void SetDeviceIndex(uint32_t node, uint32_t deviceIndex);
+
+		[[nodiscard]] size_t size() const noexcept { return _nodes.size(); }
+		[[nodiscard]] bool empty() const noexcept { return _nodes.empty(); }
+		[[nodiscard]] const UsbTopologyNode& operator[](uint32_t node) const noexcept { return _nodes[node]; }
+		[[nodiscard]] const std::vector<UsbTopologyNode>& GetNodes() const noexcept { return _nodes; }
+
+		/// @brief Index of a node obtained by reference from this topology.
+		[[nodiscard]] uint32_t IndexOf(const UsbTopologyNode& node) const noexcept
+		{
+			return static_cast<uint32_t>(&node - _nodes.data());
+		}
+
+		[[nodiscard]] uint32_t GetParent(uint32_t node) const noexcept { return _nodes[node].parent; }
+
+		/// @brief First child of node, or NoNode for a leaf.
+		[[nodiscard]] uint32_t GetFirstChild(uint32_t node) const noexcept
+		{
+			return _nodes[node].subtreeEnd > node + 1 ? node + 1 : NoNode;
+		}
+
+		/// @brief Next node with the same parent, or NoNode for the last child (or last root).
+		[[nodiscard]] uint32_t GetNextSibling(uint32_t node) const noexcept;
+
+		/// @brief node followed by all of its descendants in pre-order.
+		[[nodiscard]] Range GetSubtree(uint32_t node) const noexcept
+		{
+			return { _nodes.data() + node, _nodes.data() + _nodes[node].subtreeEnd };
+		}
+
+		/// @brief Node of the given DeviceSnapshot::devices entry, or NoNode if it has none.
+		[[nodiscard]] uint32_t GetDeviceNode(size_t deviceIndex) const noexcept
+		{
+			return deviceIndex < _deviceNodes.size() ? _deviceNodes[deviceIndex] : NoNode;
+		}
+
+		/// @brief Hub or Device node at location, or NoNode.
+		[[nodiscard]] uint32_t FindByLocation(uint64_t locationKey) const noexcept
+		{
+			auto it = _locationNodes.find(locationKey);
+			return it != _locationNodes.end() ? it->second : NoNode;
+		}
+
+		void Clear() noexcept;
+
+	private:
+		[[nodiscard]] uint64_t LocationOf(const UsbTopologyNode& node) const noexcept;
+
+		std::vector<UsbTopologyNode> _nodes;
+		std::vector<uint32_t> _deviceNodes;     // DeviceSnapshot::devices index -> node
+		std::unordered_map<uint64_t, uint32_t> _locationNodes;
+		uint32_t _controllerCount = 0;
+	};
+}
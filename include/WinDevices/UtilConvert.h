@@ -28,6 +28,7 @@ namespace KDM
 		/// <param name="Value">Value to convert</param>
 		/// <param name="BytesNumber">Width of hex output (e.g., 4 for "0x1234")</param>
 		/// <returns>Hex string (e.g., "0x0403" for Value=1027, BytesNumber=4)</returns>
+		/// <remarks>Allocates the result; HexFormat::Id formats into an inline buffer.</remarks>
 		[[nodiscard]] static std::wstring GetHexIdAsString(USHORT Value, USHORT BytesNumber);
 
 		/// <summary>
@@ -0,0 +1,185 @@
+#include "pch.h"
+#include "AllocationProfiler.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace KDM
+{
+namespace
+{
+	constexpr size_t PhaseCount = static_cast<size_t>(AllocationPhase::Count);
+
+	// Counters are plain atomics: the hook runs inside operator new and must
+	// neither allocate nor take locks.
+	std::atomic<bool> g_recording{ false };
+	std::atomic<uint64_t> g_allocations[PhaseCount]{};
+	std::atomic<uint64_t> g_bytes[PhaseCount]{};
+
+	// Trivially constructible so first access from operator new cannot allocate
+	thread_local AllocationPhase t_currentPhase = AllocationPhase::Other;
+
+	double PerDevice(uint64_t value, size_t deviceCount) noexcept
+	{
+		return deviceCount == 0 ? 0.0 : static_cast<double>(value) / static_cast<double>(deviceCount);
+	}
+}
+
+	AllocationCounters AllocationReport::Total() const noexcept
+	{
+		AllocationCounters total;
+		for (const auto& phase : phases)
+		{
+			total.allocations += phase.allocations;
+			total.bytes += phase.bytes;
+		}
+		return total;
+	}
+
+	double AllocationReport::AllocationsPerDevice() const noexcept
+	{
+		return PerDevice(Total().allocations, deviceCount);
+	}
+
+	double AllocationReport::AllocationsPerDevice(AllocationPhase phase) const noexcept
+	{
+		return PerDevice((*this)[phase].allocations, deviceCount);
+	}
+
+	double AllocationReport::BytesPerDevice() const noexcept
+	{
+		return PerDevice(Total().bytes, deviceCount);
+	}
+
+	double AllocationReport::BytesPerDevice(AllocationPhase phase) const noexcept
+	{
+		return PerDevice((*this)[phase].bytes, deviceCount);
+	}
+
+	void AllocationProfiler::Start() noexcept
+	{
+		for (size_t i = 0; i < PhaseCount; ++i)
+		{
+			g_allocations[i].store(0, std::memory_order_relaxed);
+			g_bytes[i].store(0, std::memory_order_relaxed);
+		}
+		g_recording.store(true, std::memory_order_release);
+	}
+
+	AllocationReport AllocationProfiler::Stop(size_t deviceCount) noexcept
+	{
+		g_recording.store(false, std::memory_order_release);
+
+		AllocationReport report;
+		report.deviceCount = deviceCount;
+		for (size_t i = 0; i < PhaseCount; ++i)
+		{
+			report.phases[i].allocations = g_allocations[i].load(std::memory_order_relaxed);
+			report.phases[i].bytes = g_bytes[i].load(std::memory_order_relaxed);
+		}
+		return report;
+	}
+
+	bool AllocationProfiler::IsRecording() noexcept
+	{
+		return g_recording.load(std::memory_order_acquire);
+	}
+
+	void AllocationProfiler::RecordAllocation(size_t bytes) noexcept
+	{
+		if (!g_recording.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		const auto index = static_cast<size_t>(t_currentPhase);
+		g_allocations[index].fetch_add(1, std::memory_order_relaxed);
+		g_bytes[index].fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	AllocationPhase AllocationProfiler::CurrentPhase() noexcept
+	{
+		return t_currentPhase;
+	}
+
+	AllocationPhase AllocationProfiler::SetPhase(AllocationPhase phase) noexcept
+	{
+		const AllocationPhase previous = t_currentPhase;
+		t_currentPhase = phase;
+		return previous;
+	}
+}
+
+#ifdef WINDEVICES_ALLOCATION_PROFILER
+
+// ============================================================================
+// Counting global operator new/delete replacement
+// ============================================================================
+// Replaces the non-aligned forms only; over-aligned allocations are rare in
+// this library and keep the default implementation (not counted).
+
+namespace
+{
+	void* CountingAllocate(size_t size) noexcept
+	{
+		KDM::AllocationProfiler::RecordAllocation(size);
+		return ::malloc(size == 0 ? 1 : size);
+	}
+}
+
+void* operator new(size_t size)
+{
+	if (void* ptr = CountingAllocate(size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	if (void* ptr = CountingAllocate(size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return CountingAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return CountingAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	::free(ptr);
+}
+
+#endif // WINDEVICES_ALLOCATION_PROFILER
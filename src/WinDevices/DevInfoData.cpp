@@ -5,26 +5,30 @@
 namespace KDM
 {
 
-	DevInfoData::DevInfoData(const HDEVINFO DevInfo, const  SP_DEVINFO_DATA DevInfoData)
+	DevInfoData::DevInfoData(const HDEVINFO DevInfo, const  SP_DEVINFO_DATA DevInfoData, const allocator_type& allocator)
+		: _driverKeyName(allocator), _hardwareId(allocator), _hardwareIds(allocator),
+		  _compatibleIds(allocator), _deviceDescription(allocator), _containerId(allocator)
 	{
 		_devInfo = DevInfo;
 		_devInfoData = DevInfoData;
+	}
 
-
-		WCHAR tmpGuidBuffer[MAX_PATH] = { 0 };
-		auto len = StringFromGUID2(_devInfoData.ClassGuid, tmpGuidBuffer, MAX_PATH);
-
-		// THROW_LAST_ERROR_IF(0 == len);
-
-		_classGuid = std::wstring(tmpGuidBuffer);
-		// std::wcout << _classGuid << std::endl;
-		// _classGuid
-
+	DevInfoData::DevInfoData(const DevInfoData& other, const allocator_type& allocator)
+		: _devInfo(other._devInfo), _devInfoData(other._devInfoData),
+		  _driverKeyName(other._driverKeyName, allocator),
+		  _hardwareId(other._hardwareId, allocator), _hardwareIds(other._hardwareIds, allocator),
+		  _compatibleIds(other._compatibleIds, allocator), _powerState(other._powerState),
+		  _deviceDescription(other._deviceDescription, allocator), _containerId(other._containerId, allocator)
+	{
 	}
 
-	SP_DEVINFO_DATA DevInfoData::GetDevInfoData()
+	DevInfoData::DevInfoData(DevInfoData&& other, const allocator_type& allocator)
+		: _devInfo(other._devInfo), _devInfoData(other._devInfoData),
+		  _driverKeyName(std::move(other._driverKeyName), allocator),
+		  _hardwareId(std::move(other._hardwareId), allocator), _hardwareIds(std::move(other._hardwareIds), allocator),
+		  _compatibleIds(std::move(other._compatibleIds), allocator), _powerState(other._powerState),
+		  _deviceDescription(std::move(other._deviceDescription), allocator), _containerId(std::move(other._containerId), allocator)
 	{
-		return _devInfoData;
 	}
 
 	void DevInfoData::SetDriverKeyName(const std::wstring& driverKeyName)
@@ -35,6 +39,36 @@ namespace KDM
 	void DevInfoData::SetHardwareId(const std::wstring& hardwareId)
 	{
 		_hardwareId = hardwareId;
+		_hardwareIds.assign(1, ParseHardwareId(hardwareId));
+	}
+
+	void DevInfoData::SetHardwareIds(const std::vector<std::wstring>& hardwareIds)
+	{
+		_hardwareId = hardwareIds.empty() ? std::wstring{} : hardwareIds.front();
+		_hardwareIds.clear();
+		_hardwareIds.reserve(hardwareIds.size());
+		for (const auto& id : hardwareIds) {
+			_hardwareIds.push_back(ParseHardwareId(id));
+		}
+	}
+
+	void DevInfoData::SetCompatibleIds(const std::vector<std::wstring>& compatibleIds)
+	{
+		_compatibleIds.clear();
+		_compatibleIds.reserve(compatibleIds.size());
+		for (const auto& id : compatibleIds) {
+			_compatibleIds.push_back(ParseHardwareId(id));
+		}
+	}
+
+	bool DevInfoData::MatchesVidPid(uint16_t vendorId, uint16_t productId) const noexcept
+	{
+		for (const auto& id : _hardwareIds) {
+			if (id.MatchesVidPid(vendorId, productId)) {
+				return true;
+			}
+		}
+		return false;
 	}
 
 	void DevInfoData::SetDeviceDescription(const std::wstring& value)
@@ -42,9 +76,9 @@ namespace KDM
 		_deviceDescription = value;
 	}
 
-	std::wstring DevInfoData::GetDeviceDescription() const
+	void DevInfoData::SetContainerId(const std::wstring& containerId)
 	{
-		return _deviceDescription;
+		_containerId = containerId;
 	}
 
 
@@ -53,7 +87,7 @@ namespace KDM
 		_powerState = PowerState;
 	}
 
-	std::wstring DevInfoData::GetPowerStateAsString()
+	std::wstring_view DevInfoData::GetPowerStateAsString() const noexcept
 	{
 		switch (_powerState)
 		{
@@ -75,10 +109,4 @@ namespace KDM
 		}
 	}
 
-	DEVICE_POWER_STATE DevInfoData::GetPowerState()
-	{
-		return _powerState;
-	}
-
-
 }
\ No newline at end of file
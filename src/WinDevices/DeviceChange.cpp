@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "DeviceChange.h"
+#include "Fnv1a.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace KDM
+{
+namespace
+{
+	using Fnv1a::HashBytes;
+	using Fnv1a::HashString;
+
+	DeviceChange MakeChange(DeviceChangeType type, const DeviceResultantInfo& device, uint64_t key,
+		uint64_t snapshotVersion)
+	{
+		DeviceChange change;
+		change.type = type;
+		change.snapshotVersion = snapshotVersion;
+		change.deviceKey = key;
+		change.device = device;
+		return change;
+	}
+}
+
+	uint64_t DeviceKeyOf(const DeviceResultantInfo& device) noexcept
+	{
+		uint64_t hash = Fnv1a::OffsetBasis;
+		HashString(hash, device.GetDevicePath());
+		HashString(hash, device.GetDeviceId());
+		HashString(hash, device.GetSerialNumber());
+
+		const uint32_t ids[] = { device.GetVendorId(), device.GetProductId() };
+		HashBytes(hash, ids, sizeof(ids));
+
+		// Tells apart identical devices without serial numbers; a device moved to another port is a new device
+		const uint64_t location = device.GetLocationKey();
+		HashBytes(hash, &location, sizeof(location));
+		return hash;
+	}
+
+	uint64_t DeviceContentHashOf(const DeviceResultantInfo& device) noexcept
+	{
+		uint64_t hash = Fnv1a::OffsetBasis;
+		for (const std::wstring_view value : { device.GetManufacturer(), device.GetProduct(), device.GetSerialNumber(),
+			device.GetDescription(), device.GetDeviceId(), device.GetFriendlyName(), device.GetDevicePath(),
+			device.GetVendorName(), device.GetInterfaceClassName() }) {
+			HashString(hash, value);
+		}
+
+		const uint32_t ids[] = { device.GetVendorId(), device.GetProductId() };
+		HashBytes(hash, ids, sizeof(ids));
+		const uint8_t flags[] = { device.GetDeviceClass(), device.GetInterfaceClass(),
+			static_cast<uint8_t>(device.IsUsbDevice()), static_cast<uint8_t>(device.IsConnected()) };
+		HashBytes(hash, flags, sizeof(flags));
+		HashBytes(hash, &device.GetSetupClassGuid(), sizeof(GUID));
+		const uint64_t location = device.GetLocationKey();
+		HashBytes(hash, &location, sizeof(location));
+		return hash;
+	}
+
+	std::vector<DeviceChange> DiffSnapshots(const DeviceSnapshot& previous, const DeviceSnapshot& current)
+	{
+		std::vector<DeviceChange> changes;
+		if (previous.devices.empty() && current.devices.empty()) {
+			return changes;
+		}
+
+		// Previous devices sorted by key, then by position. Duplicates of a key are claimed
+		// by an identical device first, otherwise in previous order, so the pairing never
+		// depends on hash table iteration order.
+		std::vector<std::pair<uint64_t, size_t>> byKey;
+		byKey.reserve(previous.devices.size());
+		for (size_t i = 0; i < previous.devices.size(); ++i) {
+			byKey.emplace_back(DeviceKeyOf(previous.devices[i]), i);
+		}
+		std::sort(byKey.begin(), byKey.end());
+		std::vector<bool> matched(previous.devices.size());
+
+		std::vector<DeviceChange> updates;
+		for (const auto& device : current.devices)
+		{
+			const uint64_t key = DeviceKeyOf(device);
+			const auto first = std::lower_bound(byKey.begin(), byKey.end(), std::make_pair(key, size_t{ 0 }));
+			const auto last = std::find_if(first, byKey.end(), [key](const auto& entry) { return entry.first != key; });
+
+			auto it = std::find_if(first, last, [&](const auto& entry) {
+				return !matched[entry.second] && previous.devices[entry.second] == device; });
+			if (it == last) {
+				it = std::find_if(first, last, [&](const auto& entry) { return !matched[entry.second]; });
+			}
+			if (it == last)
+			{
+				updates.push_back(MakeChange(DeviceChangeType::Arrived, device, key, current.version));
+				continue;
+			}
+
+			matched[it->second] = true;
+			if (previous.devices[it->second] != device) {
+				updates.push_back(MakeChange(DeviceChangeType::Changed, device, key, current.version));
+			}
+		}
+
+		changes.reserve(previous.devices.size() + updates.size());
+		for (size_t index = 0; index < previous.devices.size(); ++index)
+		{
+			if (matched[index]) {
+				continue;
+			}
+			const auto& device = previous.devices[index];
+			changes.push_back(MakeChange(DeviceChangeType::Removed, device, DeviceKeyOf(device), current.version));
+		}
+		std::move(updates.begin(), updates.end(), std::back_inserter(changes));
+		return changes;
+	}
+}
@@ -0,0 +1,460 @@
+#include "pch.h"
+#include "DeviceChangeJournal.h"
+#include "UtilConvert.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace KDM
+{
+namespace
+{
+	// File layout: header, one BaseMarker record, the baseline devices, then the changes.
+	// Integers are written in native byte order; strings as a UTF-16 unit count + UTF-16LE
+	// code units, whatever the width of wchar_t.
+	constexpr uint32_t JournalMagic = 0x4A4D444B;      // "KDMJ"
+	constexpr uint32_t JournalFormatVersion = 2;     // 2: location key
+	// Guards against reading a corrupt length; any field a device can hold must pass
+	constexpr uint32_t MaxStringLength = static_cast<uint32_t>(DeviceResultantInfo::MaxStringLength);
+
+	enum class RecordKind : uint8_t
+	{
+		BaseMarker = 0,         // sequence = base sequence, no device
+		Arrived = static_cast<uint8_t>(DeviceChangeType::Arrived),
+		Removed = static_cast<uint8_t>(DeviceChangeType::Removed),
+		Changed = static_cast<uint8_t>(DeviceChangeType::Changed),
+		BaselineDevice = 4
+	};
+
+	template <typename T>
+	void WritePod(std::ostream& out, const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadPod(std::istream& in, T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	// Code units staged per write/read call
+	constexpr size_t StringChunkUnits = 256;
+
+	void WriteString(std::ostream& out, std::wstring_view value)
+	{
+		WritePod(out, static_cast<uint32_t>(value.size()));
+
+		char bytes[StringChunkUnits * 2];
+		size_t used = 0;
+		for (const wchar_t c : value)
+		{
+			const auto unit = static_cast<uint16_t>(c);
+			bytes[used++] = static_cast<char>(unit & 0xFF);
+			bytes[used++] = static_cast<char>(unit >> 8);
+			if (used == sizeof(bytes))
+			{
+				out.write(bytes, static_cast<std::streamsize>(used));
+				used = 0;
+			}
+		}
+		out.write(bytes, static_cast<std::streamsize>(used));
+	}
+
+	bool ReadString(std::istream& in, std::wstring& value)
+	{
+		uint32_t length = 0;
+		if (!ReadPod(in, length) || length > MaxStringLength) {
+			return false;
+		}
+		value.resize(length);
+
+		char bytes[StringChunkUnits * 2];
+		for (size_t i = 0; i < length;)
+		{
+			const size_t count = (std::min)(static_cast<size_t>(length) - i, StringChunkUnits);
+			if (!in.read(bytes, static_cast<std::streamsize>(count * 2))) {
+				return false;
+			}
+			for (size_t j = 0; j < count; ++j, ++i) {
+				value[i] = static_cast<wchar_t>(static_cast<uint8_t>(bytes[2 * j]) | (static_cast<uint8_t>(bytes[2 * j + 1]) << 8));
+			}
+		}
+		return true;
+	}
+
+	void WriteDevice(std::ostream& out, const DeviceResultantInfo& device)
+	{
+		WriteString(out, device.GetManufacturer());
+		WriteString(out, device.GetProduct());
+		WriteString(out, device.GetSerialNumber());
+		WriteString(out, device.GetDescription());
+		WriteString(out, device.GetDeviceId());
+		WriteString(out, device.GetFriendlyName());
+		WriteString(out, device.GetDevicePath());
+		WriteString(out, device.GetVendorName());
+		WriteString(out, device.GetInterfaceClassName());
+		WritePod(out, device.GetDeviceClass());
+		WritePod(out, device.GetInterfaceClass());
+		WritePod(out, device.GetSetupClassGuid());
+		WritePod(out, static_cast<uint32_t>(device.GetVendorId()));
+		WritePod(out, static_cast<uint32_t>(device.GetProductId()));
+		WritePod(out, static_cast<uint8_t>(device.IsUsbDevice()));
+		WritePod(out, static_cast<uint8_t>(device.IsConnected()));
+		WritePod(out, device.GetLocationKey());
+	}
+
+	bool ReadDevice(std::istream& in, DeviceResultantInfo& device)
+	{
+		std::wstring strings[9];
+		for (auto& value : strings)
+		{
+			if (!ReadString(in, value)) {
+				return false;
+			}
+		}
+
+		UCHAR deviceClass = 0;
+		UCHAR interfaceClass = 0;
+		GUID setupClassGuid{};
+		uint32_t vendorId = 0;
+		uint32_t productId = 0;
+		uint8_t isUsbDevice = 0;
+		uint8_t isConnected = 0;
+		uint64_t locationKey = 0;
+		if (!ReadPod(in, deviceClass) || !ReadPod(in, interfaceClass) || !ReadPod(in, setupClassGuid) ||
+			!ReadPod(in, vendorId) || !ReadPod(in, productId) || !ReadPod(in, isUsbDevice) || !ReadPod(in, isConnected) ||
+			!ReadPod(in, locationKey) || vendorId > UINT16_MAX || productId > UINT16_MAX)
+		{
+			return false;
+		}
+
+		device.SetManufacturer(strings[0]);
+		device.SetProduct(strings[1]);
+		device.SetSerialNumber(strings[2]);
+		device.SetDescription(strings[3]);
+		device.SetDeviceId(strings[4]);
+		device.SetFriendlyName(strings[5]);
+		device.SetDevicePath(strings[6]);
+		device.SetVendorName(strings[7]);
+		device.SetInterfaceClassName(strings[8]);
+		device.SetDeviceClass(deviceClass);
+		device.SetInterfaceClass(interfaceClass);
+		device.SetSetupClassGuid(setupClassGuid);
+		device.SetVendorId(static_cast<uint16_t>(vendorId));
+		device.SetProductId(static_cast<uint16_t>(productId));
+		device.SetIsUsbDevice(isUsbDevice != 0);
+		device.SetIsConnected(isConnected != 0);
+		device.SetLocationKey(locationKey);
+		return true;
+	}
+
+	void WriteRecord(std::ostream& out, RecordKind kind, uint64_t sequence, uint64_t snapshotVersion,
+		uint64_t deviceKey, const DeviceResultantInfo* device)
+	{
+		WritePod(out, kind);
+		WritePod(out, sequence);
+		WritePod(out, snapshotVersion);
+		WritePod(out, deviceKey);
+		if (device) {
+			WriteDevice(out, *device);
+		}
+	}
+
+	void WriteChange(std::ostream& out, const DeviceChange& change)
+	{
+		WriteRecord(out, static_cast<RecordKind>(change.type), change.sequence, change.snapshotVersion,
+			change.deviceKey, &change.device);
+	}
+}
+
+	DeviceChangeJournal::DeviceChangeJournal(JournalPolicy policy) :
+		_policy(std::move(policy))
+	{
+		if (!_policy.filePath.empty()) {
+			LoadFile();
+		}
+	}
+
+	uint64_t DeviceChangeJournal::Append(std::vector<DeviceChange> changes)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (changes.empty()) {
+			return _lastSequence;
+		}
+
+		uint64_t sequence = _lastSequence;
+		for (auto& change : changes) {
+			change.sequence = ++sequence;
+		}
+
+		// File first: changes that did not reach the file are not taken, and their
+		// sequence numbers are handed out again by the next call
+		if (!_policy.filePath.empty())
+		{
+			if (_rewritePending) {
+				RewriteFileLocked(&changes);
+			}
+			else {
+				AppendToFileLocked(changes);
+			}
+		}
+
+		_lastSequence = sequence;
+		_changes.insert(_changes.end(), std::make_move_iterator(changes.begin()), std::make_move_iterator(changes.end()));
+
+		if (_policy.compactionThreshold != 0 && _changes.size() > _policy.compactionThreshold)
+		{
+			try
+			{
+				CompactLocked(_policy.compactionThreshold / 2);
+			}
+			catch (const DeviceIoException& ex)
+			{
+				// The changes are on file already; it just stays uncompacted until the next rewrite
+				spdlog::warn("DeviceChangeJournal: {}", ex.what());
+			}
+		}
+		return _lastSequence;
+	}
+
+	uint64_t DeviceChangeJournal::Synchronize(const DeviceSnapshot& current)
+	{
+		// Device list the journal describes: baseline plus every retained change
+		DeviceSnapshot journaled;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			std::multimap<uint64_t, DeviceResultantInfo> state = _baseline;
+			for (const auto& change : _changes) {
+				ApplyChange(state, change);
+			}
+
+			journaled.devices.reserve(state.size());
+			for (auto& [key, device] : state) {
+				journaled.devices.push_back(std::move(device));
+			}
+		}
+
+		return Append(DiffSnapshots(journaled, current));
+	}
+
+	DeviceChangeSet DeviceChangeJournal::GetChangesSince(uint64_t sequence) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		DeviceChangeSet set;
+		set.baseSequence = _baseSequence;
+		set.lastSequence = _lastSequence;
+
+		// Compacted away, or from a journal this one does not continue (e.g. a deleted file)
+		if (sequence < _baseSequence || sequence > _lastSequence)
+		{
+			set.resync = true;
+			set.baseline.reserve(_baseline.size());
+			for (const auto& [key, device] : _baseline) {
+				set.baseline.push_back(device);
+			}
+			set.changes.assign(_changes.begin(), _changes.end());
+			return set;
+		}
+
+		// Retained sequences are contiguous: _baseSequence + 1 ... _lastSequence
+		set.changes.assign(_changes.begin() + static_cast<ptrdiff_t>(sequence - _baseSequence), _changes.end());
+		return set;
+	}
+
+	uint64_t DeviceChangeJournal::GetLastSequence() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _lastSequence;
+	}
+
+	uint64_t DeviceChangeJournal::GetBaseSequence() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _baseSequence;
+	}
+
+	size_t DeviceChangeJournal::GetRecordCount() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _changes.size();
+	}
+
+	void DeviceChangeJournal::Compact()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		CompactLocked(0);
+	}
+
+	void DeviceChangeJournal::CompactLocked(size_t keep)
+	{
+		while (_changes.size() > keep)
+		{
+			ApplyChange(_baseline, _changes.front());
+			_baseSequence = _changes.front().sequence;
+			_changes.pop_front();
+		}
+
+		spdlog::debug("DeviceChangeJournal: compacted to sequence {} ({} baseline devices, {} changes kept)",
+			_baseSequence, _baseline.size(), _changes.size());
+
+		if (!_policy.filePath.empty()) {
+			RewriteFileLocked();
+		}
+	}
+
+	void DeviceChangeJournal::ApplyChange(std::multimap<uint64_t, DeviceResultantInfo>& state, const DeviceChange& change)
+	{
+		auto [first, last] = state.equal_range(change.deviceKey);
+
+		switch (change.type)
+		{
+		case DeviceChangeType::Arrived:
+			state.emplace(change.deviceKey, change.device);
+			break;
+
+		case DeviceChangeType::Removed:
+		{
+			// Prefer the exact record when identical keys are present more than once
+			auto it = std::find_if(first, last, [&](const auto& entry) { return entry.second == change.device; });
+			if (it == last) {
+				it = first;
+			}
+			if (it != last) {
+				state.erase(it);
+			}
+			break;
+		}
+
+		case DeviceChangeType::Changed:
+			if (first != last) {
+				first->second = change.device;
+			}
+			else {
+				state.emplace(change.deviceKey, change.device);
+			}
+			break;
+		}
+	}
+
+	void DeviceChangeJournal::LoadFile()
+	{
+		const std::filesystem::path path(_policy.filePath);
+
+		if (std::filesystem::exists(path))
+		{
+			std::ifstream in(path, std::ios::binary);
+			if (!in) {
+				throw DeviceIoException("DeviceChangeJournal: cannot open " + UtilConvert::WStringToUTF8(_policy.filePath));
+			}
+
+			uint32_t magic = 0;
+			uint32_t formatVersion = 0;
+			if (!ReadPod(in, magic) || !ReadPod(in, formatVersion) ||
+				magic != JournalMagic || formatVersion != JournalFormatVersion)
+			{
+				throw DeviceIoException("DeviceChangeJournal: not a journal file: " +
+					UtilConvert::WStringToUTF8(_policy.filePath), ERROR_INVALID_DATA);
+			}
+
+			RecordKind kind{};
+			while (ReadPod(in, kind))
+			{
+				DeviceChange record;
+				if (!ReadPod(in, record.sequence) || !ReadPod(in, record.snapshotVersion) || !ReadPod(in, record.deviceKey)) {
+					break;
+				}
+				if (kind == RecordKind::BaseMarker)
+				{
+					_baseSequence = _lastSequence = record.sequence;
+					continue;
+				}
+				if (!ReadDevice(in, record.device)) {
+					break;
+				}
+
+				if (kind == RecordKind::BaselineDevice) {
+					_baseline.emplace(record.deviceKey, std::move(record.device));
+				}
+				else if (kind >= RecordKind::Arrived && kind <= RecordKind::Changed && record.sequence == _lastSequence + 1)
+				{
+					record.type = static_cast<DeviceChangeType>(kind);
+					_lastSequence = record.sequence;
+					_changes.push_back(std::move(record));
+				}
+				else {
+					break;      // out of order or unknown: treat the rest as damaged
+				}
+			}
+
+			spdlog::info("DeviceChangeJournal: loaded {} changes after sequence {} from {}",
+				_changes.size(), _baseSequence, UtilConvert::WStringToUTF8(_policy.filePath));
+		}
+
+		// Start from a clean file: drops a truncated tail and creates a missing file
+		RewriteFileLocked();
+	}
+
+	void DeviceChangeJournal::RewriteFileLocked(const std::vector<DeviceChange>* pending)
+	{
+		const std::filesystem::path path(_policy.filePath);
+		std::filesystem::path temporary = path;
+		temporary += L".tmp";
+
+		// Until a rewrite succeeds the file may end in a partial record or lack compaction,
+		// so the next write replaces it instead of appending
+		_rewritePending = true;
+		{
+			std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+			WritePod(out, JournalMagic);
+			WritePod(out, JournalFormatVersion);
+			WriteRecord(out, RecordKind::BaseMarker, _baseSequence, 0, 0, nullptr);
+			for (const auto& [key, device] : _baseline) {
+				WriteRecord(out, RecordKind::BaselineDevice, _baseSequence, 0, key, &device);
+			}
+			for (const auto& change : _changes) {
+				WriteChange(out, change);
+			}
+			if (pending)
+			{
+				for (const auto& change : *pending) {
+					WriteChange(out, change);
+				}
+			}
+
+			out.flush();
+			if (!out) {
+				throw DeviceIoException("DeviceChangeJournal: cannot write " + UtilConvert::WStringToUTF8(temporary.wstring()));
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, path, error);
+		if (error) {
+			throw DeviceIoException("DeviceChangeJournal: cannot replace " + UtilConvert::WStringToUTF8(_policy.filePath) +
+				": " + error.message());
+		}
+		_rewritePending = false;
+	}
+
+	void DeviceChangeJournal::AppendToFileLocked(const std::vector<DeviceChange>& changes)
+	{
+		std::ofstream out(std::filesystem::path(_policy.filePath), std::ios::binary | std::ios::app);
+		for (const auto& change : changes) {
+			WriteChange(out, change);
+		}
+
+		out.flush();
+		if (!out)
+		{
+			_rewritePending = true;
+			throw DeviceIoException("DeviceChangeJournal: cannot append to " + UtilConvert::WStringToUTF8(_policy.filePath));
+		}
+	}
+}
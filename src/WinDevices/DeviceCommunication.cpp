@@ -7,6 +7,7 @@
 #include "DeviceCommunication.h"
 #include "UsbClassCodes.h"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <utility>
 #include <cstring>
 
@@ -23,6 +24,9 @@ namespace KDM
 				default:            return L"unknown";
 			}
 		}
+
+		// How often a pending IOCTL checks for cancellation; the token has no wait handle
+		constexpr DWORD IoPollIntervalMs = 50;
 	}
 
 	HANDLE DeviceCommunication::GetFileHandle()
@@ -38,7 +42,7 @@ namespace KDM
 			FILE_SHARE_WRITE,
 			nullptr,
 			OPEN_EXISTING,
-			0,
+			FILE_FLAG_OVERLAPPED,
 			nullptr));
 
 		if (!fileHandle || fileHandle.get() == INVALID_HANDLE_VALUE) {
@@ -46,21 +50,85 @@ namespace KDM
 				"Failed to open device: DeviceCommunication constructor");
 		}
 
+		_ioEvent.create(wil::EventOptions::ManualReset);
 		_hFile = std::move(fileHandle);
 	}
 
+	void DeviceCommunication::SetIoLimits(const EnumerationOptions& options)
+	{
+		_ioDeadline = options.deadline;
+		_ioCancellation = options.cancellation;
+	}
+
+	BOOL DeviceCommunication::Ioctl(DWORD ioControlCode, void* inBuffer, DWORD inBufferSize,
+		void* outBuffer, DWORD outBufferSize, DWORD* bytesReturned)
+	{
+		OVERLAPPED overlapped{};
+		overlapped.hEvent = _ioEvent.get();
+		_ioEvent.ResetEvent();
+
+		DWORD transferred = 0;
+		BOOL result = DeviceIoControl(_hFile.get(), ioControlCode, inBuffer, inBufferSize,
+			outBuffer, outBufferSize, &transferred, &overlapped);
+
+		if (!result && GetLastError() == ERROR_IO_PENDING)
+		{
+			const DWORD stopReason = AwaitIo(overlapped);
+
+			// Waits for the cancellation to take effect: the buffers belong to the caller
+			result = GetOverlappedResult(_hFile.get(), &overlapped, &transferred, TRUE);
+			if (!result && stopReason != ERROR_SUCCESS && GetLastError() == ERROR_OPERATION_ABORTED) {
+				SetLastError(stopReason);
+			}
+		}
+
+		if (bytesReturned) {
+			*bytesReturned = transferred;
+		}
+		return result;
+	}
+
+	// Returns ERROR_SUCCESS once the request completes, or the error to report after
+	// cancelling it because the deadline passed or cancellation was requested
+	DWORD DeviceCommunication::AwaitIo(OVERLAPPED& overlapped)
+	{
+		for (;;)
+		{
+			if (_ioCancellation.IsCancellationRequested())
+			{
+				CancelIoEx(_hFile.get(), &overlapped);
+				return ERROR_OPERATION_ABORTED;
+			}
+
+			DWORD waitMs = IoPollIntervalMs;
+			if (_ioDeadline)
+			{
+				const auto remaining = *_ioDeadline - std::chrono::steady_clock::now();
+				if (remaining <= std::chrono::steady_clock::duration::zero())
+				{
+					CancelIoEx(_hFile.get(), &overlapped);
+					return ERROR_TIMEOUT;
+				}
+				const auto remainingMs = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+				waitMs = static_cast<DWORD>((std::min<std::chrono::milliseconds::rep>)(remainingMs, waitMs));
+			}
+
+			if (WaitForSingleObject(overlapped.hEvent, waitMs) == WAIT_OBJECT_0) {
+				return ERROR_SUCCESS;
+			}
+		}
+	}
+
 	void DeviceCommunication::GetUsbHubNodeInformation(HubNodeInfo& nodeInfo)
 	{
 		USB_NODE_INFORMATION hubInfo{};
 		ULONG bytesReturned = 0;
 
-		BOOL ioctlResult = DeviceIoControl(
-			_hFile.get(),
+		BOOL ioctlResult = Ioctl(
 			IOCTL_USB_GET_NODE_INFORMATION,
 			&hubInfo, sizeof(hubInfo),
 			&hubInfo, sizeof(hubInfo),
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		THROW_LAST_ERROR_IF_MSG(!ioctlResult, "GetUsbHubNodeInformation: IOCTL_USB_GET_NODE_INFORMATION failed");
 
@@ -73,13 +141,11 @@ namespace KDM
 		USB_HUB_INFORMATION_EX hubInfoEx{};
 		ULONG bytesReturned = 0;
 
-		BOOL ioctlResult = DeviceIoControl(
-			_hFile.get(),
+		BOOL ioctlResult = Ioctl(
 			IOCTL_USB_GET_HUB_INFORMATION_EX,
 			&hubInfoEx, sizeof(hubInfoEx),
 			&hubInfoEx, sizeof(hubInfoEx),
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		// This IOCTL may not be supported on older Windows versions (pre-Windows 8)
 		bool isSupported = ioctlResult && (bytesReturned >= sizeof(USB_HUB_INFORMATION_EX));
@@ -93,13 +159,11 @@ namespace KDM
 		USB_HUB_CAPABILITIES_EX hubCapabilityEx{};
 		ULONG bytesReturned = 0;
 
-		BOOL ioctlResult = DeviceIoControl(
-			_hFile.get(),
+		BOOL ioctlResult = Ioctl(
 			IOCTL_USB_GET_HUB_CAPABILITIES_EX,
 			&hubCapabilityEx, sizeof(hubCapabilityEx),
 			&hubCapabilityEx, sizeof(hubCapabilityEx),
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		if (!ioctlResult || bytesReturned < sizeof(USB_HUB_CAPABILITIES_EX)) {
 			THROW_HR_MSG(HRESULT_FROM_WIN32(GetLastError()),
@@ -129,13 +193,11 @@ namespace KDM
 			initialQuery.ConnectionIndex = portIndex;
 			ULONG bytesReturned = 0;
 
-			BOOL result = DeviceIoControl(
-				_hFile.get(),
+			BOOL result = Ioctl(
 				IOCTL_USB_GET_PORT_CONNECTOR_PROPERTIES,
 				&initialQuery, sizeof(initialQuery),
 				&initialQuery, sizeof(initialQuery),
-				&bytesReturned,
-				nullptr);
+				&bytesReturned);
 
 			if (!result || bytesReturned != sizeof(USB_PORT_CONNECTOR_PROPERTIES)) {
 				return std::nullopt;
@@ -150,13 +212,11 @@ namespace KDM
 			auto& fullProps = *reinterpret_cast<PUSB_PORT_CONNECTOR_PROPERTIES>(propsBuffer.get());
 			fullProps.ConnectionIndex = portIndex;
 
-			result = DeviceIoControl(
-				_hFile.get(),
+			result = Ioctl(
 				IOCTL_USB_GET_PORT_CONNECTOR_PROPERTIES,
 				propsBuffer.get(), initialQuery.ActualLength,
 				propsBuffer.get(), initialQuery.ActualLength,
-				&bytesReturned,
-				nullptr);
+				&bytesReturned);
 
 			HubPortInfo portInfo;
 			if (!result || bytesReturned < initialQuery.ActualLength) {
@@ -204,13 +264,11 @@ namespace KDM
 			infoV2.SupportedUsbProtocols.Usb300 = 1;
 
 			ULONG bytesReturned = 0;
-			BOOL result = DeviceIoControl(
-				_hFile.get(),
+			BOOL result = Ioctl(
 				IOCTL_USB_GET_NODE_CONNECTION_INFORMATION_EX_V2,
 				&infoV2, sizeof(infoV2),
 				&infoV2, sizeof(infoV2),
-				&bytesReturned,
-				nullptr);
+				&bytesReturned);
 
 			if (result && bytesReturned >= sizeof(USB_NODE_CONNECTION_INFORMATION_EX_V2)) {
 				return infoV2;
@@ -264,13 +322,11 @@ namespace KDM
 			connInfo.ConnectionIndex = static_cast<ULONG>(portIndex);
 
 			ULONG bytesReturned = bufferSize;
-			BOOL result = DeviceIoControl(
-				_hFile.get(),
+			BOOL result = Ioctl(
 				IOCTL_USB_GET_NODE_CONNECTION_INFORMATION,
 				buffer.get(), bufferSize,
 				buffer.get(), bufferSize,
-				&bytesReturned,
-				nullptr);
+				&bytesReturned);
 
 			if (!result) {
 				return std::nullopt;
@@ -311,13 +367,11 @@ namespace KDM
 			connInfoEx.ConnectionIndex = static_cast<ULONG>(portNumber);
 
 			ULONG bytesReturned = exBufferSize;
-			BOOL exResult = DeviceIoControl(
-				_hFile.get(),
+			BOOL exResult = Ioctl(
 				IOCTL_USB_GET_NODE_CONNECTION_INFORMATION_EX,
 				exBuffer.get(), exBufferSize,
 				exBuffer.get(), exBufferSize,
-				&bytesReturned,
-				nullptr);
+				&bytesReturned);
 
 			HubConnectionInfo connectionInfo;
 			bool deviceConnected = false;
@@ -362,13 +416,11 @@ namespace KDM
 		initialQuery.ConnectionIndex = connectionIndex;
 		ULONG bytesReturned = 0;
 
-		BOOL result = DeviceIoControl(
-			_hFile.get(),
+		BOOL result = Ioctl(
 			IOCTL_USB_GET_NODE_CONNECTION_DRIVERKEY_NAME,
 			&initialQuery, sizeof(initialQuery),
 			&initialQuery, sizeof(initialQuery),
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		THROW_LAST_ERROR_IF_MSG(!result, "GetDriverKeyName: initial query failed");
 
@@ -384,13 +436,11 @@ namespace KDM
 		auto& driverKeyName = *reinterpret_cast<PUSB_NODE_CONNECTION_DRIVERKEY_NAME>(keyNameBuffer.get());
 		driverKeyName.ConnectionIndex = connectionIndex;
 
-		result = DeviceIoControl(
-			_hFile.get(),
+		result = Ioctl(
 			IOCTL_USB_GET_NODE_CONNECTION_DRIVERKEY_NAME,
 			keyNameBuffer.get(), requiredSize,
 			keyNameBuffer.get(), requiredSize,
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		THROW_LAST_ERROR_IF_MSG(!result, "GetDriverKeyName: retrieval failed");
 
@@ -425,13 +475,11 @@ namespace KDM
 				static_cast<USHORT>(bufferSize - sizeof(USB_DESCRIPTOR_REQUEST));
 
 			ULONG bytesReturned = 0;
-			BOOL result = DeviceIoControl(
-				_hFile.get(),
+			BOOL result = Ioctl(
 				IOCTL_USB_GET_DESCRIPTOR_FROM_NODE_CONNECTION,
 				buffer, bufferSize,
 				buffer, bufferSize,
-				&bytesReturned,
-				nullptr);
+				&bytesReturned);
 
 			return { result != FALSE, bytesReturned };
 		};
@@ -504,13 +552,11 @@ namespace KDM
 
 		// Execute the IOCTL request
 		ULONG bytesReturned = 0;
-		BOOL ioctlResult = DeviceIoControl(
-			_hFile.get(),
+		BOOL ioctlResult = Ioctl(
 			IOCTL_USB_GET_DESCRIPTOR_FROM_NODE_CONNECTION,
 			requestBuffer.get(), requestBufferSize,
 			requestBuffer.get(), requestBufferSize,
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		// Access the returned string descriptor (located after the request header)
 		auto& stringDescriptor = *reinterpret_cast<PUSB_STRING_DESCRIPTOR>(requestBuffer.get() + sizeof(USB_DESCRIPTOR_REQUEST));
@@ -561,13 +607,11 @@ namespace KDM
 		initialQuery.ConnectionIndex = index;
 		ULONG bytesReturned = 0;
 
-		BOOL result = DeviceIoControl(
-			_hFile.get(),
+		BOOL result = Ioctl(
 			IOCTL_USB_GET_NODE_CONNECTION_NAME,
 			&initialQuery, sizeof(initialQuery),
 			&initialQuery, sizeof(initialQuery),
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		if (!result) {
 			spdlog::debug("GetUsbExternalHubName: initial query failed, error={}", GetLastError());
@@ -586,13 +630,11 @@ namespace KDM
 		auto& connectionName = *reinterpret_cast<PUSB_NODE_CONNECTION_NAME>(hubNameBuffer.get());
 		connectionName.ConnectionIndex = index;
 
-		result = DeviceIoControl(
-			_hFile.get(),
+		result = Ioctl(
 			IOCTL_USB_GET_NODE_CONNECTION_NAME,
 			hubNameBuffer.get(), requiredSize,
 			hubNameBuffer.get(), requiredSize,
-			&bytesReturned,
-			nullptr);
+			&bytesReturned);
 
 		THROW_LAST_ERROR_IF(!result);
 
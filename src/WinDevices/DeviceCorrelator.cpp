@@ -0,0 +1,177 @@
+#include "pch.h"
+#include "DeviceCorrelator.h"
+#include <algorithm>
+#include <cwctype>
+#include <iterator>
+
+namespace KDM
+{
+namespace
+{
+	// Container of everything built into the computer; it groups unrelated devices
+	constexpr wchar_t LocalMachineContainer[] = L"{00000000-0000-0000-FFFF-FFFFFFFFFFFF}";
+
+	bool IsLocalMachineContainer(std::wstring_view containerId) noexcept
+	{
+		return containerId.size() == std::size(LocalMachineContainer) - 1 &&
+			std::equal(containerId.begin(), containerId.end(), LocalMachineContainer,
+				[](wchar_t a, wchar_t b) { return towupper(a) == static_cast<wint_t>(b); });
+	}
+
+	// Interface number a node was indexed under: whole-device nodes sort before interfaces
+	uint32_t InterfaceOrder(const DevInfoData& node, uint16_t vendorId, uint16_t productId) noexcept
+	{
+		for (const auto& id : node.GetHardwareIds()) {
+			if (id.MatchesVidPid(vendorId, productId)) {
+				return id.Has(HardwareId::HasInterface) ? id.interfaceNumber + 1u : 0u;
+			}
+		}
+		return 0;
+	}
+
+	bool CarriesOtherVidPid(const DevInfoData& node, uint16_t vendorId, uint16_t productId) noexcept
+	{
+		bool carriesVidPid = false;
+		for (const auto& id : node.GetHardwareIds()) {
+			if (id.MatchesVidPid(vendorId, productId)) {
+				return false;
+			}
+			carriesVidPid |= id.Has(HardwareId::HasVendorId | HardwareId::HasProductId);
+		}
+		return carriesVidPid;
+	}
+}
+
+	DeviceCorrelator::DeviceCorrelator(const std::vector<DevInfoData>& nodes)
+		: _nodes{ nodes }
+	{
+		_byDriverKey.reserve(nodes.size());
+		_byVidPid.reserve(nodes.size());
+		_byDescription.reserve(nodes.size());
+
+		for (uint32_t index = 0; index < nodes.size(); ++index) {
+			const DevInfoData& node = nodes[index];
+
+			if (const auto driverKey = node.GetDriverKeyName(); !driverKey.empty()) {
+				_byDriverKey.try_emplace(driverKey, index);
+			}
+
+			// Every hardware ID of a node usually carries the same VID/PID; index each pair once
+			for (const auto& id : node.GetHardwareIds()) {
+				if (id.Has(HardwareId::HasVendorId | HardwareId::HasProductId)) {
+					auto& entries = _byVidPid[VidPidKey(id.vendorId, id.productId)];
+					if (entries.empty() || entries.back() != index) {
+						entries.push_back(index);
+					}
+				}
+			}
+
+			if (const auto containerId = node.GetContainerId(); !containerId.empty() && !IsLocalMachineContainer(containerId)) {
+				_byContainerId[containerId].push_back(index);
+			}
+
+			if (const auto description = node.GetDeviceDescription(); !description.empty()) {
+				_byDescription.try_emplace(description, index);
+			}
+		}
+
+		for (auto& [key, entries] : _byVidPid) {
+			const auto vendorId = static_cast<uint16_t>(key >> 16);
+			const auto productId = static_cast<uint16_t>(key);
+			std::stable_sort(entries.begin(), entries.end(), [&](uint32_t a, uint32_t b) {
+				return InterfaceOrder(nodes[a], vendorId, productId) < InterfaceOrder(nodes[b], vendorId, productId);
+			});
+		}
+
+		_stats.indexedNodes = nodes.size();
+	}
+
+	PortCorrelation DeviceCorrelator::Join(std::wstring_view driverKey, uint16_t vendorId, uint16_t productId,
+		bool isHub, std::wstring_view productName)
+	{
+		PortCorrelation correlation;
+
+		if (!driverKey.empty()) {
+			if (auto it = _byDriverKey.find(driverKey); it != _byDriverKey.end()) {
+				correlation.busNode = &_nodes[it->second];
+			}
+		}
+
+		const auto vidPidIt = _byVidPid.find(VidPidKey(vendorId, productId));
+		const std::vector<uint32_t>* vidPidNodes = vidPidIt != _byVidPid.end() ? &vidPidIt->second : nullptr;
+
+		if (auto node = FindFunction(vidPidNodes, correlation.busNode, vendorId, productId, false)) {
+			correlation = { correlation.busNode, node, CorrelationRule::VidPid };
+		}
+		else if (!isHub && correlation.busNode && !correlation.busNode->GetContainerId().empty()) {
+			const auto containerIt = _byContainerId.find(correlation.busNode->GetContainerId());
+			if (containerIt != _byContainerId.end()) {
+				if (auto member = FindFunction(&containerIt->second, correlation.busNode, vendorId, productId, true)) {
+					correlation = { correlation.busNode, member, CorrelationRule::ContainerId };
+				}
+			}
+		}
+
+		if (!correlation.functionNode) {
+			if (correlation.busNode) {
+				correlation.functionNode = correlation.busNode;
+				correlation.rule = CorrelationRule::DriverKey;
+			}
+			else if (vidPidNodes) {
+				correlation.functionNode = &_nodes[vidPidNodes->front()];
+				correlation.rule = CorrelationRule::VidPid;
+			}
+			else if (!productName.empty()) {
+				if (auto it = _byDescription.find(productName); it != _byDescription.end()) {
+					correlation.functionNode = &_nodes[it->second];
+					correlation.rule = CorrelationRule::ProductName;
+				}
+			}
+		}
+
+		Count(correlation);
+		return correlation;
+	}
+
+	// First candidate other than the bus-layer node with a different setup class; with
+	// requireVidPidOrNone, nodes of another USB function (other VID/PID) are skipped
+	const DevInfoData* DeviceCorrelator::FindFunction(const std::vector<uint32_t>* candidates,
+		const DevInfoData* busNode, uint16_t vendorId, uint16_t productId, bool requireVidPidOrNone) const
+	{
+		if (!candidates) {
+			return nullptr;
+		}
+
+		for (uint32_t index : *candidates) {
+			const DevInfoData& node = _nodes[index];
+			if (&node == busNode) {
+				continue;
+			}
+			if (busNode && IsEqualGUID(node.GetClassGuid(), busNode->GetClassGuid())) {
+				continue;
+			}
+			if (requireVidPidOrNone && CarriesOtherVidPid(node, vendorId, productId)) {
+				continue;
+			}
+			return &node;
+		}
+		return nullptr;
+	}
+
+	void DeviceCorrelator::Count(const PortCorrelation& correlation) noexcept
+	{
+		++_stats.ports;
+		if (correlation.busNode) {
+			++_stats.busNodes;
+		}
+
+		switch (correlation.rule)
+		{
+		case CorrelationRule::DriverKey: ++_stats.byDriverKey; break;
+		case CorrelationRule::VidPid: ++_stats.byVidPid; break;
+		case CorrelationRule::ContainerId: ++_stats.byContainerId; break;
+		case CorrelationRule::ProductName: ++_stats.byProductName; break;
+		default: ++_stats.unmatched; break;
+		}
+	}
+}
@@ -25,32 +25,59 @@ namespace KDM
 		std::vector<DevInfoData> deviceInstances;
 		deviceInstances.reserve(UsbLimits::TypicalDeviceCount);
 
-		// Helper: Populate device properties from registry
+		// Helper: Populate device properties from registry, all in one batched read
 		auto populateDeviceProperties = [this](DevInfoData& deviceData, const SP_DEVINFO_DATA& spDevInfo)
 		{
-			DeviceProperty propReader(_hDevInfo.get(), spDevInfo);
+			const DeviceProperties properties = DeviceProperty(_hDevInfo.get(), spDevInfo).GetProperties(
+				DevicePropertyMask::DriverKey | DevicePropertyMask::Description |
+				DevicePropertyMask::HardwareId | DevicePropertyMask::CompatibleIds |
+				DevicePropertyMask::ContainerId | DevicePropertyMask::PowerState);
 
 			// Driver key name
-			if (std::wstring driverKey; propReader.GetStringProperty(SPDRP_DRIVER, driverKey)) {
-				deviceData.SetDriverKeyName(driverKey);
+			if (properties.Has(DevicePropertyMask::DriverKey)) {
+				deviceData.SetDriverKeyName(properties.driverKey);
 			}
 
 			// Device description (e.g., "USB Mass Storage Device", "USB Composite Device")
 			// Important for detecting USB Mass Storage devices that don't report via bDeviceClass
-			if (std::wstring description; propReader.GetStringProperty(SPDRP_DEVICEDESC, description)) {
-				deviceData.SetDeviceDescription(description);
+			if (properties.Has(DevicePropertyMask::Description)) {
+				deviceData.SetDeviceDescription(properties.description);
 			}
 
-			// Hardware ID (e.g., USB\VID_0951&PID_172B)
-			if (std::wstring hardwareId; propReader.GetStringProperty(SPDRP_HARDWAREID, hardwareId)) {
-				deviceData.SetHardwareId(hardwareId);
+			// Hardware IDs (e.g., USB\VID_0951&PID_172B&REV_0001, USB\VID_0951&PID_172B),
+			// parsed into VID/PID/REV/MI fields for matching
+			if (properties.Has(DevicePropertyMask::HardwareId)) {
+				deviceData.SetHardwareIds(properties.hardwareIds);
+			}
+
+			// Compatible IDs (e.g., USB\Class_08&SubClass_06&Prot_50)
+			if (properties.Has(DevicePropertyMask::CompatibleIds)) {
+				deviceData.SetCompatibleIds(properties.compatibleIds);
+			}
+
+			// Container ID: the same for every node of one physical device
+			if (properties.Has(DevicePropertyMask::ContainerId)) {
+				deviceData.SetContainerId(properties.containerId);
 			}
 
 			// Power state
-			deviceData.SetPowerState(propReader.GetPowerState());
+			deviceData.SetPowerState(properties.powerState);
 		};
 
 		// Enumerate all device instances
+		ForEachDevice([&](const SP_DEVINFO_DATA& spDevInfoData) {
+			// Create device info and populate properties
+			DevInfoData deviceData(_hDevInfo.get(), spDevInfoData);
+			populateDeviceProperties(deviceData, spDevInfoData);
+
+			deviceInstances.push_back(std::move(deviceData));
+		});
+
+		return deviceInstances;
+	}
+
+	void DeviceEnumerator::ForEachDevice(const std::function<void(const SP_DEVINFO_DATA&)>& callback)
+	{
 		for (ULONG deviceIndex = 0; ; ++deviceIndex) {
 			SP_DEVINFO_DATA spDevInfoData{};
 			spDevInfoData.cbSize = sizeof(SP_DEVINFO_DATA);
@@ -62,17 +89,11 @@ namespace KDM
 				if (errorCode == ERROR_NO_MORE_ITEMS) {
 					break;  // Normal termination - no more devices
 				}
-				THROW_IF_WIN32_ERROR_MSG(errorCode, "DeviceEnumerator::GetDeviceInstances: SetupDiEnumDeviceInfo failed");
+				THROW_IF_WIN32_ERROR_MSG(errorCode, "DeviceEnumerator::ForEachDevice: SetupDiEnumDeviceInfo failed");
 			}
 
-			// Create device info and populate properties
-			DevInfoData deviceData(_hDevInfo.get(), spDevInfoData);
-			populateDeviceProperties(deviceData, spDevInfoData);
-
-			deviceInstances.push_back(std::move(deviceData));
+			callback(spDevInfoData);
 		}
-
-		return deviceInstances;
 	}
 
 	HDEVINFO DeviceEnumerator::GetDevInfoSet()
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "DeviceEventRing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace KDM
+{
+namespace
+{
+	size_t RoundUpToPowerOfTwo(size_t value) noexcept
+	{
+		size_t result = 1;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	DeviceEvent MakeEvent(const DeviceChange& change, int64_t timestampMs) noexcept
+	{
+		DeviceEvent event;
+		event.type = static_cast<DeviceEventType>(change.type);
+		event.snapshotVersion = change.snapshotVersion;
+		event.deviceKey = change.deviceKey;
+		event.timestampMs = timestampMs;
+		event.vendorId = static_cast<uint16_t>(change.device.GetVendorId());
+		event.productId = static_cast<uint16_t>(change.device.GetProductId());
+		event.deviceClass = change.device.GetDeviceClass();
+		event.interfaceClass = change.device.GetInterfaceClass();
+		return event;
+	}
+}
+
+	DeviceEventRing::DeviceEventRing(size_t capacity)
+	{
+		if (capacity == 0) {
+			throw InvalidDeviceArgumentException("DeviceEventRing: capacity must be greater than 0");
+		}
+
+		const size_t slots = RoundUpToPowerOfTwo(capacity);
+		_slots = std::make_unique<Slot[]>(slots);
+		_mask = slots - 1;
+	}
+
+	uint64_t DeviceEventRing::Publish(DeviceEvent event) noexcept
+	{
+		const uint64_t position = _head.fetch_add(1, std::memory_order_acq_rel);
+		event.sequence = position + 1;
+
+		Slot& slot = _slots[position & _mask];
+		const uint64_t writing = 2 * position + 1;
+
+		uint64_t stamp = slot.stamp.load(std::memory_order_relaxed);
+		while (true)
+		{
+			if (stamp >= writing) {
+				// A producer a full lap ahead already owns the slot; this event is lost for everyone
+				return event.sequence;
+			}
+			if (stamp & 1)
+			{
+				// A producer a lap behind is still writing; only happens when the ring wraps mid-write
+				std::this_thread::yield();
+				stamp = slot.stamp.load(std::memory_order_relaxed);
+				continue;
+			}
+			if (slot.stamp.compare_exchange_weak(stamp, writing, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+
+		uint64_t words[WordsPerEvent];
+		std::memcpy(words, &event, sizeof(event));
+		for (size_t i = 0; i < WordsPerEvent; ++i) {
+			slot.words[i].store(words[i], std::memory_order_relaxed);
+		}
+
+		slot.stamp.store(writing + 1, std::memory_order_release);
+		return event.sequence;
+	}
+
+	DeviceEventRing::ReadResult DeviceEventRing::TryRead(uint64_t position, DeviceEvent& event) const noexcept
+	{
+		const Slot& slot = _slots[position & _mask];
+		const uint64_t written = 2 * position + 2;
+
+		const uint64_t before = slot.stamp.load(std::memory_order_acquire);
+		if (before < written) {
+			return ReadResult::NotPublished;
+		}
+		if (before > written) {
+			return ReadResult::Overwritten;
+		}
+
+		uint64_t words[WordsPerEvent];
+		for (size_t i = 0; i < WordsPerEvent; ++i) {
+			words[i] = slot.words[i].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// A producer a lap ahead may have started overwriting while we copied
+		if (slot.stamp.load(std::memory_order_relaxed) != before) {
+			return ReadResult::Overwritten;
+		}
+
+		std::memcpy(&event, words, sizeof(event));
+		return ReadResult::Ready;
+	}
+
+	std::unique_ptr<DeviceEventSubscriber> DeviceEventRing::Subscribe() const
+	{
+		return std::unique_ptr<DeviceEventSubscriber>(
+			new DeviceEventSubscriber(*this, _head.load(std::memory_order_acquire)));
+	}
+
+	uint64_t DeviceEventRing::GetPublishedCount() const noexcept
+	{
+		return _head.load(std::memory_order_acquire);
+	}
+
+	size_t DeviceEventSubscriber::Poll(DeviceEvent* events, size_t maxEvents) noexcept
+	{
+		if (!events) {
+			return 0;
+		}
+
+		const uint64_t capacity = _ring.GetCapacity();
+		size_t count = 0;
+
+		while (count < maxEvents)
+		{
+			uint64_t cursor = _cursor.load(std::memory_order_acquire);
+			const uint64_t head = _ring._head.load(std::memory_order_acquire);
+			if (cursor >= head) {
+				break;
+			}
+
+			// Lapped: everything older than one ring behind the head is gone
+			if (head - cursor > capacity)
+			{
+				const uint64_t oldest = head - capacity;
+				if (_cursor.compare_exchange_strong(cursor, oldest, std::memory_order_acq_rel)) {
+					_dropped.fetch_add(oldest - cursor, std::memory_order_relaxed);
+				}
+				continue;
+			}
+
+			DeviceEvent event;
+			switch (_ring.TryRead(cursor, event))
+			{
+			case DeviceEventRing::ReadResult::NotPublished:
+				// Keep order: later events wait until this one is complete
+				return count;
+
+			case DeviceEventRing::ReadResult::Overwritten:
+				if (_cursor.compare_exchange_strong(cursor, cursor + 1, std::memory_order_acq_rel)) {
+					_dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+				break;
+
+			case DeviceEventRing::ReadResult::Ready:
+				// Another consumer of this subscriber may have taken it first
+				if (_cursor.compare_exchange_strong(cursor, cursor + 1, std::memory_order_acq_rel)) {
+					events[count++] = event;
+				}
+				break;
+			}
+		}
+
+		return count;
+	}
+
+	uint64_t DeviceEventSubscriber::GetDroppedCount() const noexcept
+	{
+		return _dropped.load(std::memory_order_relaxed);
+	}
+
+	uint64_t DeviceEventSubscriber::GetPendingCount() const noexcept
+	{
+		const uint64_t cursor = _cursor.load(std::memory_order_acquire);
+		const uint64_t head = _ring._head.load(std::memory_order_acquire);
+		if (cursor >= head) {
+			return 0;
+		}
+		return (std::min)(head - cursor, static_cast<uint64_t>(_ring.GetCapacity()));
+	}
+
+	size_t PublishChanges(DeviceEventRing& ring, const std::vector<DeviceChange>& changes)
+	{
+		if (changes.empty()) {
+			return 0;
+		}
+
+		const int64_t timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+
+		for (const auto& change : changes) {
+			ring.Publish(MakeEvent(change, timestampMs));
+		}
+		return changes.size();
+	}
+}
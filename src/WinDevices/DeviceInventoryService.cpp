@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "DeviceInventoryService.h"
+#include "IUsbBackend.h"
+#include "UsbBackend.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <optional>
+
+namespace KDM
+{
+	DeviceInventoryService::DeviceInventoryService(InventoryRefreshPolicy policy) :
+		DeviceInventoryService(std::make_unique<UsbBackend>(), std::move(policy))
+	{
+	}
+
+	DeviceInventoryService::DeviceInventoryService(std::unique_ptr<IUsbBackend> backend, InventoryRefreshPolicy policy) :
+		_policy(std::move(policy)),
+		_manager(std::move(backend)),
+		_current(std::make_shared<const DeviceSnapshot>())
+	{
+		if (_policy.fastInterval.count() <= 0 || _policy.fastInterval > _policy.slowInterval) {
+			throw InvalidDeviceArgumentException("DeviceInventoryService: fastInterval must be positive and not exceed slowInterval");
+		}
+
+		_stats.currentInterval = _policy.fastInterval;
+		_thread = std::thread(&DeviceInventoryService::Run, this);
+	}
+
+	DeviceInventoryService::~DeviceInventoryService()
+	{
+		Stop();
+	}
+
+	void DeviceInventoryService::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_wake.notify_all();
+		_refreshed.notify_all();
+
+		if (_thread.joinable() && _thread.get_id() != std::this_thread::get_id()) {
+			_thread.join();
+		}
+	}
+
+	void DeviceInventoryService::RequestRefresh()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_refreshRequested = true;
+		}
+		_wake.notify_one();
+	}
+
+	DeviceSnapshotPtr DeviceInventoryService::GetSnapshot() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _current;
+	}
+
+	DeviceSnapshotPtr DeviceInventoryService::GetDevices(std::chrono::milliseconds maxAge)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		if (_current->version != 0 && std::chrono::steady_clock::now() - _lastRefresh <= maxAge) {
+			return _current;
+		}
+
+		// Wait for a scan that starts after this request; one already running may predate it
+		const uint64_t target = _startedScans + 1;
+		_refreshRequested = true;
+		_wake.notify_one();
+
+		_refreshed.wait(lock, [&]() {
+			return _stopping || _completedScans >= target ||
+				(_current->version != 0 && std::chrono::steady_clock::now() - _lastRefresh <= maxAge);
+		});
+		return _current;
+	}
+
+	DeviceSnapshotPtr DeviceInventoryService::WaitForChange(uint64_t sinceVersion, std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		const bool changed = _refreshed.wait_for(lock, timeout, [&]() {
+			return _stopping || _current->version > sinceVersion;
+		});
+		return changed && _current->version > sinceVersion ? _current : nullptr;
+	}
+
+	InventoryStats DeviceInventoryService::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _stats;
+	}
+
+	void DeviceInventoryService::Run()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		while (!_stopping)
+		{
+			_refreshRequested = false;
+			++_startedScans;
+			const uint64_t changesBefore = _stats.changes;
+
+			lock.unlock();
+			Refresh();
+			lock.lock();
+
+			// Fast right after a change, backing off towards slowInterval while idle
+			_stats.currentInterval = _stats.changes != changesBefore
+				? _policy.fastInterval
+				: (std::min)(_stats.currentInterval * 2, _policy.slowInterval);
+
+			_wake.wait_for(lock, _stats.currentInterval, [this]() {
+				return _stopping || _refreshRequested;
+			});
+		}
+	}
+
+	void DeviceInventoryService::Refresh()
+	{
+		EnumerationOptions options = _policy.scanTimeout.count() > 0
+			? EnumerationOptions::WithTimeout(_policy.scanTimeout)
+			: EnumerationOptions{};
+
+		std::optional<EnumerationStatus> status;
+		std::string error;
+		try
+		{
+			status = _manager.EnumerateUsbDevices(options);
+		}
+		catch (const std::exception& ex)
+		{
+			error = ex.what();
+			spdlog::error("DeviceInventoryService: refresh failed: {}", error);
+		}
+
+		const bool publishable = status && (status->IsComplete() || _policy.publishPartialScans);
+		DeviceSnapshotPtr scanned = publishable ? _manager.GetSnapshot() : nullptr;
+		const auto now = std::chrono::steady_clock::now();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			++_stats.refreshes;
+			++_completedScans;
+
+			if (!status)
+			{
+				++_stats.failures;
+				_stats.lastError = std::move(error);
+			}
+			else if (!scanned)
+			{
+				++_stats.incompleteScans;
+				spdlog::warn("DeviceInventoryService: scan skipped {} hub(s)/port(s), keeping previous inventory",
+					status->skipped.size());
+			}
+			else
+			{
+				_lastRefresh = now;
+
+				// Only a different device list is a new inventory; an unchanged scan just confirms it.
+				// The scan itself is published, with its topology and string arena, not a copy.
+				if (_current->version == 0 || _current->devices != scanned->devices)
+				{
+					_current = std::move(scanned);
+					++_stats.changes;
+
+					spdlog::info("DeviceInventoryService: inventory v{} published ({} devices)",
+						_current->version, _current->devices.size());
+				}
+			}
+		}
+		_refreshed.notify_all();
+	}
+}
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "DevicePropertyReader.h"
+#include <algorithm>
+
+namespace KDM
+{
+namespace
+{
+	struct StringField
+	{
+		uint32_t mask;
+		DWORD property;
+		std::wstring DeviceProperties::* member;
+	};
+
+	const StringField StringFields[] = {
+		{ DevicePropertyMask::Description, SPDRP_DEVICEDESC, &DeviceProperties::description },
+		{ DevicePropertyMask::FriendlyName, SPDRP_FRIENDLYNAME, &DeviceProperties::friendlyName },
+		{ DevicePropertyMask::Manufacturer, SPDRP_MFG, &DeviceProperties::manufacturer },
+		{ DevicePropertyMask::DriverKey, SPDRP_DRIVER, &DeviceProperties::driverKey },
+		{ DevicePropertyMask::ContainerId, SPDRP_BASE_CONTAINERID, &DeviceProperties::containerId },
+	};
+
+	struct MultiStringField
+	{
+		uint32_t mask;
+		DWORD property;
+		std::vector<std::wstring> DeviceProperties::* member;
+	};
+
+	const MultiStringField MultiStringFields[] = {
+		{ DevicePropertyMask::HardwareId, SPDRP_HARDWAREID, &DeviceProperties::hardwareIds },
+		{ DevicePropertyMask::CompatibleIds, SPDRP_COMPATIBLEIDS, &DeviceProperties::compatibleIds },
+	};
+
+	// A value can grow between the sizing read and the retry; give up after this many retries
+	constexpr int MaxOverflowReads = 2;
+}
+
+	DevicePropertyReader::DevicePropertyReader(IDevicePropertySource& source) noexcept
+		: _source{ source }
+	{
+	}
+
+	bool DevicePropertyReader::Read(DWORD property, BYTE* stackBuffer, const BYTE*& data, DWORD& size)
+	{
+		data = stackBuffer;
+		size = 0;
+		DWORD errorCode = _source.ReadProperty(property, stackBuffer, StackBufferSize, size);
+
+		for (int attempt = 0; errorCode == ERROR_INSUFFICIENT_BUFFER && size > 0 && attempt < MaxOverflowReads; ++attempt) {
+			_overflow.resize(size);
+			errorCode = _source.ReadProperty(property, _overflow.data(), size, size);
+			data = _overflow.data();
+		}
+
+		// Anything else means the property doesn't exist or is inaccessible for this
+		// device type (ERROR_INVALID_DATA, ERROR_INVALID_REG_PROPERTY, ...)
+		return errorCode == ERROR_SUCCESS && size > 0;
+	}
+
+	bool DevicePropertyReader::GetStringProperty(DWORD property, std::wstring& resultValue)
+	{
+		alignas(wchar_t) BYTE stackBuffer[StackBufferSize];
+		const BYTE* data = nullptr;
+		DWORD size = 0;
+		if (!Read(property, stackBuffer, data, size)) {
+			return false;
+		}
+
+		// Stop at the first terminator: REG_SZ ends with one, REG_MULTI_SZ separates entries with them
+		const auto text = reinterpret_cast<const wchar_t*>(data);
+		const auto end = std::find(text, text + size / sizeof(wchar_t), L'\0');
+		resultValue.assign(text, end);
+		return true;
+	}
+
+	bool DevicePropertyReader::GetMultiStringProperty(DWORD property, std::vector<std::wstring>& resultValues)
+	{
+		alignas(wchar_t) BYTE stackBuffer[StackBufferSize];
+		const BYTE* data = nullptr;
+		DWORD size = 0;
+		if (!Read(property, stackBuffer, data, size)) {
+			return false;
+		}
+
+		// Entries are NUL-terminated and the list ends with an empty one; a missing final
+		// terminator still yields the last entry
+		resultValues.clear();
+		auto text = reinterpret_cast<const wchar_t*>(data);
+		const auto end = text + size / sizeof(wchar_t);
+		while (text < end) {
+			const auto entryEnd = std::find(text, end, L'\0');
+			if (entryEnd == text) {
+				break;
+			}
+			resultValues.emplace_back(text, entryEnd);
+			text = entryEnd + 1;
+		}
+		return true;
+	}
+
+	DEVICE_POWER_STATE DevicePropertyReader::GetPowerState()
+	{
+		CM_POWER_DATA powerData{};
+		DWORD requiredSize = 0;
+
+		DWORD errorCode = _source.ReadProperty(SPDRP_DEVICE_POWER_DATA,
+			reinterpret_cast<BYTE*>(&powerData), sizeof(powerData), requiredSize);
+
+		return errorCode == ERROR_SUCCESS ? powerData.PD_MostRecentPowerState : PowerDeviceUnspecified;
+	}
+
+	DeviceProperties DevicePropertyReader::GetProperties(uint32_t mask)
+	{
+		DeviceProperties properties;
+
+		for (const StringField& field : StringFields) {
+			if ((mask & field.mask) && GetStringProperty(field.property, properties.*field.member)) {
+				properties.present |= field.mask;
+			}
+		}
+
+		for (const MultiStringField& field : MultiStringFields) {
+			if ((mask & field.mask) && GetMultiStringProperty(field.property, properties.*field.member)) {
+				properties.present |= field.mask;
+			}
+		}
+		if (!properties.hardwareIds.empty()) {
+			properties.hardwareId = properties.hardwareIds.front();
+		}
+
+		if (mask & DevicePropertyMask::PowerState) {
+			properties.powerState = GetPowerState();
+			if (properties.powerState != PowerDeviceUnspecified) {
+				properties.present |= DevicePropertyMask::PowerState;
+			}
+		}
+
+		return properties;
+	}
+}
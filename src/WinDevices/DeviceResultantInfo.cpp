@@ -1,4 +1,41 @@
 #include "pch.h"
 #include "DeviceResultantInfo.h"
+#include <stdexcept>
 
-// DeviceResultantInfo contains device information including USB device class
\ No newline at end of file
+// DeviceResultantInfo contains device information including USB device class
+
+DeviceResultantInfo::DeviceResultantInfo(const allocator_type& allocator)
+	: blob_(allocator)
+{
+}
+
+// Assignment keeps the target's allocator (polymorphic_allocator never propagates); copying
+// into an empty record sizes the blob to fit, so it takes one allocation from allocator
+DeviceResultantInfo::DeviceResultantInfo(const DeviceResultantInfo& other, const allocator_type& allocator)
+	: DeviceResultantInfo(allocator)
+{
+	*this = other;
+}
+
+DeviceResultantInfo::DeviceResultantInfo(DeviceResultantInfo&& other, const allocator_type& allocator)
+	: DeviceResultantInfo(allocator)
+{
+	*this = std::move(other);
+}
+
+void DeviceResultantInfo::Set(Field field, std::wstring_view value)
+{
+	const size_t begin = field == 0 ? 0 : ends_[field - 1];
+	const size_t length = ends_[field] - begin;
+	if (blob_.size() - length + value.size() > MaxStringLength)
+	{
+		throw std::length_error("DeviceResultantInfo: string fields exceed MaxStringLength");
+	}
+
+	// replace() copes with value viewing blob_ itself
+	blob_.replace(begin, length, value.data(), value.size());
+	for (size_t i = field; i < FieldCount; ++i)
+	{
+		ends_[i] = static_cast<uint16_t>(ends_[i] - length + value.size());
+	}
+}
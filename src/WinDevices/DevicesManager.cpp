@@ -2,51 +2,174 @@
 #include "DeviceResultantInfo.h"
 #include "DevInfoData.h"
 #include "DevicesManager.h"
+#include "IUsbBackend.h"
+#include "UsbBackend.h"
+#include "AllocationProfiler.h"
 #include "DeviceProperty.h"
 #include "DeviceInfo.h"
+#include "DeviceCorrelator.h"
 #include "DeviceEnumerator.h"
-#include "DeviceCommunication.h"
+#include "HexFormat.h"
 #include "UsbHub.h"
-#include "UsbHostController.h"
+#include "HubHealthTracker.h"
+#include "DeviceChangeJournal.h"
+#include "DeviceEventRing.h"
+#include "SharedInventory.h"
+#include "UsbLocation.h"
+#include "UsbTopology.h"
 #include "UtilConvert.h"
 #include "UsbVendorList.h"
 #include "UsbDeviceClassInfo.h"
 #include <spdlog/spdlog.h>
 #include <algorithm>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 
 namespace KDM
 {
 
 namespace
 {
-	// Helper to format GUID as string for logging
-	std::wstring FormatGuid(const GUID& guid)
+	const char* SkipReasonToString(SkipReason reason) noexcept
 	{
-		wchar_t buffer[40]{};
-		StringFromGUID2(guid, buffer, 40);
-		return buffer;
+		switch (reason)
+		{
+		case SkipReason::TimedOut: return "deadline exceeded";
+		case SkipReason::Cancelled: return "cancelled";
+		case SkipReason::HubFailed: return "hub failed";
+		case SkipReason::CircuitOpen: return "circuit open";
+		default: return "unknown";
+		}
 	}
 
-	// Helper to build VID/PID search pattern
-	std::wstring BuildVidPidPattern(USHORT vendorId, USHORT productId)
+	// Rejects hub data that cannot describe a real hub: every port 1..N must be
+	// reported exactly once, under its own connection index
+	void CheckHubConsistency(const UsbHub& usbHub)
 	{
-		wchar_t buffer[32]{};
-		swprintf_s(buffer, L"VID_%04X&PID_%04X", vendorId, productId);
-		return buffer;
+		const auto& connections = usbHub.GetPortConnectionInfo();
+		bool consistent = connections.size() == usbHub.GetNumberOfPorts();
+
+		for (auto it = connections.begin(); consistent && it != connections.end(); ++it)
+		{
+			const auto& [portNumber, connectionInfo] = *it;
+			consistent = portNumber >= 1 && portNumber <= usbHub.GetNumberOfPorts() &&
+				connectionInfo._connectionIndex == portNumber;
+		}
+
+		if (!consistent)
+		{
+			throw DeviceIoException("Hub reported inconsistent port connection information",
+				ERROR_INVALID_DATA);
+		}
 	}
 
-	// Case-insensitive wstring search
-	bool ContainsIgnoreCase(const std::wstring& haystack, const std::wstring& needle)
+	// Tracks the deadline and cancellation of one EnumerateUsbDevices call
+	class TraversalBudget
 	{
-		if (needle.empty()) return true;
-		if (haystack.empty()) return false;
+	public:
+		TraversalBudget(const EnumerationOptions& options, EnumerationStatus& status) noexcept
+			: _options{ options }, _status{ status }
+		{
+		}
+
+		// Returns the reason to stop visiting hubs and ports, if any. With a lead time,
+		// a deadline that would pass before then already counts as exceeded.
+		[[nodiscard]] std::optional<SkipReason> Check(std::chrono::milliseconds lead = {}) noexcept
+		{
+			if (_options.cancellation.IsCancellationRequested())
+			{
+				_status.cancelled = true;
+				return SkipReason::Cancelled;
+			}
+			if (_options.deadline && std::chrono::steady_clock::now() + lead >= *_options.deadline)
+			{
+				_status.timedOut = true;
+				return SkipReason::TimedOut;
+			}
+			return std::nullopt;
+		}
+
+		void Skip(const std::wstring& hubPath, ULONG portNumber, SkipReason reason)
+		{
+			spdlog::warn("Skipping hub {} port {}: {}", UtilConvert::WStringToUTF8(hubPath), portNumber,
+				SkipReasonToString(reason));
+			_status.skipped.push_back(SkippedNode{ hubPath, portNumber, reason });
+		}
+
+		[[nodiscard]] const EnumerationOptions& Options() const noexcept { return _options; }
+
+	private:
+		const EnumerationOptions& _options;
+		EnumerationStatus& _status;
+	};
+
+	// Reads the properties EnumerateByDeviceClass(es) reports for one device of a setup class,
+	// with its string blob allocated from arena; nullopt if the device could not be read
+	std::optional<DeviceResultantInfo> ReadClassDevice(HDEVINFO devInfoSet, const SP_DEVINFO_DATA& devInfoData,
+		const GUID& deviceClassGuid, std::pmr::memory_resource* arena)
+	{
+		try
+		{
+			DeviceProperties properties = DeviceProperty(devInfoSet, devInfoData).GetProperties(
+				DevicePropertyMask::Description | DevicePropertyMask::FriendlyName |
+				DevicePropertyMask::Manufacturer | DevicePropertyMask::HardwareId);
+			DeviceResultantInfo resultInfo;     // grown on the heap, copied into arena once complete
+
+			// Retrieve device properties
+			if (properties.Has(DevicePropertyMask::Description))
+			{
+				spdlog::debug("  Description: {}", UtilConvert::WStringToUTF8(properties.description));
+				resultInfo.SetDescription(properties.description);
+			}
+
+			if (properties.Has(DevicePropertyMask::FriendlyName))
+			{
+				spdlog::debug("  FriendlyName: {}", UtilConvert::WStringToUTF8(properties.friendlyName));
+				resultInfo.SetFriendlyName(properties.friendlyName);
+			}
+
+			if (properties.Has(DevicePropertyMask::Manufacturer))
+			{
+				spdlog::debug("  Manufacturer: {}", UtilConvert::WStringToUTF8(properties.manufacturer));
+				resultInfo.SetManufacturer(properties.manufacturer);
+			}
+
+			if (properties.Has(DevicePropertyMask::HardwareId))
+			{
+				spdlog::debug("  HardwareID: {}", UtilConvert::WStringToUTF8(properties.hardwareId));
+				resultInfo.SetDeviceId(properties.hardwareId);
+			}
+
+			// Try to get USB device path
+			DeviceInfo deviceInfo{ devInfoSet, devInfoData };
+			try
+			{
+				deviceInfo.PopulateUsbInfo();
+				resultInfo.SetDevicePath(deviceInfo.GetDevicePath());
+				resultInfo.SetIsUsbDevice(true);
+				spdlog::debug("  DevicePath: {}", UtilConvert::WStringToUTF8(deviceInfo.GetDevicePath()));
+			}
+			catch (const std::exception&)
+			{
+				resultInfo.SetIsUsbDevice(false);
+				spdlog::debug("  Not a USB device");
+			}
 
-		std::wstring haystackUpper = haystack;
-		std::wstring needleUpper = needle;
-		std::transform(haystackUpper.begin(), haystackUpper.end(), haystackUpper.begin(), ::towupper);
-		std::transform(needleUpper.begin(), needleUpper.end(), needleUpper.begin(), ::towupper);
+			resultInfo.SetSetupClassGuid(deviceClassGuid);
+			resultInfo.SetIsConnected(true);
 
-		return haystackUpper.find(needleUpper) != std::wstring::npos;
+			spdlog::debug("  Device added");
+			return DeviceResultantInfo{ resultInfo, arena };
+		}
+		catch (const std::exception& e)
+		{
+			spdlog::warn("  Failed to process device: {}", e.what());
+			return std::nullopt;
+		}
 	}
 }
 
@@ -54,54 +177,288 @@ namespace
 class DevicesManager::Impl
 {
 public:
-	Impl() = default;
+	explicit Impl(std::unique_ptr<IUsbBackend> backend)
+		: _backend{ std::move(backend) },
+		  _hubHealth{ std::make_shared<HubHealthTracker>() },
+		  _snapshot{ std::make_shared<const DeviceSnapshot>() },
+		  _journal{ std::make_shared<DeviceChangeJournal>() }
+	{
+		THROW_HR_IF_NULL_MSG(E_INVALIDARG, _backend, "DevicesManager: backend must not be null");
+	}
+
 	~Impl() = default;
 
+	// Non-copyable, non-movable (owns the writer mutex; DevicesManager moves the pointer)
 	Impl(const Impl&) = delete;
 	Impl& operator=(const Impl&) = delete;
-	Impl(Impl&&) noexcept = default;
-	Impl& operator=(Impl&&) noexcept = default;
+	Impl(Impl&&) = delete;
+	Impl& operator=(Impl&&) = delete;
 
-	void EnumerateUsbDevices();
+	EnumerationStatus EnumerateUsbDevices(const EnumerationOptions& options);
+	EnumerationStatus ScanUsbDevices(const EnumerationOptions& options);
 	void EnumerateByDeviceClass(const GUID& deviceClassGuid);
+	void EnumerateByDeviceClasses(const std::vector<GUID>& deviceClassGuids);
 
 	void AddDeviceInfo(DeviceResultantInfo deviceResultantInfo)
 	{
-		_devicesList.push_back(std::move(deviceResultantInfo));
-		spdlog::trace("AddDeviceInfo: Device added (total: {})", _devicesList.size());
+		std::lock_guard<std::mutex> lock(_writerMutex);
+
+		// Copy-on-write: published snapshots are never modified
+		std::vector<DeviceResultantInfo> devices = LoadSnapshot()->devices;
+		devices.push_back(std::move(deviceResultantInfo));
+		Publish(std::move(devices));
+		spdlog::trace("AddDeviceInfo: Device added (total: {})", LoadSnapshot()->devices.size());
+	}
+
+	[[nodiscard]] DeviceSnapshotPtr GetSnapshot() const noexcept
+	{
+		return LoadSnapshot();
 	}
 
-	[[nodiscard]] const std::vector<DeviceResultantInfo>& GetDevices() const noexcept
+	[[nodiscard]] std::unique_ptr<DeviceEventSubscriber> SubscribeEvents() const
 	{
-		return _devicesList;
+		return _events.Subscribe();
+	}
+
+	[[nodiscard]] DeviceChangeSet GetChangesSince(uint64_t sequence) const
+	{
+		return LoadJournal()->GetChangesSince(sequence);
+	}
+
+	void SetJournalPolicy(JournalPolicy policy)
+	{
+		auto journal = std::make_shared<DeviceChangeJournal>(std::move(policy));
+
+		std::lock_guard<std::mutex> lock(_writerMutex);
+		journal->Synchronize(*LoadSnapshot());
+		std::atomic_store_explicit(&_journal, std::move(journal), std::memory_order_release);
+		_journalBehind = false;
+	}
+
+	void EnableSharedInventory(const std::wstring& name, uint32_t capacity)
+	{
+		auto publisher = std::make_unique<SharedInventoryPublisher>(name, capacity);
+
+		std::lock_guard<std::mutex> lock(_writerMutex);
+		publisher->Publish(*LoadSnapshot());
+		_sharedInventory = std::move(publisher);
+	}
+
+	void DisableSharedInventory()
+	{
+		std::lock_guard<std::mutex> lock(_writerMutex);
+		_sharedInventory.reset();
 	}
 
 	[[nodiscard]] size_t GetDeviceCount() const noexcept
 	{
-		return _devicesList.size();
+		return LoadSnapshot()->devices.size();
 	}
 
+	// Journal and shared inventory failures are handled inside Publish; only running out
+	// of memory for the empty snapshot can still throw, and that terminates
 	void ClearDevices() noexcept
 	{
-		_devicesList.clear();
+		std::lock_guard<std::mutex> lock(_writerMutex);
+		Publish({});
+	}
+
+	void SetHubHealthPolicy(HubHealthPolicy policy)
+	{
+		auto tracker = std::make_shared<HubHealthTracker>(std::move(policy));
+
+		std::lock_guard<std::mutex> lock(_writerMutex);
+		std::atomic_store_explicit(&_hubHealth, std::move(tracker), std::memory_order_release);
+	}
+
+	[[nodiscard]] std::vector<HubHealthStats> GetHubHealth() const
+	{
+		return std::atomic_load_explicit(&_hubHealth, std::memory_order_acquire)->GetStats();
+	}
+
+	void ResetHubHealth()
+	{
+		std::atomic_load_explicit(&_hubHealth, std::memory_order_acquire)->Reset();
 	}
 
 private:
+	[[nodiscard]] DeviceSnapshotPtr LoadSnapshot() const noexcept
+	{
+		return std::atomic_load_explicit(&_snapshot, std::memory_order_acquire);
+	}
+
+	// Publishes a new immutable snapshot; caller holds _writerMutex. arena is the resource
+	// the strings of devices were allocated from, if not the default one.
+	void Publish(std::vector<DeviceResultantInfo> devices, UsbTopology topology = {},
+		std::shared_ptr<std::pmr::memory_resource> arena = {})
+	{
+		auto snapshot = std::make_shared<DeviceSnapshot>();
+		snapshot->arena = std::move(arena);
+		snapshot->version = ++_version;
+		snapshot->publishedAt = std::chrono::steady_clock::now();
+		snapshot->devices = std::move(devices);
+		snapshot->topology = std::move(topology);
+
+		DeviceSnapshotPtr previous = LoadSnapshot();
+		std::atomic_store_explicit(&_snapshot, DeviceSnapshotPtr{ snapshot }, std::memory_order_release);
+
+		// Subscribers poll the ring on their own threads; publishing never waits for them
+		std::vector<DeviceChange> changes = DiffSnapshots(*previous, *snapshot);
+		PublishChanges(_events, changes);
+		JournalChanges(*snapshot, std::move(changes));
+
+		if (_sharedInventory) {
+			_sharedInventory->Publish(*snapshot);
+		}
+	}
+
+	// A journal that failed to take the previous changes no longer matches the previous
+	// snapshot, so it is synchronized with the new one instead. The snapshot is published
+	// either way; a failing journal file does not fail the scan.
+	void JournalChanges(const DeviceSnapshot& snapshot, std::vector<DeviceChange> changes)
+	{
+		try
+		{
+			if (_journalBehind) {
+				LoadJournal()->Synchronize(snapshot);
+			}
+			else {
+				LoadJournal()->Append(std::move(changes));
+			}
+			_journalBehind = false;
+		}
+		catch (const DeviceIoException& ex)
+		{
+			spdlog::error("Journal not updated for snapshot {}: {}", snapshot.version, ex.what());
+			_journalBehind = true;
+		}
+	}
+
+	[[nodiscard]] std::shared_ptr<DeviceChangeJournal> LoadJournal() const noexcept
+	{
+		return std::atomic_load_explicit(&_journal, std::memory_order_acquire);
+	}
+
+	[[nodiscard]] std::optional<UsbHub> OpenHub(const std::wstring& hubName, TraversalBudget& budget);
+
 	void EnumeratePortsFromRootHub(const std::wstring& hubName,
-		const std::vector<DevInfoData>& allDevices,
-		HDEVINFO devInfoSet);
+		DeviceCorrelator& correlator, TraversalBudget& budget, std::pmr::memory_resource* arena,
+		std::vector<DeviceResultantInfo>& devices, UsbTopology& topology, uint32_t hubNode);
+
+	std::unique_ptr<IUsbBackend> _backend;
+
+	// Writers (enumerations, AddDeviceInfo, ClearDevices, policy changes) are serialized
+	// by _writerMutex. Readers only load _snapshot / _hubHealth atomically and never wait
+	// for a running enumeration.
+	std::mutex _writerMutex;
+	uint64_t _version = 0;
+	std::shared_ptr<HubHealthTracker> _hubHealth;
+	DeviceSnapshotPtr _snapshot;
+	DeviceEventRing _events;
+	std::shared_ptr<DeviceChangeJournal> _journal;
+	bool _journalBehind = false;        // the last journal write failed; guarded by _writerMutex
+	std::unique_ptr<SharedInventoryPublisher> _sharedInventory;    // optional, guarded by _writerMutex
+
+	// Single-flight USB scan: callers arriving while a scan runs wait for its result
+	struct InFlightScan
+	{
+		std::promise<EnumerationStatus> promise;
+		std::shared_future<EnumerationStatus> result{ promise.get_future().share() };
+	};
+
+	// Last completed USB scan, reused under EnumerationOptions::maxStaleness
+	struct CompletedScan
+	{
+		DeviceSnapshotPtr snapshot;
+		EnumerationStatus status;
+	};
 
-	std::vector<DeviceResultantInfo> _devicesList;
+	[[nodiscard]] std::optional<EnumerationStatus> RecentScan(std::chrono::milliseconds maxStaleness) const;
+	[[nodiscard]] static EnumerationStatus AwaitScan(const InFlightScan& scan, const EnumerationOptions& options);
+
+	mutable std::mutex _flightMutex;   // guards _inFlight and _lastScan
+	std::shared_ptr<InFlightScan> _inFlight;
+	CompletedScan _lastScan;
 };
 
+std::optional<UsbHub> DevicesManager::Impl::OpenHub(const std::wstring& hubName, TraversalBudget& budget)
+{
+	const uint32_t attempts = _hubHealth->BeginScan(hubName);
+	if (attempts == 0)
+	{
+		budget.Skip(hubName, 0, SkipReason::CircuitOpen);
+		return std::nullopt;
+	}
+
+	std::string lastError;
+	for (uint32_t attempt = 1; attempt <= attempts; ++attempt)
+	{
+		if (attempt > 1)
+		{
+			// A deadline or cancellation cutting the retries short is reported as such and
+			// not held against the hub: the remaining attempts might have succeeded
+			if (auto reason = budget.Check(_hubHealth->BackoffFor(attempt - 1)))
+			{
+				budget.Skip(hubName, 0, *reason);
+				return std::nullopt;
+			}
+
+			_hubHealth->WaitBeforeRetry(hubName, attempt - 1);
+		}
+
+		try
+		{
+			// A hub IOCTL still pending at the deadline is cancelled rather than waited for
+			std::unique_ptr<IDeviceCommunication> communication = _backend->OpenHub(hubName);
+			communication->SetIoLimits(budget.Options());
+
+			UsbHub usbHub(hubName, std::move(communication));
+			usbHub.PopulateInfo();
+			CheckHubConsistency(usbHub);
+
+			_hubHealth->RecordSuccess(hubName);
+			return usbHub;
+		}
+		catch (const std::exception& e)
+		{
+			lastError = e.what();
+			spdlog::warn("OpenHub: attempt {}/{} for hub {} failed: {}", attempt, attempts,
+				UtilConvert::WStringToUTF8(hubName), lastError);
+
+			// An IOCTL cancelled by the deadline or cancellation is not the hub's fault either
+			if (auto reason = budget.Check())
+			{
+				budget.Skip(hubName, 0, *reason);
+				return std::nullopt;
+			}
+		}
+	}
+
+	_hubHealth->RecordFailure(hubName, lastError);
+	budget.Skip(hubName, 0, SkipReason::HubFailed);
+	return std::nullopt;
+}
+
+// hubNode is the topology node of this hub; its ports and attached devices are added below it
 void DevicesManager::Impl::EnumeratePortsFromRootHub(const std::wstring& hubName,
-	const std::vector<DevInfoData>& allDevices,
-	HDEVINFO devInfoSet)
+	DeviceCorrelator& correlator, TraversalBudget& budget, std::pmr::memory_resource* arena,
+	std::vector<DeviceResultantInfo>& devices, UsbTopology& topology, uint32_t hubNode)
 {
+	if (auto reason = budget.Check())
+	{
+		budget.Skip(hubName, 0, *reason);
+		return;
+	}
+
 	spdlog::info("EnumeratePortsFromRootHub: Starting for hub: {}", UtilConvert::WStringToUTF8(hubName));
 
-	UsbHub usbHub(hubName);
-	usbHub.PopulateInfo();
+	AllocationPhaseScope traversalPhase{ AllocationPhase::Traversal };
+
+	std::optional<UsbHub> openedHub = OpenHub(hubName, budget);
+	if (!openedHub) {
+		return;
+	}
+	UsbHub& usbHub = *openedHub;
 
 	spdlog::debug("EnumeratePortsFromRootHub: Hub info populated");
 
@@ -112,18 +469,33 @@ void DevicesManager::Impl::EnumeratePortsFromRootHub(const std::wstring& hubName
 	std::map<size_t, USHORT> vendorIdMap;
 	std::map<size_t, USHORT> productIdMap;
 	std::map<size_t, GUID> setupClassGuidMap;
+	std::map<size_t, uint32_t> deviceNodeMap;
+	std::map<size_t, PortCorrelation> correlationMap;
 
 	// Process connected devices on each port
 	for (const auto& [portNumber, connectionInfo] : portConnectionInfo)
 	{
+		UsbTopologyNode portNode;
+		portNode.kind = UsbTopologyNodeKind::Port;
+		portNode.portNumber = static_cast<uint32_t>(portNumber);
+		portNode.parent = hubNode;
+		const uint32_t portIndex = topology.Add(std::move(portNode));
+
 		if (connectionInfo._connectionStatus == NoDeviceConnected) {
 			continue;
 		}
 
+		// Ports left unvisited when the budget runs out are reported instead of queried
+		if (auto reason = budget.Check())
+		{
+			budget.Skip(hubName, static_cast<ULONG>(portNumber), *reason);
+			continue;
+		}
+
 		const auto& descriptor = connectionInfo._deviceDescriptor;
 		spdlog::info("Port {}: Connected device found", portNumber);
-		spdlog::info("  idProduct: {}", UtilConvert::WStringToUTF8(UtilConvert::GetHexIdAsString(descriptor.idProduct, 4)));
-		spdlog::info("  idVendor: {}", UtilConvert::WStringToUTF8(UtilConvert::GetHexIdAsString(descriptor.idVendor, 4)));
+		spdlog::info("  idProduct: {}", HexFormat::Id<char>(descriptor.idProduct, 4).view());
+		spdlog::info("  idVendor: {}", HexFormat::Id<char>(descriptor.idVendor, 4).view());
 		spdlog::info("  bDeviceClass: {} (0x{:02X})",
 			UtilConvert::WStringToUTF8(UtilConvert::GetUsbClassNameByDescId(descriptor.bDeviceClass)),
 			descriptor.bDeviceClass);
@@ -135,72 +507,63 @@ void DevicesManager::Impl::EnumeratePortsFromRootHub(const std::wstring& hubName
 		vendorIdMap.try_emplace(portNumber, descriptor.idVendor);
 		productIdMap.try_emplace(portNumber, descriptor.idProduct);
 
-		std::wstring vidPidPattern = BuildVidPidPattern(descriptor.idVendor, descriptor.idProduct);
-		spdlog::info("  Searching for pattern: {}", UtilConvert::WStringToUTF8(vidPidPattern));
+		// Join the port against the SetupAPI nodes indexed once for the whole scan
+		AllocationPhaseScope correlationPhase{ AllocationPhase::Correlation };
+		const auto& descriptions = usbHub.GetUsbDeviceDescriptionInfo();
+		const auto descriptionIt = descriptions.find(portNumber);
+		const PortCorrelation correlation = correlator.Join(connectionInfo._driverKeyName,
+			descriptor.idVendor, descriptor.idProduct, connectionInfo._deviceIsHub,
+			descriptionIt != descriptions.end() ? descriptionIt->second->GetProduct() : std::wstring_view{});
 
-		// Find matching devices and collect their GUIDs
-		std::vector<GUID> matchedGuids;
-		std::optional<DevInfoData> usbBusLayerDevice;
-
-		for (const auto& device : allDevices)
+		if (correlation.functionNode)
 		{
-			std::wstring hardwareId = device.GetHardwareId();
-			if (hardwareId.empty() || hardwareId.find(vidPidPattern) == std::wstring::npos) {
-				continue;
-			}
-
-			GUID classGuid = device.GetClassGuid();
-			spdlog::info("  MATCHED: HwID={}, ClassGuid={}",
-				UtilConvert::WStringToUTF8(hardwareId),
-				UtilConvert::WStringToUTF8(FormatGuid(classGuid)));
-
-			matchedGuids.push_back(classGuid);
-
-			// Check for USB bus layer device (used for hub recursion)
-			if (!device.GetDriverKeyName().empty() &&
-				connectionInfo._driverKeyName == device.GetDriverKeyName())
-			{
-				spdlog::info("    (USB Bus layer device)");
-				usbBusLayerDevice = device;
-			}
+			const GUID classGuid = correlation.functionNode->GetClassGuid();
+			setupClassGuidMap.emplace(portNumber, classGuid);
+			spdlog::info("  MATCHED ({}): HwID={}, ClassGuid={}", CorrelationRuleToString(correlation.rule),
+				UtilConvert::WStringToUTF8(correlation.functionNode->GetHardwareId()),
+				HexFormat::Guid<char>(classGuid).view());
 		}
-
-		// Select best GUID (prefer non-USB-Bus-Device GUIDs)
-		if (!matchedGuids.empty())
+		else
 		{
-			GUID bestGuid = matchedGuids.front();
-			if (matchedGuids.size() > 1)
-			{
-				for (const auto& guid : matchedGuids)
-				{
-					if (!IsEqualGUID(guid, GUID_DEVINTERFACE_USB_DEVICE)) {
-						bestGuid = guid;
-						break;
-					}
-				}
-			}
-			setupClassGuidMap.emplace(portNumber, bestGuid);
-			spdlog::info("  Selected ClassGuid: {} (from {} candidate(s))",
-				UtilConvert::WStringToUTF8(FormatGuid(bestGuid)), matchedGuids.size());
+			spdlog::warn("  No devices found matching VID_{:04X}&PID_{:04X}", descriptor.idVendor, descriptor.idProduct);
 		}
-		else
+		correlationMap.emplace(portNumber, correlation);
+
+		// Topology node of the hub or device on this port, created before descending into a hub
+		UsbTopologyNode attachedNode;
+		attachedNode.kind = connectionInfo._deviceIsHub ? UsbTopologyNodeKind::Hub : UsbTopologyNodeKind::Device;
+		attachedNode.speed = connectionInfo._speed;
+		attachedNode.deviceClass = descriptor.bDeviceClass;
+		attachedNode.vendorId = descriptor.idVendor;
+		attachedNode.productId = descriptor.idProduct;
+		attachedNode.deviceAddress = connectionInfo._deviceAddress;
+		attachedNode.openPipes = connectionInfo._numberOfOpenPipes;
+		attachedNode.correlation = static_cast<uint8_t>(correlation.rule);
+		attachedNode.portNumber = static_cast<uint32_t>(portNumber);
+		attachedNode.parent = portIndex;
+
+		std::wstring hubPath;
+		if (connectionInfo._deviceIsHub && correlation.busNode)
 		{
-			spdlog::warn("  No devices found matching pattern: {}", UtilConvert::WStringToUTF8(vidPidPattern));
+			hubPath = _backend->GetHubDevicePath(*correlation.busNode);
+			attachedNode.path = hubPath;
 		}
+		const uint32_t attachedIndex = topology.Add(std::move(attachedNode));
+		deviceNodeMap.emplace(portNumber, attachedIndex);
 
 		// Handle hub recursion or config descriptor
-		if (usbBusLayerDevice.has_value())
+		if (correlation.busNode)
 		{
 			if (connectionInfo._deviceIsHub)
 			{
 				spdlog::info("  Recursively enumerating USB hub");
-				DeviceInfo deviceInfo{ devInfoSet, usbBusLayerDevice->GetDevInfoData() };
-				deviceInfo.PopulateUsbInfo();
-				EnumeratePortsFromRootHub(deviceInfo.GetDevicePath(), allDevices, devInfoSet);
+				AllocationPhaseScope hubPhase{ AllocationPhase::Traversal };
+				EnumeratePortsFromRootHub(hubPath, correlator, budget, arena, devices, topology, attachedIndex);
 			}
 			else
 			{
 				spdlog::debug("  Filling config descriptor for non-hub device");
+				AllocationPhaseScope descriptorPhase{ AllocationPhase::DescriptorFetch };
 				auto& mutableConnectionInfo = const_cast<HubConnectionInfo&>(connectionInfo);
 				usbHub.FillConfigDescriptor(
 					&mutableConnectionInfo._deviceDescriptor,
@@ -210,6 +573,7 @@ void DevicesManager::Impl::EnumeratePortsFromRootHub(const std::wstring& hubName
 	}
 
 	// Build DeviceResultantInfo from USB device descriptions
+	AllocationPhaseScope correlationPhase{ AllocationPhase::Correlation };
 	spdlog::info("EnumeratePortsFromRootHub: Processing {} device description(s)",
 		usbHub.GetUsbDeviceDescriptionInfo().size());
 
@@ -220,61 +584,28 @@ void DevicesManager::Impl::EnumeratePortsFromRootHub(const std::wstring& hubName
 		spdlog::info("    Product: {}", UtilConvert::WStringToUTF8(deviceDescInfo->GetProduct()));
 		spdlog::info("    SerialNumber: {}", UtilConvert::WStringToUTF8(deviceDescInfo->GetSerialNumber()));
 
-		DeviceResultantInfo resultInfo;
+		DeviceResultantInfo resultInfo;     // grown on the heap, copied into arena once complete
 		resultInfo.SetManufacturer(deviceDescInfo->GetManufacturer());
 		resultInfo.SetProduct(deviceDescInfo->GetProduct());
 
-		// Fallback: Use registry DeviceDesc if USB string descriptors are empty
+		// Fallback: Use registry DeviceDesc of the port's nodes if USB string descriptors are empty
 		if (resultInfo.GetManufacturer().empty() && resultInfo.GetProduct().empty())
 		{
-			auto vendorIt = vendorIdMap.find(portNum);
-			auto productIt = productIdMap.find(portNum);
-
-			if (vendorIt != vendorIdMap.end() && productIt != productIdMap.end())
+			if (auto it = correlationMap.find(portNum); it != correlationMap.end())
 			{
-				std::wstring pattern = BuildVidPidPattern(vendorIt->second, productIt->second);
-
-				for (const auto& device : allDevices)
+				for (const DevInfoData* node : { it->second.busNode, it->second.functionNode })
 				{
-					if (ContainsIgnoreCase(device.GetHardwareId(), pattern))
+					const std::wstring_view deviceDesc = node ? node->GetDeviceDescription() : std::wstring_view{};
+					if (!deviceDesc.empty())
 					{
-						std::wstring deviceDesc = device.GetDeviceDescription();
-						if (!deviceDesc.empty())
-						{
-							resultInfo.SetProduct(deviceDesc);
-							spdlog::info("    Registry fallback: Using DeviceDesc '{}'",
-								UtilConvert::WStringToUTF8(deviceDesc));
-							break;
-						}
+						spdlog::info("    Registry fallback: Using DeviceDesc '{}'", UtilConvert::WStringToUTF8(deviceDesc));
+						resultInfo.SetProduct(deviceDesc);
+						break;
 					}
 				}
 			}
 		}
 
-		// Try to find functional device GUID by product name match
-		std::wstring productName = deviceDescInfo->GetProduct();
-		if (productName.empty() && !resultInfo.GetProduct().empty()) {
-			productName = resultInfo.GetProduct();
-		}
-
-		if (!productName.empty())
-		{
-			spdlog::debug("  Searching for functional device: {}", UtilConvert::WStringToUTF8(productName));
-			for (const auto& device : allDevices)
-			{
-				std::wstring deviceDesc = device.GetDeviceDescription();
-				if (!deviceDesc.empty() && deviceDesc.find(productName) != std::wstring::npos)
-				{
-					GUID functionalGuid = device.GetClassGuid();
-					spdlog::info("  Found functional GUID: {} (Desc: {})",
-						UtilConvert::WStringToUTF8(FormatGuid(functionalGuid)),
-						UtilConvert::WStringToUTF8(deviceDesc));
-					setupClassGuidMap.insert_or_assign(portNum, functionalGuid);
-					break;
-				}
-			}
-		}
-
 		resultInfo.SetSerialNumber(deviceDescInfo->GetSerialNumber());
 
 		// Set interface class
@@ -328,66 +659,213 @@ void DevicesManager::Impl::EnumeratePortsFromRootHub(const std::wstring& hubName
 		if (auto it = setupClassGuidMap.find(portNum); it != setupClassGuidMap.end())
 		{
 			resultInfo.SetSetupClassGuid(it->second);
-			spdlog::info("    SetupClassGuid: {}", UtilConvert::WStringToUTF8(FormatGuid(it->second)));
+			spdlog::info("    SetupClassGuid: {}", HexFormat::Guid<char>(it->second).view());
 		}
 
 		resultInfo.SetIsConnected(true);
 		resultInfo.SetIsUsbDevice(true);
 
-		AddDeviceInfo(std::move(resultInfo));
+		if (auto it = deviceNodeMap.find(portNum); it != deviceNodeMap.end())
+		{
+			resultInfo.SetLocationKey(topology[it->second].locationKey);
+			topology.SetDeviceIndex(it->second, static_cast<uint32_t>(devices.size()));
+			spdlog::debug("    Location: {}", UtilConvert::WStringToUTF8(UsbLocation::Format(resultInfo.GetLocationKey())));
+		}
+		devices.emplace_back(resultInfo, arena);
 		spdlog::debug("  DeviceResultantInfo added");
 	}
 }
 
-void DevicesManager::Impl::EnumerateUsbDevices()
+std::optional<EnumerationStatus> DevicesManager::Impl::RecentScan(std::chrono::milliseconds maxStaleness) const
+{
+	std::lock_guard<std::mutex> lock(_flightMutex);
+
+	// Only valid while the scan's snapshot is still the published one
+	if (!_lastScan.snapshot || _lastScan.snapshot != LoadSnapshot()) {
+		return std::nullopt;
+	}
+	if (std::chrono::steady_clock::now() - _lastScan.snapshot->publishedAt > maxStaleness) {
+		return std::nullopt;
+	}
+
+	EnumerationStatus status = _lastScan.status;
+	status.elapsed = std::chrono::milliseconds{ 0 };
+	status.servedFromCache = true;
+	return status;
+}
+
+EnumerationStatus DevicesManager::Impl::AwaitScan(const InFlightScan& scan, const EnumerationOptions& options)
 {
-	_devicesList.clear();
+	// Poll so the joining caller's own deadline and cancellation are honoured
+	constexpr std::chrono::milliseconds pollInterval{ 10 };
+	const auto startTime = std::chrono::steady_clock::now();
+
+	EnumerationStatus status;
+	status.coalesced = true;
+
+	while (true)
+	{
+		auto waitUntil = std::chrono::steady_clock::now() + pollInterval;
+		if (options.deadline && *options.deadline < waitUntil) {
+			waitUntil = *options.deadline;
+		}
+
+		if (scan.result.wait_until(waitUntil) == std::future_status::ready)
+		{
+			status = scan.result.get();     // rethrows if the scan failed
+			status.coalesced = true;
+			return status;
+		}
+		if (options.cancellation.IsCancellationRequested())
+		{
+			status.cancelled = true;
+			break;
+		}
+		if (options.deadline && std::chrono::steady_clock::now() >= *options.deadline)
+		{
+			status.timedOut = true;
+			break;
+		}
+	}
+
+	status.stoppedWaiting = true;
+	status.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - startTime);
+	spdlog::warn("EnumerateUsbDevices: stopped waiting for the running scan ({})",
+		status.cancelled ? "cancelled" : "deadline exceeded");
+	return status;
+}
+
+EnumerationStatus DevicesManager::Impl::EnumerateUsbDevices(const EnumerationOptions& options)
+{
+	if (options.maxStaleness)
+	{
+		if (auto cached = RecentScan(*options.maxStaleness))
+		{
+			spdlog::debug("EnumerateUsbDevices: serving scan published within {} ms", options.maxStaleness->count());
+			return *cached;
+		}
+	}
+
+	std::shared_ptr<InFlightScan> scan;
+	bool leader = false;
+	{
+		std::lock_guard<std::mutex> lock(_flightMutex);
+		if (!_inFlight)
+		{
+			_inFlight = std::make_shared<InFlightScan>();
+			leader = true;
+		}
+		scan = _inFlight;
+	}
+
+	if (!leader)
+	{
+		spdlog::info("EnumerateUsbDevices: joining the scan already in progress");
+		return AwaitScan(*scan, options);
+	}
+
+	try
+	{
+		EnumerationStatus status = ScanUsbDevices(options);
+		{
+			std::lock_guard<std::mutex> lock(_flightMutex);
+			_inFlight.reset();
+		}
+		scan->promise.set_value(status);
+		return status;
+	}
+	catch (...)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_flightMutex);
+			_inFlight.reset();
+		}
+		scan->promise.set_exception(std::current_exception());
+		throw;
+	}
+}
+
+EnumerationStatus DevicesManager::Impl::ScanUsbDevices(const EnumerationOptions& options)
+{
+	std::lock_guard<std::mutex> lock(_writerMutex);
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Strings of the scan's results; the published snapshot takes ownership. Declared before
+	// devices so that it outlives them if the scan throws.
+	auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+	std::vector<DeviceResultantInfo> devices;
+	EnumerationStatus status;
+	TraversalBudget budget{ options, status };
 
 	spdlog::info("========================================");
 	spdlog::info("EnumerateUsbDevices: Starting USB device enumeration");
 	spdlog::info("========================================");
 
-	DeviceEnumerator allDevicesEnumerator(
-		GUID_DEVINTERFACE_USB_DEVICE,
-		DIGCF_ALLCLASSES | DIGCF_DEVICEINTERFACE | DIGCF_PRESENT);
+	std::vector<DevInfoData> allUsbDevices;
+	std::vector<std::wstring> rootHubPaths;
+	{
+		AllocationPhaseScope traversalPhase{ AllocationPhase::Traversal };
 
-	auto allUsbDevices = allDevicesEnumerator.GetDeviceInstances();
-	spdlog::info("EnumerateUsbDevices: Found {} USB devices", allUsbDevices.size());
+		allUsbDevices = _backend->GetDeviceInstances();
+		spdlog::info("EnumerateUsbDevices: Found {} USB devices", allUsbDevices.size());
 
-	DeviceEnumerator controllerEnumerator(
-		GUID_CLASS_USB_HOST_CONTROLLER,
-		DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+		rootHubPaths = _backend->GetRootHubPaths();
+		spdlog::info("EnumerateUsbDevices: Found {} root hub(s)", rootHubPaths.size());
+	}
 
-	auto controllers = controllerEnumerator.GetDeviceInstances();
-	spdlog::info("EnumerateUsbDevices: Found {} USB host controller(s)", controllers.size());
+	// Ports are joined against these indexes as the traversal reaches them
+	DeviceCorrelator correlator{ allUsbDevices };
 
-	for (auto& controller : controllers)
+	// The backend reaches each host controller through its root hub
+	UsbTopology topology;
+	for (const auto& rootHubPath : rootHubPaths)
 	{
-		spdlog::info("Processing USB host controller");
+		spdlog::info("Processing root hub: {}", UtilConvert::WStringToUTF8(rootHubPath));
 
-		DeviceInfo deviceInfo{ controllerEnumerator.GetDevInfoSet(), controller.GetDevInfoData() };
-		deviceInfo.PopulateUsbControllerInfo();
+		UsbTopologyNode controller;
+		controller.kind = UsbTopologyNodeKind::Controller;
+		UsbTopologyNode rootHub;
+		rootHub.kind = UsbTopologyNodeKind::Hub;
+		rootHub.parent = topology.Add(std::move(controller));
+		rootHub.path = rootHubPath;
+		const uint32_t rootHubNode = topology.Add(std::move(rootHub));
 
-		std::wstring devicePath = deviceInfo.GetDevicePath();
-		DeviceCommunication deviceCommunication(devicePath);
-		UsbHostController hostController(devicePath, deviceCommunication);
+		EnumeratePortsFromRootHub(rootHubPath, correlator, budget, arena.get(), devices, topology, rootHubNode);
+	}
 
-		hostController.PopulateInfo();
+	const CorrelationStats& correlation = correlator.GetStats();
+	status.correlation = correlation;
+	spdlog::info("EnumerateUsbDevices: Correlated {} port(s) against {} node(s) - driver key: {}, VID/PID: {}, "
+		"container: {}, product name: {}, unmatched: {}", correlation.ports, correlation.indexedNodes,
+		correlation.byDriverKey, correlation.byVidPid, correlation.byContainerId, correlation.byProductName,
+		correlation.unmatched);
 
-		std::wstring rootHubPath = L"\\\\.\\" + hostController.GetRootHubName();
-		spdlog::info("Root hub device: {}", UtilConvert::WStringToUTF8(rootHubPath));
+	const size_t deviceCount = devices.size();
+	Publish(std::move(devices), std::move(topology), std::move(arena));
 
-		EnumeratePortsFromRootHub(rootHubPath, allUsbDevices, allDevicesEnumerator.GetDevInfoSet());
-	}
+	status.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::steady_clock::now() - startTime);
 
 	spdlog::info("========================================");
-	spdlog::info("EnumerateUsbDevices: Complete - total devices: {}", _devicesList.size());
+	spdlog::info("EnumerateUsbDevices: Complete - total devices: {}, skipped: {}, elapsed: {} ms",
+		deviceCount, status.skipped.size(), status.elapsed.count());
 	spdlog::info("========================================");
+
+	{
+		std::lock_guard<std::mutex> flightLock(_flightMutex);
+		_lastScan = CompletedScan{ LoadSnapshot(), status };
+	}
+
+	return status;
 }
 
 void DevicesManager::Impl::EnumerateByDeviceClass(const GUID& deviceClassGuid)
 {
-	_devicesList.clear();
+	std::lock_guard<std::mutex> lock(_writerMutex);
+	auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+	std::vector<DeviceResultantInfo> collected;
 
 	spdlog::info("========================================");
 	spdlog::info("EnumerateByDeviceClass: Starting enumeration");
@@ -396,82 +874,110 @@ void DevicesManager::Impl::EnumerateByDeviceClass(const GUID& deviceClassGuid)
 	try
 	{
 		DeviceEnumerator enumerator(deviceClassGuid, DIGCF_PRESENT);
-		auto devices = enumerator.GetDeviceInstances();
-		spdlog::info("EnumerateByDeviceClass: Found {} device(s)", devices.size());
+		size_t found = 0;
 
-		for (auto& devInfoData : devices)
-		{
-			try
+		// The set holds only this class; properties are read once, by ReadClassDevice
+		enumerator.ForEachDevice([&](const SP_DEVINFO_DATA& devInfoData) {
+			++found;
+			if (auto resultInfo = ReadClassDevice(enumerator.GetDevInfoSet(), devInfoData, deviceClassGuid, arena.get()))
 			{
-				DeviceProperty propReader(enumerator.GetDevInfoSet(), devInfoData.GetDevInfoData());
-				DeviceResultantInfo resultInfo;
+				collected.push_back(std::move(*resultInfo));
+			}
+		});
+		spdlog::info("EnumerateByDeviceClass: Found {} device(s)", found);
 
-				// Retrieve device properties
-				if (std::wstring desc; propReader.GetStringProperty(SPDRP_DEVICEDESC, desc))
-				{
-					resultInfo.SetDescription(desc);
-					spdlog::debug("  Description: {}", UtilConvert::WStringToUTF8(desc));
-				}
+		spdlog::info("========================================");
+		spdlog::info("EnumerateByDeviceClass: Complete - total: {}", collected.size());
+		Publish(std::move(collected), {}, std::move(arena));
+		spdlog::info("========================================");
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error("EnumerateByDeviceClass: Exception: {}", e.what());
+		throw;
+	}
+}
 
-				if (std::wstring friendlyName; propReader.GetStringProperty(SPDRP_FRIENDLYNAME, friendlyName))
-				{
-					resultInfo.SetFriendlyName(friendlyName);
-					spdlog::debug("  FriendlyName: {}", UtilConvert::WStringToUTF8(friendlyName));
-				}
+void DevicesManager::Impl::EnumerateByDeviceClasses(const std::vector<GUID>& deviceClassGuids)
+{
+	std::lock_guard<std::mutex> lock(_writerMutex);
 
-				if (std::wstring mfg; propReader.GetStringProperty(SPDRP_MFG, mfg))
-				{
-					resultInfo.SetManufacturer(mfg);
-					spdlog::debug("  Manufacturer: {}", UtilConvert::WStringToUTF8(mfg));
-				}
+	spdlog::info("========================================");
+	spdlog::info("EnumerateByDeviceClasses: Starting enumeration of {} class(es)", deviceClassGuids.size());
+	spdlog::info("========================================");
 
-				if (std::wstring hwId; propReader.GetStringProperty(SPDRP_HARDWAREID, hwId))
-				{
-					resultInfo.SetDeviceId(hwId);
-					spdlog::debug("  HardwareID: {}", UtilConvert::WStringToUTF8(hwId));
-				}
+	// One bucket per distinct requested class, in request order
+	std::vector<GUID> classes;
+	for (const GUID& guid : deviceClassGuids)
+	{
+		if (std::none_of(classes.begin(), classes.end(), [&](const GUID& known) { return IsEqualGUID(known, guid); }))
+		{
+			classes.push_back(guid);
+		}
+	}
+	auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+	std::vector<std::vector<DeviceResultantInfo>> buckets(classes.size());
 
-				// Try to get USB device path
-				DeviceInfo deviceInfo{ enumerator.GetDevInfoSet(), devInfoData.GetDevInfoData() };
-				try
-				{
-					deviceInfo.PopulateUsbInfo();
-					resultInfo.SetDevicePath(deviceInfo.GetDevicePath());
-					resultInfo.SetIsUsbDevice(true);
-					spdlog::debug("  DevicePath: {}", UtilConvert::WStringToUTF8(deviceInfo.GetDevicePath()));
-				}
-				catch (const std::exception&)
+	try
+	{
+		if (!classes.empty())
+		{
+			DeviceEnumerator enumerator(GUID{}, DIGCF_ALLCLASSES | DIGCF_PRESENT);     // GUID ignored with DIGCF_ALLCLASSES
+			size_t found = 0;
+
+			// ClassGuid comes with every SetupDiEnumDeviceInfo result, so devices of other
+			// classes are skipped without a single property read
+			enumerator.ForEachDevice([&](const SP_DEVINFO_DATA& devInfoData) {
+				++found;
+				for (size_t bucket = 0; bucket < classes.size(); ++bucket)
 				{
-					resultInfo.SetIsUsbDevice(false);
-					spdlog::debug("  Not a USB device");
+					if (!IsEqualGUID(devInfoData.ClassGuid, classes[bucket]))
+					{
+						continue;
+					}
+					if (auto resultInfo = ReadClassDevice(enumerator.GetDevInfoSet(), devInfoData, classes[bucket], arena.get()))
+					{
+						buckets[bucket].push_back(std::move(*resultInfo));
+					}
+					break;
 				}
+			});
+			spdlog::info("EnumerateByDeviceClasses: Scanned {} device(s)", found);
+		}
 
-				resultInfo.SetSetupClassGuid(deviceClassGuid);
-				resultInfo.SetIsConnected(true);
-
-				AddDeviceInfo(std::move(resultInfo));
-				spdlog::debug("  Device added");
-			}
-			catch (const std::exception& e)
-			{
-				spdlog::warn("  Failed to process device: {}", e.what());
-			}
+		std::vector<DeviceResultantInfo> collected;
+		size_t total = 0;
+		for (const auto& bucket : buckets)
+		{
+			total += bucket.size();
+		}
+		collected.reserve(total);
+		for (size_t bucket = 0; bucket < buckets.size(); ++bucket)
+		{
+			spdlog::debug("  {}: {} device(s)", HexFormat::Guid<char>(classes[bucket]).view(), buckets[bucket].size());
+			std::move(buckets[bucket].begin(), buckets[bucket].end(), std::back_inserter(collected));
 		}
 
 		spdlog::info("========================================");
-		spdlog::info("EnumerateByDeviceClass: Complete - total: {}", _devicesList.size());
+		spdlog::info("EnumerateByDeviceClasses: Complete - total: {}", collected.size());
+		Publish(std::move(collected), {}, std::move(arena));
 		spdlog::info("========================================");
 	}
 	catch (const std::exception& e)
 	{
-		spdlog::error("EnumerateByDeviceClass: Exception: {}", e.what());
+		spdlog::error("EnumerateByDeviceClasses: Exception: {}", e.what());
 		throw;
 	}
 }
 
 // DevicesManager Public Interface
 DevicesManager::DevicesManager()
-	: pImpl{ std::make_unique<Impl>() }
+	: pImpl{ std::make_unique<Impl>(std::make_unique<UsbBackend>()) }
+{
+}
+
+DevicesManager::DevicesManager(std::unique_ptr<IUsbBackend> backend)
+	: pImpl{ std::make_unique<Impl>(std::move(backend)) }
 {
 }
 
@@ -481,7 +987,12 @@ DevicesManager& DevicesManager::operator=(DevicesManager&&) noexcept = default;
 
 void DevicesManager::EnumerateUsbDevices()
 {
-	pImpl->EnumerateUsbDevices();
+	(void)pImpl->EnumerateUsbDevices(EnumerationOptions{});
+}
+
+EnumerationStatus DevicesManager::EnumerateUsbDevices(const EnumerationOptions& options)
+{
+	return pImpl->EnumerateUsbDevices(options);
 }
 
 void DevicesManager::EnumerateByDeviceClass(const GUID& deviceClassGuid)
@@ -489,14 +1000,49 @@ void DevicesManager::EnumerateByDeviceClass(const GUID& deviceClassGuid)
 	pImpl->EnumerateByDeviceClass(deviceClassGuid);
 }
 
+void DevicesManager::EnumerateByDeviceClasses(const std::vector<GUID>& deviceClassGuids)
+{
+	pImpl->EnumerateByDeviceClasses(deviceClassGuids);
+}
+
 void DevicesManager::AddDeviceInfo(DeviceResultantInfo deviceResultantInfo)
 {
 	pImpl->AddDeviceInfo(std::move(deviceResultantInfo));
 }
 
-const std::vector<DeviceResultantInfo>& DevicesManager::GetDevices() const noexcept
+DeviceSnapshotPtr DevicesManager::GetSnapshot() const noexcept
+{
+	return pImpl->GetSnapshot();
+}
+
+std::unique_ptr<DeviceEventSubscriber> DevicesManager::SubscribeEvents() const
+{
+	return pImpl->SubscribeEvents();
+}
+
+DeviceChangeSet DevicesManager::GetChangesSince(uint64_t sequence) const
+{
+	return pImpl->GetChangesSince(sequence);
+}
+
+void DevicesManager::SetJournalPolicy(JournalPolicy policy)
+{
+	pImpl->SetJournalPolicy(std::move(policy));
+}
+
+void DevicesManager::EnableSharedInventory(const std::wstring& name, uint32_t capacity)
+{
+	pImpl->EnableSharedInventory(name, capacity);
+}
+
+void DevicesManager::DisableSharedInventory()
+{
+	pImpl->DisableSharedInventory();
+}
+
+DeviceSnapshotPtr DevicesManager::GetDevices() const noexcept
 {
-	return pImpl->GetDevices();
+	return pImpl->GetSnapshot();
 }
 
 size_t DevicesManager::GetDeviceCount() const noexcept
@@ -509,4 +1055,19 @@ void DevicesManager::ClearDevices() noexcept
 	pImpl->ClearDevices();
 }
 
+void DevicesManager::SetHubHealthPolicy(HubHealthPolicy policy)
+{
+	pImpl->SetHubHealthPolicy(std::move(policy));
+}
+
+std::vector<HubHealthStats> DevicesManager::GetHubHealth() const
+{
+	return pImpl->GetHubHealth();
+}
+
+void DevicesManager::ResetHubHealth()
+{
+	pImpl->ResetHubHealth();
+}
+
 }
@@ -0,0 +1,220 @@
+#include "pch.h"
+#include "FaultInjectingDeviceCommunication.h"
+#include "HubConnectionInfo.h"
+#include <thread>
+
+namespace KDM
+{
+namespace
+{
+	bool IsValidRate(double rate) noexcept
+	{
+		return rate >= 0.0 && rate <= 1.0;
+	}
+}
+
+	FaultInjectionStats FaultInjectionCounters::Snapshot() const noexcept
+	{
+		FaultInjectionStats stats;
+		stats.calls = calls.load(std::memory_order_relaxed);
+		stats.injectedErrors = injectedErrors.load(std::memory_order_relaxed);
+		stats.injectedDisconnects = injectedDisconnects.load(std::memory_order_relaxed);
+		stats.stalls = stalls.load(std::memory_order_relaxed);
+		stats.injectedLatency = std::chrono::microseconds(injectedLatencyUs.load(std::memory_order_relaxed));
+		return stats;
+	}
+
+	FaultInjectingDeviceCommunication::FaultInjectingDeviceCommunication(
+		std::unique_ptr<IDeviceCommunication> inner, FaultInjectionConfig config,
+		std::shared_ptr<FaultInjectionCounters> counters) :
+		_inner(std::move(inner)),
+		_config(std::move(config)),
+		_random(_config.seed),
+		_counters(counters ? std::move(counters) : std::make_shared<FaultInjectionCounters>())
+	{
+		if (!_inner) {
+			throw InvalidDeviceArgumentException("FaultInjectingDeviceCommunication: inner communication must not be null");
+		}
+		if (!IsValidRate(_config.disconnectRate)) {
+			throw InvalidDeviceArgumentException("FaultInjectingDeviceCommunication: disconnectRate must be within [0, 1]");
+		}
+		for (const auto& faults : _config.operations)
+		{
+			if (!IsValidRate(faults.errorRate) || !IsValidRate(faults.latency.stallProbability)) {
+				throw InvalidDeviceArgumentException("FaultInjectingDeviceCommunication: rates must be within [0, 1]");
+			}
+		}
+		if (!_config.delay) {
+			_config.delay = [](std::chrono::microseconds duration) { std::this_thread::sleep_for(duration); };
+		}
+	}
+
+	bool FaultInjectingDeviceCommunication::Draw(double probability)
+	{
+		if (probability <= 0.0) {
+			return false;
+		}
+		if (probability >= 1.0) {
+			return true;
+		}
+		return std::uniform_real_distribution<double>(0.0, 1.0)(_random) < probability;
+	}
+
+	bool FaultInjectingDeviceCommunication::BeginOperation(CommunicationOperation operation)
+	{
+		const OperationFaults& faults = _config[operation];
+		_counters->calls.fetch_add(1, std::memory_order_relaxed);
+
+		std::chrono::microseconds latency = faults.latency.base;
+		bool fail = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			if (faults.latency.jitter.count() > 0)
+			{
+				std::uniform_int_distribution<int64_t> jitter(0, faults.latency.jitter.count());
+				latency += std::chrono::microseconds(jitter(_random));
+			}
+			if (Draw(faults.latency.stallProbability))
+			{
+				latency += faults.latency.stall;
+				_counters->stalls.fetch_add(1, std::memory_order_relaxed);
+			}
+			fail = Draw(faults.errorRate);
+		}
+
+		// Sleep outside the lock so concurrent callers stall independently
+		if (latency.count() > 0)
+		{
+			_counters->injectedLatencyUs.fetch_add(latency.count(), std::memory_order_relaxed);
+			_config.delay(latency);
+		}
+
+		if (fail) {
+			_counters->injectedErrors.fetch_add(1, std::memory_order_relaxed);
+		}
+		return fail;
+	}
+
+	void FaultInjectingDeviceCommunication::ThrowInjectedError(const char* operation) const
+	{
+		throw DeviceIoException(std::string("Injected fault: ") + operation + " failed", ERROR_GEN_FAILURE);
+	}
+
+	void FaultInjectingDeviceCommunication::GetUsbHubNodeInformation(HubNodeInfo& nodeInfo)
+	{
+		if (BeginOperation(CommunicationOperation::HubNodeInformation)) {
+			ThrowInjectedError("GetUsbHubNodeInformation");
+		}
+		_inner->GetUsbHubNodeInformation(nodeInfo);
+	}
+
+	void FaultInjectingDeviceCommunication::GetUsbHubNodeInformationEx(HubNodeInfoEx& nodeInfo)
+	{
+		if (BeginOperation(CommunicationOperation::HubNodeInformationEx)) {
+			ThrowInjectedError("GetUsbHubNodeInformationEx");
+		}
+		_inner->GetUsbHubNodeInformationEx(nodeInfo);
+	}
+
+	void FaultInjectingDeviceCommunication::GetUsbHubNodeCapabilitiesEx(HubNodeCapabilitiesEx& nodeInfo)
+	{
+		if (BeginOperation(CommunicationOperation::HubNodeCapabilitiesEx)) {
+			ThrowInjectedError("GetUsbHubNodeCapabilitiesEx");
+		}
+		_inner->GetUsbHubNodeCapabilitiesEx(nodeInfo);
+	}
+
+	void FaultInjectingDeviceCommunication::GetUsbExternalHubName(DWORD index, std::wstring& hubName)
+	{
+		if (BeginOperation(CommunicationOperation::ExternalHubName)) {
+			ThrowInjectedError("GetUsbExternalHubName");
+		}
+		_inner->GetUsbExternalHubName(index, hubName);
+	}
+
+	void FaultInjectingDeviceCommunication::EnumeratePorts(ULONG numberOfPorts,
+		std::map<size_t, HubPortInfo>& portConnectorPropsList)
+	{
+		if (BeginOperation(CommunicationOperation::EnumeratePorts)) {
+			ThrowInjectedError("EnumeratePorts");
+		}
+		_inner->EnumeratePorts(numberOfPorts, portConnectorPropsList);
+	}
+
+	void FaultInjectingDeviceCommunication::EnumeratePortsConnectionInfo(ULONG numberOfPorts,
+		std::map<size_t, HubConnectionInfo>& hubConnectionInfoList)
+	{
+		if (BeginOperation(CommunicationOperation::EnumeratePortsConnectionInfo)) {
+			ThrowInjectedError("EnumeratePortsConnectionInfo");
+		}
+		_inner->EnumeratePortsConnectionInfo(numberOfPorts, hubConnectionInfoList);
+
+		if (_config.disconnectRate <= 0.0) {
+			return;
+		}
+
+		// Ports stay reported as connected; the device vanishes before its descriptors are read
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const auto& [portNumber, connectionInfo] : hubConnectionInfoList)
+		{
+			if (connectionInfo._connectionStatus == NoDeviceConnected) {
+				continue;
+			}
+			if (Draw(_config.disconnectRate) &&
+				_disconnectedPorts.insert(static_cast<ULONG>(portNumber)).second)
+			{
+				_counters->injectedDisconnects.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	std::wstring FaultInjectingDeviceCommunication::GetDriverKeyName(ULONG connectionIndex)
+	{
+		if (BeginOperation(CommunicationOperation::DriverKeyName)) {
+			ThrowInjectedError("GetDriverKeyName");
+		}
+		if (IsDisconnected(connectionIndex)) {
+			throw DeviceIoException("Injected fault: device disconnected", ERROR_NO_SUCH_DEVICE);
+		}
+		return _inner->GetDriverKeyName(connectionIndex);
+	}
+
+	PUSB_DESCRIPTOR_REQUEST FaultInjectingDeviceCommunication::GetConfigDescriptor(ULONG connectionIndex, UCHAR descriptorIndex)
+	{
+		if (BeginOperation(CommunicationOperation::ConfigDescriptor) || IsDisconnected(connectionIndex)) {
+			return nullptr;
+		}
+		return _inner->GetConfigDescriptor(connectionIndex, descriptorIndex);
+	}
+
+	PSTRING_DESCRIPTOR_NODE FaultInjectingDeviceCommunication::GetStringDescriptor(ULONG connectionIndex,
+		UCHAR descriptorIndex, USHORT languageId)
+	{
+		if (BeginOperation(CommunicationOperation::StringDescriptor) || IsDisconnected(connectionIndex)) {
+			return nullptr;
+		}
+		return _inner->GetStringDescriptor(connectionIndex, descriptorIndex, languageId);
+	}
+
+	HANDLE FaultInjectingDeviceCommunication::GetFileHandle()
+	{
+		return _inner->GetFileHandle();
+	}
+
+	void FaultInjectingDeviceCommunication::SetIoLimits(const EnumerationOptions& options)
+	{
+		_inner->SetIoLimits(options);
+	}
+
+	FaultInjectionStats FaultInjectingDeviceCommunication::GetStats() const noexcept
+	{
+		return _counters->Snapshot();
+	}
+
+	bool FaultInjectingDeviceCommunication::IsDisconnected(ULONG connectionIndex) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _disconnectedPorts.count(connectionIndex) != 0;
+	}
+}
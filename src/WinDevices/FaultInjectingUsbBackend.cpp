@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "FaultInjectingUsbBackend.h"
+#include "DevInfoData.h"
+#include "Fnv1a.h"
+
+namespace KDM
+{
+	FaultInjectingUsbBackend::FaultInjectingUsbBackend(std::unique_ptr<IUsbBackend> inner, FaultInjectionConfig config) :
+		_inner(std::move(inner)),
+		_config(std::move(config)),
+		_counters(std::make_shared<FaultInjectionCounters>())
+	{
+		if (!_inner) {
+			throw InvalidDeviceArgumentException("FaultInjectingUsbBackend: inner backend must not be null");
+		}
+	}
+
+	std::vector<DevInfoData> FaultInjectingUsbBackend::GetDeviceInstances()
+	{
+		return _inner->GetDeviceInstances();
+	}
+
+	std::vector<std::wstring> FaultInjectingUsbBackend::GetRootHubPaths()
+	{
+		return _inner->GetRootHubPaths();
+	}
+
+	std::unique_ptr<IDeviceCommunication> FaultInjectingUsbBackend::OpenHub(const std::wstring& hubPath)
+	{
+		uint64_t openIndex = 0;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			openIndex = _openCounts[hubPath]++;
+		}
+
+		// The first open of a hub keeps the plain per-path seed
+		FaultInjectionConfig hubConfig = _config;
+		hubConfig.seed = _config.seed ^ Fnv1a::Of(hubPath) ^ (openIndex * 0x9E3779B97F4A7C15ull);
+
+		return std::make_unique<FaultInjectingDeviceCommunication>(
+			_inner->OpenHub(hubPath), std::move(hubConfig), _counters);
+	}
+
+	std::wstring FaultInjectingUsbBackend::GetHubDevicePath(const DevInfoData& hubDevice)
+	{
+		return _inner->GetHubDevicePath(hubDevice);
+	}
+
+	FaultInjectionStats FaultInjectingUsbBackend::GetStats() const noexcept
+	{
+		return _counters->Snapshot();
+	}
+}
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "HardwareId.h"
+
+namespace KDM
+{
+namespace
+{
+	struct FieldSpec
+	{
+		std::wstring_view prefix;
+		size_t maxDigits;
+		uint32_t bit;
+	};
+
+	constexpr FieldSpec Fields[] = {
+		{ L"VID_", 4, HardwareId::HasVendorId },
+		{ L"PID_", 4, HardwareId::HasProductId },
+		{ L"REV_", 4, HardwareId::HasRevision },
+		{ L"MI_", 2, HardwareId::HasInterface },
+		{ L"Class_", 2, HardwareId::HasClass },
+		{ L"SubClass_", 2, HardwareId::HasSubClass },
+		{ L"Prot_", 2, HardwareId::HasProtocol },
+	};
+
+	constexpr wchar_t FoldAscii(wchar_t c) noexcept
+	{
+		return (c >= L'a' && c <= L'z') ? static_cast<wchar_t>(c - L'a' + L'A') : c;
+	}
+
+	bool StartsWithIgnoreCase(std::wstring_view text, std::wstring_view prefix) noexcept
+	{
+		if (text.size() < prefix.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < prefix.size(); ++i) {
+			if (FoldAscii(text[i]) != FoldAscii(prefix[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// 1..maxDigits hex digits and nothing else
+	bool ParseHex(std::wstring_view digits, size_t maxDigits, uint32_t& value) noexcept
+	{
+		if (digits.empty() || digits.size() > maxDigits) {
+			return false;
+		}
+
+		value = 0;
+		for (wchar_t c : digits) {
+			const wchar_t folded = FoldAscii(c);
+			if (folded >= L'0' && folded <= L'9') {
+				value = (value << 4) | static_cast<uint32_t>(folded - L'0');
+			}
+			else if (folded >= L'A' && folded <= L'F') {
+				value = (value << 4) | static_cast<uint32_t>(folded - L'A' + 10);
+			}
+			else {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Store(HardwareId& id, uint32_t bit, uint32_t value) noexcept
+	{
+		switch (bit)
+		{
+		case HardwareId::HasVendorId: id.vendorId = static_cast<uint16_t>(value); break;
+		case HardwareId::HasProductId: id.productId = static_cast<uint16_t>(value); break;
+		case HardwareId::HasRevision: id.revision = static_cast<uint16_t>(value); break;
+		case HardwareId::HasInterface: id.interfaceNumber = static_cast<uint8_t>(value); break;
+		case HardwareId::HasClass: id.deviceClass = static_cast<uint8_t>(value); break;
+		case HardwareId::HasSubClass: id.deviceSubClass = static_cast<uint8_t>(value); break;
+		case HardwareId::HasProtocol: id.deviceProtocol = static_cast<uint8_t>(value); break;
+		default: return;
+		}
+		id.fields |= bit;
+	}
+}
+
+	HardwareId ParseHardwareId(std::wstring_view id) noexcept
+	{
+		HardwareId result;
+
+		const size_t enumeratorEnd = id.find(L'\\');
+		std::wstring_view rest = enumeratorEnd == std::wstring_view::npos ? id : id.substr(enumeratorEnd + 1);
+
+		while (!rest.empty()) {
+			const size_t separator = rest.find(L'&');
+			const std::wstring_view token = rest.substr(0, separator);
+			rest = separator == std::wstring_view::npos ? std::wstring_view{} : rest.substr(separator + 1);
+
+			for (const FieldSpec& field : Fields) {
+				uint32_t value = 0;
+				if (StartsWithIgnoreCase(token, field.prefix) &&
+					ParseHex(token.substr(field.prefix.size()), field.maxDigits, value))
+				{
+					Store(result, field.bit, value);
+					break;
+				}
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,161 @@
+#include "pch.h"
+#include "HubHealthTracker.h"
+#include "UtilConvert.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <thread>
+
+namespace KDM
+{
+	HubHealthTracker::HubHealthTracker(HubHealthPolicy policy) :
+		_policy(std::move(policy))
+	{
+		if (_policy.maxAttempts == 0) {
+			throw InvalidDeviceArgumentException("HubHealthTracker: maxAttempts must be greater than 0");
+		}
+		if (_policy.initialBackoff > _policy.maxBackoff) {
+			throw InvalidDeviceArgumentException("HubHealthTracker: initialBackoff must not exceed maxBackoff");
+		}
+		if (!_policy.clock) {
+			_policy.clock = []() { return std::chrono::steady_clock::now(); };
+		}
+		if (!_policy.delay) {
+			_policy.delay = [](std::chrono::milliseconds duration) { std::this_thread::sleep_for(duration); };
+		}
+	}
+
+	std::chrono::steady_clock::time_point HubHealthTracker::Now() const
+	{
+		return _policy.clock();
+	}
+
+	HubHealthTracker::HubState& HubHealthTracker::StateOf(const std::wstring& hubPath)
+	{
+		auto [it, inserted] = _hubs.try_emplace(hubPath);
+		if (inserted) {
+			it->second.stats.hubPath = hubPath;
+		}
+		return it->second;
+	}
+
+	uint32_t HubHealthTracker::BeginScan(const std::wstring& hubPath)
+	{
+		const auto now = Now();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		HubState& hub = StateOf(hubPath);
+
+		switch (hub.stats.state)
+		{
+		case CircuitState::Closed:
+			return _policy.maxAttempts;
+
+		case CircuitState::Open:
+			if (now - hub.openedAt < _policy.cooldown)
+			{
+				++hub.stats.skippedWhileOpen;
+				return 0;
+			}
+			hub.stats.state = CircuitState::HalfOpen;
+			spdlog::info("HubHealthTracker: cooldown elapsed, trial attempt for hub {}",
+				UtilConvert::WStringToUTF8(hubPath));
+			return 1;
+
+		case CircuitState::HalfOpen:
+		default:
+			return 1;
+		}
+	}
+
+	std::chrono::milliseconds HubHealthTracker::BackoffFor(uint32_t retry) const noexcept
+	{
+		if (retry == 0) {
+			return std::chrono::milliseconds{ 0 };
+		}
+
+		// initialBackoff * 2^(retry - 1), saturating at maxBackoff
+		auto backoff = _policy.initialBackoff;
+		for (uint32_t i = 1; i < retry && backoff < _policy.maxBackoff; ++i) {
+			backoff *= 2;
+		}
+		return (std::min)(backoff, _policy.maxBackoff);
+	}
+
+	void HubHealthTracker::WaitBeforeRetry(const std::wstring& hubPath, uint32_t retry)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			++StateOf(hubPath).stats.retries;
+		}
+
+		if (auto backoff = BackoffFor(retry); backoff.count() > 0) {
+			_policy.delay(backoff);
+		}
+	}
+
+	void HubHealthTracker::RecordSuccess(const std::wstring& hubPath)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		HubState& hub = StateOf(hubPath);
+
+		if (hub.stats.state != CircuitState::Closed)
+		{
+			spdlog::info("HubHealthTracker: hub {} recovered, closing circuit",
+				UtilConvert::WStringToUTF8(hubPath));
+		}
+
+		hub.stats.state = CircuitState::Closed;
+		hub.stats.consecutiveFailures = 0;
+		++hub.stats.successes;
+	}
+
+	void HubHealthTracker::RecordFailure(const std::wstring& hubPath, const std::string& error)
+	{
+		const auto now = Now();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		HubState& hub = StateOf(hubPath);
+
+		++hub.stats.failures;
+		++hub.stats.consecutiveFailures;
+		hub.stats.lastError = error;
+
+		const bool trialFailed = hub.stats.state == CircuitState::HalfOpen;
+		const bool thresholdReached = _policy.failureThreshold != 0 &&
+			hub.stats.consecutiveFailures >= _policy.failureThreshold;
+
+		if (trialFailed || (hub.stats.state == CircuitState::Closed && thresholdReached))
+		{
+			hub.stats.state = CircuitState::Open;
+			hub.openedAt = now;
+			++hub.stats.timesOpened;
+			spdlog::warn("HubHealthTracker: opening circuit for hub {} after {} consecutive failure(s), cooldown {} ms",
+				UtilConvert::WStringToUTF8(hubPath), hub.stats.consecutiveFailures, _policy.cooldown.count());
+		}
+	}
+
+	CircuitState HubHealthTracker::GetState(const std::wstring& hubPath) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _hubs.find(hubPath);
+		return it != _hubs.end() ? it->second.stats.state : CircuitState::Closed;
+	}
+
+	std::vector<HubHealthStats> HubHealthTracker::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		std::vector<HubHealthStats> stats;
+		stats.reserve(_hubs.size());
+		for (const auto& [hubPath, hub] : _hubs) {
+			stats.push_back(hub.stats);
+		}
+		return stats;
+	}
+
+	void HubHealthTracker::Reset()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_hubs.clear();
+	}
+}
@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "JsonExporter.h"
+#include "UsbLocation.h"
+
+namespace KDM
+{
+namespace
+{
+	std::string_view EventTypeName(DeviceEventType type) noexcept
+	{
+		switch (type)
+		{
+		case DeviceEventType::Removed: return "removed";
+		case DeviceEventType::Changed: return "changed";
+		case DeviceEventType::Arrived:
+		default: return "arrived";
+		}
+	}
+
+	std::string_view ChangeTypeName(DeviceChangeType type) noexcept
+	{
+		return EventTypeName(static_cast<DeviceEventType>(type));
+	}
+}
+
+	JsonExporter::JsonExporter(JsonSink sink, JsonFormat format, size_t bufferSize)
+		: _writer(std::move(sink), bufferSize, "JsonExporter"), _format(format)
+	{
+	}
+
+	void JsonExporter::WriteSnapshot(const DeviceSnapshot& snapshot)
+	{
+		WriteDevices(snapshot.devices, snapshot.version);
+	}
+
+	void JsonExporter::WriteDevices(const std::vector<DeviceResultantInfo>& devices, uint64_t snapshotVersion)
+	{
+		if (_format == JsonFormat::NdJson)
+		{
+			for (const auto& device : devices)
+			{
+				Key("{\"snapshotVersion\"");
+				_writer.Unsigned(snapshotVersion);
+				_writer.Char(',');
+				WriteDevice(device);
+				_writer.Raw("}\n");
+			}
+			return;
+		}
+
+		Key("{\"version\"");
+		_writer.Unsigned(snapshotVersion);
+		Key(",\"devices\"");
+		_writer.Char('[');
+		for (size_t i = 0; i < devices.size(); ++i)
+		{
+			_writer.Raw(i == 0 ? "{" : ",{");
+			WriteDevice(devices[i]);
+			_writer.Char('}');
+		}
+		_writer.Raw("]}");
+	}
+
+	template <typename Item, typename WriteItem>
+	void JsonExporter::WriteSequence(const Item* items, size_t count, WriteItem writeItem)
+	{
+		if (_format == JsonFormat::NdJson)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				_writer.Char('{');
+				writeItem(items[i]);
+				_writer.Raw("}\n");
+			}
+			return;
+		}
+
+		_writer.Char('[');
+		for (size_t i = 0; i < count; ++i)
+		{
+			_writer.Raw(i == 0 ? "{" : ",{");
+			writeItem(items[i]);
+			_writer.Char('}');
+		}
+		_writer.Char(']');
+	}
+
+	void JsonExporter::WriteEvents(const DeviceEvent* events, size_t count)
+	{
+		WriteSequence(events, count, [this](const DeviceEvent& event) { WriteEvent(event); });
+	}
+
+	void JsonExporter::WriteChanges(const std::vector<DeviceChange>& changes)
+	{
+		WriteSequence(changes.data(), changes.size(), [this](const DeviceChange& change) { WriteChange(change); });
+	}
+
+	// Writes the members of a device object, without braces
+	void JsonExporter::WriteDevice(const DeviceResultantInfo& device)
+	{
+		Key("\"manufacturer\"");
+		_writer.String(device.GetManufacturer());
+		Key(",\"product\"");
+		_writer.String(device.GetProduct());
+		Key(",\"serialNumber\"");
+		_writer.String(device.GetSerialNumber());
+		Key(",\"description\"");
+		_writer.String(device.GetDescription());
+		Key(",\"deviceId\"");
+		_writer.String(device.GetDeviceId());
+		Key(",\"friendlyName\"");
+		_writer.String(device.GetFriendlyName());
+		Key(",\"devicePath\"");
+		_writer.String(device.GetDevicePath());
+		Key(",\"vendorName\"");
+		_writer.String(device.GetVendorName());
+		Key(",\"interfaceClassName\"");
+		_writer.String(device.GetInterfaceClassName());
+		Key(",\"vendorId\"");
+		_writer.Unsigned(device.GetVendorId());
+		Key(",\"productId\"");
+		_writer.Unsigned(device.GetProductId());
+		Key(",\"deviceClass\"");
+		_writer.Unsigned(device.GetDeviceClass());
+		Key(",\"interfaceClass\"");
+		_writer.Unsigned(device.GetInterfaceClass());
+		Key(",\"setupClassGuid\"");
+		Guid(device.GetSetupClassGuid());
+		Key(",\"isUsbDevice\"");
+		_writer.Raw(device.IsUsbDevice() ? "true" : "false");
+		Key(",\"isConnected\"");
+		_writer.Raw(device.IsConnected() ? "true" : "false");
+		Key(",\"location\"");
+		Location(device.GetLocationKey());
+	}
+
+	// 64-bit keys are written as hex strings: JSON numbers lose precision above 2^53
+	void JsonExporter::WriteEvent(const DeviceEvent& event)
+	{
+		Key("\"sequence\"");
+		_writer.Unsigned(event.sequence);
+		Key(",\"snapshotVersion\"");
+		_writer.Unsigned(event.snapshotVersion);
+		Key(",\"type\"");
+		_writer.Char('"');
+		_writer.Raw(EventTypeName(event.type));
+		_writer.Char('"');
+		Key(",\"deviceKey\"");
+		_writer.Char('"');
+		_writer.Hex(event.deviceKey, 16);
+		_writer.Char('"');
+		Key(",\"timestampMs\"");
+		_writer.Signed(event.timestampMs);
+		Key(",\"vendorId\"");
+		_writer.Unsigned(event.vendorId);
+		Key(",\"productId\"");
+		_writer.Unsigned(event.productId);
+		Key(",\"deviceClass\"");
+		_writer.Unsigned(event.deviceClass);
+		Key(",\"interfaceClass\"");
+		_writer.Unsigned(event.interfaceClass);
+	}
+
+	void JsonExporter::WriteChange(const DeviceChange& change)
+	{
+		Key("\"sequence\"");
+		_writer.Unsigned(change.sequence);
+		Key(",\"snapshotVersion\"");
+		_writer.Unsigned(change.snapshotVersion);
+		Key(",\"type\"");
+		_writer.Char('"');
+		_writer.Raw(ChangeTypeName(change.type));
+		_writer.Char('"');
+		Key(",\"deviceKey\"");
+		_writer.Char('"');
+		_writer.Hex(change.deviceKey, 16);
+		_writer.Char('"');
+		Key(",\"device\"");
+		_writer.Char('{');
+		WriteDevice(change.device);
+		_writer.Char('}');
+	}
+
+	void JsonExporter::Flush()
+	{
+		_writer.Flush();
+	}
+
+	// key is a pre-escaped literal including quotes (and a leading comma or brace); adds the colon
+	void JsonExporter::Key(std::string_view key)
+	{
+		_writer.Raw(key);
+		_writer.Char(':');
+	}
+
+	// UsbLocation text form, e.g. "2-1.4.3"; "" if unknown
+	void JsonExporter::Location(uint64_t location)
+	{
+		_writer.Char('"');
+		_writer.Location(location);
+		_writer.Char('"');
+	}
+
+	// Registry form: "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}"
+	void JsonExporter::Guid(const GUID& guid)
+	{
+		_writer.Raw("\"{");
+		_writer.Hex(guid.Data1, 8);
+		_writer.Char('-');
+		_writer.Hex(guid.Data2, 4);
+		_writer.Char('-');
+		_writer.Hex(guid.Data3, 4);
+		_writer.Char('-');
+		_writer.Hex(guid.Data4[0], 2);
+		_writer.Hex(guid.Data4[1], 2);
+		_writer.Char('-');
+		for (int i = 2; i < 8; ++i) {
+			_writer.Hex(guid.Data4[i], 2);
+		}
+		_writer.Raw("}\"");
+	}
+}
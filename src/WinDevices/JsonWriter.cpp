@@ -0,0 +1,204 @@
+#include "pch.h"
+#include "JsonWriter.h"
+#include "UsbLocation.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string>
+
+namespace KDM
+{
+namespace
+{
+	constexpr char HexDigits[] = "0123456789ABCDEF";
+
+	// Longest output of one UTF-16 code unit: \u00XX (6 bytes); a surrogate pair takes 4
+	constexpr size_t MaxEscapedUnit = 6;
+}
+
+	JsonWriter::JsonWriter(JsonSink sink, size_t bufferSize, std::string_view owner)
+		: _sink(std::move(sink))
+	{
+		if (!_sink) {
+			throw InvalidDeviceArgumentException(std::string(owner) + ": sink must not be empty");
+		}
+		if (bufferSize < MinBufferSize) {
+			throw InvalidDeviceArgumentException(std::string(owner) + ": bufferSize must be at least 64 bytes");
+		}
+		_buffer.resize(bufferSize);
+	}
+
+	void JsonWriter::Flush()
+	{
+		if (_used == 0) {
+			return;
+		}
+
+		// Reset first: a throwing sink aborts this chunk but leaves the writer usable
+		const size_t size = _used;
+		_used = 0;
+		_flushed += size;
+		_sink(_buffer.data(), size);
+	}
+
+	char* JsonWriter::Reserve(size_t bytes)
+	{
+		if (_buffer.size() - _used < bytes) {
+			Flush();
+		}
+		return _buffer.data() + _used;
+	}
+
+	void JsonWriter::Raw(std::string_view text)
+	{
+		while (!text.empty())
+		{
+			if (_used == _buffer.size()) {
+				Flush();
+			}
+			const size_t chunk = (std::min)(text.size(), _buffer.size() - _used);
+			std::memcpy(_buffer.data() + _used, text.data(), chunk);
+			_used += chunk;
+			text.remove_prefix(chunk);
+		}
+	}
+
+	void JsonWriter::Char(char c)
+	{
+		*Reserve(1) = c;
+		++_used;
+	}
+
+	void JsonWriter::String(std::wstring_view value)
+	{
+		Char('"');
+		Escaped(value, true);
+		Char('"');
+	}
+
+	void JsonWriter::DotLabel(std::wstring_view value)
+	{
+		Escaped(value, false);
+	}
+
+	// Escapes and transcodes UTF-16 to UTF-8 in one pass
+	void JsonWriter::Escaped(std::wstring_view value, bool json)
+	{
+		char* out = _buffer.data() + _used;
+		for (size_t i = 0; i < value.size(); ++i)
+		{
+			if (static_cast<size_t>(_buffer.data() + _buffer.size() - out) < MaxEscapedUnit)
+			{
+				_used = out - _buffer.data();
+				Flush();
+				out = _buffer.data();
+			}
+
+			uint32_t c = static_cast<uint16_t>(value[i]);
+			if (c < 0x80)
+			{
+				if (c >= 0x20 && c != '"' && c != '\\')
+				{
+					*out++ = static_cast<char>(c);
+					continue;
+				}
+				if (c == '"' || c == '\\')
+				{
+					*out++ = '\\';
+					*out++ = static_cast<char>(c);
+					continue;
+				}
+				if (!json)
+				{
+					*out++ = ' ';
+					continue;
+				}
+
+				*out++ = '\\';
+				switch (c)
+				{
+				case '\b': *out++ = 'b'; break;
+				case '\f': *out++ = 'f'; break;
+				case '\n': *out++ = 'n'; break;
+				case '\r': *out++ = 'r'; break;
+				case '\t': *out++ = 't'; break;
+				default:
+					*out++ = 'u';
+					*out++ = '0';
+					*out++ = '0';
+					*out++ = HexDigits[c >> 4];
+					*out++ = HexDigits[c & 0xF];
+					break;
+				}
+				continue;
+			}
+
+			if (c < 0x800)
+			{
+				*out++ = static_cast<char>(0xC0 | (c >> 6));
+				*out++ = static_cast<char>(0x80 | (c & 0x3F));
+				continue;
+			}
+
+			if (c >= 0xD800 && c <= 0xDBFF && i + 1 < value.size())
+			{
+				const uint32_t low = static_cast<uint16_t>(value[i + 1]);
+				if (low >= 0xDC00 && low <= 0xDFFF)
+				{
+					const uint32_t codePoint = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+					*out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+					*out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+					*out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+					++i;
+					continue;
+				}
+			}
+
+			if (c >= 0xD800 && c <= 0xDFFF) {
+				c = 0xFFFD;
+			}
+			*out++ = static_cast<char>(0xE0 | (c >> 12));
+			*out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*out++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		_used = out - _buffer.data();
+	}
+
+	void JsonWriter::Unsigned(uint64_t value)
+	{
+		char* out = Reserve(20);
+		_used = std::to_chars(out, out + 20, value).ptr - _buffer.data();
+	}
+
+	void JsonWriter::Signed(int64_t value)
+	{
+		char* out = Reserve(20);
+		_used = std::to_chars(out, out + 20, value).ptr - _buffer.data();
+	}
+
+	void JsonWriter::Hex(uint64_t value, int digits)
+	{
+		char* out = Reserve(static_cast<size_t>(digits));
+		for (int i = digits - 1; i >= 0; --i)
+		{
+			out[i] = HexDigits[value & 0xF];
+			value >>= 4;
+		}
+		_used += static_cast<size_t>(digits);
+	}
+
+	void JsonWriter::Location(uint64_t location)
+	{
+		if (location == UsbLocation::Unknown) {
+			return;
+		}
+		Unsigned(UsbLocation::ControllerOf(location));
+		const uint32_t length = UsbLocation::ChainLength(location);
+		for (uint32_t i = 0; i < length; ++i)
+		{
+			Char(i == 0 ? '-' : '.');
+			Unsigned(UsbLocation::PortAt(location, i));
+		}
+	}
+}
@@ -0,0 +1,286 @@
+#include "pch.h"
+#include "SharedInventory.h"
+#include "DeviceChange.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace KDM
+{
+namespace
+{
+	using namespace SharedInventoryLayout;
+
+	// A reader gives up after this many torn copies; the publisher writes at most a
+	// few times per second, so hitting the limit means the region is being hammered
+	constexpr int MaxReadAttempts = 64;
+
+	constexpr size_t AlignUp(size_t value, size_t alignment) noexcept
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	size_t BufferSize(uint32_t capacity) noexcept
+	{
+		return AlignUp(sizeof(BufferHeader) + static_cast<size_t>(capacity) * sizeof(DeviceRecord), alignof(BufferHeader));
+	}
+
+	BufferHeader* BufferAt(void* region, uint64_t generation) noexcept
+	{
+		auto* header = static_cast<RegionHeader*>(region);
+		return reinterpret_cast<BufferHeader*>(static_cast<char*>(region) + header->bufferOffset[generation % 2]);
+	}
+
+	const BufferHeader* BufferAt(const void* region, uint64_t generation) noexcept
+	{
+		return BufferAt(const_cast<void*>(region), generation);
+	}
+
+	DeviceRecord* RecordsOf(BufferHeader* buffer) noexcept
+	{
+		return reinterpret_cast<DeviceRecord*>(buffer + 1);
+	}
+
+	const DeviceRecord* RecordsOf(const BufferHeader* buffer) noexcept
+	{
+		return reinterpret_cast<const DeviceRecord*>(buffer + 1);
+	}
+
+	// Stores value as zero-terminated UTF-8, cut at a character boundary if it does not fit.
+	// Converts straight into target: it runs while readers see the buffer as being written,
+	// so it must neither allocate nor throw.
+	template <size_t N>
+	void CopyString(char (&target)[N], std::wstring_view value) noexcept
+	{
+		constexpr int Capacity = static_cast<int>(N - 1);
+		int units = static_cast<int>((std::min)(value.size(), static_cast<size_t>(Capacity)));
+
+		// A UTF-16 unit takes 1 to 3 bytes; drop at least a third of the excess per pass
+		int bytes = units > 0 ? WideCharToMultiByte(CP_UTF8, 0, value.data(), units, nullptr, 0, nullptr, nullptr) : 0;
+		while (bytes > Capacity)
+		{
+			units -= (std::max)(1, (bytes - Capacity + 2) / 3);
+			if (units > 0 && IS_HIGH_SURROGATE(value[units - 1])) {
+				--units;
+			}
+			bytes = units > 0 ? WideCharToMultiByte(CP_UTF8, 0, value.data(), units, nullptr, 0, nullptr, nullptr) : 0;
+		}
+		if (units > 0 && units < static_cast<int>(value.size()) && IS_HIGH_SURROGATE(value[units - 1]))
+		{
+			--units;
+			bytes = units > 0 ? WideCharToMultiByte(CP_UTF8, 0, value.data(), units, nullptr, 0, nullptr, nullptr) : 0;
+		}
+
+		const int written = bytes > 0
+			? WideCharToMultiByte(CP_UTF8, 0, value.data(), units, target, Capacity, nullptr, nullptr)
+			: 0;
+		target[written > 0 ? written : 0] = '\0';
+	}
+
+	void FillRecord(DeviceRecord& record, const DeviceResultantInfo& device) noexcept
+	{
+		std::memset(&record, 0, sizeof(record));
+		CopyString(record.manufacturer, device.GetManufacturer());
+		CopyString(record.product, device.GetProduct());
+		CopyString(record.serialNumber, device.GetSerialNumber());
+		CopyString(record.description, device.GetDescription());
+		CopyString(record.deviceId, device.GetDeviceId());
+		CopyString(record.friendlyName, device.GetFriendlyName());
+		CopyString(record.devicePath, device.GetDevicePath());
+		CopyString(record.vendorName, device.GetVendorName());
+		CopyString(record.interfaceClassName, device.GetInterfaceClassName());
+		record.setupClassGuid = device.GetSetupClassGuid();
+		record.deviceKey = DeviceKeyOf(device);
+		record.locationKey = device.GetLocationKey();
+		record.vendorId = device.GetVendorId();
+		record.productId = device.GetProductId();
+		record.deviceClass = device.GetDeviceClass();
+		record.interfaceClass = device.GetInterfaceClass();
+		record.isUsbDevice = device.IsUsbDevice() ? 1 : 0;
+		record.isConnected = device.IsConnected() ? 1 : 0;
+	}
+}
+
+	size_t SharedInventoryLayout::RegionSize(uint32_t capacity) noexcept
+	{
+		return sizeof(RegionHeader) + 2 * BufferSize(capacity);
+	}
+
+	void SharedInventoryLayout::InitializeRegion(void* region, uint32_t capacity) noexcept
+	{
+		const size_t size = RegionSize(capacity);
+		std::memset(region, 0, size);
+
+		auto* header = new (region) RegionHeader{};
+		header->magic = Magic;
+		header->layoutVersion = LayoutVersion;
+		header->capacity = capacity;
+		header->recordSize = sizeof(DeviceRecord);
+		header->regionSize = size;
+		header->bufferOffset[0] = sizeof(RegionHeader);
+		header->bufferOffset[1] = sizeof(RegionHeader) + BufferSize(capacity);
+
+		for (uint64_t buffer = 0; buffer < 2; ++buffer) {
+			new (BufferAt(region, buffer)) BufferHeader{};
+		}
+	}
+
+	bool SharedInventoryLayout::IsValidRegion(const void* region, size_t size) noexcept
+	{
+		if (!region || size < sizeof(RegionHeader)) {
+			return false;
+		}
+
+		const auto* header = static_cast<const RegionHeader*>(region);
+		return header->magic == Magic
+			&& header->layoutVersion == LayoutVersion
+			&& header->recordSize == sizeof(DeviceRecord)
+			&& header->capacity > 0
+			&& header->regionSize == RegionSize(header->capacity)
+			&& header->regionSize <= size
+			&& header->bufferOffset[0] == sizeof(RegionHeader)
+			&& header->bufferOffset[1] == sizeof(RegionHeader) + BufferSize(header->capacity);
+	}
+
+	void SharedInventoryLayout::WriteSnapshot(void* region, const DeviceSnapshot& snapshot) noexcept
+	{
+		auto* header = static_cast<RegionHeader*>(region);
+		const uint64_t next = header->generation.load(std::memory_order_relaxed) + 1;
+		BufferHeader* buffer = BufferAt(region, next);
+
+		// Readers still copying the previous contents of this buffer see the odd
+		// sequence (or its change afterwards) and retry on the active buffer
+		const uint64_t sequence = buffer->sequence.load(std::memory_order_relaxed);
+		buffer->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		const uint32_t count = static_cast<uint32_t>((std::min)(snapshot.devices.size(), static_cast<size_t>(header->capacity)));
+		DeviceRecord* records = RecordsOf(buffer);
+		for (uint32_t i = 0; i < count; ++i) {
+			FillRecord(records[i], snapshot.devices[i]);
+		}
+
+		buffer->snapshotVersion = snapshot.version;
+		buffer->publishedAtMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		buffer->deviceCount = count;
+		buffer->totalDevices = static_cast<uint32_t>(snapshot.devices.size());
+
+		buffer->sequence.store(sequence + 2, std::memory_order_release);
+		header->generation.store(next, std::memory_order_release);
+	}
+
+	bool ReadSharedInventory(const void* region, SharedInventoryContents& contents)
+	{
+		const auto* header = static_cast<const RegionHeader*>(region);
+		const uint32_t capacity = header->capacity;
+
+		for (int attempt = 0; attempt < MaxReadAttempts; ++attempt)
+		{
+			const uint64_t generation = header->generation.load(std::memory_order_acquire);
+			const BufferHeader* buffer = BufferAt(region, generation);
+
+			const uint64_t before = buffer->sequence.load(std::memory_order_acquire);
+			if (before & 1)
+			{
+				// The publisher lapped us and is rewriting this buffer; the other one is current
+				std::this_thread::yield();
+				continue;
+			}
+
+			// Fields may be torn until the sequence check below; never trust the count before it
+			const uint32_t count = (std::min)(buffer->deviceCount, capacity);
+			contents.snapshotVersion = buffer->snapshotVersion;
+			contents.publishedAtMs = buffer->publishedAtMs;
+			contents.totalDevices = buffer->totalDevices;
+			contents.devices.resize(count);
+			std::memcpy(contents.devices.data(), RecordsOf(buffer), count * sizeof(DeviceRecord));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (buffer->sequence.load(std::memory_order_relaxed) == before)
+			{
+				contents.generation = generation;
+				return true;
+			}
+		}
+
+		spdlog::warn("ReadSharedInventory: gave up after {} torn reads", MaxReadAttempts);
+		return false;
+	}
+
+	SharedInventoryPublisher::SharedInventoryPublisher(const std::wstring& name, uint32_t capacity)
+		: _name(name)
+	{
+		if (name.empty()) {
+			throw InvalidDeviceArgumentException("SharedInventoryPublisher: name must not be empty");
+		}
+		if (capacity == 0) {
+			throw InvalidDeviceArgumentException("SharedInventoryPublisher: capacity must be greater than 0");
+		}
+
+		const uint64_t size = RegionSize(capacity);
+		_mapping.reset(CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), name.c_str()));
+		if (!_mapping) {
+			throw DeviceIoException("SharedInventoryPublisher: CreateFileMappingW failed", GetLastError());
+		}
+		const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+		_view.reset(MapViewOfFile(_mapping.get(), FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(size)));
+		if (!_view) {
+			throw DeviceIoException("SharedInventoryPublisher: MapViewOfFile failed", GetLastError());
+		}
+
+		if (existed)
+		{
+			// Another publisher (or an earlier one whose readers keep it alive) owns the name
+			if (!IsValidRegion(_view.get(), static_cast<size_t>(size))
+				|| static_cast<const RegionHeader*>(_view.get())->capacity != capacity) {
+				throw DeviceIoException("SharedInventoryPublisher: existing region has an incompatible layout", ERROR_INVALID_DATA);
+			}
+		}
+		else
+		{
+			InitializeRegion(_view.get(), capacity);
+		}
+
+		static_cast<RegionHeader*>(_view.get())->publisherProcessId = GetCurrentProcessId();
+		spdlog::debug("SharedInventoryPublisher: mapped {} bytes for {} devices", size, capacity);
+	}
+
+	void SharedInventoryPublisher::Publish(const DeviceSnapshot& snapshot) noexcept
+	{
+		WriteSnapshot(_view.get(), snapshot);
+	}
+
+	SharedInventoryReader::SharedInventoryReader(const std::wstring& name)
+	{
+		_mapping.reset(OpenFileMappingW(FILE_MAP_READ, FALSE, name.c_str()));
+		if (!_mapping) {
+			throw DeviceIoException("SharedInventoryReader: OpenFileMappingW failed", GetLastError());
+		}
+
+		_view.reset(MapViewOfFile(_mapping.get(), FILE_MAP_READ, 0, 0, 0));
+		if (!_view) {
+			throw DeviceIoException("SharedInventoryReader: MapViewOfFile failed", GetLastError());
+		}
+
+		MEMORY_BASIC_INFORMATION info{};
+		if (VirtualQuery(_view.get(), &info, sizeof(info)) == 0 || !IsValidRegion(_view.get(), info.RegionSize)) {
+			throw DeviceIoException("SharedInventoryReader: not a shared device inventory", ERROR_INVALID_DATA);
+		}
+	}
+
+	uint64_t SharedInventoryReader::GetGeneration() const noexcept
+	{
+		return static_cast<const RegionHeader*>(_view.get())->generation.load(std::memory_order_acquire);
+	}
+
+	bool SharedInventoryReader::Read(SharedInventoryContents& contents) const
+	{
+		return ReadSharedInventory(_view.get(), contents);
+	}
+}
@@ -0,0 +1,416 @@
+#include "pch.h"
+#include "SnapshotDelta.h"
+#include "DeviceChange.h"
+#include "Fnv1a.h"
+#include "UtilConvert.h"
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+namespace KDM
+{
+namespace
+{
+	// Layout: magic, format version, base version, target version, base digest (8 bytes),
+	// base device count, string dictionary, edit script. Everything but the magic and the
+	// digest is a LEB128 varint.
+	constexpr uint32_t DeltaMagic = 0x444D444B;        // "KDMD"
+	constexpr uint64_t DeltaFormatVersion = 3;      // 2: location key, 3: base digest from DeviceContentHashOf
+
+	enum class Op : uint8_t
+	{
+		Copy = 0,       // base start, count: unchanged run
+		Modify = 1,     // base index, field mask, changed fields
+		Add = 2         // every field
+	};
+
+	// Bit i of a field mask; strings are dictionary indices (0 = empty string)
+	enum Field : uint32_t
+	{
+		Manufacturer, Product, SerialNumber, Description, DeviceId, FriendlyName, DevicePath,
+		VendorName, InterfaceClassName, VendorId, ProductId, DeviceClass, InterfaceClass,
+		SetupClassGuid, IsUsbDevice, IsConnected, LocationKey, FieldCount
+	};
+
+	constexpr uint32_t AllFields = (1u << FieldCount) - 1;
+
+	using StringGetter = std::wstring_view (DeviceResultantInfo::*)() const noexcept;
+	using StringSetter = void (DeviceResultantInfo::*)(std::wstring_view);
+
+	struct StringField
+	{
+		StringGetter get;
+		StringSetter set;
+	};
+
+	// Indexed by Field for the string fields (Manufacturer..InterfaceClassName)
+	const StringField StringFields[] = {
+		{ &DeviceResultantInfo::GetManufacturer, &DeviceResultantInfo::SetManufacturer },
+		{ &DeviceResultantInfo::GetProduct, &DeviceResultantInfo::SetProduct },
+		{ &DeviceResultantInfo::GetSerialNumber, &DeviceResultantInfo::SetSerialNumber },
+		{ &DeviceResultantInfo::GetDescription, &DeviceResultantInfo::SetDescription },
+		{ &DeviceResultantInfo::GetDeviceId, &DeviceResultantInfo::SetDeviceId },
+		{ &DeviceResultantInfo::GetFriendlyName, &DeviceResultantInfo::SetFriendlyName },
+		{ &DeviceResultantInfo::GetDevicePath, &DeviceResultantInfo::SetDevicePath },
+		{ &DeviceResultantInfo::GetVendorName, &DeviceResultantInfo::SetVendorName },
+		{ &DeviceResultantInfo::GetInterfaceClassName, &DeviceResultantInfo::SetInterfaceClassName },
+	};
+	static_assert(std::size(StringFields) == VendorId, "one entry per string field");
+
+	[[noreturn]] void ThrowInvalid(const char* reason)
+	{
+		throw DeviceIoException(std::string("DecodeSnapshotDelta: ") + reason, ERROR_INVALID_DATA);
+	}
+
+	// Content hashes of every device in order: a delta only applies to the exact base it was made from
+	uint64_t DigestOf(const DeviceSnapshot& snapshot) noexcept
+	{
+		uint64_t hash = Fnv1a::OffsetBasis;
+		for (const auto& device : snapshot.devices)
+		{
+			const uint64_t content = DeviceContentHashOf(device);
+			Fnv1a::HashBytes(hash, &content, sizeof(content));
+		}
+		return hash;
+	}
+
+	uint32_t ChangedFields(const DeviceResultantInfo& from, const DeviceResultantInfo& to)
+	{
+		uint32_t mask = 0;
+		for (uint32_t field = 0; field < VendorId; ++field)
+		{
+			if ((from.*StringFields[field].get)() != (to.*StringFields[field].get)()) {
+				mask |= 1u << field;
+			}
+		}
+		if (from.GetVendorId() != to.GetVendorId()) mask |= 1u << VendorId;
+		if (from.GetProductId() != to.GetProductId()) mask |= 1u << ProductId;
+		if (from.GetDeviceClass() != to.GetDeviceClass()) mask |= 1u << DeviceClass;
+		if (from.GetInterfaceClass() != to.GetInterfaceClass()) mask |= 1u << InterfaceClass;
+		if (!IsEqualGUID(from.GetSetupClassGuid(), to.GetSetupClassGuid())) mask |= 1u << SetupClassGuid;
+		if (from.IsUsbDevice() != to.IsUsbDevice()) mask |= 1u << IsUsbDevice;
+		if (from.IsConnected() != to.IsConnected()) mask |= 1u << IsConnected;
+		if (from.GetLocationKey() != to.GetLocationKey()) mask |= 1u << LocationKey;
+		return mask;
+	}
+
+	class DeltaWriter
+	{
+	public:
+		void Varint(uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				_bytes.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			_bytes.push_back(static_cast<uint8_t>(value));
+		}
+
+		void Bytes(const void* data, size_t size)
+		{
+			const auto* bytes = static_cast<const uint8_t*>(data);
+			_bytes.insert(_bytes.end(), bytes, bytes + size);
+		}
+
+		// Appends the fields in mask, strings as dictionary references
+		void Fields(const DeviceResultantInfo& device, uint32_t mask)
+		{
+			for (uint32_t field = 0; field < VendorId; ++field)
+			{
+				if (mask & (1u << field)) {
+					Varint(Intern((device.*StringFields[field].get)()));
+				}
+			}
+			if (mask & (1u << VendorId)) Varint(device.GetVendorId());
+			if (mask & (1u << ProductId)) Varint(device.GetProductId());
+			if (mask & (1u << DeviceClass)) Varint(device.GetDeviceClass());
+			if (mask & (1u << InterfaceClass)) Varint(device.GetInterfaceClass());
+			if (mask & (1u << SetupClassGuid)) Bytes(&device.GetSetupClassGuid(), sizeof(GUID));
+			if (mask & (1u << IsUsbDevice)) Varint(device.IsUsbDevice() ? 1 : 0);
+			if (mask & (1u << IsConnected)) Varint(device.IsConnected() ? 1 : 0);
+			if (mask & (1u << LocationKey)) Varint(device.GetLocationKey());
+		}
+
+		[[nodiscard]] const std::vector<std::wstring_view>& Dictionary() const noexcept { return _dictionary; }
+		[[nodiscard]] std::vector<uint8_t>& Data() noexcept { return _bytes; }
+
+	private:
+		// The views point into the target snapshot, which outlives the writer
+		uint64_t Intern(std::wstring_view value)
+		{
+			if (value.empty()) {
+				return 0;
+			}
+			auto [it, inserted] = _indices.try_emplace(value, _dictionary.size() + 1);
+			if (inserted) {
+				_dictionary.push_back(value);
+			}
+			return it->second;
+		}
+
+		std::vector<uint8_t> _bytes;
+		std::vector<std::wstring_view> _dictionary;
+		std::unordered_map<std::wstring_view, uint64_t> _indices;
+	};
+
+	class DeltaReader
+	{
+	public:
+		DeltaReader(const uint8_t* data, size_t size) noexcept : _data(data), _size(size) {}
+
+		uint64_t Varint()
+		{
+			uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (_position >= _size) {
+					ThrowInvalid("truncated");
+				}
+				const uint8_t byte = _data[_position++];
+				value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0) {
+					return value;
+				}
+			}
+			ThrowInvalid("varint too long");
+		}
+
+		// A count of items that each take at least one byte cannot exceed what is left
+		uint64_t Count()
+		{
+			const uint64_t count = Varint();
+			if (count > Remaining()) {
+				ThrowInvalid("count exceeds data");
+			}
+			return count;
+		}
+
+		// USB vendor and product IDs are 16-bit
+		uint16_t UsbId()
+		{
+			const uint64_t value = Varint();
+			if (value > UINT16_MAX) {
+				ThrowInvalid("USB ID out of range");
+			}
+			return static_cast<uint16_t>(value);
+		}
+
+		void Bytes(void* target, size_t size)
+		{
+			if (size > Remaining()) {
+				ThrowInvalid("truncated");
+			}
+			std::memcpy(target, _data + _position, size);
+			_position += size;
+		}
+
+		std::string_view Text(size_t size)
+		{
+			if (size > Remaining()) {
+				ThrowInvalid("truncated");
+			}
+			std::string_view text(reinterpret_cast<const char*>(_data + _position), size);
+			_position += size;
+			return text;
+		}
+
+		[[nodiscard]] size_t Remaining() const noexcept { return _size - _position; }
+
+	private:
+		const uint8_t* _data;
+		size_t _size;
+		size_t _position = 0;
+	};
+
+	void ReadFields(DeltaReader& reader, const std::vector<std::wstring>& dictionary, uint32_t mask,
+		DeviceResultantInfo& device)
+	{
+		for (uint32_t field = 0; field < VendorId; ++field)
+		{
+			if (mask & (1u << field))
+			{
+				const uint64_t index = reader.Varint();
+				if (index > dictionary.size()) {
+					ThrowInvalid("string index out of range");
+				}
+				(device.*StringFields[field].set)(index == 0 ? std::wstring_view() : dictionary[index - 1]);
+			}
+		}
+		if (mask & (1u << VendorId)) device.SetVendorId(reader.UsbId());
+		if (mask & (1u << ProductId)) device.SetProductId(reader.UsbId());
+		if (mask & (1u << DeviceClass)) device.SetDeviceClass(static_cast<UCHAR>(reader.Varint()));
+		if (mask & (1u << InterfaceClass)) device.SetInterfaceClass(static_cast<UCHAR>(reader.Varint()));
+		if (mask & (1u << SetupClassGuid))
+		{
+			GUID guid{};
+			reader.Bytes(&guid, sizeof(guid));
+			device.SetSetupClassGuid(guid);
+		}
+		if (mask & (1u << IsUsbDevice)) device.SetIsUsbDevice(reader.Varint() != 0);
+		if (mask & (1u << IsConnected)) device.SetIsConnected(reader.Varint() != 0);
+		if (mask & (1u << LocationKey)) device.SetLocationKey(reader.Varint());
+	}
+}
+
+	std::vector<uint8_t> EncodeSnapshotDelta(const DeviceSnapshot& base, const DeviceSnapshot& target)
+	{
+		// Base indices by key, claimed in ascending order so unchanged runs stay contiguous
+		std::unordered_map<uint64_t, std::deque<size_t>> unmatched;
+		unmatched.reserve(base.devices.size());
+		for (size_t i = 0; i < base.devices.size(); ++i) {
+			unmatched[DeviceKeyOf(base.devices[i])].push_back(i);
+		}
+
+		DeltaWriter script;
+		uint64_t opCount = 0;
+		size_t runStart = 0;
+		size_t runLength = 0;
+
+		auto flushRun = [&] {
+			if (runLength > 0)
+			{
+				script.Varint(static_cast<uint8_t>(Op::Copy));
+				script.Varint(runStart);
+				script.Varint(runLength);
+				++opCount;
+				runLength = 0;
+			}
+		};
+
+		for (const auto& device : target.devices)
+		{
+			auto it = unmatched.find(DeviceKeyOf(device));
+			if (it == unmatched.end() || it->second.empty())
+			{
+				flushRun();
+				script.Varint(static_cast<uint8_t>(Op::Add));
+				script.Fields(device, AllFields);
+				++opCount;
+				continue;
+			}
+
+			const size_t index = it->second.front();
+			it->second.pop_front();
+
+			const uint32_t mask = ChangedFields(base.devices[index], device);
+			if (mask == 0)
+			{
+				if (runLength > 0 && runStart + runLength == index)
+				{
+					++runLength;
+					continue;
+				}
+				flushRun();
+				runStart = index;
+				runLength = 1;
+				continue;
+			}
+
+			flushRun();
+			script.Varint(static_cast<uint8_t>(Op::Modify));
+			script.Varint(index);
+			script.Varint(mask);
+			script.Fields(device, mask);
+			++opCount;
+		}
+		flushRun();
+
+		DeltaWriter delta;
+		delta.Bytes(&DeltaMagic, sizeof(DeltaMagic));
+		delta.Varint(DeltaFormatVersion);
+		delta.Varint(base.version);
+		delta.Varint(target.version);
+		const uint64_t digest = DigestOf(base);
+		delta.Bytes(&digest, sizeof(digest));
+		delta.Varint(base.devices.size());
+
+		delta.Varint(script.Dictionary().size());
+		for (const auto& value : script.Dictionary())
+		{
+			const std::string utf8 = UtilConvert::WStringToUTF8(value);
+			delta.Varint(utf8.size());
+			delta.Bytes(utf8.data(), utf8.size());
+		}
+
+		delta.Varint(opCount);
+		delta.Bytes(script.Data().data(), script.Data().size());
+		return std::move(delta.Data());
+	}
+
+	DeviceSnapshot DecodeSnapshotDelta(const DeviceSnapshot& base, const uint8_t* data, size_t size)
+	{
+		if (!data) {
+			ThrowInvalid("no data");
+		}
+		DeltaReader reader(data, size);
+
+		uint32_t magic = 0;
+		reader.Bytes(&magic, sizeof(magic));
+		if (magic != DeltaMagic) {
+			ThrowInvalid("not a snapshot delta");
+		}
+		if (reader.Varint() != DeltaFormatVersion) {
+			ThrowInvalid("unsupported format version");
+		}
+
+		const uint64_t baseVersion = reader.Varint();
+		DeviceSnapshot target;
+		target.version = reader.Varint();
+
+		uint64_t digest = 0;
+		reader.Bytes(&digest, sizeof(digest));
+		if (baseVersion != base.version || reader.Varint() != base.devices.size() || digest != DigestOf(base)) {
+			ThrowInvalid("delta was encoded against a different base");
+		}
+
+		std::vector<std::wstring> dictionary(static_cast<size_t>(reader.Count()));
+		for (auto& value : dictionary) {
+			value = UtilConvert::UTF8ToWString(reader.Text(static_cast<size_t>(reader.Varint())));
+		}
+
+		const uint64_t opCount = reader.Count();
+		for (uint64_t op = 0; op < opCount; ++op)
+		{
+			switch (static_cast<Op>(reader.Varint()))
+			{
+			case Op::Copy:
+			{
+				const uint64_t start = reader.Varint();
+				const uint64_t count = reader.Varint();
+				if (start > base.devices.size() || count > base.devices.size() - start) {
+					ThrowInvalid("copy out of range");
+				}
+				target.devices.insert(target.devices.end(), base.devices.begin() + start, base.devices.begin() + start + count);
+				break;
+			}
+			case Op::Modify:
+			{
+				const uint64_t index = reader.Varint();
+				if (index >= base.devices.size()) {
+					ThrowInvalid("device index out of range");
+				}
+				DeviceResultantInfo device = base.devices[static_cast<size_t>(index)];
+				ReadFields(reader, dictionary, static_cast<uint32_t>(reader.Varint()) & AllFields, device);
+				target.devices.push_back(std::move(device));
+				break;
+			}
+			case Op::Add:
+			{
+				DeviceResultantInfo device;
+				ReadFields(reader, dictionary, AllFields, device);
+				target.devices.push_back(std::move(device));
+				break;
+			}
+			default:
+				ThrowInvalid("unknown operation");
+			}
+		}
+
+		if (reader.Remaining() != 0) {
+			ThrowInvalid("trailing data");
+		}
+		return target;
+	}
+}
@@ -0,0 +1,258 @@
+#include "pch.h"
+#include "SnapshotFile.h"
+#include "DeviceChange.h"
+#include "UtilConvert.h"
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace KDM
+{
+namespace
+{
+	using namespace SnapshotFormat;
+
+	[[noreturn]] void ThrowInvalid(const char* reason)
+	{
+		throw DeviceIoException(std::string("SnapshotFileView: ") + reason, ERROR_INVALID_DATA);
+	}
+
+	// Appends strings to the heap and returns their references
+	class StringHeap
+	{
+	public:
+		explicit StringHeap(wchar_t* units) noexcept : _units(units) {}
+
+		StringRef Add(std::wstring_view value) noexcept
+		{
+			const StringRef ref{ _used, static_cast<uint32_t>(value.size()) };
+			std::memcpy(_units + _used, value.data(), value.size() * sizeof(wchar_t));
+			_used += ref.length;
+			return ref;
+		}
+
+	private:
+		wchar_t* _units;
+		uint32_t _used = 0;
+	};
+
+	uint64_t StringUnitsOf(const DeviceResultantInfo& device) noexcept
+	{
+		return device.GetManufacturer().size() + device.GetProduct().size() + device.GetSerialNumber().size()
+			+ device.GetDescription().size() + device.GetDeviceId().size() + device.GetFriendlyName().size()
+			+ device.GetDevicePath().size() + device.GetVendorName().size() + device.GetInterfaceClassName().size();
+	}
+
+	void FillRecord(Record& record, const DeviceResultantInfo& device, StringHeap& heap) noexcept
+	{
+		record.manufacturer = heap.Add(device.GetManufacturer());
+		record.product = heap.Add(device.GetProduct());
+		record.serialNumber = heap.Add(device.GetSerialNumber());
+		record.description = heap.Add(device.GetDescription());
+		record.deviceId = heap.Add(device.GetDeviceId());
+		record.friendlyName = heap.Add(device.GetFriendlyName());
+		record.devicePath = heap.Add(device.GetDevicePath());
+		record.vendorName = heap.Add(device.GetVendorName());
+		record.interfaceClassName = heap.Add(device.GetInterfaceClassName());
+		record.setupClassGuid = device.GetSetupClassGuid();
+		record.deviceKey = DeviceKeyOf(device);
+		record.locationKey = device.GetLocationKey();
+		record.vendorId = device.GetVendorId();
+		record.productId = device.GetProductId();
+		record.deviceClass = device.GetDeviceClass();
+		record.interfaceClass = device.GetInterfaceClass();
+		record.isUsbDevice = device.IsUsbDevice() ? 1 : 0;
+		record.isConnected = device.IsConnected() ? 1 : 0;
+	}
+
+	bool IsInHeap(const StringRef& ref, uint64_t heapUnits) noexcept
+	{
+		return static_cast<uint64_t>(ref.offset) + ref.length <= heapUnits;
+	}
+
+	bool StringsAreInHeap(const Record& record, uint64_t heapUnits) noexcept
+	{
+		return IsInHeap(record.manufacturer, heapUnits) && IsInHeap(record.product, heapUnits)
+			&& IsInHeap(record.serialNumber, heapUnits) && IsInHeap(record.description, heapUnits)
+			&& IsInHeap(record.deviceId, heapUnits) && IsInHeap(record.friendlyName, heapUnits)
+			&& IsInHeap(record.devicePath, heapUnits) && IsInHeap(record.vendorName, heapUnits)
+			&& IsInHeap(record.interfaceClassName, heapUnits);
+	}
+}
+
+	std::vector<uint8_t> SnapshotFileWriter::Serialize(const DeviceSnapshot& snapshot)
+	{
+		uint64_t stringUnits = 0;
+		for (const auto& device : snapshot.devices) {
+			stringUnits += StringUnitsOf(device);
+		}
+		if (stringUnits > (std::numeric_limits<uint32_t>::max)()) {
+			throw InvalidDeviceArgumentException("SnapshotFileWriter: string heap exceeds 4G code units");
+		}
+
+		FileHeader header{};
+		header.magic = Magic;
+		header.formatVersion = FormatVersion;
+		header.headerSize = sizeof(FileHeader);
+		header.recordSize = sizeof(Record);
+		header.snapshotVersion = snapshot.version;
+		header.createdAtMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		header.deviceCount = snapshot.devices.size();
+		header.recordsOffset = sizeof(FileHeader);
+		header.stringsOffset = header.recordsOffset + header.deviceCount * sizeof(Record);
+		header.stringsSize = stringUnits * sizeof(wchar_t);
+		header.fileSize = (header.stringsOffset + header.stringsSize + 7) & ~uint64_t{ 7 };
+
+		std::vector<uint8_t> buffer(static_cast<size_t>(header.fileSize));
+		std::memcpy(buffer.data(), &header, sizeof(header));
+
+		auto* records = reinterpret_cast<Record*>(buffer.data() + header.recordsOffset);
+		StringHeap heap(reinterpret_cast<wchar_t*>(buffer.data() + header.stringsOffset));
+		for (size_t i = 0; i < snapshot.devices.size(); ++i) {
+			FillRecord(records[i], snapshot.devices[i], heap);
+		}
+		return buffer;
+	}
+
+	void SnapshotFileWriter::WriteFile(const std::wstring& path, const DeviceSnapshot& snapshot)
+	{
+		const std::vector<uint8_t> buffer = Serialize(snapshot);
+
+		const std::filesystem::path target(path);
+		std::filesystem::path temporary = target;
+		temporary += L".tmp";
+		{
+			std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+			if (!out) {
+				throw DeviceIoException("SnapshotFileWriter: cannot write " + UtilConvert::WStringToUTF8(temporary.wstring()));
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary, target, error);
+		if (error) {
+			throw DeviceIoException("SnapshotFileWriter: cannot replace " + UtilConvert::WStringToUTF8(path),
+				static_cast<DWORD>(error.value()));
+		}
+		spdlog::debug("SnapshotFileWriter: wrote {} devices ({} bytes)", snapshot.devices.size(), buffer.size());
+	}
+
+	DeviceResultantInfo SnapshotDeviceView::ToDeviceResultantInfo() const
+	{
+		DeviceResultantInfo device;
+		device.SetManufacturer(GetManufacturer());
+		device.SetProduct(GetProduct());
+		device.SetSerialNumber(GetSerialNumber());
+		device.SetDescription(GetDescription());
+		device.SetDeviceId(GetDeviceId());
+		device.SetFriendlyName(GetFriendlyName());
+		device.SetDevicePath(GetDevicePath());
+		device.SetVendorName(GetVendorName());
+		device.SetInterfaceClassName(GetInterfaceClassName());
+		device.SetSetupClassGuid(_record->setupClassGuid);
+		device.SetVendorId(static_cast<uint16_t>(_record->vendorId));     // range checked by SnapshotFileView
+		device.SetProductId(static_cast<uint16_t>(_record->productId));
+		device.SetDeviceClass(_record->deviceClass);
+		device.SetInterfaceClass(_record->interfaceClass);
+		device.SetIsUsbDevice(_record->isUsbDevice != 0);
+		device.SetIsConnected(_record->isConnected != 0);
+		device.SetLocationKey(_record->locationKey);
+		return device;
+	}
+
+	SnapshotFileView::SnapshotFileView(const void* data, size_t size)
+	{
+		if (!data || size < sizeof(FileHeader)) {
+			ThrowInvalid("too short for a header");
+		}
+		if (reinterpret_cast<uintptr_t>(data) % alignof(Record) != 0) {
+			ThrowInvalid("data is not 8-byte aligned");
+		}
+
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		_header = reinterpret_cast<const FileHeader*>(bytes);
+		if (_header->magic != Magic) {
+			ThrowInvalid("not a snapshot file");
+		}
+		if (_header->formatVersion != FormatVersion || _header->headerSize != sizeof(FileHeader)
+			|| _header->recordSize != sizeof(Record)) {
+			ThrowInvalid("unsupported format version");
+		}
+
+		// Every range must lie inside the buffer, with records before strings. Each bound is
+		// checked before it takes part in an addition, so crafted offsets cannot wrap around.
+		if (_header->fileSize > size
+			|| _header->recordsOffset < sizeof(FileHeader) || _header->recordsOffset % alignof(Record) != 0
+			|| _header->recordsOffset > _header->fileSize
+			|| _header->deviceCount > (_header->fileSize - _header->recordsOffset) / sizeof(Record)) {
+			ThrowInvalid("section out of bounds");
+		}
+		const uint64_t recordBytes = _header->deviceCount * sizeof(Record);
+		if (_header->stringsOffset < _header->recordsOffset + recordBytes
+			|| _header->stringsOffset % sizeof(wchar_t) != 0
+			|| _header->stringsSize % sizeof(wchar_t) != 0
+			|| _header->stringsOffset > _header->fileSize
+			|| _header->stringsSize > _header->fileSize - _header->stringsOffset) {
+			ThrowInvalid("section out of bounds");
+		}
+
+		_records = reinterpret_cast<const Record*>(bytes + _header->recordsOffset);
+		_strings = reinterpret_cast<const wchar_t*>(bytes + _header->stringsOffset);
+
+		const uint64_t heapUnits = _header->stringsSize / sizeof(wchar_t);
+		for (uint64_t i = 0; i < _header->deviceCount; ++i)
+		{
+			if (!StringsAreInHeap(_records[i], heapUnits)) {
+				ThrowInvalid("string reference out of bounds");
+			}
+			if (_records[i].vendorId > UINT16_MAX || _records[i].productId > UINT16_MAX) {
+				ThrowInvalid("USB ID out of range");
+			}
+		}
+	}
+
+	DeviceSnapshot SnapshotFileView::ToSnapshot() const
+	{
+		DeviceSnapshot snapshot;
+		snapshot.version = _header->snapshotVersion;
+		snapshot.devices.reserve(size());
+		for (size_t i = 0; i < size(); ++i) {
+			snapshot.devices.push_back((*this)[i].ToDeviceResultantInfo());
+		}
+		return snapshot;
+	}
+
+	SnapshotFileReader::SnapshotFileReader(const std::wstring& path)
+	{
+		_file.reset(CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+		if (!_file) {
+			throw DeviceIoException("SnapshotFileReader: cannot open " + UtilConvert::WStringToUTF8(path), GetLastError());
+		}
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(_file.get(), &fileSize)) {
+			throw DeviceIoException("SnapshotFileReader: GetFileSizeEx failed", GetLastError());
+		}
+		if (static_cast<uint64_t>(fileSize.QuadPart) < sizeof(FileHeader)) {
+			ThrowInvalid("too short for a header");
+		}
+
+		_mapping.reset(CreateFileMappingW(_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+		if (!_mapping) {
+			throw DeviceIoException("SnapshotFileReader: CreateFileMappingW failed", GetLastError());
+		}
+
+		_data.reset(MapViewOfFile(_mapping.get(), FILE_MAP_READ, 0, 0, 0));
+		if (!_data) {
+			throw DeviceIoException("SnapshotFileReader: MapViewOfFile failed", GetLastError());
+		}
+
+		_view.emplace(_data.get(), static_cast<size_t>(fileSize.QuadPart));
+	}
+}
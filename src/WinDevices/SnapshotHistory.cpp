@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "SnapshotHistory.h"
+#include "DeviceChange.h"
+#include <algorithm>
+
+namespace KDM
+{
+namespace
+{
+	// Node of the record map: the value, its key and the links of a typical implementation
+	constexpr size_t RecordNodeOverhead = sizeof(uint64_t) + 2 * sizeof(void*);
+
+	size_t StringBytes(const DeviceResultantInfo& device) noexcept
+	{
+		const size_t characters = device.GetManufacturer().size() + device.GetProduct().size() +
+			device.GetSerialNumber().size() + device.GetDescription().size() + device.GetDeviceId().size() +
+			device.GetFriendlyName().size() + device.GetDevicePath().size() + device.GetVendorName().size() +
+			device.GetInterfaceClassName().size();
+		return characters == 0 ? 0 : (characters + 1) * sizeof(wchar_t);
+	}
+}
+
+	SnapshotHistory::SnapshotHistory(SnapshotHistoryPolicy policy)
+		: _policy{ policy }
+	{
+	}
+
+	bool SnapshotHistory::Add(const DeviceSnapshot& snapshot)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_entries.empty() && snapshot.version <= _entries.back().version) {
+			return false;
+		}
+
+		Entry entry;
+		entry.version = snapshot.version;
+		entry.publishedAt = snapshot.publishedAt;
+		entry.topology = snapshot.topology;
+		entry.devices.reserve(snapshot.devices.size());
+		try {
+			for (const auto& device : snapshot.devices) {
+				entry.devices.push_back(Intern(device));
+			}
+		}
+		catch (...) {
+			for (Record* record : entry.devices) {
+				Release(record);
+			}
+			throw;
+		}
+
+		entry.bytes = sizeof(Entry) + entry.devices.capacity() * sizeof(Record*) +
+			entry.topology.size() * sizeof(UsbTopologyNode);
+		_bytes += entry.bytes;
+		_deviceReferences += entry.devices.size();
+		_entries.push_back(std::move(entry));
+
+		EvictLocked();
+		return true;
+	}
+
+	DeviceSnapshotPtr SnapshotHistory::Get(uint64_t version) const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		const auto it = std::lower_bound(_entries.begin(), _entries.end(), version,
+			[](const Entry& entry, uint64_t wanted) { return entry.version < wanted; });
+		if (it == _entries.end() || it->version != version) {
+			return nullptr;
+		}
+
+		auto snapshot = std::make_shared<DeviceSnapshot>();
+		snapshot->version = it->version;
+		snapshot->publishedAt = it->publishedAt;
+		snapshot->topology = it->topology;
+		snapshot->devices.reserve(it->devices.size());
+		for (const Record* record : it->devices) {
+			snapshot->devices.push_back(record->device);
+		}
+		return snapshot;
+	}
+
+	std::vector<uint64_t> SnapshotHistory::GetVersions() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		std::vector<uint64_t> versions;
+		versions.reserve(_entries.size());
+		for (const auto& entry : _entries) {
+			versions.push_back(entry.version);
+		}
+		return versions;
+	}
+
+	SnapshotHistoryFootprint SnapshotHistory::GetFootprint() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		SnapshotHistoryFootprint footprint;
+		footprint.snapshots = _entries.size();
+		footprint.deviceReferences = _deviceReferences;
+		footprint.uniqueDevices = _records.size();
+		footprint.bytes = _bytes;
+		footprint.evictedSnapshots = _evicted;
+
+		// Each snapshot as a plain DeviceSnapshot: a vector of records instead of references
+		for (const auto& entry : _entries) {
+			footprint.topologyNodes += entry.topology.size();
+			footprint.bytesWithoutSharing += entry.bytes - entry.devices.capacity() * sizeof(Record*);
+			for (const Record* record : entry.devices) {
+				footprint.bytesWithoutSharing += sizeof(DeviceResultantInfo) + record->stringBytes;
+			}
+		}
+		return footprint;
+	}
+
+	void SnapshotHistory::SetPolicy(SnapshotHistoryPolicy policy)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_policy = policy;
+		EvictLocked();
+	}
+
+	void SnapshotHistory::Clear()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_evicted += _entries.size();
+		_entries.clear();
+		_records.clear();
+		_bytes = 0;
+		_deviceReferences = 0;
+	}
+
+	// Returns the stored record equal to device, copying device in if there is none
+	SnapshotHistory::Record* SnapshotHistory::Intern(const DeviceResultantInfo& device)
+	{
+		const uint64_t hash = DeviceContentHashOf(device);
+		auto [first, last] = _records.equal_range(hash);
+		for (auto it = first; it != last; ++it) {
+			if (it->second.device == device) {
+				++it->second.references;
+				return &it->second;
+			}
+		}
+
+		// The copy uses the default resource, detaching the record from the snapshot's arena
+		auto it = _records.emplace(hash, Record{ device, 1, StringBytes(device), hash });
+		_bytes += sizeof(Record) + RecordNodeOverhead + it->second.stringBytes;
+		return &it->second;
+	}
+
+	void SnapshotHistory::Release(Record* record) noexcept
+	{
+		if (--record->references > 0) {
+			return;
+		}
+
+		_bytes -= sizeof(Record) + RecordNodeOverhead + record->stringBytes;
+		auto [first, last] = _records.equal_range(record->hash);
+		for (auto it = first; it != last; ++it) {
+			if (&it->second == record) {
+				_records.erase(it);
+				return;
+			}
+		}
+	}
+
+	void SnapshotHistory::EvictLocked()
+	{
+		auto exceeded = [this] {
+			return (_policy.byteBudget != 0 && _bytes > _policy.byteBudget) ||
+				(_policy.maxSnapshots != 0 && _entries.size() > _policy.maxSnapshots);
+		};
+
+		while (_entries.size() > 1 && exceeded()) {
+			Entry& oldest = _entries.front();
+			for (Record* record : oldest.devices) {
+				Release(record);
+			}
+			_bytes -= oldest.bytes;
+			_deviceReferences -= oldest.devices.size();
+			_entries.pop_front();
+			++_evicted;
+		}
+	}
+}
@@ -0,0 +1,246 @@
+#include "pch.h"
+#include "TopologyExporter.h"
+#include "EnumerationOptions.h"
+#include "UsbLocation.h"
+
+namespace KDM
+{
+namespace
+{
+	std::string_view KindName(UsbTopologyNodeKind kind) noexcept
+	{
+		switch (kind)
+		{
+		case UsbTopologyNodeKind::Controller: return "controller";
+		case UsbTopologyNodeKind::Hub: return "hub";
+		case UsbTopologyNodeKind::Port: return "port";
+		case UsbTopologyNodeKind::Device:
+		default: return "device";
+		}
+	}
+
+	// USB_DEVICE_SPEED as reported in the port's connection information
+	std::string_view SpeedName(uint8_t speed) noexcept
+	{
+		switch (speed)
+		{
+		case UsbLowSpeed: return "low";
+		case UsbFullSpeed: return "full";
+		case UsbHighSpeed: return "high";
+		case UsbSuperSpeed: return "super";
+		default: return "unknown";
+		}
+	}
+
+	bool IsAttached(UsbTopologyNodeKind kind) noexcept
+	{
+		return kind == UsbTopologyNodeKind::Hub || kind == UsbTopologyNodeKind::Device;
+	}
+}
+
+	TopologyExporter::TopologyExporter(JsonSink sink, TopologyFormat format, size_t bufferSize)
+		: _writer(std::move(sink), bufferSize, "TopologyExporter"), _format(format)
+	{
+	}
+
+	void TopologyExporter::Write(const DeviceSnapshot& snapshot)
+	{
+		Write(snapshot.topology, &snapshot.devices);
+	}
+
+	void TopologyExporter::Write(const UsbTopology& topology)
+	{
+		Write(topology, nullptr);
+	}
+
+	void TopologyExporter::Write(const UsbTopology& topology, const std::vector<DeviceResultantInfo>* devices)
+	{
+		_writer.Raw(_format == TopologyFormat::Dot
+			? "digraph usb {\n  rankdir=LR;\n  node [fontname=\"Helvetica\",fontsize=10];\n"
+			: "{\"nodes\":[");
+
+		for (uint32_t node = 0; node < topology.size(); ++node)
+		{
+			const uint32_t deviceIndex = topology[node].deviceIndex;
+			const DeviceResultantInfo* device = devices && deviceIndex < devices->size() ? &(*devices)[deviceIndex] : nullptr;
+
+			if (_format == TopologyFormat::Dot)
+			{
+				WriteDotNode(topology, node, device);
+				continue;
+			}
+			if (node > 0) {
+				_writer.Char(',');
+			}
+			WriteJsonNode(topology, node, device);
+		}
+
+		_writer.Raw(_format == TopologyFormat::Dot ? "}\n" : "]}");
+	}
+
+	// Statement for the node and one for the edge from its parent
+	void TopologyExporter::WriteDotNode(const UsbTopology& topology, uint32_t node, const DeviceResultantInfo* device)
+	{
+		const UsbTopologyNode& info = topology[node];
+
+		_writer.Raw("  n");
+		_writer.Unsigned(node);
+		switch (info.kind)
+		{
+		case UsbTopologyNodeKind::Controller:
+			_writer.Raw(" [shape=doubleoctagon,label=\"Controller ");
+			_writer.Unsigned(UsbLocation::ControllerOf(info.locationKey));
+			break;
+		case UsbTopologyNodeKind::Port:
+			_writer.Raw(topology.GetFirstChild(node) == UsbTopology::NoNode
+				? " [shape=circle,style=dashed,label=\"" : " [shape=circle,label=\"");
+			_writer.Unsigned(info.portNumber);
+			break;
+		case UsbTopologyNodeKind::Hub:
+		case UsbTopologyNodeKind::Device:
+		default:
+			_writer.Raw(info.kind == UsbTopologyNodeKind::Hub ? " [shape=box3d,label=\"" : " [shape=box,label=\"");
+			if (device && !device->GetProduct().empty())
+			{
+				_writer.DotLabel(device->GetProduct());
+				_writer.Raw("\\n");
+			}
+			if (info.kind == UsbTopologyNodeKind::Hub && info.parent != UsbTopology::NoNode &&
+				topology[info.parent].kind == UsbTopologyNodeKind::Controller)
+			{
+				_writer.Raw("Root hub");
+			}
+			else
+			{
+				_writer.Hex(info.vendorId, 4);
+				_writer.Char(':');
+				_writer.Hex(info.productId, 4);
+				_writer.Raw(" class 0x");
+				_writer.Hex(info.deviceClass, 2);
+				_writer.Raw("\\n");
+				_writer.Location(info.locationKey);
+				_writer.Raw(", ");
+				_writer.Raw(SpeedName(info.speed));
+				_writer.Raw(" speed, ");
+				_writer.Unsigned(info.openPipes);
+				_writer.Raw(" pipes");
+			}
+			if (info.kind == UsbTopologyNodeKind::Hub)
+			{
+				const PortUsage ports = PortsOf(topology, node);
+				_writer.Raw("\\n");
+				_writer.Unsigned(ports.inUse);
+				_writer.Char('/');
+				_writer.Unsigned(ports.total);
+				_writer.Raw(" ports in use");
+			}
+			break;
+		}
+		_writer.Raw("\"];\n");
+
+		if (info.parent != UsbTopology::NoNode)
+		{
+			_writer.Raw("  n");
+			_writer.Unsigned(info.parent);
+			_writer.Raw(" -> n");
+			_writer.Unsigned(node);
+			_writer.Raw(";\n");
+		}
+	}
+
+	void TopologyExporter::WriteJsonNode(const UsbTopology& topology, uint32_t node, const DeviceResultantInfo* device)
+	{
+		const UsbTopologyNode& info = topology[node];
+
+		_writer.Raw("{\"id\":");
+		_writer.Unsigned(node);
+		_writer.Raw(",\"kind\":\"");
+		_writer.Raw(KindName(info.kind));
+		_writer.Raw("\",\"parent\":");
+		if (info.parent == UsbTopology::NoNode) {
+			_writer.Raw("null");
+		}
+		else {
+			_writer.Unsigned(info.parent);
+		}
+
+		_writer.Raw(",\"children\":[");
+		for (uint32_t child = topology.GetFirstChild(node); child != UsbTopology::NoNode; child = topology.GetNextSibling(child))
+		{
+			if (child != node + 1) {
+				_writer.Char(',');
+			}
+			_writer.Unsigned(child);
+		}
+		_writer.Raw("],\"location\":\"");
+		_writer.Location(info.locationKey);
+		_writer.Raw("\",\"hubDepth\":");
+		_writer.Unsigned(info.hubDepth);
+
+		if (info.kind == UsbTopologyNodeKind::Port || (IsAttached(info.kind) && info.portNumber != 0))
+		{
+			_writer.Raw(",\"port\":");
+			_writer.Unsigned(info.portNumber);
+		}
+
+		if (IsAttached(info.kind) && info.portNumber != 0)
+		{
+			_writer.Raw(",\"vendorId\":");
+			_writer.Unsigned(info.vendorId);
+			_writer.Raw(",\"productId\":");
+			_writer.Unsigned(info.productId);
+			_writer.Raw(",\"deviceClass\":");
+			_writer.Unsigned(info.deviceClass);
+			_writer.Raw(",\"speed\":\"");
+			_writer.Raw(SpeedName(info.speed));
+			_writer.Raw("\",\"openPipes\":");
+			_writer.Unsigned(info.openPipes);
+			_writer.Raw(",\"address\":");
+			_writer.Unsigned(info.deviceAddress);
+			_writer.Raw(",\"match\":\"");
+			_writer.Raw(CorrelationRuleToString(static_cast<CorrelationRule>(info.correlation)));
+			_writer.Char('"');
+		}
+
+		if (info.kind == UsbTopologyNodeKind::Hub)
+		{
+			const PortUsage ports = PortsOf(topology, node);
+			_writer.Raw(",\"portsTotal\":");
+			_writer.Unsigned(ports.total);
+			_writer.Raw(",\"portsInUse\":");
+			_writer.Unsigned(ports.inUse);
+			_writer.Raw(",\"path\":");
+			_writer.String(info.path);
+		}
+
+		if (info.deviceIndex != UsbTopology::NoNode)
+		{
+			_writer.Raw(",\"deviceIndex\":");
+			_writer.Unsigned(info.deviceIndex);
+		}
+		if (device)
+		{
+			_writer.Raw(",\"product\":");
+			_writer.String(device->GetProduct());
+		}
+		_writer.Char('}');
+	}
+
+	TopologyExporter::PortUsage TopologyExporter::PortsOf(const UsbTopology& topology, uint32_t hub) noexcept
+	{
+		PortUsage usage;
+		for (uint32_t port = topology.GetFirstChild(hub); port != UsbTopology::NoNode; port = topology.GetNextSibling(port))
+		{
+			++usage.total;
+			if (topology.GetFirstChild(port) != UsbTopology::NoNode) {
+				++usage.inUse;
+			}
+		}
+		return usage;
+	}
+
+	void TopologyExporter::Flush()
+	{
+		_writer.Flush();
+	}
+}
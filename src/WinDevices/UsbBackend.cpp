@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "UsbBackend.h"
+#include "DevInfoData.h"
+#include "DeviceEnumerator.h"
+#include "DeviceInfo.h"
+#include "DeviceCommunication.h"
+#include "UsbHostController.h"
+#include "UtilConvert.h"
+#include <spdlog/spdlog.h>
+
+namespace KDM
+{
+	UsbBackend::UsbBackend() = default;
+	UsbBackend::~UsbBackend() = default;
+	UsbBackend::UsbBackend(UsbBackend&&) noexcept = default;
+	UsbBackend& UsbBackend::operator=(UsbBackend&&) noexcept = default;
+
+	std::vector<DevInfoData> UsbBackend::GetDeviceInstances()
+	{
+		// Keep the enumerator alive: GetHubDevicePath() needs its HDEVINFO
+		_allDevicesEnumerator = std::make_unique<DeviceEnumerator>(
+			GUID_DEVINTERFACE_USB_DEVICE,
+			DIGCF_ALLCLASSES | DIGCF_DEVICEINTERFACE | DIGCF_PRESENT);
+
+		return _allDevicesEnumerator->GetDeviceInstances();
+	}
+
+	std::vector<std::wstring> UsbBackend::GetRootHubPaths()
+	{
+		DeviceEnumerator controllerEnumerator(
+			GUID_CLASS_USB_HOST_CONTROLLER,
+			DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+
+		auto controllers = controllerEnumerator.GetDeviceInstances();
+		spdlog::info("UsbBackend: Found {} USB host controller(s)", controllers.size());
+
+		std::vector<std::wstring> rootHubPaths;
+		rootHubPaths.reserve(controllers.size());
+
+		for (auto& controller : controllers)
+		{
+			DeviceInfo deviceInfo{ controllerEnumerator.GetDevInfoSet(), controller.GetDevInfoData() };
+			deviceInfo.PopulateUsbControllerInfo();
+
+			std::wstring devicePath = deviceInfo.GetDevicePath();
+			DeviceCommunication deviceCommunication(devicePath);
+			UsbHostController hostController(devicePath, deviceCommunication);
+
+			hostController.PopulateInfo();
+
+			std::wstring rootHubPath = L"\\\\.\\" + hostController.GetRootHubName();
+			spdlog::info("Root hub device: {}", UtilConvert::WStringToUTF8(rootHubPath));
+
+			rootHubPaths.push_back(std::move(rootHubPath));
+		}
+
+		return rootHubPaths;
+	}
+
+	std::unique_ptr<IDeviceCommunication> UsbBackend::OpenHub(const std::wstring& hubPath)
+	{
+		return std::make_unique<DeviceCommunication>(hubPath);
+	}
+
+	std::wstring UsbBackend::GetHubDevicePath(const DevInfoData& hubDevice)
+	{
+		THROW_HR_IF_MSG(E_UNEXPECTED, !_allDevicesEnumerator,
+			"UsbBackend::GetHubDevicePath: GetDeviceInstances() was not called");
+
+		DeviceInfo deviceInfo{ _allDevicesEnumerator->GetDevInfoSet(), hubDevice.GetDevInfoData() };
+		deviceInfo.PopulateUsbInfo();
+		return deviceInfo.GetDevicePath();
+	}
+}
@@ -6,9 +6,9 @@ void UsbDeviceDescriptorInfo::SetUsbDeviceInfo(std::wstring manufacturer,
 	std::wstring product,
 	std::wstring serialNumber)
 {
-	_manufacturer = manufacturer;
-	_product = product;
-	_serialNumber = serialNumber;
+	_manufacturer = std::move(manufacturer);
+	_product = std::move(product);
+	_serialNumber = std::move(serialNumber);
 }
 
 
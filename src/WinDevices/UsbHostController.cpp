@@ -29,14 +29,13 @@ namespace KDM
 		// usbControllerInfo.Header.UsbUserRequest = RequestType;
 		usbControllerInfo.Header.RequestBufferLength = sizeof(usbControllerInfo);
 
-		result = DeviceIoControl(_deviceCommunication.GetFileHandle(),
+		result = _deviceCommunication.Ioctl(
 			IOCTL_USB_USER_REQUEST,
 			&usbControllerInfo,
 			sizeof(usbControllerInfo),
 			&usbControllerInfo,
 			sizeof(usbControllerInfo),
-			&neededSize,
-			nullptr);
+			&neededSize);
 
 		THROW_HR_IF_MSG(HRESULT_FROM_WIN32(GetLastError()),
 			!result, "UsbHostController::PopulateInfo, DeviceIoControl");
@@ -50,12 +49,12 @@ namespace KDM
 		_pciRevision = usbControllerInfo.Info0.PciRevision;
 
 		// get info about root hub name
-		_rootHubName = GetRootHubNameByHandle(_deviceCommunication.GetFileHandle());
-		_driverKeyName = GetDriverKeyName(_deviceCommunication.GetFileHandle());
+		_rootHubName = GetRootHubNameByHandle(_deviceCommunication);
+		_driverKeyName = GetDriverKeyName(_deviceCommunication);
 	}
 
 
-	std::wstring UsbHostController::GetRootHubNameByHandle(HANDLE HostController)
+	std::wstring UsbHostController::GetRootHubNameByHandle(DeviceCommunication& hostController)
 	{
 		BOOL result = FALSE;
 		USB_ROOT_HUB_NAME   rootHubName = { 0 };
@@ -65,14 +64,13 @@ namespace KDM
 		//DWORD lastErrorCode;
 
 
-		result = DeviceIoControl(HostController,
+		result = hostController.Ioctl(
 			IOCTL_USB_GET_ROOT_HUB_NAME,
 			0,
 			0,
 			&rootHubName,
 			sizeof(rootHubName),
-			&requiredSize,
-			nullptr);
+			&requiredSize);
 
 
 		THROW_HR_IF_MSG(HRESULT_FROM_WIN32(GetLastError()),
@@ -84,14 +82,13 @@ namespace KDM
 		auto bufferPtr = std::make_unique < BYTE[] >(requiredSize);
 		auto pBuffer = bufferPtr.get();
 
-		result = DeviceIoControl(HostController,
+		result = hostController.Ioctl(
 			IOCTL_USB_GET_ROOT_HUB_NAME,
 			nullptr,
 			0,
 			pBuffer,
 			requiredSize,
-			&requiredSize,
-			nullptr);
+			&requiredSize);
 
 		THROW_HR_IF_MSG(HRESULT_FROM_WIN32(GetLastError()),
 			!result, "UsbHostController::GetRootHubName, DeviceIoControl");
@@ -106,7 +103,7 @@ namespace KDM
 
 	}
 
-	std::wstring UsbHostController::GetDriverKeyName(HANDLE hFile)
+	std::wstring UsbHostController::GetDriverKeyName(DeviceCommunication& hostController)
 	{
 		USB_HCD_DRIVERKEY_NAME  driverKeyName = { 0 };
 		PUSB_HCD_DRIVERKEY_NAME pDriverKeyName = nullptr;
@@ -117,14 +114,13 @@ namespace KDM
 
 		ZeroMemory(&driverKeyName, sizeof(driverKeyName));
 
-		result = DeviceIoControl(hFile,
+		result = hostController.Ioctl(
 			IOCTL_GET_HCD_DRIVERKEY_NAME,
 			&driverKeyName,
 			sizeof(driverKeyName),
 			&driverKeyName,
 			sizeof(driverKeyName),
-			&neededSize,
-			nullptr);
+			&neededSize);
 
 		THROW_HR_IF_MSG(HRESULT_FROM_WIN32(GetLastError()),
 			!result, "UsbHostController::GetDriverKeyName, DeviceIoControl");
@@ -142,14 +138,13 @@ namespace KDM
 		pDriverKeyName = reinterpret_cast<PUSB_HCD_DRIVERKEY_NAME>(driverKeyNamePtr.get());
 
 
-		result = DeviceIoControl(hFile,
+		result = hostController.Ioctl(
 			IOCTL_GET_HCD_DRIVERKEY_NAME,
 			pDriverKeyName,
 			neededSize,
 			pDriverKeyName,
 			neededSize,
-			&neededSize,
-			nullptr);
+			&neededSize);
 
 		THROW_HR_IF_MSG(HRESULT_FROM_WIN32(GetLastError()),
 			!result, "UsbHostController::GetDriverKeyName, DeviceIoControl");
@@ -91,6 +91,11 @@ namespace KDM
 		return _pDeviceCommunication.get();
 	}
 
+	ULONG UsbHub::GetNumberOfPorts() const noexcept
+	{
+		return _numberOfPorts;
+	}
+
 	/// <summary>
 	/// Fills configuration descriptor for a USB device.
 	/// Uses smart pointers for automatic memory management.
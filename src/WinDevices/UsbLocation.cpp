@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "UsbLocation.h"
+
+namespace KDM
+{
+namespace
+{
+	// Reads a decimal number in [1, max] from the front of text; 0 if there is none
+	uint32_t TakeNumber(std::wstring_view& text, uint32_t max) noexcept
+	{
+		uint32_t value = 0;
+		size_t digits = 0;
+		while (digits < text.size() && text[digits] >= L'0' && text[digits] <= L'9')
+		{
+			value = value * 10 + static_cast<uint32_t>(text[digits] - L'0');
+			if (value > max) {
+				return 0;
+			}
+			++digits;
+		}
+		text.remove_prefix(digits);
+		return value;
+	}
+}
+
+	std::wstring UsbLocation::Format(uint64_t location)
+	{
+		if (location == Unknown) {
+			return {};
+		}
+
+		std::wstring text = std::to_wstring(ControllerOf(location));
+		const uint32_t length = ChainLength(location);
+		for (uint32_t i = 0; i < length; ++i)
+		{
+			text += i == 0 ? L'-' : L'.';
+			text += std::to_wstring(PortAt(location, i));
+		}
+		return text;
+	}
+
+	uint64_t UsbLocation::Parse(std::wstring_view text) noexcept
+	{
+		uint64_t location = ForController(TakeNumber(text, MaxControllers));
+		if (location == Unknown) {
+			return Unknown;
+		}
+
+		for (wchar_t separator = L'-'; !text.empty(); separator = L'.')
+		{
+			if (text.front() != separator) {
+				return Unknown;
+			}
+			text.remove_prefix(1);
+
+			location = AppendPort(location, TakeNumber(text, MaxPorts));
+			if (location == Unknown) {
+				return Unknown;
+			}
+		}
+		return location;
+	}
+}
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "UsbTopology.h"
+#include "UsbLocation.h"
+
+namespace KDM
+{
+	uint32_t UsbTopology::Add(UsbTopologyNode node)
+	{
+		const auto index = static_cast<uint32_t>(_nodes.size());
+
+		// Only the last node and its ancestors still end at the current size
+		if (node.parent != NoNode && (node.parent >= index || _nodes[node.parent].subtreeEnd != index)) {
+			throw InvalidDeviceArgumentException("UsbTopology::Add: parent must be the last node or one of its ancestors");
+		}
+
+		node.subtreeEnd = index + 1;
+		node.hubDepth = static_cast<uint8_t>((node.parent != NoNode ? _nodes[node.parent].hubDepth : 0) +
+			(node.kind == UsbTopologyNodeKind::Hub ? 1 : 0));
+		node.deviceIndex = NoNode;
+		node.locationKey = LocationOf(node);
+		if (node.kind == UsbTopologyNodeKind::Controller) {
+			++_controllerCount;
+		}
+		if ((node.kind == UsbTopologyNodeKind::Hub || node.kind == UsbTopologyNodeKind::Device) &&
+			node.locationKey != UsbLocation::Unknown)
+		{
+			_locationNodes.insert_or_assign(node.locationKey, index);
+		}
+		_nodes.push_back(std::move(node));
+
+		for (uint32_t ancestor = _nodes[index].parent; ancestor != NoNode; ancestor = _nodes[ancestor].parent) {
+			_nodes[ancestor].subtreeEnd = index + 1;
+		}
+		return index;
+	}
+
+	void UsbTopology::SetDeviceIndex(uint32_t node, uint32_t deviceIndex)
+	{
+		if (node >= _nodes.size()) {
+			throw InvalidDeviceArgumentException("UsbTopology::SetDeviceIndex: node out of range");
+		}
+
+		if (const uint32_t previous = _nodes[node].deviceIndex; previous != NoNode) {
+			_deviceNodes[previous] = NoNode;
+		}
+		if (deviceIndex != NoNode)
+		{
+			if (deviceIndex >= _deviceNodes.size()) {
+				_deviceNodes.resize(static_cast<size_t>(deviceIndex) + 1, NoNode);
+			}
+			_deviceNodes[deviceIndex] = node;
+		}
+		_nodes[node].deviceIndex = deviceIndex;
+	}
+
+	uint32_t UsbTopology::GetNextSibling(uint32_t node) const noexcept
+	{
+		const uint32_t next = _nodes[node].subtreeEnd;
+		const uint32_t parent = _nodes[node].parent;
+		const uint32_t limit = parent != NoNode ? _nodes[parent].subtreeEnd : static_cast<uint32_t>(_nodes.size());
+		return next < limit ? next : NoNode;
+	}
+
+	// A port extends its hub's chain; everything else shares the location of its parent
+	uint64_t UsbTopology::LocationOf(const UsbTopologyNode& node) const noexcept
+	{
+		if (node.parent == NoNode) {
+			return node.kind == UsbTopologyNodeKind::Controller ? UsbLocation::ForController(_controllerCount + 1) : UsbLocation::Unknown;
+		}
+
+		const uint64_t parentLocation = _nodes[node.parent].locationKey;
+		return node.kind == UsbTopologyNodeKind::Port ? UsbLocation::AppendPort(parentLocation, node.portNumber) : parentLocation;
+	}
+
+	void UsbTopology::Clear() noexcept
+	{
+		_nodes.clear();
+		_deviceNodes.clear();
+		_locationNodes.clear();
+		_controllerCount = 0;
+	}
+}
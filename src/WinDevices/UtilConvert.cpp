@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "UtilConvert.h"
 #include "UsbClassCodes.h"
+#include "HexFormat.h"
 
 namespace KDM
 {
@@ -43,20 +44,9 @@ namespace KDM
 	/// <returns></returns>
 	std::wstring UtilConvert::GetHexIdAsString(USHORT Value, USHORT BytesNumber)
 	{
-		WCHAR buff[16] = { 0 };
-
-		std::wstring test = L"0x%0" + std::to_wstring(BytesNumber) + L"x";
-		auto res = swprintf_s(buff, ARRAYSIZE(buff), test.c_str(), Value);
-
-
-		if (res < 0)
-		{
-			THROW_HR(E_INVALIDARG);
-		}
-
-		return std::wstring(buff);
-
+		THROW_HR_IF(E_INVALIDARG, BytesNumber > HexFormat::MaxIdDigits);
 
+		return std::wstring(HexFormat::Id(Value, BytesNumber).view());
 	}
 
 	std::wstring UtilConvert::GetBaseClassById(USHORT value)
@@ -9,26 +9,94 @@
 #include "DeviceInfo.h"
 #include "UtilConvert.h"
 #include "UsbClassCodes.h"
+#include "AllocationProfiler.h"
+#include "DeviceEventRing.h"
+#include "HexFormat.h"
+#include "JsonExporter.h"
+#include "TopologyExporter.h"
+#include "SharedInventory.h"
 #include <spdlog/spdlog.h>
 #include <memory>
 #include <vector>
 #include <string>
 #include <cstring>
+#include <chrono>
+#include <list>
+#include <atomic>
+#include <mutex>
 
 #define API_VERSION_MAJOR 1
 #define API_VERSION_MINOR 0
 #define API_VERSION_PATCH 0
 #define API_BUILD_DATE __DATE__
 
-/* Internal device manager wrapper */
+using SkippedListPtr = std::shared_ptr<const std::vector<KDM::SkippedNode>>;
+
+/* Internal device manager wrapper.
+ * Results are immutable snapshots swapped atomically, so WD_GetDeviceCount/WD_GetDeviceInfo
+ * can run on other threads while an enumeration is in progress; they see the last
+ * completed result. A filtered result is a snapshot of its own with the version of the
+ * manager snapshot it was taken from. */
 struct DeviceManagerWrapper {
     std::unique_ptr<KDM::DevicesManager> manager;
-    std::vector<DeviceResultantInfo> devices;
+    std::unique_ptr<KDM::DeviceEventSubscriber> events;     /* declared after manager: released first */
+    KDM::DeviceSnapshotPtr snapshot = std::make_shared<const KDM::DeviceSnapshot>();
+    SkippedListPtr skippedNodes = std::make_shared<const std::vector<KDM::SkippedNode>>();
+    std::mutex cancellationMutex;       /* guards runningCalls */
+    std::list<KDM::CancellationToken> runningCalls;     /* one per running WD_EnumerateUsbDevicesEx */
+    std::mutex lastErrorMutex;          /* guards lastError */
     std::string lastError;
-    unsigned int vendorIdFilter = 0;
-    unsigned int deviceClassFilter = 0;
+    std::atomic<unsigned int> vendorIdFilter{ 0 };
+    std::atomic<unsigned int> deviceClassFilter{ 0 };
+};
+
+static KDM::DeviceSnapshotPtr LoadSnapshot(const DeviceManagerWrapper* wrapper) {
+    return std::atomic_load_explicit(&wrapper->snapshot, std::memory_order_acquire);
+}
+
+static void PublishSnapshot(DeviceManagerWrapper* wrapper, KDM::DeviceSnapshotPtr snapshot) {
+    std::atomic_store_explicit(&wrapper->snapshot, std::move(snapshot), std::memory_order_release);
+}
+
+static SkippedListPtr LoadSkippedNodes(const DeviceManagerWrapper* wrapper) {
+    return std::atomic_load_explicit(&wrapper->skippedNodes, std::memory_order_acquire);
+}
+
+static void PublishSkippedNodes(DeviceManagerWrapper* wrapper, std::vector<KDM::SkippedNode> skippedNodes) {
+    std::atomic_store_explicit(&wrapper->skippedNodes,
+        SkippedListPtr(std::make_shared<const std::vector<KDM::SkippedNode>>(std::move(skippedNodes))),
+        std::memory_order_release);
+}
+
+/* Fresh cancellation token of one WD_EnumerateUsbDevicesEx call, registered for
+ * WD_CancelEnumeration while the call runs */
+class CallCancellation {
+public:
+    explicit CallCancellation(DeviceManagerWrapper* wrapper) : wrapper_(wrapper) {
+        std::lock_guard<std::mutex> lock(wrapper_->cancellationMutex);
+        entry_ = wrapper_->runningCalls.emplace(wrapper_->runningCalls.end());
+    }
+
+    ~CallCancellation() {
+        std::lock_guard<std::mutex> lock(wrapper_->cancellationMutex);
+        wrapper_->runningCalls.erase(entry_);
+    }
+
+    CallCancellation(const CallCancellation&) = delete;
+    CallCancellation& operator=(const CallCancellation&) = delete;
+
+    const KDM::CancellationToken& Token() const { return *entry_; }
+
+private:
+    DeviceManagerWrapper* wrapper_;
+    std::list<KDM::CancellationToken>::iterator entry_;
 };
 
+static void SetWrapperError(DeviceManagerWrapper* wrapper, std::string message) {
+    std::lock_guard<std::mutex> lock(wrapper->lastErrorMutex);
+    wrapper->lastError = std::move(message);
+}
+
 /* Helper function to safely copy string to fixed buffer */
 static void SafeStrCopy(char* dest, size_t destSize, const std::string& src) {
     if (dest && destSize > 0) {
@@ -38,13 +106,13 @@ static void SafeStrCopy(char* dest, size_t destSize, const std::string& src) {
     }
 }
 
-static void SafeStrCopy(char* dest, size_t destSize, const std::wstring& src) {
+static void SafeStrCopy(char* dest, size_t destSize, std::wstring_view src) {
     if (dest && destSize > 0) {
         // Convert wide string to narrow string
-        int size_needed = WideCharToMultiByte(CP_UTF8, 0, src.c_str(), (int)src.length(), NULL, 0, NULL, NULL);
+        int size_needed = WideCharToMultiByte(CP_UTF8, 0, src.data(), (int)src.length(), NULL, 0, NULL, NULL);
         if (size_needed > 0) {
             size_t copyLen = (std::min)((size_t)size_needed, destSize - 1);
-            WideCharToMultiByte(CP_UTF8, 0, src.c_str(), (int)src.length(), dest, (int)copyLen, NULL, NULL);
+            WideCharToMultiByte(CP_UTF8, 0, src.data(), (int)src.length(), dest, (int)copyLen, NULL, NULL);
             dest[copyLen] = '\0';
         } else {
             dest[0] = '\0';
@@ -52,11 +120,88 @@ static void SafeStrCopy(char* dest, size_t destSize, const std::wstring& src) {
     }
 }
 
+/* Map a C++ skip reason to its C API value */
+static WD_SKIP_REASON ToSkipReason(KDM::SkipReason reason) {
+    switch (reason) {
+    case KDM::SkipReason::Cancelled: return WD_SKIP_CANCELLED;
+    case KDM::SkipReason::HubFailed: return WD_SKIP_HUB_FAILED;
+    case KDM::SkipReason::CircuitOpen: return WD_SKIP_CIRCUIT_OPEN;
+    case KDM::SkipReason::TimedOut:
+    default: return WD_SKIP_TIMED_OUT;
+    }
+}
+
+/* Result of a USB scan; a timeout or cancellation takes precedence over failed hubs */
+static WD_RESULT ToEnumResult(const KDM::EnumerationStatus& status) {
+    if (status.cancelled) {
+        return WD_ERROR_CANCELLED;
+    }
+    if (status.timedOut) {
+        return WD_ERROR_TIMEOUT;
+    }
+    return status.IsComplete() ? WD_SUCCESS : WD_ERROR_PARTIAL;
+}
+
+/* Map a C++ device event type to its C API value */
+static WD_EVENT_TYPE ToEventType(KDM::DeviceEventType type) {
+    switch (type) {
+    case KDM::DeviceEventType::Removed: return WD_EVENT_REMOVED;
+    case KDM::DeviceEventType::Changed: return WD_EVENT_CHANGED;
+    case KDM::DeviceEventType::Arrived:
+    default: return WD_EVENT_ARRIVED;
+    }
+}
+
+/* Copy a zero-terminated shared inventory field into a (larger) C API field */
+template <size_t N, size_t M>
+static void CopyRecordField(char (&dest)[N], const char (&src)[M]) {
+    static_assert(N >= M, "C API field must hold the shared inventory field");
+    const size_t length = strnlen(src, M - 1);
+    std::memcpy(dest, src, length);
+    dest[length] = '\0';
+}
+
+static void FillDeviceInfo(WD_DEVICE_INFO* info, const KDM::SharedInventoryLayout::DeviceRecord& record) {
+    std::memset(info, 0, sizeof(WD_DEVICE_INFO));
+    CopyRecordField(info->manufacturer, record.manufacturer);
+    CopyRecordField(info->product, record.product);
+    CopyRecordField(info->serialNumber, record.serialNumber);
+    CopyRecordField(info->description, record.description);
+    CopyRecordField(info->deviceId, record.deviceId);
+    CopyRecordField(info->friendlyName, record.friendlyName);
+    CopyRecordField(info->devicePath, record.devicePath);
+    CopyRecordField(info->vendorName, record.vendorName);
+    CopyRecordField(info->interfaceClassName, record.interfaceClassName);
+
+    info->vendorId = record.vendorId;
+    info->productId = record.productId;
+    info->deviceClass = record.deviceClass;
+    info->interfaceClass = record.interfaceClass;
+    info->isUsbDevice = record.isUsbDevice;
+    info->isConnected = record.isConnected;
+    info->deviceClassGuid.Data1 = record.setupClassGuid.Data1;
+    info->deviceClassGuid.Data2 = record.setupClassGuid.Data2;
+    info->deviceClassGuid.Data3 = record.setupClassGuid.Data3;
+    std::memcpy(info->deviceClassGuid.Data4, record.setupClassGuid.Data4, sizeof(info->deviceClassGuid.Data4));
+}
+
 /* Validate handle */
 static bool IsValidHandle(HDEVICE_MANAGER handle) {
     return handle != nullptr;
 }
 
+/* Thrown out of an export sink when the callback asks to stop */
+struct ExportStopped {};
+
+/* Exporter sink that forwards each chunk to a WD_JSON_CALLBACK */
+static KDM::JsonSink CallbackSink(WD_JSON_CALLBACK callback, void* context) {
+    return [callback, context](const char* data, size_t size) {
+        if (callback(data, static_cast<unsigned int>(size), context) != 0) {
+            throw ExportStopped{};
+        }
+    };
+}
+
 /* ========== Device Manager Functions ========== */
 
 WINDEVICES_API WD_RESULT WD_CreateDeviceManager(HDEVICE_MANAGER* handle) {
@@ -68,6 +213,7 @@ WINDEVICES_API WD_RESULT WD_CreateDeviceManager(HDEVICE_MANAGER* handle) {
     try {
         auto wrapper = new DeviceManagerWrapper();
         wrapper->manager = std::make_unique<KDM::DevicesManager>();
+        wrapper->events = wrapper->manager->SubscribeEvents();
         *handle = wrapper;
         
         spdlog::info("Device manager created successfully");
@@ -110,22 +256,132 @@ WINDEVICES_API WD_RESULT WD_EnumerateUsbDevices(HDEVICE_MANAGER handle) {
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->devices.clear();
-        
-        wrapper->manager->EnumerateUsbDevices();
-        wrapper->devices = wrapper->manager->GetDevices();
-        
-        spdlog::info("Enumerated {} USB devices", wrapper->devices.size());
-        return WD_SUCCESS;
+
+        KDM::EnumerationStatus enumStatus = wrapper->manager->EnumerateUsbDevices(KDM::EnumerationOptions{});
+        KDM::DeviceSnapshotPtr snapshot = wrapper->manager->GetSnapshot();
+        const size_t skippedCount = enumStatus.skipped.size();
+        PublishSnapshot(wrapper, snapshot);
+        PublishSkippedNodes(wrapper, std::move(enumStatus.skipped));
+
+        spdlog::info("Enumerated {} USB devices ({} hub(s)/port(s) skipped)",
+            snapshot->devices.size(), skippedCount);
+        return ToEnumResult(enumStatus);
     }
     catch (const std::exception& e) {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->lastError = std::string("Exception: ") + e.what();
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
         spdlog::error("WD_EnumerateUsbDevices: Exception: {}", e.what());
         return WD_ERROR_UNKNOWN;
     }
 }
 
+WINDEVICES_API WD_RESULT WD_EnumerateUsbDevicesEx(HDEVICE_MANAGER handle, const WD_ENUM_OPTIONS* options,
+    WD_ENUM_STATUS* status) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_EnumerateUsbDevicesEx: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    try {
+        auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+        CallCancellation cancellation(wrapper);
+
+        KDM::EnumerationOptions enumOptions;
+        enumOptions.cancellation = cancellation.Token();
+        if (options && options->timeoutMs > 0) {
+            enumOptions.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options->timeoutMs);
+        }
+        if (options && options->maxStalenessMs > 0) {
+            enumOptions.maxStaleness = std::chrono::milliseconds(options->maxStalenessMs);
+        }
+
+        KDM::EnumerationStatus enumStatus = wrapper->manager->EnumerateUsbDevices(enumOptions);
+        const size_t skippedCount = enumStatus.skipped.size();
+
+        /* A call that stopped waiting for another call's scan has no result of its own: the
+         * manager still holds the snapshot from before that scan, so nothing is published */
+        if (!enumStatus.stoppedWaiting) {
+            KDM::DeviceSnapshotPtr snapshot = wrapper->manager->GetSnapshot();
+            spdlog::info("Enumerated {} USB devices ({} hub(s)/port(s) skipped)",
+                snapshot->devices.size(), skippedCount);
+            PublishSnapshot(wrapper, std::move(snapshot));
+            PublishSkippedNodes(wrapper, std::move(enumStatus.skipped));
+        }
+
+        if (status) {
+            std::memset(status, 0, sizeof(WD_ENUM_STATUS));
+            status->isComplete = enumStatus.IsComplete() ? 1 : 0;
+            status->timedOut = enumStatus.timedOut ? 1 : 0;
+            status->cancelled = enumStatus.cancelled ? 1 : 0;
+            status->skippedCount = static_cast<int>(skippedCount);
+            status->elapsedMs = static_cast<unsigned int>(enumStatus.elapsed.count());
+            status->coalesced = enumStatus.coalesced ? 1 : 0;
+            status->servedFromCache = enumStatus.servedFromCache ? 1 : 0;
+        }
+
+        return ToEnumResult(enumStatus);
+    }
+    catch (const std::exception& e) {
+        auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
+        spdlog::error("WD_EnumerateUsbDevicesEx: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
+WINDEVICES_API WD_RESULT WD_CancelEnumeration(HDEVICE_MANAGER handle) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_CancelEnumeration: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+    {
+        std::lock_guard<std::mutex> lock(wrapper->cancellationMutex);
+        for (auto& token : wrapper->runningCalls) {
+            token.Cancel();
+        }
+    }
+
+    spdlog::info("Enumeration cancellation requested");
+    return WD_SUCCESS;
+}
+
+WINDEVICES_API WD_RESULT WD_GetSkippedNode(HDEVICE_MANAGER handle, int index, WD_SKIPPED_NODE* node) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_GetSkippedNode: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!node) {
+        spdlog::error("WD_GetSkippedNode: NULL node pointer");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    try {
+        auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+
+        SkippedListPtr skippedNodes = LoadSkippedNodes(wrapper);
+
+        if (index < 0 || index >= static_cast<int>(skippedNodes->size())) {
+            spdlog::error("WD_GetSkippedNode: Invalid index {}", index);
+            return WD_ERROR_INVALID_INDEX;
+        }
+
+        const auto& skipped = (*skippedNodes)[index];
+        std::memset(node, 0, sizeof(WD_SKIPPED_NODE));
+        SafeStrCopy(node->hubPath, sizeof(node->hubPath), skipped.hubPath);
+        node->portNumber = skipped.portNumber;
+        node->reason = ToSkipReason(skipped.reason);
+
+        return WD_SUCCESS;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("WD_GetSkippedNode: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
 WINDEVICES_API WD_RESULT WD_EnumerateAllDevices(HDEVICE_MANAGER handle) {
     if (!IsValidHandle(handle)) {
         spdlog::error("WD_EnumerateAllDevices: Invalid handle");
@@ -134,18 +390,18 @@ WINDEVICES_API WD_RESULT WD_EnumerateAllDevices(HDEVICE_MANAGER handle) {
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->devices.clear();
 
         // For now, just enumerate USB devices since that's what's implemented
         wrapper->manager->EnumerateUsbDevices();
-        wrapper->devices = wrapper->manager->GetDevices();
+        KDM::DeviceSnapshotPtr snapshot = wrapper->manager->GetSnapshot();
+        PublishSnapshot(wrapper, snapshot);
 
-        spdlog::info("Enumerated {} devices", wrapper->devices.size());
+        spdlog::info("Enumerated {} devices", snapshot->devices.size());
         return WD_SUCCESS;
     }
     catch (const std::exception& e) {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->lastError = std::string("Exception: ") + e.what();
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
         spdlog::error("WD_EnumerateAllDevices: Exception: {}", e.what());
         return WD_ERROR_UNKNOWN;
     }
@@ -164,7 +420,6 @@ WINDEVICES_API WD_RESULT WD_EnumerateByDeviceClass(HDEVICE_MANAGER handle, const
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->devices.clear();
 
         // Convert WD_GUID to Windows GUID
         GUID deviceClassGuid;
@@ -173,25 +428,64 @@ WINDEVICES_API WD_RESULT WD_EnumerateByDeviceClass(HDEVICE_MANAGER handle, const
         deviceClassGuid.Data3 = classGuid->Data3;
         std::memcpy(deviceClassGuid.Data4, classGuid->Data4, sizeof(deviceClassGuid.Data4));
 
-        spdlog::info("WD_EnumerateByDeviceClass: Enumerating devices with class GUID: {{{:08X}-{:04X}-{:04X}-{:02X}{:02X}-{:02X}{:02X}{:02X}{:02X}{:02X}{:02X}}}",
-            deviceClassGuid.Data1, deviceClassGuid.Data2, deviceClassGuid.Data3,
-            deviceClassGuid.Data4[0], deviceClassGuid.Data4[1], deviceClassGuid.Data4[2], deviceClassGuid.Data4[3],
-            deviceClassGuid.Data4[4], deviceClassGuid.Data4[5], deviceClassGuid.Data4[6], deviceClassGuid.Data4[7]);
+        spdlog::info("WD_EnumerateByDeviceClass: Enumerating devices with class GUID: {}",
+            KDM::HexFormat::Guid<char>(deviceClassGuid).view());
 
         wrapper->manager->EnumerateByDeviceClass(deviceClassGuid);
-        wrapper->devices = wrapper->manager->GetDevices();
+        KDM::DeviceSnapshotPtr snapshot = wrapper->manager->GetSnapshot();
+        PublishSnapshot(wrapper, snapshot);
 
-        spdlog::info("Enumerated {} devices by class", wrapper->devices.size());
+        spdlog::info("Enumerated {} devices by class", snapshot->devices.size());
         return WD_SUCCESS;
     }
     catch (const std::exception& e) {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->lastError = std::string("Exception: ") + e.what();
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
         spdlog::error("WD_EnumerateByDeviceClass: Exception: {}", e.what());
         return WD_ERROR_UNKNOWN;
     }
 }
 
+WINDEVICES_API WD_RESULT WD_EnumerateByDeviceClasses(HDEVICE_MANAGER handle, const WD_GUID* classGuids, unsigned int count) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_EnumerateByDeviceClasses: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!classGuids && count > 0) {
+        spdlog::error("WD_EnumerateByDeviceClasses: NULL classGuids pointer");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+
+    try {
+        // Convert WD_GUID to Windows GUID
+        std::vector<GUID> deviceClassGuids(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            deviceClassGuids[i].Data1 = classGuids[i].Data1;
+            deviceClassGuids[i].Data2 = classGuids[i].Data2;
+            deviceClassGuids[i].Data3 = classGuids[i].Data3;
+            std::memcpy(deviceClassGuids[i].Data4, classGuids[i].Data4, sizeof(deviceClassGuids[i].Data4));
+        }
+
+        wrapper->manager->EnumerateByDeviceClasses(deviceClassGuids);
+        KDM::DeviceSnapshotPtr snapshot = wrapper->manager->GetSnapshot();
+        PublishSnapshot(wrapper, snapshot);
+
+        spdlog::info("Enumerated {} devices in {} classes", snapshot->devices.size(), count);
+        return WD_SUCCESS;
+    }
+    catch (const std::bad_alloc&) {
+        return WD_ERROR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& e) {
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
+        spdlog::error("WD_EnumerateByDeviceClasses: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
 WINDEVICES_API WD_RESULT WD_EnumerateUsbMassStorage(HDEVICE_MANAGER handle) {
     if (!IsValidHandle(handle)) {
         spdlog::error("WD_EnumerateUsbMassStorage: Invalid handle");
@@ -200,11 +494,14 @@ WINDEVICES_API WD_RESULT WD_EnumerateUsbMassStorage(HDEVICE_MANAGER handle) {
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->devices.clear();
 
         // First enumerate all USB devices to get interface class from USB descriptors
         wrapper->manager->EnumerateUsbDevices();
-        auto allDevices = wrapper->manager->GetDevices();
+        KDM::DeviceSnapshotPtr snapshot = wrapper->manager->GetSnapshot();
+        const auto& allDevices = snapshot->devices;
+        auto massStorage = std::make_shared<KDM::DeviceSnapshot>();
+        massStorage->version = snapshot->version;
+        massStorage->publishedAt = snapshot->publishedAt;
 
         // Filter to only mass storage devices using USB Interface Class
         // This is the correct way to detect mass storage - NOT using Windows Setup Class GUID
@@ -216,17 +513,21 @@ WINDEVICES_API WD_RESULT WD_EnumerateUsbMassStorage(HDEVICE_MANAGER handle) {
             // Device class at device level is often 0x00 (interface-defined)
             if (KDM::IsMassStorageClass(device.GetInterfaceClass()) ||
                 KDM::IsMassStorageClass(device.GetDeviceClass())) {
-                wrapper->devices.push_back(device);
+                KDM::AllocationPhaseScope exportPhase{ KDM::AllocationPhase::Export };
+                massStorage->devices.push_back(device);
             }
         }
 
+        const size_t massStorageCount = massStorage->devices.size();
+        PublishSnapshot(wrapper, std::move(massStorage));
+
         spdlog::info("WD_EnumerateUsbMassStorage: Found {} mass storage device(s) out of {} USB devices",
-            wrapper->devices.size(), allDevices.size());
+            massStorageCount, allDevices.size());
         return WD_SUCCESS;
     }
     catch (const std::exception& e) {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->lastError = std::string("Exception: ") + e.what();
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
         spdlog::error("WD_EnumerateUsbMassStorage: Exception: {}", e.what());
         return WD_ERROR_UNKNOWN;
     }
@@ -245,7 +546,7 @@ WINDEVICES_API WD_RESULT WD_GetDeviceCount(HDEVICE_MANAGER handle, int* count) {
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        *count = static_cast<int>(wrapper->devices.size());
+        *count = static_cast<int>(LoadSnapshot(wrapper)->devices.size());
         return WD_SUCCESS;
     }
     catch (const std::exception& e) {
@@ -268,12 +569,14 @@ WINDEVICES_API WD_RESULT WD_GetDeviceInfo(HDEVICE_MANAGER handle, int index, WD_
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
         
-        if (index < 0 || index >= static_cast<int>(wrapper->devices.size())) {
+        KDM::DeviceSnapshotPtr snapshot = LoadSnapshot(wrapper);
+
+        if (index < 0 || index >= static_cast<int>(snapshot->devices.size())) {
             spdlog::error("WD_GetDeviceInfo: Invalid index {}", index);
             return WD_ERROR_INVALID_INDEX;
         }
 
-        const auto& deviceResult = wrapper->devices[index];
+        const auto& deviceResult = snapshot->devices[index];
         std::memset(info, 0, sizeof(WD_DEVICE_INFO));
 
         // Copy device info from DeviceResultantInfo
@@ -308,7 +611,7 @@ WINDEVICES_API WD_RESULT WD_GetDeviceInfo(HDEVICE_MANAGER handle, int index, WD_
     }
     catch (const std::exception& e) {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->lastError = std::string("Exception: ") + e.what();
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
         spdlog::error("WD_GetDeviceInfo: Exception: {}", e.what());
         return WD_ERROR_UNKNOWN;
     }
@@ -322,8 +625,8 @@ WINDEVICES_API WD_RESULT WD_ClearDevices(HDEVICE_MANAGER handle) {
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        wrapper->devices.clear();
-        wrapper->lastError.clear();
+        PublishSnapshot(wrapper, std::make_shared<const KDM::DeviceSnapshot>());
+        SetWrapperError(wrapper, {});
         
         spdlog::info("Devices cleared");
         return WD_SUCCESS;
@@ -334,6 +637,274 @@ WINDEVICES_API WD_RESULT WD_ClearDevices(HDEVICE_MANAGER handle) {
     }
 }
 
+/* ========== Device Event Functions ========== */
+
+WINDEVICES_API WD_RESULT WD_PollEvents(HDEVICE_MANAGER handle, WD_DEVICE_EVENT* buffer, int maxEvents,
+    int* eventCount) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_PollEvents: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!buffer || !eventCount) {
+        spdlog::error("WD_PollEvents: NULL pointer argument");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    *eventCount = 0;
+    if (maxEvents <= 0) {
+        return WD_SUCCESS;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+
+    /* Drain in fixed-size batches so no allocation happens per call */
+    constexpr size_t batchSize = 64;
+    KDM::DeviceEvent batch[batchSize];
+    int written = 0;
+
+    while (written < maxEvents) {
+        const size_t wanted = (std::min)(batchSize, static_cast<size_t>(maxEvents - written));
+        const size_t polled = wrapper->events->Poll(batch, wanted);
+
+        for (size_t i = 0; i < polled; ++i) {
+            const KDM::DeviceEvent& event = batch[i];
+            WD_DEVICE_EVENT& out = buffer[written++];
+            out.sequence = event.sequence;
+            out.snapshotVersion = event.snapshotVersion;
+            out.deviceKey = event.deviceKey;
+            out.timestampMs = event.timestampMs;
+            out.vendorId = event.vendorId;
+            out.productId = event.productId;
+            out.deviceClass = event.deviceClass;
+            out.interfaceClass = event.interfaceClass;
+            out.type = ToEventType(event.type);
+        }
+
+        if (polled < wanted) {
+            break;
+        }
+    }
+
+    *eventCount = written;
+    return WD_SUCCESS;
+}
+
+WINDEVICES_API WD_RESULT WD_GetDroppedEventCount(HDEVICE_MANAGER handle, unsigned long long* droppedCount) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_GetDroppedEventCount: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!droppedCount) {
+        spdlog::error("WD_GetDroppedEventCount: NULL droppedCount pointer");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+    *droppedCount = wrapper->events->GetDroppedCount();
+    return WD_SUCCESS;
+}
+
+/* ========== Export Functions ========== */
+
+WINDEVICES_API WD_RESULT WD_ExportJson(HDEVICE_MANAGER handle, WD_JSON_FORMAT format, WD_JSON_CALLBACK callback,
+    void* context) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_ExportJson: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!callback) {
+        spdlog::error("WD_ExportJson: NULL callback");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+
+    try {
+        KDM::DeviceSnapshotPtr snapshot = LoadSnapshot(wrapper);
+
+        KDM::JsonExporter exporter(
+            CallbackSink(callback, context),
+            format == WD_JSON_NDJSON ? KDM::JsonFormat::NdJson : KDM::JsonFormat::Document);
+
+        exporter.WriteSnapshot(*snapshot);
+        exporter.Flush();
+        return WD_SUCCESS;
+    }
+    catch (const ExportStopped&) {
+        return WD_ERROR_CANCELLED;
+    }
+    catch (const std::bad_alloc&) {
+        return WD_ERROR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& e) {
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
+        spdlog::error("WD_ExportJson: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
+WINDEVICES_API WD_RESULT WD_ExportTopology(HDEVICE_MANAGER handle, WD_TOPOLOGY_FORMAT format,
+    WD_JSON_CALLBACK callback, void* context) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_ExportTopology: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!callback) {
+        spdlog::error("WD_ExportTopology: NULL callback");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+
+    try {
+        KDM::DeviceSnapshotPtr snapshot = LoadSnapshot(wrapper);
+
+        KDM::TopologyExporter exporter(
+            CallbackSink(callback, context),
+            format == WD_TOPOLOGY_JSON ? KDM::TopologyFormat::Json : KDM::TopologyFormat::Dot);
+
+        exporter.Write(*snapshot);
+        exporter.Flush();
+        return WD_SUCCESS;
+    }
+    catch (const ExportStopped&) {
+        return WD_ERROR_CANCELLED;
+    }
+    catch (const std::bad_alloc&) {
+        return WD_ERROR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& e) {
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
+        spdlog::error("WD_ExportTopology: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
+/* ========== Shared Inventory Functions ========== */
+
+WINDEVICES_API WD_RESULT WD_PublishSharedInventory(HDEVICE_MANAGER handle, const char* name, unsigned int capacity) {
+    if (!IsValidHandle(handle)) {
+        spdlog::error("WD_PublishSharedInventory: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
+
+    try {
+        if (!name || !*name) {
+            wrapper->manager->DisableSharedInventory();
+            return WD_SUCCESS;
+        }
+
+        wrapper->manager->EnableSharedInventory(KDM::UtilConvert::UTF8ToWString(name),
+            capacity ? capacity : KDM::SharedInventoryLayout::DefaultCapacity);
+        SetWrapperError(wrapper, {});
+        return WD_SUCCESS;
+    }
+    catch (const KDM::DeviceIoException& e) {
+        SetWrapperError(wrapper, std::string("Shared inventory: ") + e.what());
+        spdlog::error("WD_PublishSharedInventory: {}", e.what());
+        return WD_ERROR_NOT_AVAILABLE;
+    }
+    catch (const std::bad_alloc&) {
+        return WD_ERROR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& e) {
+        SetWrapperError(wrapper, std::string("Exception: ") + e.what());
+        spdlog::error("WD_PublishSharedInventory: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
+WINDEVICES_API WD_RESULT WD_OpenSharedInventory(const char* name, HSHARED_INVENTORY* inventory) {
+    if (!name || !inventory) {
+        spdlog::error("WD_OpenSharedInventory: NULL pointer argument");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    *inventory = nullptr;
+    try {
+        *inventory = new KDM::SharedInventoryReader(KDM::UtilConvert::UTF8ToWString(name));
+        return WD_SUCCESS;
+    }
+    catch (const KDM::DeviceIoException& e) {
+        spdlog::debug("WD_OpenSharedInventory: {}", e.what());
+        return WD_ERROR_NOT_AVAILABLE;
+    }
+    catch (const std::bad_alloc&) {
+        return WD_ERROR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("WD_OpenSharedInventory: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
+WINDEVICES_API WD_RESULT WD_CloseSharedInventory(HSHARED_INVENTORY inventory) {
+    if (!inventory) {
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    delete static_cast<KDM::SharedInventoryReader*>(inventory);
+    return WD_SUCCESS;
+}
+
+WINDEVICES_API WD_RESULT WD_GetSharedInventoryVersion(HSHARED_INVENTORY inventory, unsigned long long* generation) {
+    if (!inventory) {
+        return WD_ERROR_INVALID_HANDLE;
+    }
+    if (!generation) {
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    *generation = static_cast<const KDM::SharedInventoryReader*>(inventory)->GetGeneration();
+    return WD_SUCCESS;
+}
+
+WINDEVICES_API WD_RESULT WD_ReadSharedInventory(HSHARED_INVENTORY inventory, WD_DEVICE_INFO* buffer, int maxDevices,
+    int* deviceCount, unsigned long long* generation) {
+    if (!inventory) {
+        spdlog::error("WD_ReadSharedInventory: Invalid handle");
+        return WD_ERROR_INVALID_HANDLE;
+    }
+
+    if (!deviceCount || (!buffer && maxDevices > 0)) {
+        spdlog::error("WD_ReadSharedInventory: NULL pointer argument");
+        return WD_ERROR_NULL_POINTER;
+    }
+
+    *deviceCount = 0;
+    try {
+        KDM::SharedInventoryContents contents;
+        if (!static_cast<const KDM::SharedInventoryReader*>(inventory)->Read(contents)) {
+            return WD_ERROR_NOT_AVAILABLE;
+        }
+
+        const int available = static_cast<int>(contents.devices.size());
+        const int written = (std::min)(available, (std::max)(maxDevices, 0));
+        for (int i = 0; i < written; ++i) {
+            FillDeviceInfo(&buffer[i], contents.devices[i]);
+        }
+
+        *deviceCount = available;
+        if (generation) {
+            *generation = contents.generation;
+        }
+        return WD_SUCCESS;
+    }
+    catch (const std::bad_alloc&) {
+        return WD_ERROR_OUT_OF_MEMORY;
+    }
+    catch (const std::exception& e) {
+        spdlog::error("WD_ReadSharedInventory: Exception: {}", e.what());
+        return WD_ERROR_UNKNOWN;
+    }
+}
+
 /* ========== Utility Functions ========== */
 
 WINDEVICES_API const char* WD_GetErrorMessage(WD_RESULT result) {
@@ -352,6 +923,14 @@ WINDEVICES_API const char* WD_GetErrorMessage(WD_RESULT result) {
             return "Invalid device index";
         case WD_ERROR_NULL_POINTER:
             return "NULL pointer argument";
+        case WD_ERROR_TIMEOUT:
+            return "Enumeration deadline exceeded (partial result)";
+        case WD_ERROR_CANCELLED:
+            return "Enumeration cancelled (partial result)";
+        case WD_ERROR_NOT_AVAILABLE:
+            return "Shared inventory not available";
+        case WD_ERROR_PARTIAL:
+            return "Some hubs could not be enumerated (partial result)";
         case WD_ERROR_UNKNOWN:
             return "Unknown error";
         default:
@@ -379,7 +958,13 @@ WINDEVICES_API const char* WD_GetLastError(HDEVICE_MANAGER handle) {
 
     try {
         auto wrapper = static_cast<DeviceManagerWrapper*>(handle);
-        return wrapper->lastError.empty() ? nullptr : wrapper->lastError.c_str();
+        // Copy per calling thread so the pointer stays valid while other threads set errors
+        static thread_local std::string lastErrorCopy;
+        {
+            std::lock_guard<std::mutex> lock(wrapper->lastErrorMutex);
+            lastErrorCopy = wrapper->lastError;
+        }
+        return lastErrorCopy.empty() ? nullptr : lastErrorCopy.c_str();
     }
     catch (...) {
         return "Exception getting last error";
@@ -47,8 +47,10 @@ extern "C" {
 /* Using modern C++ 'using' syntax (compatible with C via typedef fallback) */
 #ifdef __cplusplus
 using HDEVICE_MANAGER = void*;
+using HSHARED_INVENTORY = void*;
 #else
 typedef void* HDEVICE_MANAGER;
+typedef void* HSHARED_INVENTORY;
 #endif
 
 /* GUID structure for device class GUIDs */
@@ -68,6 +70,10 @@ typedef enum {
     WD_ERROR_ENUM_FAILED = -4,
     WD_ERROR_INVALID_INDEX = -5,
     WD_ERROR_NULL_POINTER = -6,
+    WD_ERROR_TIMEOUT = -7,
+    WD_ERROR_CANCELLED = -8,
+    WD_ERROR_NOT_AVAILABLE = -9,    /* Shared inventory missing, incompatible or busy */
+    WD_ERROR_PARTIAL = -10,         /* Hubs failed or were skipped; the devices found are available */
     WD_ERROR_UNKNOWN = -99
 } WD_RESULT;
 
@@ -94,6 +100,74 @@ typedef struct {
     char interfaceClassName[64]; /* Human-readable USB Interface Class name */
 } WD_DEVICE_INFO;
 
+/* Options for WD_EnumerateUsbDevicesEx */
+typedef struct {
+    unsigned int timeoutMs;     /* Time budget for the scan, 0 = no deadline */
+    unsigned int maxStalenessMs; /* Reuse the last scan if younger than this, 0 = always scan */
+} WD_ENUM_OPTIONS;
+
+/* Why a hub or port is missing from a partial enumeration result */
+typedef enum {
+    WD_SKIP_TIMED_OUT = 0,
+    WD_SKIP_CANCELLED = 1,
+    WD_SKIP_HUB_FAILED = 2,     /* Every retry to open or read the hub failed */
+    WD_SKIP_CIRCUIT_OPEN = 3    /* Hub skipped while its circuit breaker is open */
+} WD_SKIP_REASON;
+
+/* Outcome of WD_EnumerateUsbDevicesEx */
+typedef struct {
+    int isComplete;             /* 1 if every hub and port was visited */
+    int timedOut;
+    int cancelled;
+    int skippedCount;           /* Number of entries available via WD_GetSkippedNode */
+    unsigned int elapsedMs;
+    int coalesced;              /* 1 if the result was shared from a scan already running */
+    int servedFromCache;        /* 1 if the previous scan was reused (maxStalenessMs) */
+} WD_ENUM_STATUS;
+
+/* A hub (portNumber == 0) or hub port that was not enumerated */
+typedef struct {
+    char hubPath[512];
+    unsigned int portNumber;
+    WD_SKIP_REASON reason;
+} WD_SKIPPED_NODE;
+
+/* Kind of device change reported by WD_PollEvents */
+typedef enum {
+    WD_EVENT_ARRIVED = 1,
+    WD_EVENT_REMOVED = 2,
+    WD_EVENT_CHANGED = 3        /* Same device, different properties */
+} WD_EVENT_TYPE;
+
+/* Device change derived from two consecutive enumeration results */
+typedef struct {
+    unsigned long long sequence;        /* Increases by one per event; a gap means events were dropped */
+    unsigned long long snapshotVersion; /* Enumeration result that produced the event */
+    unsigned long long deviceKey;       /* Stable identity of the device across enumerations */
+    long long timestampMs;              /* Milliseconds since the Unix epoch */
+    unsigned int vendorId;
+    unsigned int productId;
+    unsigned int deviceClass;
+    unsigned int interfaceClass;
+    WD_EVENT_TYPE type;
+} WD_DEVICE_EVENT;
+
+/* Output shape of WD_ExportJson */
+typedef enum {
+    WD_JSON_DOCUMENT = 0,       /* {"version":N,"devices":[...]} */
+    WD_JSON_NDJSON = 1          /* One device object per line */
+} WD_JSON_FORMAT;
+
+/* Receives consecutive chunks of UTF-8 output (WD_ExportJson, WD_ExportTopology);
+   return 0 to continue, non-zero to stop */
+typedef int (*WD_JSON_CALLBACK)(const char* data, unsigned int size, void* context);
+
+/* Output shape of WD_ExportTopology */
+typedef enum {
+    WD_TOPOLOGY_DOT = 0,        /* Graphviz digraph */
+    WD_TOPOLOGY_JSON = 1        /* {"nodes":[...]} adjacency list */
+} WD_TOPOLOGY_FORMAT;
+
 /* API Version Information */
 typedef struct {
     int major;
@@ -104,6 +178,13 @@ typedef struct {
 
 /* ========== Device Manager Functions ========== */
 
+/*
+ * Thread safety: a handle may be used from several threads at once. Enumeration
+ * calls on one handle run one at a time; WD_GetDeviceCount, WD_GetDeviceInfo and
+ * WD_GetSkippedNode never wait for them and report the last completed enumeration.
+ * WD_DestroyDeviceManager must not race with any other call on the same handle.
+ */
+
 /**
  * @brief Create a new device manager instance
  * @param handle Pointer to receive the device manager handle
@@ -126,12 +207,64 @@ WINDEVICES_API WD_RESULT WD_DestroyDeviceManager(
 /**
  * @brief Enumerate all USB devices
  * @param handle Device manager handle
+ * @return WD_SUCCESS if the whole tree was visited, WD_ERROR_PARTIAL if hubs
+ *         failed or their circuit breaker was open, error code otherwise
+ *
+ * On WD_ERROR_PARTIAL the devices on the other hubs are still available through
+ * WD_GetDeviceCount/WD_GetDeviceInfo, and the missing hubs through WD_GetSkippedNode.
+ */
+WINDEVICES_API WD_RESULT WD_EnumerateUsbDevices(
+    _In_ HDEVICE_MANAGER handle);
+
+/**
+ * @brief Enumerate USB devices within a time budget
+ * @param handle Device manager handle
+ * @param options Enumeration options, or NULL for an unbounded scan
+ * @param status Optional pointer to receive which hubs and ports were skipped
+ * @return WD_SUCCESS if the whole tree was visited, WD_ERROR_TIMEOUT,
+ *         WD_ERROR_CANCELLED or WD_ERROR_PARTIAL (hubs failed) for a partial
+ *         result, error code otherwise
+ *
+ * Calls made on one handle while a scan is running wait for that scan and
+ * share its result instead of walking the bus again.
+ *
+ * On WD_ERROR_TIMEOUT, WD_ERROR_CANCELLED and WD_ERROR_PARTIAL the devices found
+ * before the scan stopped are still available through WD_GetDeviceCount/WD_GetDeviceInfo,
+ * and the unvisited hubs and ports through WD_GetSkippedNode. A call that stops
+ * waiting for a scan started by another call returns WD_ERROR_TIMEOUT or
+ * WD_ERROR_CANCELLED with coalesced set and leaves the previous result in place.
+ */
+WINDEVICES_API WD_RESULT WD_EnumerateUsbDevicesEx(
+    _In_ HDEVICE_MANAGER handle,
+    _In_opt_ const WD_ENUM_OPTIONS* options,
+    _Out_opt_ WD_ENUM_STATUS* status);
+
+/**
+ * @brief Cancel a WD_EnumerateUsbDevicesEx call running on another thread
+ * @param handle Device manager handle
  * @return WD_SUCCESS on success, error code otherwise
+ *
+ * Every WD_EnumerateUsbDevicesEx call running on the handle stops at its next hub
+ * or port boundary and returns WD_ERROR_CANCELLED. Calls started afterwards are
+ * not affected.
  */
 _Success_(return == WD_SUCCESS)
-WINDEVICES_API WD_RESULT WD_EnumerateUsbDevices(
+WINDEVICES_API WD_RESULT WD_CancelEnumeration(
     _In_ HDEVICE_MANAGER handle);
 
+/**
+ * @brief Get a hub or port skipped by the last WD_EnumerateUsbDevices(Ex) call
+ * @param handle Device manager handle
+ * @param index Zero-based index, less than WD_ENUM_STATUS.skippedCount
+ * @param node Pointer to WD_SKIPPED_NODE structure to fill
+ * @return WD_SUCCESS on success, error code otherwise
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_GetSkippedNode(
+    _In_ HDEVICE_MANAGER handle,
+    _In_ int index,
+    _Out_ WD_SKIPPED_NODE* node);
+
 /**
  * @brief Enumerate all devices (USB and non-USB)
  * @param handle Device manager handle
@@ -152,6 +285,23 @@ WINDEVICES_API WD_RESULT WD_EnumerateByDeviceClass(
     _In_ HDEVICE_MANAGER handle,
     _In_ const WD_GUID* classGuid);
 
+/**
+ * @brief Enumerate devices of several Device Setup Classes in a single pass
+ * @param handle Device manager handle
+ * @param classGuids Array of count device class GUIDs
+ * @param count Number of entries in classGuids
+ * @return WD_SUCCESS on success, error code otherwise
+ *
+ * Results are grouped by class, in the order of classGuids. Cheaper than calling
+ * WD_EnumerateByDeviceClass once per class: the device set is opened once and
+ * properties are read only for devices of the requested classes.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_EnumerateByDeviceClasses(
+    _In_ HDEVICE_MANAGER handle,
+    _In_reads_(count) const WD_GUID* classGuids,
+    _In_ unsigned int count);
+
 /**
  * @brief Enumerate external USB mass storage devices only
  * @param handle Device manager handle
@@ -198,6 +348,159 @@ _Success_(return == WD_SUCCESS)
 WINDEVICES_API WD_RESULT WD_ClearDevices(
     _In_ HDEVICE_MANAGER handle);
 
+/* ========== Device Event Functions ========== */
+
+/**
+ * @brief Drain pending device arrival/removal/change events
+ * @param handle Device manager handle
+ * @param buffer Array receiving up to maxEvents events, oldest first
+ * @param maxEvents Capacity of buffer
+ * @param eventCount Pointer to receive the number of events written
+ * @return WD_SUCCESS on success (also when no event is pending), error code otherwise
+ *
+ * Every enumeration on the handle is compared with the previous result and the
+ * differences are queued in a bounded ring. Enumeration never waits for the
+ * caller; events not polled before the ring wraps are dropped and counted by
+ * WD_GetDroppedEventCount. Events queued before WD_CreateDeviceManager returned
+ * do not exist, so the first enumeration reports every device as arrived.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_PollEvents(
+    _In_ HDEVICE_MANAGER handle,
+    _Out_ WD_DEVICE_EVENT* buffer,
+    _In_ int maxEvents,
+    _Out_ int* eventCount);
+
+/**
+ * @brief Get the number of events dropped because they were not polled in time
+ * @param handle Device manager handle
+ * @param droppedCount Pointer to receive the total number of dropped events
+ * @return WD_SUCCESS on success, error code otherwise
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_GetDroppedEventCount(
+    _In_ HDEVICE_MANAGER handle,
+    _Out_ unsigned long long* droppedCount);
+
+/* ========== Export Functions ========== */
+
+/**
+ * @brief Stream the last enumeration result as UTF-8 JSON
+ * @param handle Device manager handle
+ * @param format WD_JSON_DOCUMENT or WD_JSON_NDJSON
+ * @param callback Receives the output in chunks of up to 64 KB (not NUL-terminated)
+ * @param context Passed through to callback
+ * @return WD_SUCCESS on success, WD_ERROR_CANCELLED if callback stopped the export,
+ *         error code otherwise
+ *
+ * The JSON is written straight from the native device records; no WD_DEVICE_INFO
+ * copies are made.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_ExportJson(
+    _In_ HDEVICE_MANAGER handle,
+    _In_ WD_JSON_FORMAT format,
+    _In_ WD_JSON_CALLBACK callback,
+    _In_opt_ void* context);
+
+/**
+ * @brief Stream the USB topology of the last enumeration (controllers, hubs, ports, devices)
+ * @param handle Device manager handle
+ * @param format WD_TOPOLOGY_DOT or WD_TOPOLOGY_JSON
+ * @param callback Receives the output in chunks of up to 64 KB (not NUL-terminated)
+ * @param context Passed through to callback
+ * @return WD_SUCCESS on success, WD_ERROR_CANCELLED if callback stopped the export,
+ *         error code otherwise
+ *
+ * Nodes carry location, speed, class and open pipe count; hubs also report ports in use.
+ * Reads the same result as WD_GetDeviceInfo and WD_ExportJson: the topology is empty
+ * unless that result came from WD_EnumerateUsbDevices(Ex), and after WD_ClearDevices.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_ExportTopology(
+    _In_ HDEVICE_MANAGER handle,
+    _In_ WD_TOPOLOGY_FORMAT format,
+    _In_ WD_JSON_CALLBACK callback,
+    _In_opt_ void* context);
+
+/* ========== Shared Inventory Functions ========== */
+
+/*
+ * One process publishes its enumeration results into a named shared-memory
+ * region; any number of other processes read them without enumerating. Readers
+ * never block the publisher and never see a half-written inventory.
+ */
+
+/**
+ * @brief Mirror every enumeration result of a device manager into shared memory
+ * @param handle Device manager handle
+ * @param name UTF-8 kernel object name, e.g. "Local\\KDM.Inventory"; NULL or "" stops publishing
+ * @param capacity Devices stored per publication, 0 = default (512)
+ * @return WD_SUCCESS on success, error code otherwise
+ *
+ * The last enumeration result is published immediately.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_PublishSharedInventory(
+    _In_ HDEVICE_MANAGER handle,
+    _In_opt_ const char* name,
+    _In_ unsigned int capacity);
+
+/**
+ * @brief Open a shared inventory published by another (or this) process
+ * @param name UTF-8 name passed to WD_PublishSharedInventory
+ * @param inventory Pointer to receive the read-only inventory handle
+ * @return WD_SUCCESS on success, WD_ERROR_NOT_AVAILABLE if no compatible inventory has this name
+ */
+_Must_inspect_result_
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_OpenSharedInventory(
+    _In_ const char* name,
+    _Outptr_ HSHARED_INVENTORY* inventory);
+
+/**
+ * @brief Close a shared inventory handle
+ * @param inventory Handle returned by WD_OpenSharedInventory
+ * @return WD_SUCCESS on success, error code otherwise
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_CloseSharedInventory(
+    _In_ HSHARED_INVENTORY inventory);
+
+/**
+ * @brief Get the number of publications so far
+ * @param inventory Shared inventory handle
+ * @param generation Pointer to receive the publication count (0 = nothing published yet)
+ * @return WD_SUCCESS on success, error code otherwise
+ *
+ * Cheap enough to poll: read the devices only when the value changes.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_GetSharedInventoryVersion(
+    _In_ HSHARED_INVENTORY inventory,
+    _Out_ unsigned long long* generation);
+
+/**
+ * @brief Copy a consistent view of the shared inventory
+ * @param inventory Shared inventory handle
+ * @param buffer Array receiving up to maxDevices devices (may be NULL if maxDevices is 0)
+ * @param maxDevices Capacity of buffer
+ * @param deviceCount Pointer to receive the number of devices in the inventory;
+ *        if larger than maxDevices, only the first maxDevices were written
+ * @param generation Optional pointer to receive the publication the devices belong to
+ * @return WD_SUCCESS on success, WD_ERROR_NOT_AVAILABLE if the publisher kept
+ *         rewriting the inventory while it was copied
+ *
+ * productName, deviceSubClass and deviceProtocol are not shared and read as empty/0.
+ */
+_Success_(return == WD_SUCCESS)
+WINDEVICES_API WD_RESULT WD_ReadSharedInventory(
+    _In_ HSHARED_INVENTORY inventory,
+    _Out_opt_ WD_DEVICE_INFO* buffer,
+    _In_ int maxDevices,
+    _Out_ int* deviceCount,
+    _Out_opt_ unsigned long long* generation);
+
 /* ========== Utility Functions ========== */
 
 /**
@@ -221,7 +524,9 @@ WINDEVICES_API WD_RESULT WD_GetVersion(
 /**
  * @brief Get the last error message from the device manager
  * @param handle Device manager handle
- * @return Last error message string (do not free), or NULL if no error
+ * @return Last error message string (do not free), or NULL if no error.
+ *         The string is owned by the calling thread and valid until its next
+ *         WD_GetLastError call.
  */
 _Ret_maybenull_
 WINDEVICES_API const char* WD_GetLastError(
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "DeviceResultantInfo.h"
+#include "DeviceSnapshot.h"
+#include "fixtures/TestDevices.h"
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Time limits for building and discarding a large snapshot whose devices live
+/// in a scan arena.
+/// </summary>
+class DeviceResultantInfoBenchmark : public ::testing::Test
+{
+protected:
+    static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+TEST_F(DeviceResultantInfoBenchmark, LargeSnapshot_ArenaConstructionAndDestruction)
+{
+    constexpr unsigned int DeviceCount = 50000;
+
+    auto start = std::chrono::steady_clock::now();
+    auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+    auto snapshot = std::make_shared<DeviceSnapshot>();
+    snapshot->devices.reserve(DeviceCount);
+    for (unsigned int i = 0; i < DeviceCount; ++i) {
+        // As the scan does: fill on the heap, then one exact-size copy into the arena
+        snapshot->devices.emplace_back(MakeFleetDevice(i), arena.get());
+    }
+    snapshot->arena = std::move(arena);
+    const double buildMs = MillisecondsSince(start);
+    ASSERT_EQ(snapshot->devices.size(), DeviceCount);
+
+    start = std::chrono::steady_clock::now();
+    snapshot.reset();
+    const double destroyMs = MillisecondsSince(start);
+
+    EXPECT_LT(buildMs, 5000.0);
+    EXPECT_LT(destroyMs, 1000.0);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "HexFormat.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// HexFormat must stay faster than the swprintf formatting it replaced.
+/// </summary>
+class HexFormatBenchmark : public ::testing::Test
+{
+protected:
+    // What UtilConvert::GetHexIdAsString used to do for every ID it logged
+    static std::wstring LegacyHexId(USHORT value, USHORT width)
+    {
+        wchar_t buffer[16] = { 0 };
+        const std::wstring format = L"0x%0" + std::to_wstring(width) + L"x";
+        swprintf(buffer, 16, format.c_str(), value);
+        return std::wstring(buffer);
+    }
+
+    template <typename Format>
+    static double NanosecondsPerCall(int iterations, Format&& format)
+    {
+        size_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            sink += format(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_GT(sink, 0u);
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+};
+
+TEST_F(HexFormatBenchmark, Id_FasterThanSwprintf)
+{
+    constexpr int Iterations = 200000;
+
+    const double legacyId = NanosecondsPerCall(Iterations, [](int i) {
+        return LegacyHexId(static_cast<USHORT>(i), 4).size();
+    });
+    const double inlineId = NanosecondsPerCall(Iterations, [](int i) {
+        return HexFormat::Id(static_cast<USHORT>(i), 4).size();
+    });
+
+    EXPECT_LT(inlineId, legacyId);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "JsonExporter.h"
+#include "DeviceResultantInfo.h"
+#include "fixtures/TestDevices.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Minimum NDJSON export rate for a large snapshot.
+/// </summary>
+class JsonExporterBenchmark : public ::testing::Test
+{
+};
+
+TEST_F(JsonExporterBenchmark, Throughput_AtLeastTenMegabytesPerSecond)
+{
+    const auto snapshot = MakeFleet(1, 100000);
+
+    uint64_t bytes = 0;
+    JsonExporter exporter([&](const char*, size_t size) { bytes += size; }, JsonFormat::NdJson);
+
+    const auto start = std::chrono::steady_clock::now();
+    exporter.WriteSnapshot(snapshot);
+    exporter.Flush();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double megabytesPerSecond = bytes / (1024.0 * 1024.0) / (seconds > 0 ? seconds : 1e-9);
+    RecordProperty("MBps", std::to_string(static_cast<int>(megabytesPerSecond)));
+    EXPECT_GT(megabytesPerSecond, 10.0);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "SnapshotFile.h"
+#include "DeviceResultantInfo.h"
+#include "fixtures/TestDevices.h"
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+namespace KDM
+{
+namespace Testing
+{
+
+using namespace std::chrono_literals;
+
+/// <summary>
+/// Time limits for writing and mapping a large binary snapshot file.
+/// </summary>
+class SnapshotFileBenchmark : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path_ = std::filesystem::temp_directory_path() / "kdm_snapshot_benchmark.bin";
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path_);
+    }
+
+    std::filesystem::path path_;
+};
+
+TEST_F(SnapshotFileBenchmark, LargeSnapshot_WritesAndMapsQuickly)
+{
+    auto snapshot = MakeFleet(1, 100000);
+
+    const auto writeStart = std::chrono::steady_clock::now();
+    SnapshotFileWriter::WriteFile(path_.wstring(), snapshot);
+    const auto writeElapsed = std::chrono::steady_clock::now() - writeStart;
+
+    const auto readStart = std::chrono::steady_clock::now();
+    SnapshotFileReader reader(path_.wstring());
+    const auto& view = reader.GetView();
+    size_t productUnits = 0;
+    for (size_t i = 0; i < view.size(); ++i) {
+        productUnits += view[i].GetProduct().size();
+    }
+    const auto readElapsed = std::chrono::steady_clock::now() - readStart;
+
+    ASSERT_EQ(view.size(), 100000u);
+    EXPECT_GT(productUnits, 0u);
+    EXPECT_LT(writeElapsed, 2000ms);
+    EXPECT_LT(readElapsed, 500ms);
+}
+
+} // namespace Testing
+} // namespace KDM
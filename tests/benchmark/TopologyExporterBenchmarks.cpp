@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usbspec.h>
+#include "TopologyExporter.h"
+#include <chrono>
+#include <cstdint>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Export time of a topology of about ten thousand nodes, in both formats.
+/// </summary>
+class TopologyExporterBenchmark : public ::testing::Test
+{
+protected:
+    static UsbTopologyNode MakeNode(UsbTopologyNodeKind kind, uint32_t parent, uint32_t portNumber, uint16_t productId = 0)
+    {
+        UsbTopologyNode node;
+        node.kind = kind;
+        node.parent = parent;
+        node.portNumber = portNumber;
+        if (kind == UsbTopologyNodeKind::Hub || kind == UsbTopologyNodeKind::Device)
+        {
+            node.vendorId = 0x1234;
+            node.productId = productId;
+            node.deviceClass = kind == UsbTopologyNodeKind::Hub ? 0x09 : 0x03;
+            node.speed = UsbHighSpeed;
+        }
+        return node;
+    }
+
+    // rootHubs x (root hub + width x (port + hub + width x (port + device)))
+    static UsbTopology MakeLargeTopology(uint32_t rootHubs, uint32_t width)
+    {
+        UsbTopology topology;
+        uint16_t productId = 0;
+        for (uint32_t r = 0; r < rootHubs; ++r)
+        {
+            const auto controller = topology.Add(MakeNode(UsbTopologyNodeKind::Controller, UsbTopology::NoNode, 0));
+            const auto root = topology.Add(MakeNode(UsbTopologyNodeKind::Hub, controller, 0));
+            for (uint32_t p = 1; p <= width; ++p)
+            {
+                const auto rootPort = topology.Add(MakeNode(UsbTopologyNodeKind::Port, root, p));
+                const auto hub = topology.Add(MakeNode(UsbTopologyNodeKind::Hub, rootPort, p, productId++));
+                for (uint32_t q = 1; q <= width; ++q)
+                {
+                    const auto port = topology.Add(MakeNode(UsbTopologyNodeKind::Port, hub, q));
+                    topology.Add(MakeNode(UsbTopologyNodeKind::Device, port, q, productId++));
+                }
+            }
+        }
+        return topology;
+    }
+};
+
+TEST_F(TopologyExporterBenchmark, LargeTopology_ExportsWellUnderASecond)
+{
+    const UsbTopology topology = MakeLargeTopology(4, 35);
+    ASSERT_GT(topology.size(), 10000u);
+
+    for (auto format : { TopologyFormat::Dot, TopologyFormat::Json })
+    {
+        TopologyExporter exporter([](const char*, size_t) {}, format);
+
+        const auto start = std::chrono::steady_clock::now();
+        exporter.Write(topology);
+        exporter.Flush();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        EXPECT_LT(seconds, 1.0) << (format == TopologyFormat::Dot ? "Dot" : "Json");
+    }
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -40,7 +40,7 @@ protected:
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateUsbDevices) {
     manager->EnumerateUsbDevices();
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"USB Devices");
 
     // USB devices should exist on most systems
@@ -49,7 +49,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateUsbDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateMediaDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_MEDIA);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Media Devices (Sound, Video, Game Controllers)");
 
     EXPECT_GE(devices.size(), 0u);
@@ -57,7 +57,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateMediaDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateModemDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_MODEM);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Modem Devices");
 
     EXPECT_GE(devices.size(), 0u);
@@ -65,7 +65,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateModemDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateKeyboardDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_KEYBOARD);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Keyboard Devices");
 
     // Most systems have at least one keyboard
@@ -74,7 +74,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateKeyboardDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateMouseDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_MOUSE);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Mouse Devices");
 
     EXPECT_GE(devices.size(), 0u);
@@ -82,7 +82,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateMouseDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateDiskDriveDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_DISKDRIVE);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Disk Drive Devices");
 
     // Most systems have at least one disk drive
@@ -91,7 +91,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateDiskDriveDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateNetworkDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_NET);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Network Adapter Devices");
 
     // Most systems have at least one network adapter
@@ -100,7 +100,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateNetworkDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateBluetoothDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_BLUETOOTH);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Bluetooth Devices");
 
     EXPECT_GE(devices.size(), 0u);
@@ -108,7 +108,7 @@ TEST_F(DeviceClassEnumerationE2ETest, EnumerateBluetoothDevices) {
 
 TEST_F(DeviceClassEnumerationE2ETest, EnumerateImageDevices) {
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_IMAGE);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     PrintDevices(devices, L"Image Devices (Cameras, Scanners)");
 
     EXPECT_GE(devices.size(), 0u);
@@ -120,47 +120,47 @@ TEST_F(DeviceClassEnumerationE2ETest, FullDeviceEnumerationDemo) {
 
     // USB devices
     manager->EnumerateUsbDevices();
-    auto usbDevices = manager->GetDevices();
+    auto usbDevices = manager->GetDevices()->devices;
     PrintDevices(usbDevices, L"USB Devices");
 
     // Media Devices
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_MEDIA);
-    auto mediaDevices = manager->GetDevices();
+    auto mediaDevices = manager->GetDevices()->devices;
     PrintDevices(mediaDevices, L"Media Devices");
 
     // Modems
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_MODEM);
-    auto modemDevices = manager->GetDevices();
+    auto modemDevices = manager->GetDevices()->devices;
     PrintDevices(modemDevices, L"Modem Devices");
 
     // Keyboards
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_KEYBOARD);
-    auto keyboardDevices = manager->GetDevices();
+    auto keyboardDevices = manager->GetDevices()->devices;
     PrintDevices(keyboardDevices, L"Keyboard Devices");
 
     // Mice
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_MOUSE);
-    auto mouseDevices = manager->GetDevices();
+    auto mouseDevices = manager->GetDevices()->devices;
     PrintDevices(mouseDevices, L"Mouse Devices");
 
     // Disk Drives
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_DISKDRIVE);
-    auto diskDevices = manager->GetDevices();
+    auto diskDevices = manager->GetDevices()->devices;
     PrintDevices(diskDevices, L"Disk Drive Devices");
 
     // Network Adapters
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_NET);
-    auto networkDevices = manager->GetDevices();
+    auto networkDevices = manager->GetDevices()->devices;
     PrintDevices(networkDevices, L"Network Adapter Devices");
 
     // Bluetooth
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_BLUETOOTH);
-    auto bluetoothDevices = manager->GetDevices();
+    auto bluetoothDevices = manager->GetDevices()->devices;
     PrintDevices(bluetoothDevices, L"Bluetooth Devices");
 
     // Image Devices
     manager->EnumerateByDeviceClass(GUID_DEVCLASS_IMAGE);
-    auto imageDevices = manager->GetDevices();
+    auto imageDevices = manager->GetDevices()->devices;
     PrintDevices(imageDevices, L"Image Devices");
 
     // Summary
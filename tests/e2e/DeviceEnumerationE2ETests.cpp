@@ -6,6 +6,12 @@
 #include <gtest/gtest.h>
 #include "WinDevicesAPI.h"
 #include <iostream>
+#include <string>
+
+static int AppendToString(const char* data, unsigned int size, void* context) {
+    static_cast<std::string*>(context)->append(data, size);
+    return 0;
+}
 
 class DeviceEnumerationE2ETest : public ::testing::Test {
 protected:
@@ -72,6 +78,20 @@ TEST_F(DeviceEnumerationE2ETest, CompareUsbVsAllDevices) {
         << "All devices count should be >= USB devices count";
 }
 
+TEST_F(DeviceEnumerationE2ETest, ExportTopologyAfterClearIsEmpty) {
+    ASSERT_EQ(WD_EnumerateUsbDevices(handle), WD_SUCCESS);
+
+    std::string topology;
+    ASSERT_EQ(WD_ExportTopology(handle, WD_TOPOLOGY_JSON, AppendToString, &topology), WD_SUCCESS);
+    EXPECT_NE(topology, "{\"nodes\":[]}") << "A USB enumeration should report at least one controller";
+
+    // The export reads the handle's result, which no longer lists any device
+    ASSERT_EQ(WD_ClearDevices(handle), WD_SUCCESS);
+    topology.clear();
+    ASSERT_EQ(WD_ExportTopology(handle, WD_TOPOLOGY_JSON, AppendToString, &topology), WD_SUCCESS);
+    EXPECT_EQ(topology, "{\"nodes\":[]}");
+}
+
 TEST_F(DeviceEnumerationE2ETest, InvalidHandleReturnsError) {
     WD_RESULT result = WD_EnumerateUsbDevices(nullptr);
     EXPECT_EQ(result, WD_ERROR_INVALID_HANDLE);
@@ -100,6 +120,47 @@ TEST_F(DeviceEnumerationE2ETest, InvalidIndexReturnsError) {
     EXPECT_EQ(result, WD_ERROR_INVALID_INDEX);
 }
 
+TEST_F(DeviceEnumerationE2ETest, EnumerateUsbDevicesExWithoutDeadlineIsComplete) {
+    WD_ENUM_STATUS status;
+    WD_RESULT result = WD_EnumerateUsbDevicesEx(handle, nullptr, &status);
+    ASSERT_EQ(result, WD_SUCCESS);
+
+    EXPECT_EQ(status.isComplete, 1);
+    EXPECT_EQ(status.timedOut, 0);
+    EXPECT_EQ(status.cancelled, 0);
+    EXPECT_EQ(status.skippedCount, 0);
+
+    WD_SKIPPED_NODE node;
+    EXPECT_EQ(WD_GetSkippedNode(handle, 0, &node), WD_ERROR_INVALID_INDEX);
+}
+
+TEST_F(DeviceEnumerationE2ETest, EnumerateUsbDevicesExReportsSkippedNodes) {
+    WD_ENUM_OPTIONS options = { 1 };
+    WD_ENUM_STATUS status;
+    WD_RESULT result = WD_EnumerateUsbDevicesEx(handle, &options, &status);
+
+    // A 1 ms budget may or may not be enough; either way the result must be consistent
+    if (result == WD_SUCCESS) {
+        EXPECT_EQ(status.isComplete, 1);
+        return;
+    }
+    ASSERT_EQ(result, WD_ERROR_TIMEOUT);
+    EXPECT_EQ(status.timedOut, 1);
+    ASSERT_GT(status.skippedCount, 0);
+
+    WD_SKIPPED_NODE node;
+    ASSERT_EQ(WD_GetSkippedNode(handle, 0, &node), WD_SUCCESS);
+    EXPECT_NE(node.hubPath[0], '\0');
+    EXPECT_EQ(node.reason, WD_SKIP_TIMED_OUT);
+}
+
+TEST_F(DeviceEnumerationE2ETest, CancelBeforeEnumerateIsCleared) {
+    // A cancellation request is reset when the next enumeration starts
+    ASSERT_EQ(WD_CancelEnumeration(handle), WD_SUCCESS);
+    EXPECT_EQ(WD_EnumerateUsbDevicesEx(handle, nullptr, nullptr), WD_SUCCESS);
+    EXPECT_EQ(WD_CancelEnumeration(nullptr), WD_ERROR_INVALID_HANDLE);
+}
+
 TEST_F(DeviceEnumerationE2ETest, ErrorMessages) {
     std::cout << "\n*** Testing error messages ***" << std::endl;
     
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "AllocationProfiler.h"
+#include "DeviceCorrelator.h"
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "DevInfoData.h"
+#include "UsbDeviceDescriptorInfo.h"
+#include "mocks/MockUsbBackend.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+// Allocation budget per enumerated device for a scan of the simulated bus below
+// (all phases). Lower it when an optimization lands; a failure means a change
+// made USB enumeration allocate more per device.
+#if defined(_MSC_VER) && defined(_DEBUG)
+// MSVC debug containers allocate an extra iterator-debugging proxy per container
+constexpr double AllocationsPerDeviceBudget = 800.0;
+#else
+constexpr double AllocationsPerDeviceBudget = 400.0;
+#endif
+
+/// <summary>
+/// Allocation profiling of full DevicesManager scans over a simulated bus
+/// (2 root hubs x 4 external hubs x 8 devices = 64 devices).
+/// Counting tests are skipped unless built with ENABLE_ALLOCATION_PROFILER=ON.
+/// </summary>
+class AllocationProfilerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        manager_ = std::make_unique<DevicesManager>(
+            std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 4, 8)));
+    }
+
+    AllocationReport ProfileScan()
+    {
+        AllocationProfiler::Start();
+        manager_->EnumerateUsbDevices();
+        return AllocationProfiler::Stop(manager_->GetDeviceCount());
+    }
+
+    std::unique_ptr<DevicesManager> manager_;
+};
+
+TEST_F(AllocationProfilerTest, MockScan_EnumeratesAllSimulatedDevices)
+{
+    manager_->EnumerateUsbDevices();
+
+    ASSERT_EQ(manager_->GetDeviceCount(), 64u);
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    for (const auto& device : snapshot->devices)
+    {
+        EXPECT_EQ(device.GetVendorId(), 0x1234u);
+        EXPECT_EQ(device.GetManufacturer(), L"Simulated Vendor");
+        EXPECT_EQ(device.GetProduct(), L"Simulated Device " + std::to_wstring(device.GetProductId()));
+        EXPECT_TRUE(device.IsUsbDevice());
+    }
+}
+
+TEST_F(AllocationProfilerTest, PhaseScopes_NestAndRestore)
+{
+    EXPECT_EQ(AllocationProfiler::CurrentPhase(), AllocationPhase::Other);
+    {
+        AllocationPhaseScope traversal{ AllocationPhase::Traversal };
+        EXPECT_EQ(AllocationProfiler::CurrentPhase(), AllocationPhase::Traversal);
+        {
+            AllocationPhaseScope correlation{ AllocationPhase::Correlation };
+            EXPECT_EQ(AllocationProfiler::CurrentPhase(), AllocationPhase::Correlation);
+        }
+        EXPECT_EQ(AllocationProfiler::CurrentPhase(), AllocationPhase::Traversal);
+    }
+    EXPECT_EQ(AllocationProfiler::CurrentPhase(), AllocationPhase::Other);
+}
+
+TEST_F(AllocationProfilerTest, Report_NormalizesPerDevice)
+{
+    AllocationReport report;
+    report.deviceCount = 4;
+    report.phases[static_cast<size_t>(AllocationPhase::Traversal)] = { 8, 800 };
+    report.phases[static_cast<size_t>(AllocationPhase::Correlation)] = { 4, 200 };
+
+    EXPECT_EQ(report.Total().allocations, 12u);
+    EXPECT_DOUBLE_EQ(report.AllocationsPerDevice(), 3.0);
+    EXPECT_DOUBLE_EQ(report.AllocationsPerDevice(AllocationPhase::Traversal), 2.0);
+    EXPECT_DOUBLE_EQ(report.BytesPerDevice(), 250.0);
+
+    report.deviceCount = 0;
+    EXPECT_DOUBLE_EQ(report.AllocationsPerDevice(), 0.0);
+}
+
+TEST_F(AllocationProfilerTest, MockScan_AttributesAllocationsToPhases)
+{
+    if (!AllocationProfiler::IsAvailable()) {
+        GTEST_SKIP() << "Built without ENABLE_ALLOCATION_PROFILER";
+    }
+
+    AllocationReport report = ProfileScan();
+
+    EXPECT_FALSE(AllocationProfiler::IsRecording());
+    EXPECT_GT(report[AllocationPhase::Traversal].allocations, 0u);
+    EXPECT_GT(report[AllocationPhase::DescriptorFetch].allocations, 0u);
+    EXPECT_GT(report[AllocationPhase::Correlation].allocations, 0u);
+}
+
+TEST_F(AllocationProfilerTest, MockScan_AllocationsPerDeviceWithinBudget)
+{
+    if (!AllocationProfiler::IsAvailable()) {
+        GTEST_SKIP() << "Built without ENABLE_ALLOCATION_PROFILER";
+    }
+
+    // Warm-up scan so one-time allocations (vendor tables, logger) are not counted
+    manager_->EnumerateUsbDevices();
+    AllocationReport report = ProfileScan();
+    ASSERT_EQ(report.deviceCount, 64u);
+
+    RecordProperty("AllocationsPerDevice", std::to_string(report.AllocationsPerDevice()));
+    RecordProperty("TraversalPerDevice", std::to_string(report.AllocationsPerDevice(AllocationPhase::Traversal)));
+    RecordProperty("DescriptorsPerDevice", std::to_string(report.AllocationsPerDevice(AllocationPhase::DescriptorFetch)));
+    RecordProperty("CorrelationPerDevice", std::to_string(report.AllocationsPerDevice(AllocationPhase::Correlation)));
+    RecordProperty("OtherPerDevice", std::to_string(report.AllocationsPerDevice(AllocationPhase::Other)));
+    RecordProperty("BytesPerDevice", std::to_string(report.BytesPerDevice()));
+
+    EXPECT_LE(report.AllocationsPerDevice(), AllocationsPerDeviceBudget)
+        << "USB enumeration allocations per device regressed past the budget";
+}
+
+TEST_F(AllocationProfilerTest, Accessors_ReturnViewsWithoutAllocating)
+{
+    if (!AllocationProfiler::IsAvailable()) {
+        GTEST_SKIP() << "Built without ENABLE_ALLOCATION_PROFILER";
+    }
+
+    // Strings longer than the small-string buffer, so a copy would allocate
+    DevInfoData node{ nullptr, SP_DEVINFO_DATA{} };
+    node.SetDriverKeyName(L"{36fc9e60-c465-11cf-8056-444553540000}\\0042");
+    node.SetHardwareId(L"USB\\VID_1234&PID_0042&REV_0100");
+    node.SetDeviceDescription(L"Simulated USB Input Device");
+    UsbDeviceDescriptorInfo descriptor;
+    descriptor.SetUsbDeviceInfo(L"Simulated Vendor Incorporated", L"Simulated Device Product Name", L"SN-0000-0000-0042");
+
+    size_t characters = 0;
+    AllocationProfiler::Start();
+    for (int i = 0; i < 1000; ++i)
+    {
+        characters += node.GetDriverKeyName().size() + node.GetHardwareId().size() +
+            node.GetDeviceDescription().size() + node.GetPowerStateAsString().size() +
+            node.GetDevInfoData().cbSize;
+        characters += descriptor.GetManufacturer().size() + descriptor.GetProduct().size() +
+            descriptor.GetSerialNumber().size();
+    }
+    AllocationReport report = AllocationProfiler::Stop(1);
+
+    EXPECT_GT(characters, 0u);
+    EXPECT_EQ(report.Total().allocations, 0u);
+}
+
+TEST_F(AllocationProfilerTest, CorrelatorJoin_DoesNotAllocate)
+{
+    if (!AllocationProfiler::IsAvailable()) {
+        GTEST_SKIP() << "Built without ENABLE_ALLOCATION_PROFILER";
+    }
+
+    std::vector<DevInfoData> nodes;
+    for (int i = 0; i < 32; ++i)
+    {
+        DevInfoData node{ nullptr, SP_DEVINFO_DATA{} };
+        node.SetDriverKeyName(L"{36fc9e60-c465-11cf-8056-444553540000}\\" + std::to_wstring(i));
+        node.SetHardwareId(L"USB\\VID_1234&PID_" + std::to_wstring(1000 + i));
+        node.SetDeviceDescription(L"Simulated Device Product Name " + std::to_wstring(i));
+        nodes.push_back(std::move(node));
+    }
+    DeviceCorrelator correlator{ nodes };
+    UsbDeviceDescriptorInfo descriptor;
+    descriptor.SetUsbDeviceInfo(L"Simulated Vendor", L"Simulated Device Product Name 7", L"");
+    const std::wstring driverKey = L"{36fc9e60-c465-11cf-8056-444553540000}\\7";
+
+    // The per-port lookups of EnumeratePortsFromRootHub, repeated as for every port of a scan
+    size_t matched = 0;
+    AllocationProfiler::Start();
+    for (int port = 0; port < 1000; ++port)
+    {
+        matched += correlator.Join(driverKey, 0x1234, 0x1007, false, descriptor.GetProduct()).functionNode != nullptr;
+        matched += correlator.Join(L"", 0xFFFF, 0xFFFF, false, descriptor.GetProduct()).functionNode != nullptr;
+    }
+    AllocationReport report = AllocationProfiler::Stop(1);
+
+    EXPECT_EQ(matched, 2000u);
+    EXPECT_EQ(report.Total().allocations, 0u);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,355 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "DeviceChangeJournal.h"
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "mocks/MockUsbBackend.h"
+#include "fixtures/TestDevices.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for DiffSnapshots, DeviceChangeJournal (sequencing, compaction,
+/// resync, file persistence) and DevicesManager::GetChangesSince.
+/// </summary>
+class DeviceChangeJournalTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path_ = std::filesystem::temp_directory_path() /
+            (std::string("kdm_journal_") + info->name() + ".bin");
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path_);
+    }
+
+    // Appends the changes from previous to current and returns the journal's last sequence
+    static uint64_t Record(DeviceChangeJournal& journal, const DeviceSnapshot& previous, const DeviceSnapshot& current)
+    {
+        return journal.Append(DiffSnapshots(previous, current));
+    }
+
+    std::filesystem::path path_;
+};
+
+TEST_F(DeviceChangeJournalTest, Diff_ReportsArrivalsRemovalsAndChanges)
+{
+    auto previous = MakeSnapshot(1, { MakeDevice(1), MakeDevice(2), MakeDevice(3) });
+    auto current = MakeSnapshot(2, { MakeDevice(1), MakeDevice(3, L"Renamed"), MakeDevice(4) });
+
+    auto changes = DiffSnapshots(previous, current);
+
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(changes[0].type, DeviceChangeType::Removed);
+    EXPECT_EQ(changes[0].device.GetProductId(), 2u);
+    EXPECT_EQ(changes[1].type, DeviceChangeType::Changed);
+    EXPECT_EQ(changes[1].device.GetProduct(), L"Renamed");
+    EXPECT_EQ(changes[2].type, DeviceChangeType::Arrived);
+    EXPECT_EQ(changes[2].device.GetProductId(), 4u);
+    for (const auto& change : changes) {
+        EXPECT_EQ(change.snapshotVersion, 2u);
+    }
+}
+
+TEST_F(DeviceChangeJournalTest, Diff_IdenticalDevicesCountSeparately)
+{
+    auto previous = MakeSnapshot(1, { MakeDevice(1), MakeDevice(1) });
+    auto current = MakeSnapshot(2, { MakeDevice(1) });
+
+    auto changes = DiffSnapshots(previous, current);
+
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].type, DeviceChangeType::Removed);
+}
+
+TEST_F(DeviceChangeJournalTest, Diff_DuplicateKeysPairInPreviousOrder)
+{
+    // Same key, different products: the product is not part of the key
+    auto previous = MakeSnapshot(1, { MakeDevice(1, L"First"), MakeDevice(1, L"Second") });
+
+    auto identical = DiffSnapshots(previous, MakeSnapshot(2, { MakeDevice(1, L"Second") }));
+    ASSERT_EQ(identical.size(), 1u);
+    EXPECT_EQ(identical[0].type, DeviceChangeType::Removed);
+    EXPECT_EQ(identical[0].device.GetProduct(), L"First");
+
+    auto renamed = DiffSnapshots(previous, MakeSnapshot(2, { MakeDevice(1, L"Third") }));
+    ASSERT_EQ(renamed.size(), 2u);
+    EXPECT_EQ(renamed[0].type, DeviceChangeType::Removed);
+    EXPECT_EQ(renamed[0].device.GetProduct(), L"Second");
+    EXPECT_EQ(renamed[1].type, DeviceChangeType::Changed);
+    EXPECT_EQ(renamed[1].device.GetProduct(), L"Third");
+}
+
+TEST_F(DeviceChangeJournalTest, GetChangesSince_ReturnsTailBySequence)
+{
+    DeviceChangeJournal journal;
+    auto empty = MakeSnapshot(0, {});
+    auto first = MakeSnapshot(1, { MakeDevice(1), MakeDevice(2) });
+    auto second = MakeSnapshot(2, { MakeDevice(2) });
+
+    EXPECT_EQ(Record(journal, empty, first), 2u);
+    EXPECT_EQ(Record(journal, first, second), 3u);
+
+    auto all = journal.GetChangesSince(0);
+    EXPECT_FALSE(all.resync);
+    ASSERT_EQ(all.changes.size(), 3u);
+    for (size_t i = 0; i < all.changes.size(); ++i) {
+        EXPECT_EQ(all.changes[i].sequence, i + 1);
+    }
+
+    auto tail = journal.GetChangesSince(2);
+    ASSERT_EQ(tail.changes.size(), 1u);
+    EXPECT_EQ(tail.changes[0].type, DeviceChangeType::Removed);
+    EXPECT_EQ(tail.lastSequence, 3u);
+
+    EXPECT_TRUE(journal.GetChangesSince(3).changes.empty());
+}
+
+TEST_F(DeviceChangeJournalTest, Compaction_FoldsOldestIntoBaseline)
+{
+    JournalPolicy policy;
+    policy.compactionThreshold = 4;
+    DeviceChangeJournal journal(policy);
+
+    DeviceSnapshot previous = MakeSnapshot(0, {});
+    std::vector<DeviceResultantInfo> devices;
+    for (uint16_t pid = 1; pid <= 5; ++pid)
+    {
+        devices.push_back(MakeDevice(pid));
+        auto current = MakeSnapshot(pid, devices);
+        Record(journal, previous, current);
+        previous = current;
+    }
+
+    // The fifth record exceeded the threshold; the newest half (2) is kept
+    EXPECT_EQ(journal.GetRecordCount(), 2u);
+    EXPECT_EQ(journal.GetBaseSequence(), 3u);
+
+    auto recent = journal.GetChangesSince(3);
+    EXPECT_FALSE(recent.resync);
+    EXPECT_EQ(recent.changes.size(), 2u);
+
+    auto stale = journal.GetChangesSince(1);
+    EXPECT_TRUE(stale.resync);
+    EXPECT_EQ(stale.baseline.size(), 3u);
+    EXPECT_EQ(stale.changes.size(), 2u);
+}
+
+TEST_F(DeviceChangeJournalTest, UnknownSequence_RequestsResync)
+{
+    DeviceChangeJournal journal;
+    Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { MakeDevice(1) }));
+
+    EXPECT_TRUE(journal.GetChangesSince(42).resync);
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_ReloadContinuesSequence)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+
+    {
+        DeviceChangeJournal journal(policy);
+        Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { MakeDevice(1), MakeDevice(2, L"Keyboard") }));
+    }
+
+    DeviceChangeJournal reloaded(policy);
+    EXPECT_EQ(reloaded.GetLastSequence(), 2u);
+
+    auto changes = reloaded.GetChangesSince(0).changes;
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[1].device, MakeDevice(2, L"Keyboard"));
+
+    Record(reloaded, MakeSnapshot(1, { MakeDevice(1), MakeDevice(2, L"Keyboard") }), MakeSnapshot(2, {}));
+    EXPECT_EQ(reloaded.GetLastSequence(), 4u);
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_ReloadKeepsLocationKeys)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+
+    // Identical devices told apart only by the port they are on
+    DeviceResultantInfo left = MakeDevice(1);
+    left.SetSerialNumber(L"");
+    left.SetLocationKey(0x0101);
+    DeviceResultantInfo right = left;
+    right.SetLocationKey(0x0102);
+    const DeviceSnapshot current = MakeSnapshot(1, { left, right });
+    {
+        DeviceChangeJournal journal(policy);
+        journal.Synchronize(current);
+        journal.Compact();
+    }
+
+    // After a restart the journaled devices must match the live ones exactly
+    DeviceChangeJournal reloaded(policy);
+    const uint64_t lastSequence = reloaded.GetLastSequence();
+    EXPECT_EQ(reloaded.Synchronize(current), lastSequence);
+    EXPECT_TRUE(reloaded.GetChangesSince(lastSequence).changes.empty());
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_LongStringsSurviveReload)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+
+    // A single field beyond 32K characters, still within what a device can hold
+    DeviceResultantInfo longPath = MakeDevice(1);
+    longPath.SetDevicePath(std::wstring(40 * 1024, L'p'));
+    {
+        DeviceChangeJournal journal(policy);
+        Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { longPath, MakeDevice(2) }));
+    }
+
+    DeviceChangeJournal reloaded(policy);
+    EXPECT_EQ(reloaded.GetLastSequence(), 2u);
+
+    auto changes = reloaded.GetChangesSince(0).changes;
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].device, longPath);
+    EXPECT_EQ(changes[1].device, MakeDevice(2));
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_TruncatedTailIsIgnored)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+    {
+        DeviceChangeJournal journal(policy);
+        Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { MakeDevice(1) }));
+    }
+    {
+        // Half-written record, as left by a crash
+        std::ofstream out(path_, std::ios::binary | std::ios::app);
+        const char partial[] = { 1, 2, 0, 0 };
+        out.write(partial, sizeof(partial));
+    }
+
+    DeviceChangeJournal reloaded(policy);
+    EXPECT_EQ(reloaded.GetLastSequence(), 1u);
+    EXPECT_EQ(reloaded.GetRecordCount(), 1u);
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_CompactedBaselineSurvivesReload)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+    {
+        DeviceChangeJournal journal(policy);
+        Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { MakeDevice(1), MakeDevice(2) }));
+        journal.Compact();
+    }
+
+    DeviceChangeJournal reloaded(policy);
+    EXPECT_EQ(reloaded.GetBaseSequence(), 2u);
+
+    auto set = reloaded.GetChangesSince(0);
+    EXPECT_TRUE(set.resync);
+    EXPECT_EQ(set.baseline.size(), 2u);
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_StringsAreUtf16LittleEndian)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+    {
+        DeviceChangeJournal journal(policy);
+        Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { MakeDevice(1, L"\u00E9t\u00E9") }));
+    }
+
+    std::ifstream in(path_, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_NE(bytes.find(std::string("\x03\0\0\0\xE9\0t\0\xE9\0", 10)), std::string::npos);
+}
+
+TEST_F(DeviceChangeJournalTest, FileBacked_FailedAppendThrowsAndTakesNothing)
+{
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+    DeviceChangeJournal journal(policy);
+    Record(journal, MakeSnapshot(0, {}), MakeSnapshot(1, { MakeDevice(1) }));
+
+    // A directory in place of the file makes every write fail
+    std::filesystem::remove(path_);
+    std::filesystem::create_directory(path_);
+    EXPECT_THROW(Record(journal, MakeSnapshot(1, { MakeDevice(1) }), MakeSnapshot(2, { MakeDevice(1), MakeDevice(2) })),
+        DeviceIoException);
+    EXPECT_EQ(journal.GetLastSequence(), 1u);
+    EXPECT_EQ(journal.GetRecordCount(), 1u);
+
+    // The next write replaces the file with everything the journal holds
+    std::filesystem::remove(path_);
+    EXPECT_EQ(Record(journal, MakeSnapshot(1, { MakeDevice(1) }), MakeSnapshot(2, { MakeDevice(1), MakeDevice(2) })), 2u);
+
+    DeviceChangeJournal reloaded(policy);
+    EXPECT_EQ(reloaded.GetLastSequence(), 2u);
+    EXPECT_EQ(reloaded.GetRecordCount(), 2u);
+}
+
+TEST_F(DeviceChangeJournalTest, NotAJournalFile_Throws)
+{
+    {
+        std::ofstream out(path_, std::ios::binary);
+        out << "not a journal";
+    }
+
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+    EXPECT_THROW(DeviceChangeJournal journal(policy), DeviceIoException);
+}
+
+TEST_F(DeviceChangeJournalTest, DevicesManager_JournalsEveryPublication)
+{
+    auto backend = std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4));
+    MockUsbBackend* bus = backend.get();
+    DevicesManager manager(std::move(backend));
+
+    manager.EnumerateUsbDevices();
+    auto initial = manager.GetChangesSince(0);
+    EXPECT_EQ(initial.changes.size(), 8u);
+
+    manager.EnumerateUsbDevices();
+    EXPECT_TRUE(manager.GetChangesSince(initial.lastSequence).changes.empty());
+
+    bus->SetRootHubs(MakeSimulatedBus(1, 1, 4));
+    manager.EnumerateUsbDevices();
+    auto update = manager.GetChangesSince(initial.lastSequence);
+    ASSERT_EQ(update.changes.size(), 4u);
+    for (const auto& change : update.changes) {
+        EXPECT_EQ(change.type, DeviceChangeType::Removed);
+    }
+}
+
+TEST_F(DeviceChangeJournalTest, DevicesManager_FileJournalSynchronizesWithCurrentDevices)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(1, 1, 3)));
+    manager.EnumerateUsbDevices();
+
+    JournalPolicy policy;
+    policy.filePath = path_.wstring();
+    manager.SetJournalPolicy(policy);
+
+    auto set = manager.GetChangesSince(0);
+    EXPECT_EQ(set.changes.size(), 3u);
+    EXPECT_EQ(set.lastSequence, 3u);
+}
+
+} // namespace Testing
+} // namespace KDM
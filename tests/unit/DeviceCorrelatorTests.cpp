@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "DeviceCorrelator.h"
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for DeviceCorrelator: driver key, VID/PID, container ID and product-name
+/// joins between hub ports and SetupAPI device nodes, and the join statistics.
+/// </summary>
+class DeviceCorrelatorTest : public ::testing::Test
+{
+protected:
+    static constexpr GUID UsbClass{ 0x36fc9e60, 0xc465, 0x11cf, { 0x80, 0x56, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00 } };
+    static constexpr GUID HidClass{ 0x745a17a0, 0x74d3, 0x11d0, { 0xb6, 0xfe, 0x00, 0xa0, 0xc9, 0x0f, 0x57, 0xda } };
+    static constexpr GUID DiskClass{ 0x4d36e967, 0xe325, 0x11ce, { 0xbf, 0xc1, 0x08, 0x00, 0x2b, 0xe1, 0x03, 0x18 } };
+
+    static constexpr wchar_t ContainerA[] = L"{8F3A2C11-0D7E-4B8B-9F43-1C2D3E4F5A6B}";
+    static constexpr wchar_t LocalMachine[] = L"{00000000-0000-0000-FFFF-FFFFFFFFFFFF}";
+
+    DevInfoData& AddNode(const GUID& classGuid, std::vector<std::wstring> hardwareIds,
+        const std::wstring& driverKey = {}, const std::wstring& containerId = {},
+        const std::wstring& description = {})
+    {
+        SP_DEVINFO_DATA devInfoData{};
+        devInfoData.cbSize = sizeof(SP_DEVINFO_DATA);
+        devInfoData.ClassGuid = classGuid;
+        devInfoData.DevInst = static_cast<DWORD>(nodes_.size() + 1);
+
+        DevInfoData node(nullptr, devInfoData);
+        node.SetHardwareIds(hardwareIds);
+        node.SetDriverKeyName(driverKey);
+        node.SetContainerId(containerId);
+        node.SetDeviceDescription(description);
+        nodes_.push_back(std::move(node));
+        return nodes_.back();
+    }
+
+    std::vector<DevInfoData> nodes_;
+};
+
+TEST_F(DeviceCorrelatorTest, DriverKeyOnly_UsesBusNode)
+{
+    AddNode(UsbClass, { L"USB\\VID_1234&PID_0001&REV_0100" }, L"{usb}\\0000");
+    AddNode(UsbClass, { L"USB\\VID_1234&PID_0002&REV_0100" }, L"{usb}\\0001");
+
+    DeviceCorrelator correlator{ nodes_ };
+    const PortCorrelation correlation = correlator.Join(L"{usb}\\0001", 0x1234, 0x0002, false, {});
+
+    EXPECT_EQ(correlation.busNode, &nodes_[1]);
+    EXPECT_EQ(correlation.functionNode, &nodes_[1]);
+    EXPECT_EQ(correlation.rule, CorrelationRule::DriverKey);
+}
+
+TEST_F(DeviceCorrelatorTest, CompositeDevice_PrefersWholeDeviceThenLowestInterface)
+{
+    AddNode(UsbClass, { L"USB\\VID_046D&PID_C52B&REV_1201" }, L"{usb}\\0000");
+    AddNode(HidClass, { L"HID\\VID_046D&PID_C52B&REV_1201&MI_02&Col01" });
+    AddNode(HidClass, { L"HID\\VID_046D&PID_C52B&REV_1201&MI_00" });
+
+    DeviceCorrelator correlator{ nodes_ };
+    const PortCorrelation correlation = correlator.Join(L"{usb}\\0000", 0x046D, 0xC52B, false, {});
+
+    EXPECT_EQ(correlation.busNode, &nodes_[0]);
+    EXPECT_EQ(correlation.functionNode, &nodes_[2]);
+    EXPECT_EQ(correlation.rule, CorrelationRule::VidPid);
+}
+
+TEST_F(DeviceCorrelatorTest, StorageFunction_JoinsThroughContainer)
+{
+    AddNode(UsbClass, { L"USB\\VID_0781&PID_5581&REV_0100" }, L"{usb}\\0000", ContainerA);
+    AddNode(DiskClass, { L"USBSTOR\\DiskSanDisk_Ultra___________1.00", L"GenDisk" }, {}, ContainerA);
+
+    DeviceCorrelator correlator{ nodes_ };
+    const PortCorrelation correlation = correlator.Join(L"{usb}\\0000", 0x0781, 0x5581, false, {});
+
+    EXPECT_EQ(correlation.functionNode, &nodes_[1]);
+    EXPECT_EQ(correlation.rule, CorrelationRule::ContainerId);
+}
+
+TEST_F(DeviceCorrelatorTest, ContainerJoin_SkipsHubsAndLocalMachineContainer)
+{
+    AddNode(UsbClass, { L"USB\\VID_05E3&PID_0608&REV_6060" }, L"{usb}\\0000", ContainerA);
+    AddNode(DiskClass, { L"USBSTOR\\DiskGeneric" }, {}, ContainerA);
+    AddNode(UsbClass, { L"USB\\VID_0781&PID_5581&REV_0100" }, L"{usb}\\0001", LocalMachine);
+    AddNode(DiskClass, { L"USBSTOR\\DiskBuiltIn" }, {}, LocalMachine);
+
+    DeviceCorrelator correlator{ nodes_ };
+    const PortCorrelation hub = correlator.Join(L"{usb}\\0000", 0x05E3, 0x0608, true, {});
+    const PortCorrelation device = correlator.Join(L"{usb}\\0001", 0x0781, 0x5581, false, {});
+
+    EXPECT_EQ(hub.functionNode, &nodes_[0]);
+    EXPECT_EQ(hub.rule, CorrelationRule::DriverKey);
+    EXPECT_EQ(device.functionNode, &nodes_[2]);
+    EXPECT_EQ(device.rule, CorrelationRule::DriverKey);
+}
+
+TEST_F(DeviceCorrelatorTest, ContainerJoin_SkipsSiblingWithOtherVidPid)
+{
+    AddNode(UsbClass, { L"USB\\VID_1234&PID_0001&REV_0100" }, L"{usb}\\0000", ContainerA);
+    AddNode(HidClass, { L"HID\\VID_1234&PID_0002&REV_0100" }, {}, ContainerA);
+
+    DeviceCorrelator correlator{ nodes_ };
+    const PortCorrelation correlation = correlator.Join(L"{usb}\\0000", 0x1234, 0x0001, false, {});
+
+    EXPECT_EQ(correlation.functionNode, &nodes_[0]);
+    EXPECT_EQ(correlation.rule, CorrelationRule::DriverKey);
+}
+
+TEST_F(DeviceCorrelatorTest, NoDriverKey_FallsBackToVidPidThenProductName)
+{
+    AddNode(UsbClass, { L"USB\\VID_1234&PID_0001&REV_0100" });
+    AddNode(UsbClass, { L"USB\\ROOT_HUB30" }, {}, {}, L"Widget Pro");
+
+    DeviceCorrelator correlator{ nodes_ };
+    const PortCorrelation byVidPid = correlator.Join(L"{usb}\\missing", 0x1234, 0x0001, false, L"Widget Pro");
+    const PortCorrelation byName = correlator.Join({}, 0x9999, 0x0001, false, L"Widget Pro");
+    const PortCorrelation none = correlator.Join({}, 0x9999, 0x0001, false, L"Widget");
+
+    EXPECT_EQ(byVidPid.busNode, nullptr);
+    EXPECT_EQ(byVidPid.functionNode, &nodes_[0]);
+    EXPECT_EQ(byVidPid.rule, CorrelationRule::VidPid);
+    EXPECT_EQ(byName.functionNode, &nodes_[1]);
+    EXPECT_EQ(byName.rule, CorrelationRule::ProductName);
+    EXPECT_EQ(none.functionNode, nullptr);
+    EXPECT_EQ(none.rule, CorrelationRule::None);
+}
+
+TEST_F(DeviceCorrelatorTest, Stats_CountPortsPerRule)
+{
+    AddNode(UsbClass, { L"USB\\VID_1234&PID_0001&REV_0100" }, L"{usb}\\0000");
+    AddNode(HidClass, { L"HID\\VID_1234&PID_0001&REV_0100" });
+    AddNode(UsbClass, { L"USB\\VID_1234&PID_0002&REV_0100" }, L"{usb}\\0001");
+
+    DeviceCorrelator correlator{ nodes_ };
+    (void)correlator.Join(L"{usb}\\0000", 0x1234, 0x0001, false, {});
+    (void)correlator.Join(L"{usb}\\0001", 0x1234, 0x0002, false, {});
+    (void)correlator.Join({}, 0x9999, 0x9999, false, {});
+
+    const CorrelationStats& stats = correlator.GetStats();
+    EXPECT_EQ(stats.indexedNodes, 3u);
+    EXPECT_EQ(stats.ports, 3u);
+    EXPECT_EQ(stats.busNodes, 2u);
+    EXPECT_EQ(stats.byVidPid, 1u);
+    EXPECT_EQ(stats.byDriverKey, 1u);
+    EXPECT_EQ(stats.unmatched, 1u);
+    EXPECT_STREQ(CorrelationRuleToString(CorrelationRule::ContainerId), "containerId");
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -31,7 +31,7 @@ TEST_F(DeviceEnumeratorTest, GetDevicesAfterEnumeration) {
     auto manager = std::make_unique<KDM::DevicesManager>();
     manager->EnumerateUsbDevices();
     
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     // Should have enumerated some devices on a Windows system
     EXPECT_GE(devices.size(), 0);
 }
@@ -40,7 +40,7 @@ TEST_F(DeviceEnumeratorTest, EnumeratedDevicesHaveValidInfo) {
     auto manager = std::make_unique<KDM::DevicesManager>();
     manager->EnumerateUsbDevices();
     
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     
     for (const auto& device : devices) {
         // Check that at least one field has data
@@ -60,10 +60,10 @@ TEST_F(DeviceEnumeratorTest, MultipleEnumerationCalls) {
     auto manager = std::make_unique<KDM::DevicesManager>();
     
     EXPECT_NO_THROW(manager->EnumerateUsbDevices());
-    auto count1 = manager->GetDevices().size();
+    auto count1 = manager->GetDevices()->devices.size();
     
     EXPECT_NO_THROW(manager->EnumerateUsbDevices());
-    auto count2 = manager->GetDevices().size();
+    auto count2 = manager->GetDevices()->devices.size();
     
     // Both calls should succeed and return similar counts
     EXPECT_GE(count1, 0);
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "DeviceEventRing.h"
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "mocks/MockUsbBackend.h"
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for DeviceEventRing (ordering, per-subscriber cursors, overflow
+/// accounting, concurrent producers/consumers) and the events DevicesManager
+/// derives from consecutive snapshots.
+/// </summary>
+class DeviceEventRingTest : public ::testing::Test
+{
+protected:
+    static DeviceEvent MakeEvent(uint16_t productId)
+    {
+        DeviceEvent event;
+        event.vendorId = 0x1234;
+        event.productId = productId;
+        return event;
+    }
+
+    static std::vector<DeviceEvent> Drain(DeviceEventSubscriber& subscriber)
+    {
+        std::vector<DeviceEvent> events(1024);
+        events.resize(subscriber.Poll(events.data(), events.size()));
+        return events;
+    }
+};
+
+TEST_F(DeviceEventRingTest, Capacity_RoundedUpToPowerOfTwo)
+{
+    EXPECT_EQ(DeviceEventRing(5).GetCapacity(), 8u);
+    EXPECT_EQ(DeviceEventRing(64).GetCapacity(), 64u);
+    EXPECT_THROW(DeviceEventRing(0), InvalidDeviceArgumentException);
+}
+
+TEST_F(DeviceEventRingTest, Poll_ReturnsEventsInOrderWithSequences)
+{
+    DeviceEventRing ring(16);
+    auto subscriber = ring.Subscribe();
+
+    for (uint16_t pid = 1; pid <= 5; ++pid) {
+        ring.Publish(MakeEvent(pid));
+    }
+
+    auto events = Drain(*subscriber);
+    ASSERT_EQ(events.size(), 5u);
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        EXPECT_EQ(events[i].sequence, i + 1);
+        EXPECT_EQ(events[i].productId, i + 1);
+    }
+    EXPECT_TRUE(Drain(*subscriber).empty());
+}
+
+TEST_F(DeviceEventRingTest, Poll_RespectsMaxEvents)
+{
+    DeviceEventRing ring(16);
+    auto subscriber = ring.Subscribe();
+    for (uint16_t pid = 1; pid <= 5; ++pid) {
+        ring.Publish(MakeEvent(pid));
+    }
+
+    DeviceEvent events[3];
+    EXPECT_EQ(subscriber->Poll(events, 3), 3u);
+    EXPECT_EQ(subscriber->GetPendingCount(), 2u);
+    EXPECT_EQ(subscriber->Poll(events, 3), 2u);
+    EXPECT_EQ(events[0].productId, 4);
+}
+
+TEST_F(DeviceEventRingTest, Subscribers_HaveIndependentCursors)
+{
+    DeviceEventRing ring(16);
+    auto first = ring.Subscribe();
+    ring.Publish(MakeEvent(1));
+    auto second = ring.Subscribe();
+    ring.Publish(MakeEvent(2));
+
+    EXPECT_EQ(Drain(*first).size(), 2u);
+
+    auto late = Drain(*second);
+    ASSERT_EQ(late.size(), 1u);
+    EXPECT_EQ(late[0].productId, 2);
+}
+
+TEST_F(DeviceEventRingTest, SlowSubscriber_LosesOldestAndCountsThem)
+{
+    DeviceEventRing ring(8);
+    auto subscriber = ring.Subscribe();
+
+    for (uint16_t pid = 1; pid <= 20; ++pid) {
+        ring.Publish(MakeEvent(pid));
+    }
+
+    auto events = Drain(*subscriber);
+    ASSERT_EQ(events.size(), 8u);
+    EXPECT_EQ(events.front().sequence, 13u);
+    EXPECT_EQ(events.back().sequence, 20u);
+    EXPECT_EQ(subscriber->GetDroppedCount(), 12u);
+}
+
+TEST_F(DeviceEventRingTest, ConcurrentProducersAndConsumers_DeliverEveryEventOnce)
+{
+    constexpr int numProducers = 4;
+    constexpr int eventsPerProducer = 5000;
+    constexpr uint64_t total = numProducers * eventsPerProducer;
+
+    DeviceEventRing ring(1 << 15);     // holds everything: nothing may be dropped
+    auto shared = ring.Subscribe();     // drained by two consumer threads
+    auto observer = ring.Subscribe();   // drained after the fact
+
+    std::atomic<bool> producing{ true };
+    std::vector<std::vector<uint64_t>> received(2);
+    std::vector<std::thread> consumers;
+    for (size_t c = 0; c < received.size(); ++c)
+    {
+        consumers.emplace_back([&, c]() {
+            DeviceEvent batch[32];
+            while (true)
+            {
+                const bool done = !producing.load();
+                const size_t count = shared->Poll(batch, 32);
+                for (size_t i = 0; i < count; ++i) {
+                    received[c].push_back(batch[i].sequence);
+                }
+                if (done && count == 0) {
+                    break;
+                }
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < eventsPerProducer; ++i) {
+                ring.Publish(MakeEvent(static_cast<uint16_t>(p)));
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    producing = false;
+    for (auto& t : consumers) {
+        t.join();
+    }
+
+    std::set<uint64_t> sequences;
+    for (const auto& list : received) {
+        sequences.insert(list.begin(), list.end());
+    }
+    EXPECT_EQ(received[0].size() + received[1].size(), total);
+    EXPECT_EQ(sequences.size(), total);
+    EXPECT_EQ(*sequences.rbegin(), total);
+    EXPECT_EQ(shared->GetDroppedCount(), 0u);
+
+    EXPECT_EQ(observer->GetPendingCount(), total);
+    EXPECT_EQ(ring.GetPublishedCount(), total);
+}
+
+TEST_F(DeviceEventRingTest, DevicesManager_PublishesArrivalsAndRemovals)
+{
+    auto backend = std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4));
+    MockUsbBackend* bus = backend.get();
+    DevicesManager manager(std::move(backend));
+    auto subscriber = manager.SubscribeEvents();
+
+    manager.EnumerateUsbDevices();
+    auto arrived = Drain(*subscriber);
+    ASSERT_EQ(arrived.size(), 8u);
+    for (const auto& event : arrived)
+    {
+        EXPECT_EQ(event.type, DeviceEventType::Arrived);
+        EXPECT_EQ(event.snapshotVersion, 1u);
+        EXPECT_EQ(event.vendorId, 0x1234);
+    }
+
+    // Unchanged bus: no events
+    manager.EnumerateUsbDevices();
+    EXPECT_TRUE(Drain(*subscriber).empty());
+
+    // Second root hub unplugged: its four devices are removed
+    bus->SetRootHubs(MakeSimulatedBus(1, 1, 4));
+    manager.EnumerateUsbDevices();
+    auto removed = Drain(*subscriber);
+    ASSERT_EQ(removed.size(), 4u);
+    for (const auto& event : removed)
+    {
+        EXPECT_EQ(event.type, DeviceEventType::Removed);
+        EXPECT_GE(event.productId, 5);
+    }
+
+    manager.ClearDevices();
+    EXPECT_EQ(Drain(*subscriber).size(), 4u);
+}
+
+TEST_F(DeviceEventRingTest, DeviceKey_DistinguishesDevicesWithSameIds)
+{
+    DeviceResultantInfo first;
+    first.SetVendorId(0x1234);
+    first.SetProductId(0x0001);
+    first.SetSerialNumber(L"A");
+    DeviceResultantInfo second = first;
+    second.SetSerialNumber(L"B");
+
+    EXPECT_NE(DeviceKeyOf(first), DeviceKeyOf(second));
+    EXPECT_EQ(DeviceKeyOf(first), DeviceKeyOf(DeviceResultantInfo(first)));
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "DeviceInventoryService.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "FaultInjectingUsbBackend.h"
+#include "mocks/MockUsbBackend.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for DeviceInventoryService: background refresh against a simulated bus,
+/// bounded-staleness reads, change notification and the adaptive interval.
+/// </summary>
+class DeviceInventoryServiceTest : public ::testing::Test
+{
+protected:
+    /// Service over a hot-pluggable simulated bus; bus_ stays valid for the service's lifetime.
+    std::unique_ptr<DeviceInventoryService> MakeService(InventoryRefreshPolicy policy)
+    {
+        auto backend = std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4));
+        bus_ = backend.get();
+        return std::make_unique<DeviceInventoryService>(std::move(backend), policy);
+    }
+
+    static InventoryRefreshPolicy IdlePolicy()
+    {
+        // Long intervals: only the first scan and explicit requests refresh
+        InventoryRefreshPolicy policy;
+        policy.fastInterval = 1h;
+        policy.slowInterval = 1h;
+        return policy;
+    }
+
+    MockUsbBackend* bus_ = nullptr;
+};
+
+TEST_F(DeviceInventoryServiceTest, FirstScan_PublishesVersionOne)
+{
+    auto service = MakeService(IdlePolicy());
+
+    DeviceSnapshotPtr snapshot = service->WaitForChange(0, 5s);
+
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->version, 1u);
+    EXPECT_EQ(snapshot->devices.size(), 8u);
+}
+
+TEST_F(DeviceInventoryServiceTest, GetDevices_BeforeFirstScan_WaitsForIt)
+{
+    auto service = MakeService(IdlePolicy());
+
+    DeviceSnapshotPtr snapshot = service->GetDevices(1h);
+
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->version, 1u);
+    EXPECT_EQ(snapshot->devices.size(), 8u);
+}
+
+TEST_F(DeviceInventoryServiceTest, GetDevices_FreshEnough_DoesNotScan)
+{
+    auto service = MakeService(IdlePolicy());
+    DeviceSnapshotPtr first = service->GetDevices(1h);
+
+    DeviceSnapshotPtr second = service->GetDevices(1h);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(service->GetStats().refreshes, 1u);
+}
+
+TEST_F(DeviceInventoryServiceTest, GetDevices_TooOld_WaitsForRefresh)
+{
+    auto service = MakeService(IdlePolicy());
+    (void)service->GetDevices(1h);
+    std::this_thread::sleep_for(10ms);
+
+    DeviceSnapshotPtr snapshot = service->GetDevices(1ms);
+
+    // Rescanned, but an unchanged bus is not a new inventory
+    EXPECT_EQ(service->GetStats().refreshes, 2u);
+    EXPECT_EQ(snapshot->version, 1u);
+}
+
+TEST_F(DeviceInventoryServiceTest, HotPlug_WaitForChange_ReturnsNewInventory)
+{
+    auto service = MakeService(IdlePolicy());
+    ASSERT_NE(service->WaitForChange(0, 5s), nullptr);
+
+    bus_->SetRootHubs(MakeSimulatedBus(1, 1, 2));
+    service->RequestRefresh();
+    DeviceSnapshotPtr snapshot = service->WaitForChange(1, 5s);
+
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->version, 2u);
+    EXPECT_EQ(snapshot->devices.size(), 2u);
+    EXPECT_EQ(service->GetStats().changes, 2u);
+}
+
+TEST_F(DeviceInventoryServiceTest, Snapshot_KeepsTopologyAndArenaOfScan)
+{
+    auto service = MakeService(IdlePolicy());
+
+    DeviceSnapshotPtr snapshot = service->GetDevices(1h);
+
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_NE(snapshot->arena, nullptr);
+    ASSERT_FALSE(snapshot->topology.empty());
+    for (size_t i = 0; i < snapshot->devices.size(); ++i) {
+        EXPECT_NE(snapshot->topology.GetDeviceNode(i), UsbTopology::NoNode);
+    }
+}
+
+TEST_F(DeviceInventoryServiceTest, WaitForChange_NoChange_TimesOut)
+{
+    auto service = MakeService(IdlePolicy());
+    ASSERT_NE(service->WaitForChange(0, 5s), nullptr);
+
+    EXPECT_EQ(service->WaitForChange(1, 50ms), nullptr);
+}
+
+TEST_F(DeviceInventoryServiceTest, Stop_ReleasesWaiters)
+{
+    auto service = MakeService(IdlePolicy());
+    ASSERT_NE(service->WaitForChange(0, 5s), nullptr);
+
+    std::thread stopper([&]() {
+        std::this_thread::sleep_for(20ms);
+        service->Stop();
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(service->WaitForChange(1, 10s), nullptr);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+    stopper.join();
+}
+
+TEST_F(DeviceInventoryServiceTest, Idle_IntervalBacksOffToSlow)
+{
+    InventoryRefreshPolicy policy;
+    policy.fastInterval = 5ms;
+    policy.slowInterval = 40ms;
+    auto service = MakeService(policy);
+    ASSERT_NE(service->WaitForChange(0, 5s), nullptr);
+
+    // 5 + 10 + 20 + 40 ms of unchanged scans reach the ceiling
+    std::this_thread::sleep_for(300ms);
+
+    InventoryStats stats = service->GetStats();
+    EXPECT_EQ(stats.currentInterval, 40ms);
+    EXPECT_GE(stats.refreshes, 5u);
+    EXPECT_EQ(stats.changes, 1u);
+}
+
+TEST_F(DeviceInventoryServiceTest, IncompleteScan_IsNotPublished)
+{
+    FaultInjectionConfig config;
+    config[CommunicationOperation::HubNodeInformation].errorRate = 1.0;
+    auto backend = std::make_unique<FaultInjectingUsbBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), config);
+
+    DeviceInventoryService service(std::move(backend), IdlePolicy());
+    DeviceSnapshotPtr snapshot = service.GetDevices(1h);
+
+    EXPECT_EQ(snapshot->version, 0u);
+    EXPECT_TRUE(snapshot->devices.empty());
+    EXPECT_EQ(service.GetStats().incompleteScans, 1u);
+}
+
+TEST_F(DeviceInventoryServiceTest, InvalidPolicy_Throws)
+{
+    InventoryRefreshPolicy policy;
+    policy.fastInterval = 10s;
+    policy.slowInterval = 1s;
+
+    EXPECT_THROW(MakeService(policy), InvalidDeviceArgumentException);
+}
+
+} // namespace Testing
+} // namespace KDM
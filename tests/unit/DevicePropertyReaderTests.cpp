@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <SetupAPI.h>
+#include "DevicePropertyReader.h"
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Property source serving fixed values with SetupDiGetDeviceRegistryProperty
+/// semantics and counting how often it is queried.
+/// </summary>
+class FixturePropertySource : public IDevicePropertySource
+{
+public:
+    void SetString(DWORD property, const std::wstring& value)
+    {
+        // REG_SZ: characters plus terminator
+        SetRaw(property, value.c_str(), (value.size() + 1) * sizeof(wchar_t));
+    }
+
+    void SetRaw(DWORD property, const void* data, size_t size)
+    {
+        const auto bytes = static_cast<const BYTE*>(data);
+        values_[property].assign(bytes, bytes + size);
+    }
+
+    DWORD ReadProperty(DWORD property, BYTE* buffer, DWORD size, DWORD& requiredSize) override
+    {
+        ++reads;
+        requiredSize = 0;
+
+        const auto it = values_.find(property);
+        if (it == values_.end()) {
+            return ERROR_INVALID_DATA;
+        }
+
+        requiredSize = static_cast<DWORD>(it->second.size());
+        if (size < requiredSize) {
+            return ERROR_INSUFFICIENT_BUFFER;
+        }
+        std::memcpy(buffer, it->second.data(), it->second.size());
+        return ERROR_SUCCESS;
+    }
+
+    int reads = 0;
+
+private:
+    std::map<DWORD, std::vector<BYTE>> values_;
+};
+
+/// <summary>
+/// Tests for DevicePropertyReader: single-call reads of values that fit the
+/// stack buffer, overflow fallback, missing properties and batched reads.
+/// </summary>
+class DevicePropertyReaderTest : public ::testing::Test
+{
+protected:
+    FixturePropertySource source_;
+};
+
+TEST_F(DevicePropertyReaderTest, ShortValue_ReadInOneCall)
+{
+    source_.SetString(SPDRP_DEVICEDESC, L"USB Input Device");
+
+    std::wstring value;
+    ASSERT_TRUE(DevicePropertyReader(source_).GetStringProperty(SPDRP_DEVICEDESC, value));
+    EXPECT_EQ(value, L"USB Input Device");
+    EXPECT_EQ(source_.reads, 1);
+}
+
+TEST_F(DevicePropertyReaderTest, LongValue_FallsBackToOverflowBuffer)
+{
+    const std::wstring longValue(DevicePropertyReader::StackBufferSize, L'x');
+    source_.SetString(SPDRP_FRIENDLYNAME, longValue);
+    source_.SetString(SPDRP_MFG, longValue + L"y");
+
+    DevicePropertyReader reader(source_);
+    std::wstring value;
+    ASSERT_TRUE(reader.GetStringProperty(SPDRP_FRIENDLYNAME, value));
+    EXPECT_EQ(value, longValue);
+    EXPECT_EQ(source_.reads, 2);
+
+    ASSERT_TRUE(reader.GetStringProperty(SPDRP_MFG, value));
+    EXPECT_EQ(value, longValue + L"y");
+    EXPECT_EQ(source_.reads, 4);
+}
+
+TEST_F(DevicePropertyReaderTest, MissingProperty_ReturnsFalse)
+{
+    std::wstring value = L"unchanged";
+    EXPECT_FALSE(DevicePropertyReader(source_).GetStringProperty(SPDRP_DRIVER, value));
+    EXPECT_EQ(value, L"unchanged");
+    EXPECT_EQ(source_.reads, 1);
+}
+
+TEST_F(DevicePropertyReaderTest, MultiSz_ReturnsFirstString)
+{
+    const wchar_t hardwareIds[] = L"USB\\VID_046D&PID_C52B&REV_1201\0USB\\VID_046D&PID_C52B\0";
+    source_.SetRaw(SPDRP_HARDWAREID, hardwareIds, sizeof(hardwareIds));
+
+    std::wstring value;
+    ASSERT_TRUE(DevicePropertyReader(source_).GetStringProperty(SPDRP_HARDWAREID, value));
+    EXPECT_EQ(value, L"USB\\VID_046D&PID_C52B&REV_1201");
+}
+
+TEST_F(DevicePropertyReaderTest, MultiSz_ReadsEveryEntry)
+{
+    const wchar_t hardwareIds[] = L"USB\\VID_046D&PID_C52B&REV_1201\0USB\\VID_046D&PID_C52B\0";
+    source_.SetRaw(SPDRP_HARDWAREID, hardwareIds, sizeof(hardwareIds));
+    const wchar_t compatibleIds[] = L"USB\\Class_03&SubClass_01&Prot_01\0USB\\Class_03";    // no list terminator
+    source_.SetRaw(SPDRP_COMPATIBLEIDS, compatibleIds, sizeof(compatibleIds) - sizeof(wchar_t));
+
+    const DeviceProperties properties = DevicePropertyReader(source_).GetProperties(
+        DevicePropertyMask::HardwareId | DevicePropertyMask::CompatibleIds);
+
+    EXPECT_EQ(properties.hardwareIds, (std::vector<std::wstring>{
+        L"USB\\VID_046D&PID_C52B&REV_1201", L"USB\\VID_046D&PID_C52B" }));
+    EXPECT_EQ(properties.hardwareId, L"USB\\VID_046D&PID_C52B&REV_1201");
+    EXPECT_EQ(properties.compatibleIds, (std::vector<std::wstring>{
+        L"USB\\Class_03&SubClass_01&Prot_01", L"USB\\Class_03" }));
+}
+
+TEST_F(DevicePropertyReaderTest, GetProperties_ReadsOnlyRequestedProperties)
+{
+    source_.SetString(SPDRP_DEVICEDESC, L"HID Keyboard Device");
+    source_.SetString(SPDRP_MFG, L"(Standard keyboards)");
+    source_.SetString(SPDRP_DRIVER, L"{4d36e96b-e325-11ce-bfc1-08002be10318}\\0000");
+    CM_POWER_DATA powerData{};
+    powerData.PD_MostRecentPowerState = PowerDeviceD0;
+    source_.SetRaw(SPDRP_DEVICE_POWER_DATA, &powerData, sizeof(powerData));
+
+    const DeviceProperties properties = DevicePropertyReader(source_).GetProperties(
+        DevicePropertyMask::Description | DevicePropertyMask::FriendlyName |
+        DevicePropertyMask::Manufacturer | DevicePropertyMask::PowerState);
+
+    EXPECT_EQ(source_.reads, 4);
+    EXPECT_TRUE(properties.Has(DevicePropertyMask::Description | DevicePropertyMask::Manufacturer));
+    EXPECT_FALSE(properties.Has(DevicePropertyMask::FriendlyName));
+    EXPECT_FALSE(properties.Has(DevicePropertyMask::DriverKey));
+    EXPECT_TRUE(properties.driverKey.empty());
+    EXPECT_EQ(properties.description, L"HID Keyboard Device");
+    EXPECT_EQ(properties.manufacturer, L"(Standard keyboards)");
+    EXPECT_EQ(properties.powerState, PowerDeviceD0);
+}
+
+TEST_F(DevicePropertyReaderTest, GetProperties_Benchmark)
+{
+    source_.SetString(SPDRP_DEVICEDESC, L"USB Composite Device");
+    source_.SetString(SPDRP_FRIENDLYNAME, L"Logitech USB Receiver");
+    source_.SetString(SPDRP_MFG, L"(Standard USB Host Controller)");
+    source_.SetString(SPDRP_HARDWAREID, L"USB\\VID_046D&PID_C52B&REV_1201");
+
+    constexpr int Devices = 100000;
+    const uint32_t mask = DevicePropertyMask::Description | DevicePropertyMask::FriendlyName |
+        DevicePropertyMask::Manufacturer | DevicePropertyMask::HardwareId;
+
+    size_t characters = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < Devices; ++i) {
+        const DeviceProperties properties = DevicePropertyReader(source_).GetProperties(mask);
+        characters += properties.description.size() + properties.hardwareId.size();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    RecordProperty("NsPerDevice", std::to_string(static_cast<int>(seconds * 1e9 / Devices)));
+    RecordProperty("TotalMs", std::to_string(static_cast<int>(seconds * 1000)));
+
+    // One source call per property: no sizing queries
+    EXPECT_EQ(source_.reads, Devices * 4);
+    EXPECT_GT(characters, 0u);
+}
+
+} // namespace Testing
+} // namespace KDM
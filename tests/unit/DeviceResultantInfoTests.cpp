@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "DeviceResultantInfo.h"
+#include "DeviceSnapshot.h"
+#include <chrono>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for the packed layout and allocator support of DeviceResultantInfo: string
+/// fields share one buffer from the resource given at construction, copies fall back
+/// to the default resource, and snapshots whose devices live in an arena are built
+/// and discarded quickly.
+/// </summary>
+class DeviceResultantInfoTest : public ::testing::Test
+{
+protected:
+    /// Counts the allocations it forwards to the default resource.
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        size_t allocations = 0;
+        size_t deallocations = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    // Strings long enough to defeat the small-string buffer, as real descriptors are
+    static void Fill(DeviceResultantInfo& device, unsigned int index)
+    {
+        const std::wstring suffix = std::to_wstring(index);
+        device.SetManufacturer(L"Simulated Manufacturer " + suffix);
+        device.SetProduct(L"Simulated Product Name " + suffix);
+        device.SetSerialNumber(L"SN-0000-0000-" + suffix);
+        device.SetDescription(L"USB Composite Device " + suffix);
+        device.SetDeviceId(L"USB\\VID_1234&PID_5678&REV_0100\\" + suffix);
+        device.SetDevicePath(L"\\\\?\\usb#vid_1234&pid_5678#" + suffix + L"#{a5dcbf10-6530-11d2-901f-00c04fb951ed}");
+        device.SetVendorName(L"Simulated Vendor Incorporated");
+        device.SetInterfaceClassName(L"Human Interface Device");
+        device.SetVendorId(0x1234);
+        device.SetProductId(static_cast<uint16_t>(index));
+        device.SetIsUsbDevice(true);
+    }
+
+    // The layout before the strings were packed: one string per field
+    struct UnpackedLayout
+    {
+        std::pmr::wstring strings[9];
+        UCHAR deviceClass = 0;
+        UCHAR interfaceClass = 0xFF;
+        GUID setupClassGuid = { 0 };
+        unsigned int vendorId = 0;
+        unsigned int productId = 0;
+        bool isUsbDevice = false;
+        bool isConnected = false;
+        uint64_t locationKey = 0;
+    };
+
+    static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+TEST_F(DeviceResultantInfoTest, Strings_AllocatedFromGivenResource)
+{
+    CountingResource resource;
+    {
+        DeviceResultantInfo device{ &resource };
+        Fill(device, 1);
+
+        EXPECT_EQ(device.get_allocator().resource(), &resource);
+        EXPECT_EQ(device.GetProduct(), L"Simulated Product Name 1");
+        EXPECT_GE(resource.allocations, 1u);
+    }
+    EXPECT_EQ(resource.deallocations, resource.allocations);
+}
+
+TEST_F(DeviceResultantInfoTest, Fields_IndependentInSharedBuffer)
+{
+    DeviceResultantInfo device;
+    Fill(device, 3);
+
+    device.SetSerialNumber(L"");
+    device.SetDescription(L"A considerably longer description than the one it replaces");
+    device.SetFriendlyName(device.GetVendorName());     // value views the buffer being changed
+
+    EXPECT_EQ(device.GetManufacturer(), L"Simulated Manufacturer 3");
+    EXPECT_EQ(device.GetProduct(), L"Simulated Product Name 3");
+    EXPECT_TRUE(device.GetSerialNumber().empty());
+    EXPECT_EQ(device.GetDescription(), L"A considerably longer description than the one it replaces");
+    EXPECT_EQ(device.GetDeviceId(), L"USB\\VID_1234&PID_5678&REV_0100\\3");
+    EXPECT_EQ(device.GetFriendlyName(), L"Simulated Vendor Incorporated");
+    EXPECT_EQ(device.GetVendorName(), L"Simulated Vendor Incorporated");
+    EXPECT_EQ(device.GetInterfaceClassName(), L"Human Interface Device");
+
+    // Same text in different fields is a different record
+    DeviceResultantInfo shifted;
+    shifted.SetManufacturer(L"AB");
+    DeviceResultantInfo split;
+    split.SetManufacturer(L"A");
+    split.SetProduct(L"B");
+    EXPECT_NE(shifted, split);
+}
+
+TEST_F(DeviceResultantInfoTest, Strings_RejectedBeyondMaxStringLength)
+{
+    DeviceResultantInfo device;
+    device.SetDevicePath(std::wstring(DeviceResultantInfo::MaxStringLength - 4, L'x'));
+
+    EXPECT_THROW(device.SetProduct(L"12345"), std::length_error);
+    EXPECT_EQ(device.GetDevicePath().size(), DeviceResultantInfo::MaxStringLength - 4);
+    EXPECT_TRUE(device.GetProduct().empty());
+    EXPECT_NO_THROW(device.SetProduct(L"1234"));
+}
+
+TEST_F(DeviceResultantInfoTest, PackedLayout_OneAllocationPerCopy)
+{
+    DeviceResultantInfo source;
+    Fill(source, 4);
+
+    CountingResource arena;
+    const DeviceResultantInfo placed{ source, &arena };
+
+    EXPECT_EQ(placed, source);
+    EXPECT_EQ(arena.allocations, 1u);
+
+    RecordProperty("PackedBytes", std::to_string(sizeof(DeviceResultantInfo)));
+    RecordProperty("UnpackedBytes", std::to_string(sizeof(UnpackedLayout)));
+    EXPECT_LE(sizeof(DeviceResultantInfo) * 4, sizeof(UnpackedLayout));
+}
+
+TEST_F(DeviceResultantInfoTest, Copy_UsesDefaultResourceUnlessGivenOne)
+{
+    CountingResource arena;
+    CountingResource other;
+    DeviceResultantInfo source{ &arena };
+    Fill(source, 2);
+
+    const DeviceResultantInfo copy = source;
+    const DeviceResultantInfo extended{ source, &other };
+    DeviceResultantInfo assigned{ &other };
+    assigned = source;
+
+    EXPECT_EQ(copy.get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(extended.get_allocator().resource(), &other);
+    EXPECT_EQ(assigned.get_allocator().resource(), &other);
+    EXPECT_EQ(copy, source);
+    EXPECT_EQ(extended, source);
+    EXPECT_EQ(assigned, source);
+
+    const size_t arenaAllocations = arena.allocations;
+    const DeviceResultantInfo moved = std::move(source);
+    EXPECT_EQ(moved.get_allocator().resource(), &arena);
+    EXPECT_EQ(arena.allocations, arenaAllocations);
+}
+
+TEST_F(DeviceResultantInfoTest, Snapshot_ReleasesArenaAfterDevices)
+{
+    auto arena = std::make_shared<CountingResource>();
+    auto snapshot = std::make_shared<DeviceSnapshot>();
+    snapshot->arena = arena;
+    for (unsigned int i = 0; i < 10; ++i)
+    {
+        DeviceResultantInfo device{ arena.get() };
+        Fill(device, i);
+        snapshot->devices.push_back(std::move(device));
+    }
+    EXPECT_EQ(snapshot->devices[3].get_allocator().resource(), arena.get());
+
+    // The snapshot keeps the arena alive until its devices are gone
+    std::weak_ptr<CountingResource> weakArena = arena;
+    arena.reset();
+    EXPECT_FALSE(weakArena.expired());
+    snapshot.reset();
+    EXPECT_TRUE(weakArena.expired());
+}
+
+TEST_F(DeviceResultantInfoTest, LargeSnapshot_ArenaConstructionAndDestruction)
+{
+    constexpr unsigned int DeviceCount = 50000;
+
+    auto build = [&](std::pmr::memory_resource* resource) {
+        auto snapshot = std::make_shared<DeviceSnapshot>();
+        snapshot->devices.reserve(DeviceCount);
+        DeviceResultantInfo scratch;
+        for (unsigned int i = 0; i < DeviceCount; ++i)
+        {
+            // As the scan does: fill on the heap, then one exact-size copy into resource
+            Fill(scratch, i);
+            snapshot->devices.emplace_back(scratch, resource);
+        }
+        return snapshot;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    auto heapSnapshot = build(std::pmr::get_default_resource());
+    const double heapBuildMs = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    heapSnapshot.reset();
+    const double heapDestroyMs = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+    auto arenaSnapshot = build(arena.get());
+    arenaSnapshot->arena = std::move(arena);
+    const double arenaBuildMs = MillisecondsSince(start);
+    ASSERT_EQ(arenaSnapshot->devices.size(), DeviceCount);
+
+    start = std::chrono::steady_clock::now();
+    arenaSnapshot.reset();
+    const double arenaDestroyMs = MillisecondsSince(start);
+
+    RecordProperty("HeapBuildMs", std::to_string(static_cast<int>(heapBuildMs)));
+    RecordProperty("HeapDestroyMs", std::to_string(static_cast<int>(heapDestroyMs)));
+    RecordProperty("ArenaBuildMs", std::to_string(static_cast<int>(arenaBuildMs)));
+    RecordProperty("ArenaDestroyMs", std::to_string(static_cast<int>(arenaDestroyMs)));
+    // Time limits are checked by WinDevicesBenchmarks (BUILD_BENCHMARKS)
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -4,6 +4,7 @@
 #include "DeviceResultantInfo.h"
 #include "DeviceClassGuids.h"
 #include <memory>
+#include <vector>
 
 class DevicesManagerTest : public ::testing::Test {
 protected:
@@ -28,14 +29,14 @@ TEST_F(DevicesManagerTest, EnumerateUsbDevices) {
 
 TEST_F(DevicesManagerTest, GetDevicesAfterEnumeration) {
     manager->EnumerateUsbDevices();
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     
     // Should have enumerated devices
     EXPECT_GE(devices.size(), 0);
 }
 
 TEST_F(DevicesManagerTest, GetDevicesBeforeEnumeration) {
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     
     // Should return empty vector before enumeration
     EXPECT_EQ(devices.size(), 0);
@@ -43,7 +44,7 @@ TEST_F(DevicesManagerTest, GetDevicesBeforeEnumeration) {
 
 TEST_F(DevicesManagerTest, DeviceHasInformation) {
     manager->EnumerateUsbDevices();
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     
     if (devices.size() > 0) {
         // Check first device has some information
@@ -59,10 +60,10 @@ TEST_F(DevicesManagerTest, DeviceHasInformation) {
 
 TEST_F(DevicesManagerTest, MultipleEnumerations) {
     EXPECT_NO_THROW(manager->EnumerateUsbDevices());
-    auto count1 = manager->GetDevices().size();
+    auto count1 = manager->GetDevices()->devices.size();
 
     EXPECT_NO_THROW(manager->EnumerateUsbDevices());
-    auto count2 = manager->GetDevices().size();
+    auto count2 = manager->GetDevices()->devices.size();
 
     EXPECT_GE(count1, 0);
     EXPECT_GE(count2, 0);
@@ -74,7 +75,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Keyboard) {
     // Test enumeration of keyboard devices
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // Most systems have at least one keyboard
     EXPECT_GT(devices.size(), 0) << "System should have at least one keyboard";
@@ -90,7 +91,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Mouse) {
     // Test enumeration of mouse devices
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_MOUSE));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // Most systems have at least one mouse/pointing device
     EXPECT_GT(devices.size(), 0) << "System should have at least one mouse";
@@ -111,7 +112,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_DiskDrive) {
     // Test enumeration of disk drives
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_DISKDRIVE));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // All systems have at least one disk drive (where OS is installed)
     EXPECT_GT(devices.size(), 0) << "System should have at least one disk drive";
@@ -126,7 +127,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Display) {
     // Test enumeration of display adapters
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_DISPLAY));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // All systems have at least one display adapter
     EXPECT_GT(devices.size(), 0) << "System should have at least one display adapter";
@@ -136,7 +137,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Network) {
     // Test enumeration of network adapters
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_NET));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // Most modern systems have network adapters
     EXPECT_GE(devices.size(), 0);
@@ -152,14 +153,14 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Network) {
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_ClearsPreviousList) {
     // First enumerate keyboards
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
-    auto keyboardCount = manager->GetDevices().size();
+    auto keyboardCount = manager->GetDevices()->devices.size();
 
     // Then enumerate mice
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_MOUSE);
-    auto mouseCount = manager->GetDevices().size();
+    auto mouseCount = manager->GetDevices()->devices.size();
 
     // Verify the list was cleared and only contains mice
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
     for (const auto& device : devices) {
         EXPECT_EQ(memcmp(&device.GetSetupClassGuid(), &KDM::GUID_DEVCLASS_MOUSE, sizeof(GUID)), 0)
             << "After enumerating mice, should only have mouse devices";
@@ -169,10 +170,10 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_ClearsPreviousList) {
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_MultipleCallsSameClass) {
     // Enumerate keyboards twice
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
-    auto count1 = manager->GetDevices().size();
+    auto count1 = manager->GetDevices()->devices.size();
 
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
-    auto count2 = manager->GetDevices().size();
+    auto count2 = manager->GetDevices()->devices.size();
 
     // Should get the same count both times
     EXPECT_EQ(count1, count2) << "Multiple enumerations should produce consistent results";
@@ -181,7 +182,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_MultipleCallsSameClass) {
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_DeviceFieldsPopulated) {
     // Enumerate keyboards and check that fields are populated correctly
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     ASSERT_GT(devices.size(), 0);
 
@@ -199,11 +200,48 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_DeviceFieldsPopulated) {
     EXPECT_TRUE(hasName) << "Device should have a description or friendly name";
 }
 
+// ========== EnumerateByDeviceClasses Tests ==========
+
+TEST_F(DevicesManagerTest, EnumerateByDeviceClasses_MatchesPerClassEnumeration) {
+    const std::vector<GUID> classes = { KDM::GUID_DEVCLASS_KEYBOARD, KDM::GUID_DEVCLASS_MOUSE, KDM::GUID_DEVCLASS_NET };
+
+    std::vector<size_t> perClass;
+    for (const GUID& guid : classes) {
+        manager->EnumerateByDeviceClass(guid);
+        perClass.push_back(manager->GetDevices()->devices.size());
+    }
+
+    manager->EnumerateByDeviceClasses(classes);
+    auto devices = manager->GetDevices()->devices;
+
+    // Same devices as one call per class, grouped in request order
+    ASSERT_EQ(devices.size(), perClass[0] + perClass[1] + perClass[2]);
+    size_t offset = 0;
+    for (size_t c = 0; c < classes.size(); ++c) {
+        for (size_t i = offset; i < offset + perClass[c]; ++i) {
+            EXPECT_EQ(memcmp(&devices[i].GetSetupClassGuid(), &classes[c], sizeof(GUID)), 0);
+            EXPECT_TRUE(devices[i].IsConnected());
+        }
+        offset += perClass[c];
+    }
+}
+
+TEST_F(DevicesManagerTest, EnumerateByDeviceClasses_IgnoresDuplicatesAndEmptyList) {
+    manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
+    auto keyboardCount = manager->GetDevices()->devices.size();
+
+    manager->EnumerateByDeviceClasses({ KDM::GUID_DEVCLASS_KEYBOARD, KDM::GUID_DEVCLASS_KEYBOARD });
+    EXPECT_EQ(manager->GetDevices()->devices.size(), keyboardCount);
+
+    manager->EnumerateByDeviceClasses({});
+    EXPECT_EQ(manager->GetDevices()->devices.size(), 0);
+}
+
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_HID) {
     // Test HID class (Human Interface Devices)
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_HIDCLASS));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // HID class usually has many devices (keyboards, mice, game controllers, etc.)
     EXPECT_GE(devices.size(), 0);
@@ -217,7 +255,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Media) {
     // Test Media class (Sound, video, game controllers)
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_MEDIA));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // Media devices are common (sound cards, etc.)
     EXPECT_GE(devices.size(), 0);
@@ -227,7 +265,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_Battery) {
     // Test Battery class (may not exist on desktop systems)
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_BATTERY));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // Laptops have batteries, desktops don't - so >= 0 is fine
     EXPECT_GE(devices.size(), 0);
@@ -242,7 +280,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_USBDevice) {
     // Test USB Device class
     EXPECT_NO_THROW(manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_USBDEVICE));
 
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     // Should have some USB devices on any modern system
     EXPECT_GE(devices.size(), 0);
@@ -255,12 +293,12 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_USBDevice) {
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_CompareWithUSBEnumeration) {
     // Enumerate using USB enumeration
     manager->EnumerateUsbDevices();
-    auto usbDevices = manager->GetDevices();
+    auto usbDevices = manager->GetDevices()->devices;
     auto usbCount = usbDevices.size();
 
     // Enumerate using device class
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_USBDEVICE);
-    auto classDevices = manager->GetDevices();
+    auto classDevices = manager->GetDevices()->devices;
 
     // Both methods should find devices (though counts may differ due to different enumeration logic)
     EXPECT_GE(usbCount, 0);
@@ -275,7 +313,7 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_CompareWithUSBEnumeration) {
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_DeviceIdNotEmpty) {
     // Enumerate keyboards and verify device IDs
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
-    auto devices = manager->GetDevices();
+    auto devices = manager->GetDevices()->devices;
 
     ASSERT_GT(devices.size(), 0);
 
@@ -292,13 +330,13 @@ TEST_F(DevicesManagerTest, EnumerateByDeviceClass_DeviceIdNotEmpty) {
 
 TEST_F(DevicesManagerTest, EnumerateByDeviceClass_EmptyListBeforeEnumeration) {
     // Verify list is empty before enumeration
-    auto devicesBefore = manager->GetDevices();
+    auto devicesBefore = manager->GetDevices()->devices;
     EXPECT_EQ(devicesBefore.size(), 0);
 
     // Enumerate
     manager->EnumerateByDeviceClass(KDM::GUID_DEVCLASS_KEYBOARD);
 
     // Verify list has devices after enumeration
-    auto devicesAfter = manager->GetDevices();
+    auto devicesAfter = manager->GetDevices()->devices;
     EXPECT_GT(devicesAfter.size(), 0);
 }
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "EnumerationOptions.h"
+#include "FaultInjectingUsbBackend.h"
+#include "mocks/MockUsbBackend.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for single-flight coalescing of concurrent DevicesManager::EnumerateUsbDevices
+/// calls and for serving recent results under EnumerationOptions::maxStaleness.
+/// </summary>
+class EnumerationCoalescingTest : public ::testing::Test
+{
+protected:
+    /// Every hub stalls for hubStall; scanStarted_ fires when the first stall begins.
+    std::unique_ptr<IUsbBackend> MakeSlowBackend(std::chrono::milliseconds hubStall)
+    {
+        FaultInjectionConfig config;
+        config[CommunicationOperation::HubNodeInformation].latency.stall = hubStall;
+        config[CommunicationOperation::HubNodeInformation].latency.stallProbability = 1.0;
+        config.delay = [this](std::chrono::microseconds duration) {
+            if (!signalled_.exchange(true)) {
+                scanStarted_.set_value();
+            }
+            std::this_thread::sleep_for(duration);
+        };
+
+        return std::make_unique<FaultInjectingUsbBackend>(
+            std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), std::move(config));
+    }
+
+    void WaitForScanStart()
+    {
+        ASSERT_EQ(scanStarted_.get_future().wait_for(5s), std::future_status::ready);
+    }
+
+    std::promise<void> scanStarted_;
+    std::atomic<bool> signalled_{ false };
+};
+
+TEST_F(EnumerationCoalescingTest, ConcurrentCalls_ShareOneScan)
+{
+    constexpr int numJoiners = 3;
+    DevicesManager manager(MakeSlowBackend(50ms));
+
+    EnumerationStatus leaderStatus;
+    std::thread leader([&]() { leaderStatus = manager.EnumerateUsbDevices(EnumerationOptions{}); });
+    WaitForScanStart();
+
+    std::vector<EnumerationStatus> joinerStatus(numJoiners);
+    std::vector<std::thread> joiners;
+    for (int i = 0; i < numJoiners; ++i)
+    {
+        joiners.emplace_back([&, i]() { joinerStatus[i] = manager.EnumerateUsbDevices(EnumerationOptions{}); });
+    }
+
+    leader.join();
+    for (auto& t : joiners)
+    {
+        t.join();
+    }
+
+    EXPECT_FALSE(leaderStatus.coalesced);
+    EXPECT_TRUE(leaderStatus.IsComplete());
+    for (const auto& status : joinerStatus)
+    {
+        EXPECT_TRUE(status.coalesced);
+        EXPECT_TRUE(status.IsComplete());
+    }
+
+    // One walk of the bus, one publication
+    EXPECT_EQ(manager.GetSnapshot()->version, 1u);
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+}
+
+TEST_F(EnumerationCoalescingTest, JoiningCall_StopsWaitingAtItsOwnDeadline)
+{
+    DevicesManager manager(MakeSlowBackend(150ms));
+
+    std::thread leader([&]() { (void)manager.EnumerateUsbDevices(EnumerationOptions{}); });
+    WaitForScanStart();
+
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions::WithTimeout(20ms));
+    leader.join();
+
+    EXPECT_TRUE(status.coalesced);
+    EXPECT_TRUE(status.timedOut);
+    EXPECT_TRUE(status.stoppedWaiting);
+    EXPECT_FALSE(status.IsComplete());
+    EXPECT_LT(status.elapsed, 300ms);
+}
+
+TEST_F(EnumerationCoalescingTest, MaxStaleness_ServesRecentScanWithoutScanning)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)));
+    (void)manager.EnumerateUsbDevices(EnumerationOptions{});
+
+    EnumerationOptions options;
+    options.maxStaleness = 1h;
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_TRUE(status.servedFromCache);
+    EXPECT_TRUE(status.IsComplete());
+    EXPECT_EQ(manager.GetSnapshot()->version, 1u);
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+}
+
+TEST_F(EnumerationCoalescingTest, MaxStaleness_NoScanYet_Scans)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)));
+
+    EnumerationOptions options;
+    options.maxStaleness = 1h;
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_FALSE(status.servedFromCache);
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+}
+
+TEST_F(EnumerationCoalescingTest, MaxStaleness_OtherPublication_InvalidatesCachedScan)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)));
+    (void)manager.EnumerateUsbDevices(EnumerationOptions{});
+    manager.ClearDevices();
+
+    EnumerationOptions options;
+    options.maxStaleness = 1h;
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_FALSE(status.servedFromCache);
+    EXPECT_EQ(manager.GetSnapshot()->version, 3u);
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+}
+
+TEST_F(EnumerationCoalescingTest, MaxStaleness_TooOld_Scans)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)));
+    (void)manager.EnumerateUsbDevices(EnumerationOptions{});
+    std::this_thread::sleep_for(20ms);
+
+    EnumerationOptions options;
+    options.maxStaleness = 5ms;
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_FALSE(status.servedFromCache);
+    EXPECT_EQ(manager.GetSnapshot()->version, 2u);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "EnumerationOptions.h"
+#include "FaultInjectingUsbBackend.h"
+#include "mocks/MockUsbBackend.h"
+#include <chrono>
+#include <memory>
+
+using namespace std::chrono_literals;
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for deadline and cancellation support of DevicesManager::EnumerateUsbDevices,
+/// using a simulated bus with injected latency.
+/// </summary>
+class EnumerationDeadlineTest : public ::testing::Test
+{
+protected:
+    static std::unique_ptr<IUsbBackend> MakeBackend(FaultInjectionConfig config = {})
+    {
+        return std::make_unique<FaultInjectingUsbBackend>(
+            std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), std::move(config));
+    }
+};
+
+TEST_F(EnumerationDeadlineTest, NoBudget_VisitsWholeTree)
+{
+    DevicesManager manager(MakeBackend());
+
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions{});
+
+    EXPECT_TRUE(status.IsComplete());
+    EXPECT_FALSE(status.timedOut);
+    EXPECT_FALSE(status.cancelled);
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+}
+
+TEST_F(EnumerationDeadlineTest, ExpiredDeadline_SkipsAllRootHubs)
+{
+    DevicesManager manager(MakeBackend());
+
+    EnumerationOptions options;
+    options.deadline = std::chrono::steady_clock::now() - 1ms;
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_TRUE(status.timedOut);
+    EXPECT_FALSE(status.IsComplete());
+    EXPECT_EQ(manager.GetDeviceCount(), 0u);
+
+    ASSERT_EQ(status.skipped.size(), 2u);
+    for (const auto& node : status.skipped)
+    {
+        EXPECT_EQ(node.portNumber, 0u);
+        EXPECT_EQ(node.reason, SkipReason::TimedOut);
+    }
+}
+
+TEST_F(EnumerationDeadlineTest, CancelledBeforeStart_SkipsAllRootHubs)
+{
+    DevicesManager manager(MakeBackend());
+
+    EnumerationOptions options;
+    options.cancellation.Cancel();
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_TRUE(status.cancelled);
+    EXPECT_EQ(manager.GetDeviceCount(), 0u);
+    ASSERT_EQ(status.skipped.size(), 2u);
+    EXPECT_EQ(status.skipped[0].reason, SkipReason::Cancelled);
+}
+
+TEST_F(EnumerationDeadlineTest, CancelledDuringScan_ReturnsDevicesFoundSoFar)
+{
+    EnumerationOptions options;
+
+    // Each device issues four string descriptor requests (languages, manufacturer,
+    // product, serial); cancel once the first device has been read completely.
+    int stringRequests = 0;
+    FaultInjectionConfig config;
+    config[CommunicationOperation::StringDescriptor].latency.base = 1us;
+    config.delay = [&](std::chrono::microseconds) {
+        if (++stringRequests == 4) {
+            options.cancellation.Cancel();
+        }
+    };
+
+    DevicesManager manager(MakeBackend(config));
+    EnumerationStatus status = manager.EnumerateUsbDevices(options);
+
+    EXPECT_TRUE(status.cancelled);
+    ASSERT_EQ(manager.GetDeviceCount(), 1u);
+    EXPECT_EQ(manager.GetDevices()->devices.front().GetProductId(), 1u);
+
+    // Remaining three ports of the first external hub, then the second root hub
+    ASSERT_EQ(status.skipped.size(), 4u);
+    EXPECT_EQ(status.skipped[0].portNumber, 2u);
+    EXPECT_EQ(status.skipped[1].portNumber, 3u);
+    EXPECT_EQ(status.skipped[2].portNumber, 4u);
+    EXPECT_EQ(status.skipped[0].hubPath, status.skipped[2].hubPath);
+    EXPECT_EQ(status.skipped[3].portNumber, 0u);
+    EXPECT_NE(status.skipped[3].hubPath, status.skipped[0].hubPath);
+}
+
+TEST_F(EnumerationDeadlineTest, StalledHub_ReturnsWithinBudgetPlusOneOperation)
+{
+    // Every hub stalls for 250 ms: an unbounded scan of four hubs takes about a second
+    FaultInjectionConfig config;
+    config[CommunicationOperation::HubNodeInformation].latency.stall = 250ms;
+    config[CommunicationOperation::HubNodeInformation].latency.stallProbability = 1.0;
+
+    DevicesManager manager(MakeBackend(config));
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions::WithTimeout(100ms));
+
+    EXPECT_TRUE(status.timedOut);
+    EXPECT_LT(status.elapsed, 600ms);
+    EXPECT_EQ(manager.GetDeviceCount(), 0u);
+
+    // The external hub port of the first root hub, then the whole second root hub
+    ASSERT_EQ(status.skipped.size(), 2u);
+    EXPECT_EQ(status.skipped[0].portNumber, 1u);
+    EXPECT_EQ(status.skipped[0].reason, SkipReason::TimedOut);
+    EXPECT_EQ(status.skipped[1].portNumber, 0u);
+}
+
+TEST_F(EnumerationDeadlineTest, NextEnumeration_ClearsPreviousSkips)
+{
+    DevicesManager manager(MakeBackend());
+
+    EnumerationOptions expired;
+    expired.deadline = std::chrono::steady_clock::now() - 1ms;
+    EXPECT_FALSE(manager.EnumerateUsbDevices(expired).IsComplete());
+
+    EXPECT_TRUE(manager.EnumerateUsbDevices(EnumerationOptions{}).IsComplete());
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "FaultInjectingDeviceCommunication.h"
+#include "FaultInjectingUsbBackend.h"
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "mocks/MockUsbBackend.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for FaultInjectingDeviceCommunication / FaultInjectingUsbBackend and
+/// stress scans of the traversal over a faulty simulated bus.
+/// </summary>
+class FaultInjectionTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        backend_ = std::make_unique<MockUsbBackend>(MakeSimulatedBus(1, 1, 4));
+        externalHubPath_ = backend_->GetHubDevicePath(backend_->GetDeviceInstances().front());
+
+        // Record delays instead of sleeping
+        config_.delay = [this](std::chrono::microseconds duration) { delays_.push_back(duration); };
+    }
+
+    std::unique_ptr<FaultInjectingDeviceCommunication> MakeHub()
+    {
+        return std::make_unique<FaultInjectingDeviceCommunication>(backend_->OpenHub(externalHubPath_), config_);
+    }
+
+    std::unique_ptr<MockUsbBackend> backend_;
+    std::wstring externalHubPath_;
+    FaultInjectionConfig config_;
+    std::vector<std::chrono::microseconds> delays_;
+};
+
+TEST_F(FaultInjectionTest, NoFaults_PassesThrough)
+{
+    auto hub = MakeHub();
+
+    HubNodeInfo nodeInfo;
+    hub->GetUsbHubNodeInformation(nodeInfo);
+    EXPECT_EQ(nodeInfo.numbersOfPorts, 4);
+
+    std::unique_ptr<BYTE[]> config(reinterpret_cast<BYTE*>(hub->GetConfigDescriptor(1, 0)));
+    EXPECT_NE(config, nullptr);
+
+    auto stats = hub->GetStats();
+    EXPECT_EQ(stats.calls, 2u);
+    EXPECT_EQ(stats.injectedErrors, 0u);
+    EXPECT_TRUE(delays_.empty());
+}
+
+TEST_F(FaultInjectionTest, ErrorRateOne_DescriptorsReturnNull)
+{
+    config_[CommunicationOperation::StringDescriptor].errorRate = 1.0;
+    config_[CommunicationOperation::ConfigDescriptor].errorRate = 1.0;
+    auto hub = MakeHub();
+
+    EXPECT_EQ(hub->GetStringDescriptor(1, 1, 0x0409), nullptr);
+    EXPECT_EQ(hub->GetConfigDescriptor(1, 0), nullptr);
+    EXPECT_EQ(hub->GetStats().injectedErrors, 2u);
+}
+
+TEST_F(FaultInjectionTest, ErrorRateOne_IoctlThrowsDeviceIoException)
+{
+    config_[CommunicationOperation::HubNodeInformation].errorRate = 1.0;
+    auto hub = MakeHub();
+
+    HubNodeInfo nodeInfo;
+    try
+    {
+        hub->GetUsbHubNodeInformation(nodeInfo);
+        FAIL() << "Expected DeviceIoException";
+    }
+    catch (const DeviceIoException& e)
+    {
+        EXPECT_EQ(e.GetErrorCode(), static_cast<DWORD>(ERROR_GEN_FAILURE));
+    }
+}
+
+TEST_F(FaultInjectionTest, SameSeed_ProducesSameFaultSequence)
+{
+    config_.seed = 1234;
+    config_[CommunicationOperation::StringDescriptor].errorRate = 0.5;
+
+    auto failurePattern = [this]() {
+        auto hub = MakeHub();
+        std::vector<bool> pattern;
+        for (int i = 0; i < 200; ++i)
+        {
+            std::unique_ptr<BYTE[]> node(reinterpret_cast<BYTE*>(hub->GetStringDescriptor(1, 2, 0x0409)));
+            pattern.push_back(node == nullptr);
+        }
+        return pattern;
+    };
+
+    auto first = failurePattern();
+    auto second = failurePattern();
+    EXPECT_EQ(first, second);
+
+    config_.seed = 4321;
+    EXPECT_NE(failurePattern(), first);
+}
+
+TEST_F(FaultInjectionTest, Latency_BaseJitterAndStall)
+{
+    auto& latency = config_[CommunicationOperation::EnumeratePortsConnectionInfo].latency;
+    latency.base = 100us;
+    latency.jitter = 50us;
+    config_[CommunicationOperation::HubNodeInformation].latency.stall = 500ms;
+    config_[CommunicationOperation::HubNodeInformation].latency.stallProbability = 1.0;
+    auto hub = MakeHub();
+
+    std::map<size_t, HubConnectionInfo> connections;
+    for (int i = 0; i < 20; ++i) {
+        hub->EnumeratePortsConnectionInfo(4, connections);
+    }
+    HubNodeInfo nodeInfo;
+    hub->GetUsbHubNodeInformation(nodeInfo);
+
+    ASSERT_EQ(delays_.size(), 21u);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        EXPECT_GE(delays_[i], 100us);
+        EXPECT_LE(delays_[i], 150us);
+    }
+    EXPECT_EQ(delays_.back(), 500ms);
+    EXPECT_EQ(hub->GetStats().stalls, 1u);
+}
+
+TEST_F(FaultInjectionTest, DisconnectRace_DeviceVanishesAfterConnectionInfo)
+{
+    config_.disconnectRate = 1.0;
+    auto hub = MakeHub();
+
+    std::map<size_t, HubConnectionInfo> connections;
+    hub->EnumeratePortsConnectionInfo(4, connections);
+
+    // Ports are still reported as connected...
+    ASSERT_EQ(connections.size(), 4u);
+    EXPECT_EQ(connections.at(1)._connectionStatus, DeviceConnected);
+
+    // ...but the devices are gone when their descriptors are requested
+    EXPECT_TRUE(hub->IsDisconnected(1));
+    EXPECT_EQ(hub->GetConfigDescriptor(1, 0), nullptr);
+    EXPECT_EQ(hub->GetStringDescriptor(1, 2, 0x0409), nullptr);
+    EXPECT_THROW((void)hub->GetDriverKeyName(1), DeviceIoException);
+    EXPECT_EQ(hub->GetStats().injectedDisconnects, 4u);
+}
+
+TEST_F(FaultInjectionTest, InvalidRate_Throws)
+{
+    config_[CommunicationOperation::ConfigDescriptor].errorRate = 1.5;
+    EXPECT_THROW(MakeHub(), InvalidDeviceArgumentException);
+}
+
+// ============================================================================
+// Traversal stress tests over a faulty simulated bus
+// ============================================================================
+
+namespace
+{
+    FaultInjectionConfig MakeFlakyBusConfig(uint64_t seed)
+    {
+        FaultInjectionConfig config;
+        config.seed = seed;
+        config.disconnectRate = 0.1;
+        config[CommunicationOperation::StringDescriptor].errorRate = 0.2;
+        config[CommunicationOperation::ConfigDescriptor].errorRate = 0.05;
+        config.delay = [](std::chrono::microseconds) {};
+        return config;
+    }
+
+    std::vector<unsigned int> ScanProductIds(uint64_t seed)
+    {
+        DevicesManager manager(std::make_unique<FaultInjectingUsbBackend>(
+            std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 4, 8)), MakeFlakyBusConfig(seed)));
+        manager.EnumerateUsbDevices();
+
+        std::vector<unsigned int> productIds;
+        DeviceSnapshotPtr snapshot = manager.GetDevices();
+        for (const auto& device : snapshot->devices) {
+            productIds.push_back(device.GetProductId());
+        }
+        return productIds;
+    }
+}
+
+TEST(FaultInjectionStressTest, FlakyBus_ScansCompleteWithSubsetOfDevices)
+{
+    for (uint64_t seed = 1; seed <= 25; ++seed)
+    {
+        std::vector<unsigned int> productIds;
+        ASSERT_NO_THROW(productIds = ScanProductIds(seed)) << "seed " << seed;
+        EXPECT_LE(productIds.size(), 64u) << "seed " << seed;
+    }
+}
+
+TEST(FaultInjectionStressTest, FlakyBus_SameSeedIsReproducible)
+{
+    EXPECT_EQ(ScanProductIds(99), ScanProductIds(99));
+}
+
+TEST(FaultInjectionStressTest, FlakyBus_InjectsFaultsAcrossHubs)
+{
+    auto backend = std::make_unique<FaultInjectingUsbBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 4, 8)), MakeFlakyBusConfig(7));
+    FaultInjectingUsbBackend* faults = backend.get();
+
+    DevicesManager manager(std::move(backend));
+    manager.EnumerateUsbDevices();
+
+    auto stats = faults->GetStats();
+    EXPECT_GT(stats.calls, 0u);
+    EXPECT_GT(stats.injectedErrors + stats.injectedDisconnects, 0u);
+    EXPECT_LT(manager.GetDeviceCount(), 64u);
+}
+
+TEST(FaultInjectionStressTest, StalledHubs_AddToScanLatency)
+{
+    FaultInjectionConfig config;
+    config[CommunicationOperation::HubNodeInformation].latency.stall = 50ms;
+    config[CommunicationOperation::HubNodeInformation].latency.stallProbability = 1.0;
+
+    // Root hub + one external hub = two stalled node information requests
+    DevicesManager manager(std::make_unique<FaultInjectingUsbBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(1, 1, 4)), config));
+
+    auto start = std::chrono::steady_clock::now();
+    manager.EnumerateUsbDevices();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GE(elapsed, 100ms);
+    EXPECT_EQ(manager.GetDeviceCount(), 4u);
+}
+
+} // namespace Testing
+} // namespace KDM
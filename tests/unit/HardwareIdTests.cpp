@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "HardwareId.h"
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for ParseHardwareId: USB and HID hardware IDs, class-based compatible
+/// IDs, case handling and malformed fields.
+/// </summary>
+class HardwareIdTest : public ::testing::Test
+{
+};
+
+TEST_F(HardwareIdTest, UsbHardwareId_ParsesVidPidRevision)
+{
+    const HardwareId id = ParseHardwareId(L"USB\\VID_046D&PID_C52B&REV_1201");
+
+    EXPECT_EQ(id.fields, HardwareId::HasVendorId | HardwareId::HasProductId | HardwareId::HasRevision);
+    EXPECT_EQ(id.vendorId, 0x046D);
+    EXPECT_EQ(id.productId, 0xC52B);
+    EXPECT_EQ(id.revision, 0x1201);
+    EXPECT_TRUE(id.MatchesVidPid(0x046D, 0xC52B));
+    EXPECT_FALSE(id.MatchesVidPid(0x046D, 0xC52C));
+}
+
+TEST_F(HardwareIdTest, InterfaceAndCollection_ParsesInterfaceNumber)
+{
+    const HardwareId id = ParseHardwareId(L"HID\\VID_046D&PID_C52B&REV_1201&MI_02&Col01");
+
+    EXPECT_TRUE(id.Has(HardwareId::HasInterface));
+    EXPECT_EQ(id.interfaceNumber, 2);
+    EXPECT_TRUE(id.MatchesVidPid(0x046D, 0xC52B));
+}
+
+TEST_F(HardwareIdTest, CompatibleId_ParsesClassSubClassProtocol)
+{
+    const HardwareId id = ParseHardwareId(L"USB\\Class_08&SubClass_06&Prot_50");
+
+    EXPECT_EQ(id.fields, HardwareId::HasClass | HardwareId::HasSubClass | HardwareId::HasProtocol);
+    EXPECT_EQ(id.deviceClass, 0x08);
+    EXPECT_EQ(id.deviceSubClass, 0x06);
+    EXPECT_EQ(id.deviceProtocol, 0x50);
+    EXPECT_FALSE(id.MatchesVidPid(0, 0));
+}
+
+TEST_F(HardwareIdTest, FieldNames_AreCaseInsensitive)
+{
+    const HardwareId id = ParseHardwareId(L"usb\\vid_abcd&pid_ef01&class_ff");
+
+    EXPECT_EQ(id.vendorId, 0xABCD);
+    EXPECT_EQ(id.productId, 0xEF01);
+    EXPECT_EQ(id.deviceClass, 0xFF);
+}
+
+TEST_F(HardwareIdTest, MalformedAndForeignIds_ParseToNothing)
+{
+    EXPECT_EQ(ParseHardwareId(L"").fields, 0u);
+    EXPECT_EQ(ParseHardwareId(L"HID_DEVICE_SYSTEM_KEYBOARD").fields, 0u);
+    EXPECT_EQ(ParseHardwareId(L"PCI\\VEN_8086&DEV_A36D&CC_0C0330").fields, 0u);
+
+    // Too many digits, no digits, non-hex digits
+    const HardwareId id = ParseHardwareId(L"USB\\VID_12345&PID_&REV_12G4&MI_01");
+    EXPECT_EQ(id.fields, HardwareId::HasInterface);
+    EXPECT_EQ(id.interfaceNumber, 1);
+}
+
+} // namespace Testing
+} // namespace KDM
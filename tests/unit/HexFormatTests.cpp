@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "HexFormat.h"
+#include "UtilConvert.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for HexFormat: USB ID and GUID text must match the swprintf and
+/// StringFromGUID2 output it replaces, plus microbenchmarks against both.
+/// </summary>
+class HexFormatTest : public ::testing::Test
+{
+protected:
+    static constexpr GUID HidClass{ 0x745a17a0, 0x74d3, 0x11d0, { 0xb6, 0xfe, 0x00, 0xa0, 0xc9, 0x0f, 0x57, 0xda } };
+
+    // What UtilConvert::GetHexIdAsString used to do for every ID it logged
+    static std::wstring LegacyHexId(USHORT value, USHORT width)
+    {
+        wchar_t buffer[16] = { 0 };
+        const std::wstring format = L"0x%0" + std::to_wstring(width) + L"x";
+        swprintf(buffer, 16, format.c_str(), value);
+        return std::wstring(buffer);
+    }
+
+    static std::wstring LegacyGuid(const GUID& guid)
+    {
+        wchar_t buffer[40]{};
+        StringFromGUID2(guid, buffer, 40);
+        return buffer;
+    }
+
+    template <typename Format>
+    static double NanosecondsPerCall(int iterations, Format&& format)
+    {
+        size_t sink = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            sink += format(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_GT(sink, 0u);
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+};
+
+static_assert(HexFormat::Id(0x0951, 4).view() == L"0x0951");
+static_assert(HexFormat::Id<char>(0xC52B, 4).view() == "0xc52b");
+
+TEST_F(HexFormatTest, Id_MatchesSwprintf)
+{
+    for (USHORT width : { 1, 2, 4, 8 })
+    {
+        for (USHORT value : { 0x0, 0x1, 0x12, 0x951, 0x1234, 0xFFFF })
+        {
+            EXPECT_EQ(HexFormat::Id(value, width).view(), LegacyHexId(value, width)) << value << " width " << width;
+        }
+    }
+}
+
+TEST_F(HexFormatTest, Id_WidthIsClampedAndTerminated)
+{
+    const auto text = HexFormat::Id(0x12, 40);
+
+    EXPECT_EQ(text.size(), 2 + HexFormat::MaxIdDigits);
+    EXPECT_EQ(std::wstring(text.c_str()), text.view());
+    EXPECT_EQ(HexFormat::Id(UINT64_MAX, 0).view(), L"0xffffffffffffffff");
+}
+
+TEST_F(HexFormatTest, Guid_MatchesStringFromGuid2)
+{
+    EXPECT_EQ(HexFormat::Guid(HidClass).view(), L"{745A17A0-74D3-11D0-B6FE-00A0C90F57DA}");
+    EXPECT_EQ(HexFormat::Guid(HidClass).view(), LegacyGuid(HidClass));
+    EXPECT_EQ(HexFormat::Guid<char>(GUID{}).view(), "{00000000-0000-0000-0000-000000000000}");
+}
+
+TEST_F(HexFormatTest, GetHexIdAsString_UsesInlineFormatter)
+{
+    EXPECT_EQ(UtilConvert::GetHexIdAsString(0x0403, 4), L"0x0403");
+}
+
+TEST_F(HexFormatTest, Microbenchmark_AgainstLegacyFormatters)
+{
+    constexpr int Iterations = 200000;
+
+    const double legacyId = NanosecondsPerCall(Iterations, [](int i) {
+        return LegacyHexId(static_cast<USHORT>(i), 4).size();
+    });
+    const double inlineId = NanosecondsPerCall(Iterations, [](int i) {
+        return HexFormat::Id(static_cast<USHORT>(i), 4).size();
+    });
+
+    GUID guid = HidClass;
+    const double legacyGuid = NanosecondsPerCall(Iterations, [&](int i) {
+        guid.Data1 = static_cast<unsigned long>(i);
+        return LegacyGuid(guid).size();
+    });
+    const double inlineGuid = NanosecondsPerCall(Iterations, [&](int i) {
+        guid.Data1 = static_cast<unsigned long>(i);
+        return HexFormat::Guid(guid).size();
+    });
+
+    RecordProperty("LegacyIdNs", std::to_string(static_cast<int>(legacyId)));
+    RecordProperty("InlineIdNs", std::to_string(static_cast<int>(inlineId)));
+    RecordProperty("LegacyGuidNs", std::to_string(static_cast<int>(legacyGuid)));
+    RecordProperty("InlineGuidNs", std::to_string(static_cast<int>(inlineGuid)));
+    // The inline formatter is required to be faster by WinDevicesBenchmarks (BUILD_BENCHMARKS)
+}
+
+} // namespace Testing
+} // namespace KDM
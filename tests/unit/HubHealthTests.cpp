@@ -0,0 +1,386 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "HubHealthTracker.h"
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "FaultInjectingUsbBackend.h"
+#include "Exceptions.h"
+#include "mocks/MockUsbBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace KDM
+{
+namespace Testing
+{
+
+namespace
+{
+    const std::wstring kHubPath = L"\\\\?\\USB#SIM_HUB#1";
+
+    /// Fault injector that additionally drops the last port from the connection
+    /// information, so the hub reports fewer ports than it has.
+    class GarbageConnectionInfoCommunication : public FaultInjectingDeviceCommunication
+    {
+    public:
+        using FaultInjectingDeviceCommunication::FaultInjectingDeviceCommunication;
+
+        void EnumeratePortsConnectionInfo(ULONG numberOfPorts,
+            std::map<size_t, HubConnectionInfo>& hubConnectionInfoList) override
+        {
+            FaultInjectingDeviceCommunication::EnumeratePortsConnectionInfo(numberOfPorts, hubConnectionInfoList);
+            if (!hubConnectionInfoList.empty()) {
+                hubConnectionInfoList.erase(std::prev(hubConnectionInfoList.end()));
+            }
+        }
+    };
+
+    /// Models an IOCTL cancelled while pending: the first capability request cancels the
+    /// token handed to SetIoLimits and fails as DeviceCommunication would.
+    class CancelledIoCommunication : public FaultInjectingDeviceCommunication
+    {
+    public:
+        using FaultInjectingDeviceCommunication::FaultInjectingDeviceCommunication;
+
+        void SetIoLimits(const EnumerationOptions& options) override
+        {
+            FaultInjectingDeviceCommunication::SetIoLimits(options);
+            limits_ = options;
+        }
+
+        void GetUsbHubNodeCapabilitiesEx(HubNodeCapabilitiesEx& /*nodeInfo*/) override
+        {
+            if (!limits_) {
+                throw DeviceIoException("GetUsbHubNodeCapabilitiesEx: no I/O limits set", ERROR_GEN_FAILURE);
+            }
+            limits_->cancellation.Cancel();
+            throw DeviceIoException("GetUsbHubNodeCapabilitiesEx: cancelled", ERROR_OPERATION_ABORTED);
+        }
+
+    private:
+        std::optional<EnumerationOptions> limits_;
+    };
+
+    /// Backend that injects faults only into the hubs listed in faultyHubs,
+    /// and counts how often each hub is opened.
+    class TargetedFaultBackend : public IUsbBackend
+    {
+    public:
+        TargetedFaultBackend(std::unique_ptr<MockUsbBackend> inner, FaultInjectionConfig config)
+            : inner_(std::move(inner)), config_(std::move(config))
+        {
+        }
+
+        std::set<std::wstring> faultyHubs;
+        bool garbage = false;
+        bool cancelIo = false;
+        std::map<std::wstring, int> opens;
+
+        [[nodiscard]] std::vector<DevInfoData> GetDeviceInstances() override { return inner_->GetDeviceInstances(); }
+        [[nodiscard]] std::vector<std::wstring> GetRootHubPaths() override { return inner_->GetRootHubPaths(); }
+        [[nodiscard]] std::wstring GetHubDevicePath(const DevInfoData& hubDevice) override { return inner_->GetHubDevicePath(hubDevice); }
+
+        [[nodiscard]] std::unique_ptr<IDeviceCommunication> OpenHub(const std::wstring& hubPath) override
+        {
+            ++opens[hubPath];
+            auto hub = inner_->OpenHub(hubPath);
+            if (faultyHubs.count(hubPath) == 0) {
+                return hub;
+            }
+            if (garbage) {
+                return std::make_unique<GarbageConnectionInfoCommunication>(std::move(hub), config_);
+            }
+            if (cancelIo) {
+                return std::make_unique<CancelledIoCommunication>(std::move(hub), config_);
+            }
+            return std::make_unique<FaultInjectingDeviceCommunication>(std::move(hub), config_);
+        }
+
+    private:
+        std::unique_ptr<MockUsbBackend> inner_;
+        FaultInjectionConfig config_;
+    };
+
+    FaultInjectionConfig FailingCapabilitiesConfig(double errorRate)
+    {
+        FaultInjectionConfig config;
+        config.seed = 11;
+        config[CommunicationOperation::HubNodeCapabilitiesEx].errorRate = errorRate;
+        return config;
+    }
+
+    const HubHealthStats* FindHub(const std::vector<HubHealthStats>& stats, const std::wstring& hubPath)
+    {
+        auto it = std::find_if(stats.begin(), stats.end(),
+            [&](const HubHealthStats& hub) { return hub.hubPath == hubPath; });
+        return it != stats.end() ? &*it : nullptr;
+    }
+}
+
+/// <summary>
+/// Tests for HubHealthTracker and the per-hub retry / circuit breaker applied
+/// by DevicesManager, driven by the fault-injection harness.
+/// </summary>
+class HubHealthTest : public ::testing::Test
+{
+protected:
+    HubHealthPolicy MakePolicy()
+    {
+        HubHealthPolicy policy;
+        policy.maxAttempts = 3;
+        policy.initialBackoff = 10ms;
+        policy.maxBackoff = 40ms;
+        policy.failureThreshold = 2;
+        policy.cooldown = 1000ms;
+        policy.clock = [this]() { return now_; };
+        policy.delay = [this](std::chrono::milliseconds duration) { delays_.push_back(duration); };
+        return policy;
+    }
+
+    std::chrono::steady_clock::time_point now_{};
+    std::vector<std::chrono::milliseconds> delays_;
+};
+
+TEST_F(HubHealthTest, Backoff_DoublesUpToMaximum)
+{
+    HubHealthTracker tracker(MakePolicy());
+
+    EXPECT_EQ(tracker.BackoffFor(1), 10ms);
+    EXPECT_EQ(tracker.BackoffFor(2), 20ms);
+    EXPECT_EQ(tracker.BackoffFor(3), 40ms);
+    EXPECT_EQ(tracker.BackoffFor(10), 40ms);
+}
+
+TEST_F(HubHealthTest, InvalidPolicy_Throws)
+{
+    HubHealthPolicy noAttempts = MakePolicy();
+    noAttempts.maxAttempts = 0;
+    EXPECT_THROW(HubHealthTracker{ noAttempts }, InvalidDeviceArgumentException);
+
+    HubHealthPolicy inverted = MakePolicy();
+    inverted.initialBackoff = 100ms;
+    EXPECT_THROW(HubHealthTracker{ inverted }, InvalidDeviceArgumentException);
+}
+
+TEST_F(HubHealthTest, Tracker_OpensHalfOpensAndCloses)
+{
+    HubHealthTracker tracker(MakePolicy());
+
+    EXPECT_EQ(tracker.BeginScan(kHubPath), 3u);
+    tracker.RecordFailure(kHubPath, "first");
+    EXPECT_EQ(tracker.GetState(kHubPath), CircuitState::Closed);
+
+    EXPECT_EQ(tracker.BeginScan(kHubPath), 3u);
+    tracker.RecordFailure(kHubPath, "second");
+    EXPECT_EQ(tracker.GetState(kHubPath), CircuitState::Open);
+
+    // Skipped during the cooldown
+    now_ += 999ms;
+    EXPECT_EQ(tracker.BeginScan(kHubPath), 0u);
+
+    // Single trial attempt after the cooldown; a failed trial reopens immediately
+    now_ += 1ms;
+    EXPECT_EQ(tracker.BeginScan(kHubPath), 1u);
+    EXPECT_EQ(tracker.GetState(kHubPath), CircuitState::HalfOpen);
+    tracker.RecordFailure(kHubPath, "trial");
+    EXPECT_EQ(tracker.GetState(kHubPath), CircuitState::Open);
+    EXPECT_EQ(tracker.BeginScan(kHubPath), 0u);
+
+    now_ += 1000ms;
+    EXPECT_EQ(tracker.BeginScan(kHubPath), 1u);
+    tracker.RecordSuccess(kHubPath);
+    EXPECT_EQ(tracker.GetState(kHubPath), CircuitState::Closed);
+
+    auto stats = tracker.GetStats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].consecutiveFailures, 0u);
+    EXPECT_EQ(stats[0].failures, 3u);
+    EXPECT_EQ(stats[0].successes, 1u);
+    EXPECT_EQ(stats[0].skippedWhileOpen, 2u);
+    EXPECT_EQ(stats[0].timesOpened, 2u);
+    EXPECT_EQ(stats[0].lastError, "trial");
+}
+
+TEST_F(HubHealthTest, TransientFaults_RecoveredByRetry)
+{
+    // Three out of four capability requests fail; retries on fresh handles recover
+    auto backend = std::make_unique<FaultInjectingUsbBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), FailingCapabilitiesConfig(0.75));
+    FaultInjectingUsbBackend* faults = backend.get();
+
+    DevicesManager manager(std::move(backend));
+    HubHealthPolicy policy = MakePolicy();
+    policy.maxAttempts = 64;
+    manager.SetHubHealthPolicy(policy);
+
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions{});
+
+    EXPECT_TRUE(status.IsComplete());
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+    EXPECT_GT(faults->GetStats().injectedErrors, 0u);
+
+    uint64_t retries = 0;
+    for (const auto& hub : manager.GetHubHealth())
+    {
+        EXPECT_EQ(hub.state, CircuitState::Closed);
+        EXPECT_EQ(hub.failures, 0u);
+        retries += hub.retries;
+    }
+    EXPECT_EQ(retries, faults->GetStats().injectedErrors);
+    EXPECT_EQ(delays_.size(), retries);
+}
+
+TEST_F(HubHealthTest, FailingHub_SkippedAfterRetriesAndCircuitOpens)
+{
+    auto backend = std::make_unique<TargetedFaultBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), FailingCapabilitiesConfig(1.0));
+    TargetedFaultBackend* target = backend.get();
+    target->faultyHubs.insert(kHubPath);
+
+    DevicesManager manager(std::move(backend));
+    manager.SetHubHealthPolicy(MakePolicy());
+
+    // First scan: three attempts with 10 and 20 ms backoff, the rest of the bus is scanned
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions{});
+    EXPECT_EQ(manager.GetDeviceCount(), 4u);
+    ASSERT_EQ(status.skipped.size(), 1u);
+    EXPECT_EQ(status.skipped[0].hubPath, kHubPath);
+    EXPECT_EQ(status.skipped[0].reason, SkipReason::HubFailed);
+    EXPECT_FALSE(status.timedOut);
+    EXPECT_EQ(target->opens[kHubPath], 3);
+    EXPECT_EQ(delays_, (std::vector<std::chrono::milliseconds>{ 10ms, 20ms }));
+
+    // Second scan reaches the threshold and opens the circuit
+    (void)manager.EnumerateUsbDevices(EnumerationOptions{});
+    EXPECT_EQ(target->opens[kHubPath], 6);
+
+    const HubHealthStats* hub = FindHub(manager.GetHubHealth(), kHubPath);
+    ASSERT_NE(hub, nullptr);
+    EXPECT_EQ(hub->state, CircuitState::Open);
+    EXPECT_EQ(hub->consecutiveFailures, 2u);
+    EXPECT_EQ(hub->retries, 4u);
+    EXPECT_FALSE(hub->lastError.empty());
+
+    // While open the hub is not touched at all
+    status = manager.EnumerateUsbDevices(EnumerationOptions{});
+    EXPECT_EQ(target->opens[kHubPath], 6);
+    ASSERT_EQ(status.skipped.size(), 1u);
+    EXPECT_EQ(status.skipped[0].reason, SkipReason::CircuitOpen);
+    EXPECT_EQ(manager.GetDeviceCount(), 4u);
+
+    // After the cooldown a single trial runs; the hub has recovered
+    target->faultyHubs.clear();
+    now_ += 1000ms;
+    status = manager.EnumerateUsbDevices(EnumerationOptions{});
+    EXPECT_TRUE(status.IsComplete());
+    EXPECT_EQ(target->opens[kHubPath], 7);
+    EXPECT_EQ(manager.GetDeviceCount(), 8u);
+    EXPECT_EQ(FindHub(manager.GetHubHealth(), kHubPath)->state, CircuitState::Closed);
+}
+
+TEST_F(HubHealthTest, DeadlineDuringBackoff_ReportedAsTimeout)
+{
+    auto backend = std::make_unique<TargetedFaultBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), FailingCapabilitiesConfig(1.0));
+    TargetedFaultBackend* target = backend.get();
+    target->faultyHubs.insert(kHubPath);
+
+    DevicesManager manager(std::move(backend));
+    HubHealthPolicy policy = MakePolicy();
+    policy.initialBackoff = policy.maxBackoff = 60s;
+    manager.SetHubHealthPolicy(policy);
+
+    // The first retry would end after the deadline, so it is not attempted
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions::WithTimeout(30s));
+    EXPECT_TRUE(status.timedOut);
+    ASSERT_EQ(status.skipped.size(), 1u);
+    EXPECT_EQ(status.skipped[0].hubPath, kHubPath);
+    EXPECT_EQ(status.skipped[0].reason, SkipReason::TimedOut);
+    EXPECT_EQ(target->opens[kHubPath], 1);
+    EXPECT_TRUE(delays_.empty());
+
+    // Cut short by the deadline, the scan does not count against the hub
+    const HubHealthStats* hub = FindHub(manager.GetHubHealth(), kHubPath);
+    ASSERT_NE(hub, nullptr);
+    EXPECT_EQ(hub->failures, 0u);
+    EXPECT_EQ(hub->state, CircuitState::Closed);
+}
+
+TEST_F(HubHealthTest, IoCancelledMidRequest_NotRetriedOrCounted)
+{
+    auto backend = std::make_unique<TargetedFaultBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), FaultInjectionConfig{});
+    TargetedFaultBackend* target = backend.get();
+    target->faultyHubs.insert(kHubPath);
+    target->cancelIo = true;
+
+    DevicesManager manager(std::move(backend));
+    manager.SetHubHealthPolicy(MakePolicy());
+
+    // The hub receives the caller's token; the aborted request ends the scan there
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions{});
+    EXPECT_TRUE(status.cancelled);
+    auto skippedHub = std::find_if(status.skipped.begin(), status.skipped.end(),
+        [](const SkippedNode& node) { return node.hubPath == kHubPath && node.portNumber == 0; });
+    ASSERT_NE(skippedHub, status.skipped.end());
+    EXPECT_EQ(skippedHub->reason, SkipReason::Cancelled);
+    EXPECT_EQ(target->opens[kHubPath], 1);
+    EXPECT_TRUE(delays_.empty());
+
+    const HubHealthStats* hub = FindHub(manager.GetHubHealth(), kHubPath);
+    ASSERT_NE(hub, nullptr);
+    EXPECT_EQ(hub->failures, 0u);
+    EXPECT_EQ(hub->state, CircuitState::Closed);
+}
+
+TEST_F(HubHealthTest, InconsistentConnectionInfo_TreatedAsFailure)
+{
+    auto backend = std::make_unique<TargetedFaultBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)), FaultInjectionConfig{});
+    TargetedFaultBackend* target = backend.get();
+    target->faultyHubs.insert(kHubPath);
+    target->garbage = true;
+
+    DevicesManager manager(std::move(backend));
+    manager.SetHubHealthPolicy(MakePolicy());
+
+    EnumerationStatus status = manager.EnumerateUsbDevices(EnumerationOptions{});
+
+    EXPECT_EQ(manager.GetDeviceCount(), 4u);
+    ASSERT_EQ(status.skipped.size(), 1u);
+    EXPECT_EQ(status.skipped[0].reason, SkipReason::HubFailed);
+    EXPECT_EQ(target->opens[kHubPath], 3);
+}
+
+TEST_F(HubHealthTest, ResetHubHealth_ClosesCircuits)
+{
+    auto backend = std::make_unique<TargetedFaultBackend>(
+        std::make_unique<MockUsbBackend>(MakeSimulatedBus(1, 1, 4)), FailingCapabilitiesConfig(1.0));
+    backend->faultyHubs.insert(kHubPath);
+
+    DevicesManager manager(std::move(backend));
+    HubHealthPolicy policy = MakePolicy();
+    policy.maxAttempts = 1;
+    policy.failureThreshold = 1;
+    manager.SetHubHealthPolicy(policy);
+
+    (void)manager.EnumerateUsbDevices(EnumerationOptions{});
+    EXPECT_EQ(FindHub(manager.GetHubHealth(), kHubPath)->state, CircuitState::Open);
+    EXPECT_TRUE(delays_.empty());
+
+    manager.ResetHubHealth();
+    EXPECT_TRUE(manager.GetHubHealth().empty());
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "JsonExporter.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "fixtures/TestDevices.h"
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for JsonExporter: document and NDJSON layout, single-pass escaping,
+/// chunked output through small buffers and export throughput.
+/// </summary>
+class JsonExporterTest : public ::testing::Test
+{
+protected:
+    JsonSink Collect()
+    {
+        return [this](const char* data, size_t size) {
+            output_.append(data, size);
+            ++chunks_;
+        };
+    }
+
+    // JSON of MakeDevice(productId, product) with the default field values
+    static std::string ExpectedDevice(unsigned int productId, const std::string& product = "Device")
+    {
+        return "\"manufacturer\":\"\",\"product\":\"" + product + "\",\"serialNumber\":\"SN" + std::to_string(productId) + "\","
+            "\"description\":\"\",\"deviceId\":\"\",\"friendlyName\":\"\",\"devicePath\":\"\",\"vendorName\":\"\",\"interfaceClassName\":\"\","
+            "\"vendorId\":4660,\"productId\":" + std::to_string(productId) + ",\"deviceClass\":0,\"interfaceClass\":255,"
+            "\"setupClassGuid\":\"{00000000-0000-0000-0000-000000000000}\",\"isUsbDevice\":true,\"isConnected\":false,\"location\":\"\"";
+    }
+
+    std::string output_;
+    int chunks_ = 0;
+};
+
+TEST_F(JsonExporterTest, Document_WritesVersionAndDeviceArray)
+{
+    JsonExporter exporter(Collect(), JsonFormat::Document);
+    exporter.WriteSnapshot(MakeSnapshot(3, { MakeDevice(1), MakeDevice(2) }));
+    exporter.Flush();
+
+    EXPECT_EQ(output_, "{\"version\":3,\"devices\":[{" + ExpectedDevice(1) + "},{" + ExpectedDevice(2) + "}]}");
+    EXPECT_EQ(exporter.GetBytesWritten(), output_.size());
+}
+
+TEST_F(JsonExporterTest, NdJson_WritesOneLinePerDevice)
+{
+    JsonExporter exporter(Collect(), JsonFormat::NdJson);
+    exporter.WriteSnapshot(MakeSnapshot(4, { MakeDevice(1), MakeDevice(2) }));
+    exporter.Flush();
+
+    EXPECT_EQ(output_,
+        "{\"snapshotVersion\":4," + ExpectedDevice(1) + "}\n"
+        "{\"snapshotVersion\":4," + ExpectedDevice(2) + "}\n");
+}
+
+TEST_F(JsonExporterTest, Strings_AreEscapedAndTranscoded)
+{
+    // quote, backslash, control characters, 2-byte, 4-byte (surrogate pair) and a lone surrogate
+    const std::wstring product = L"a\"b\\c\n\x01\u00E9\xD83D\xDE00\xD800z";
+
+    JsonExporter exporter(Collect(), JsonFormat::Document);
+    exporter.WriteSnapshot(MakeSnapshot(1, { MakeDevice(1, product) }));
+    exporter.Flush();
+
+    EXPECT_NE(output_.find("\"product\":\"a\\\"b\\\\c\\n\\u0001\xC3\xA9\xF0\x9F\x98\x80\xEF\xBF\xBDz\""), std::string::npos)
+        << output_;
+}
+
+TEST_F(JsonExporterTest, SmallBuffer_ProducesSameOutputInChunks)
+{
+    std::vector<DeviceResultantInfo> devices;
+    for (uint16_t pid = 1; pid <= 20; ++pid) {
+        devices.push_back(MakeDevice(pid, std::wstring(50, L'\u00E9')));
+    }
+    const auto snapshot = MakeSnapshot(1, devices);
+
+    std::string large;
+    JsonExporter reference([&](const char* data, size_t size) { large.append(data, size); }, JsonFormat::Document);
+    reference.WriteSnapshot(snapshot);
+    reference.Flush();
+
+    JsonExporter exporter(Collect(), JsonFormat::Document, 64);
+    exporter.WriteSnapshot(snapshot);
+    exporter.Flush();
+
+    EXPECT_EQ(output_, large);
+    EXPECT_GT(chunks_, 10);
+}
+
+TEST_F(JsonExporterTest, Events_WriteKeyAsHexString)
+{
+    DeviceEvent event;
+    event.sequence = 7;
+    event.snapshotVersion = 2;
+    event.deviceKey = 0xFEDCBA9876543210ull;
+    event.timestampMs = -5;
+    event.vendorId = 0x1234;
+    event.productId = 0x10;
+    event.type = DeviceEventType::Removed;
+
+    JsonExporter exporter(Collect(), JsonFormat::NdJson);
+    exporter.WriteEvents(&event, 1);
+    exporter.Flush();
+
+    EXPECT_EQ(output_, "{\"sequence\":7,\"snapshotVersion\":2,\"type\":\"removed\",\"deviceKey\":\"FEDCBA9876543210\","
+        "\"timestampMs\":-5,\"vendorId\":4660,\"productId\":16,\"deviceClass\":0,\"interfaceClass\":0}\n");
+}
+
+TEST_F(JsonExporterTest, Changes_DocumentIsAnArray)
+{
+    DeviceChange change;
+    change.sequence = 1;
+    change.snapshotVersion = 1;
+    change.deviceKey = 0x10;
+    change.device = MakeDevice(5);
+
+    JsonExporter exporter(Collect(), JsonFormat::Document);
+    exporter.WriteChanges({ change, change });
+    exporter.Flush();
+
+    const std::string item = "{\"sequence\":1,\"snapshotVersion\":1,\"type\":\"arrived\",\"deviceKey\":\"0000000000000010\","
+        "\"device\":{" + ExpectedDevice(5) + "}}";
+    EXPECT_EQ(output_, "[" + item + "," + item + "]");
+}
+
+TEST_F(JsonExporterTest, ThrowingSink_AbortsAndExporterStaysUsable)
+{
+    bool fail = true;
+    JsonExporter exporter([&](const char* data, size_t size) {
+        if (fail) {
+            throw std::runtime_error("stop");
+        }
+        output_.append(data, size);
+    }, JsonFormat::NdJson, 64);
+
+    EXPECT_THROW(exporter.WriteSnapshot(MakeSnapshot(1, { MakeDevice(1) })), std::runtime_error);
+
+    fail = false;
+    exporter.WriteSnapshot(MakeSnapshot(1, { MakeDevice(2) }));
+    exporter.Flush();
+    EXPECT_EQ(output_, "{\"snapshotVersion\":1," + ExpectedDevice(2) + "}\n");
+}
+
+TEST_F(JsonExporterTest, InvalidArguments_Throw)
+{
+    EXPECT_THROW(JsonExporter(JsonSink{}, JsonFormat::Document), InvalidDeviceArgumentException);
+    EXPECT_THROW(JsonExporter(Collect(), JsonFormat::Document, 16), InvalidDeviceArgumentException);
+}
+
+TEST_F(JsonExporterTest, Throughput_ReportsMegabytesPerSecond)
+{
+    const auto snapshot = MakeFleet(1, 100000);
+
+    uint64_t bytes = 0;
+    JsonExporter exporter([&](const char*, size_t size) { bytes += size; }, JsonFormat::NdJson);
+
+    const auto start = std::chrono::steady_clock::now();
+    exporter.WriteSnapshot(snapshot);
+    exporter.Flush();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double megabytesPerSecond = bytes / (1024.0 * 1024.0) / (seconds > 0 ? seconds : 1e-9);
+    RecordProperty("Bytes", std::to_string(bytes));
+    RecordProperty("MBps", std::to_string(static_cast<int>(megabytesPerSecond)));
+
+    EXPECT_EQ(bytes, exporter.GetBytesWritten());
+    // The minimum rate is checked by WinDevicesBenchmarks (BUILD_BENCHMARKS)
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -48,7 +48,8 @@ protected:
 /// </summary>
 TEST_F(PropertyBasedTest, AllVendorIds_InValidRange)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -62,7 +63,8 @@ TEST_F(PropertyBasedTest, AllVendorIds_InValidRange)
 /// </summary>
 TEST_F(PropertyBasedTest, AllProductIds_InValidRange)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -78,7 +80,8 @@ TEST_F(PropertyBasedTest, AllProductIds_InValidRange)
 /// </summary>
 TEST_F(PropertyBasedTest, AllDeviceClasses_InValidRange)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -92,7 +95,8 @@ TEST_F(PropertyBasedTest, AllDeviceClasses_InValidRange)
 /// </summary>
 TEST_F(PropertyBasedTest, AllInterfaceClasses_InValidRange)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -108,7 +112,8 @@ TEST_F(PropertyBasedTest, AllInterfaceClasses_InValidRange)
 /// </summary>
 TEST_F(PropertyBasedTest, UsbDevicePaths_ContainExpectedPatterns)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -131,7 +136,8 @@ TEST_F(PropertyBasedTest, UsbDevicePaths_ContainExpectedPatterns)
 /// </summary>
 TEST_F(PropertyBasedTest, DeviceIds_NoEmbeddedNulls)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -152,7 +158,8 @@ TEST_F(PropertyBasedTest, DeviceIds_NoEmbeddedNulls)
 /// </summary>
 TEST_F(PropertyBasedTest, ConnectedUsbDevices_HaveValidDescriptorInfo)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -180,7 +187,8 @@ TEST_F(PropertyBasedTest, ConnectedUsbDevices_HaveValidDescriptorInfo)
 /// </summary>
 TEST_F(PropertyBasedTest, SetupClassGuids_ValidFormat)
 {
-    const auto& devices = manager_->GetDevices();
+    DeviceSnapshotPtr snapshot = manager_->GetDevices();
+    const auto& devices = snapshot->devices;
 
     for (const auto& device : devices)
     {
@@ -280,12 +288,12 @@ TEST_F(PropertyBasedTest, HexIdString_ConsistentLength)
 /// </summary>
 TEST_F(PropertyBasedTest, MultipleEnumerations_ConsistentCount)
 {
-    size_t firstCount = manager_->GetDevices().size();
+    size_t firstCount = manager_->GetDevices()->devices.size();
 
     // Re-enumerate
     DevicesManager manager2;
     manager2.EnumerateUsbDevices();
-    size_t secondCount = manager2.GetDevices().size();
+    size_t secondCount = manager2.GetDevices()->devices.size();
 
     // Counts should match (assuming no device changes during test)
     EXPECT_EQ(firstCount, secondCount)
@@ -297,18 +305,18 @@ TEST_F(PropertyBasedTest, MultipleEnumerations_ConsistentCount)
 /// </summary>
 TEST_F(PropertyBasedTest, ClearAndReEnumerate_Works)
 {
-    size_t originalCount = manager_->GetDevices().size();
+    size_t originalCount = manager_->GetDevices()->devices.size();
 
     // Create a new manager (simulates clear)
     manager_ = std::make_unique<DevicesManager>();
-    EXPECT_EQ(manager_->GetDevices().size(), 0)
+    EXPECT_EQ(manager_->GetDevices()->devices.size(), 0)
         << "Fresh manager should have no devices";
 
     // Re-enumerate
     manager_->EnumerateUsbDevices();
 
     // Should have devices again
-    EXPECT_EQ(manager_->GetDevices().size(), originalCount)
+    EXPECT_EQ(manager_->GetDevices()->devices.size(), originalCount)
         << "Should have same device count after re-enumeration";
 }
 
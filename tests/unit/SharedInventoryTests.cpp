@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "SharedInventory.h"
+#include "DeviceChange.h"
+#include "DevicesManager.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "mocks/MockUsbBackend.h"
+#include "fixtures/TestDevices.h"
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for the shared inventory layout (on a heap buffer), the named
+/// publisher/reader mapping and DevicesManager::EnableSharedInventory.
+/// </summary>
+class SharedInventoryTest : public ::testing::Test
+{
+protected:
+    struct alignas(64) Block
+    {
+        char bytes[64];
+    };
+
+    // Heap region with the alignment a mapped view would have
+    static std::vector<Block> MakeRegion(uint32_t capacity)
+    {
+        std::vector<Block> region((SharedInventoryLayout::RegionSize(capacity) + sizeof(Block) - 1) / sizeof(Block));
+        SharedInventoryLayout::InitializeRegion(region.data(), capacity);
+        return region;
+    }
+
+    // Unique per test and process so parallel test runs do not share a region
+    static std::wstring MappingName()
+    {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::string name = info->name();
+        return L"Local\\KDM.Tests." + std::to_wstring(GetCurrentProcessId()) + L"." +
+            std::wstring(name.begin(), name.end());
+    }
+};
+
+TEST_F(SharedInventoryTest, EmptyRegion_ReadsGenerationZero)
+{
+    auto region = MakeRegion(4);
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(ReadSharedInventory(region.data(), contents));
+    EXPECT_EQ(contents.generation, 0u);
+    EXPECT_TRUE(contents.devices.empty());
+}
+
+TEST_F(SharedInventoryTest, WriteSnapshot_RoundTripsDeviceFields)
+{
+    auto region = MakeRegion(4);
+    auto device = MakeDevice(0x5678, L"Keyboard");
+    SharedInventoryLayout::WriteSnapshot(region.data(), MakeSnapshot(7, { device }));
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(ReadSharedInventory(region.data(), contents));
+    EXPECT_EQ(contents.generation, 1u);
+    EXPECT_EQ(contents.snapshotVersion, 7u);
+    EXPECT_EQ(contents.totalDevices, 1u);
+    ASSERT_EQ(contents.devices.size(), 1u);
+
+    const auto& record = contents.devices[0];
+    EXPECT_STREQ(record.product, "Keyboard");
+    EXPECT_STREQ(record.serialNumber, "SN22136");
+    EXPECT_EQ(record.vendorId, 0x1234u);
+    EXPECT_EQ(record.productId, 0x5678u);
+    EXPECT_EQ(record.isUsbDevice, 1);
+    EXPECT_EQ(record.deviceKey, DeviceKeyOf(device));
+}
+
+TEST_F(SharedInventoryTest, WriteSnapshot_StoresAtMostCapacityDevices)
+{
+    auto region = MakeRegion(2);
+    SharedInventoryLayout::WriteSnapshot(region.data(), MakeSnapshot(1, { MakeDevice(1), MakeDevice(2), MakeDevice(3) }));
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(ReadSharedInventory(region.data(), contents));
+    EXPECT_EQ(contents.devices.size(), 2u);
+    EXPECT_EQ(contents.totalDevices, 3u);
+}
+
+TEST_F(SharedInventoryTest, LongString_IsCutAtCharacterBoundary)
+{
+    auto region = MakeRegion(1);
+    SharedInventoryLayout::WriteSnapshot(region.data(), MakeSnapshot(1, { MakeDevice(1, std::wstring(200, L'\u00E9')) }));
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(ReadSharedInventory(region.data(), contents));
+
+    // Two bytes per character: 127 bytes would split the last one
+    EXPECT_EQ(std::strlen(contents.devices[0].product), 126u);
+}
+
+TEST_F(SharedInventoryTest, LongString_KeepsSurrogatePairsWhole)
+{
+    auto region = MakeRegion(1);
+    std::wstring emoji;
+    for (int i = 0; i < 100; ++i) {
+        emoji += L"\U0001F600";
+    }
+    SharedInventoryLayout::WriteSnapshot(region.data(), MakeSnapshot(1, { MakeDevice(1, emoji) }));
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(ReadSharedInventory(region.data(), contents));
+
+    // Four bytes per character: 31 whole characters fit in 127 bytes
+    EXPECT_EQ(std::strlen(contents.devices[0].product), 124u);
+    EXPECT_EQ(std::memcmp(contents.devices[0].product, "\xF0\x9F\x98\x80", 4), 0);
+}
+
+TEST_F(SharedInventoryTest, IsValidRegion_RejectsForeignOrShortMemory)
+{
+    auto region = MakeRegion(4);
+    const size_t size = SharedInventoryLayout::RegionSize(4);
+
+    EXPECT_TRUE(SharedInventoryLayout::IsValidRegion(region.data(), size));
+    EXPECT_FALSE(SharedInventoryLayout::IsValidRegion(region.data(), size - 1));
+
+    std::vector<Block> garbage(region.size());
+    std::memset(garbage.data(), 0x5A, garbage.size() * sizeof(Block));
+    EXPECT_FALSE(SharedInventoryLayout::IsValidRegion(garbage.data(), size));
+}
+
+TEST_F(SharedInventoryTest, ConcurrentReaders_NeverSeeTornInventory)
+{
+    constexpr uint32_t capacity = 8;
+    auto region = MakeRegion(capacity);
+    std::atomic<bool> stop{ false };
+    std::atomic<int> inconsistent{ 0 };
+    std::atomic<int> reads{ 0 };
+
+    // Publication v holds (v % capacity) + 1 devices, all named after v
+    std::thread writer([&] {
+        for (uint64_t version = 1; version <= 2000; ++version)
+        {
+            std::vector<DeviceResultantInfo> devices;
+            for (uint16_t i = 0; i <= version % capacity; ++i) {
+                devices.push_back(MakeDevice(i, L"v" + std::to_wstring(version)));
+            }
+            SharedInventoryLayout::WriteSnapshot(region.data(), MakeSnapshot(version, std::move(devices)));
+        }
+        stop = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r)
+    {
+        readers.emplace_back([&] {
+            SharedInventoryContents contents;
+            while (!stop)
+            {
+                if (!ReadSharedInventory(region.data(), contents) || contents.generation == 0) {
+                    continue;
+                }
+                ++reads;
+
+                const std::string expected = "v" + std::to_string(contents.snapshotVersion);
+                bool consistent = contents.devices.size() == (contents.snapshotVersion % capacity) + 1;
+                for (const auto& record : contents.devices) {
+                    consistent = consistent && expected == record.product;
+                }
+                if (!consistent) {
+                    ++inconsistent;
+                }
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_GT(reads.load(), 0);
+    EXPECT_EQ(inconsistent.load(), 0);
+}
+
+TEST_F(SharedInventoryTest, NamedRegion_ReaderSeesPublications)
+{
+    SharedInventoryPublisher publisher(MappingName(), 4);
+    SharedInventoryReader reader(MappingName());
+    EXPECT_EQ(reader.GetGeneration(), 0u);
+
+    publisher.Publish(MakeSnapshot(3, { MakeDevice(1), MakeDevice(2) }));
+    EXPECT_EQ(reader.GetGeneration(), 1u);
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(reader.Read(contents));
+    EXPECT_EQ(contents.snapshotVersion, 3u);
+    EXPECT_EQ(contents.devices.size(), 2u);
+}
+
+TEST_F(SharedInventoryTest, NamedRegion_MissingOrIncompatibleThrows)
+{
+    EXPECT_THROW(SharedInventoryReader reader(MappingName()), DeviceIoException);
+
+    SharedInventoryPublisher publisher(MappingName(), 4);
+    EXPECT_THROW(SharedInventoryPublisher other(MappingName(), 8), DeviceIoException);
+    EXPECT_THROW(SharedInventoryPublisher unnamed(L"", 4), InvalidDeviceArgumentException);
+}
+
+TEST_F(SharedInventoryTest, DevicesManager_MirrorsEveryPublication)
+{
+    auto backend = std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4));
+    MockUsbBackend* bus = backend.get();
+    DevicesManager manager(std::move(backend));
+    manager.EnumerateUsbDevices();
+
+    manager.EnableSharedInventory(MappingName());
+    SharedInventoryReader reader(MappingName());
+
+    SharedInventoryContents contents;
+    ASSERT_TRUE(reader.Read(contents));
+    EXPECT_EQ(contents.devices.size(), 8u);
+    EXPECT_EQ(contents.snapshotVersion, manager.GetSnapshot()->version);
+
+    bus->SetRootHubs(MakeSimulatedBus(1, 1, 4));
+    manager.EnumerateUsbDevices();
+    ASSERT_TRUE(reader.Read(contents));
+    EXPECT_EQ(contents.devices.size(), 4u);
+
+    manager.DisableSharedInventory();
+    const uint64_t generation = reader.GetGeneration();
+    manager.ClearDevices();
+    EXPECT_EQ(reader.GetGeneration(), generation);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "SnapshotDelta.h"
+#include "UsbLocation.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "fixtures/TestDevices.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for EncodeSnapshotDelta / DecodeSnapshotDelta: randomized round trips,
+/// rejection of foreign or corrupt deltas and delta size on synthetic fleets.
+/// </summary>
+class SnapshotDeltaTest : public ::testing::Test
+{
+protected:
+    // Applies a random mix of removals, arrivals, property changes and moves
+    static DeviceSnapshot Mutate(const DeviceSnapshot& base, std::mt19937& rng, unsigned int& nextIndex)
+    {
+        DeviceSnapshot target = base;
+        target.version = base.version + 1;
+
+        const int edits = std::uniform_int_distribution<int>(0, 8)(rng);
+        for (int edit = 0; edit < edits; ++edit)
+        {
+            auto& devices = target.devices;
+            const auto pick = [&] { return std::uniform_int_distribution<size_t>(0, devices.size() - 1)(rng); };
+            switch (std::uniform_int_distribution<int>(0, 4)(rng))
+            {
+            case 0:
+                if (!devices.empty()) {
+                    devices.erase(devices.begin() + pick());
+                }
+                break;
+            case 1:
+                devices.insert(devices.begin() + std::uniform_int_distribution<size_t>(0, devices.size())(rng),
+                    MakeFleetDevice(nextIndex++));
+                break;
+            case 2:
+                if (!devices.empty())
+                {
+                    auto& device = devices[pick()];
+                    device.SetIsConnected(!device.IsConnected());
+                    device.SetFriendlyName(L"Renamed \u00E9 " + std::to_wstring(rng() % 4));
+                    device.SetLocationKey(UsbLocation::AppendPort(UsbLocation::ForController(1), rng() % 8 + 1));
+                }
+                break;
+            case 3:
+                if (!devices.empty()) {
+                    devices[pick()].SetSetupClassGuid(GUID{ static_cast<unsigned long>(rng()), 1, 2, { 3, 4, 5, 6, 7, 8, 9, 10 } });
+                }
+                break;
+            default:
+                if (devices.size() > 1) {
+                    std::swap(devices[pick()], devices[pick()]);
+                }
+                break;
+            }
+        }
+
+        // Duplicate devices are matched in order, like DiffSnapshots
+        if (!target.devices.empty() && rng() % 8 == 0) {
+            target.devices.push_back(target.devices.front());
+        }
+        return target;
+    }
+
+    static void ExpectSameSnapshot(const DeviceSnapshot& expected, const DeviceSnapshot& actual)
+    {
+        EXPECT_EQ(actual.version, expected.version);
+        ASSERT_EQ(actual.devices.size(), expected.devices.size());
+        for (size_t i = 0; i < expected.devices.size(); ++i) {
+            EXPECT_TRUE(actual.devices[i] == expected.devices[i]) << "device " << i;
+        }
+    }
+};
+
+TEST_F(SnapshotDeltaTest, RoundTrip_RandomEditsReproduceTarget)
+{
+    for (uint32_t seed = 1; seed <= 200; ++seed)
+    {
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        std::mt19937 rng(seed);
+        unsigned int nextIndex = 1000;
+
+        DeviceSnapshot base = MakeFleet(seed, rng() % 40);
+        for (int step = 0; step < 5; ++step)
+        {
+            const DeviceSnapshot target = Mutate(base, rng, nextIndex);
+            const auto delta = EncodeSnapshotDelta(base, target);
+            ExpectSameSnapshot(target, DecodeSnapshotDelta(base, delta));
+            if (HasFailure()) {
+                return;
+            }
+            base = target;
+        }
+    }
+}
+
+TEST_F(SnapshotDeltaTest, Unchanged_EncodesToAFewBytes)
+{
+    DeviceSnapshot base = MakeFleet(7, 500);
+    DeviceSnapshot target = base;
+    target.version = 8;
+
+    const auto delta = EncodeSnapshotDelta(base, target);
+    EXPECT_LT(delta.size(), 32u);
+    ExpectSameSnapshot(target, DecodeSnapshotDelta(base, delta));
+}
+
+TEST_F(SnapshotDeltaTest, EmptySnapshots_RoundTrip)
+{
+    const DeviceSnapshot empty;
+    const DeviceSnapshot target = MakeFleet(1, 3);
+
+    ExpectSameSnapshot(target, DecodeSnapshotDelta(empty, EncodeSnapshotDelta(empty, target)));
+    ExpectSameSnapshot(empty, DecodeSnapshotDelta(target, EncodeSnapshotDelta(target, empty)));
+}
+
+TEST_F(SnapshotDeltaTest, DifferentBase_Throws)
+{
+    const DeviceSnapshot base = MakeFleet(1, 10);
+    const DeviceSnapshot target = MakeFleet(2, 11);
+    const auto delta = EncodeSnapshotDelta(base, target);
+
+    DeviceSnapshot other = base;
+    other.devices[3].SetFriendlyName(L"changed");
+    EXPECT_THROW((void)DecodeSnapshotDelta(other, delta), DeviceIoException);
+
+    other = base;
+    other.version = 5;
+    EXPECT_THROW((void)DecodeSnapshotDelta(other, delta), DeviceIoException);
+}
+
+TEST_F(SnapshotDeltaTest, CorruptDelta_Throws)
+{
+    const DeviceSnapshot base = MakeFleet(1, 10);
+    DeviceSnapshot target = MakeFleet(2, 12);
+    target.devices[2].SetDescription(L"changed");
+    const auto delta = EncodeSnapshotDelta(base, target);
+
+    // Every truncation is rejected rather than read past the end
+    for (size_t size = 0; size < delta.size(); ++size) {
+        EXPECT_THROW((void)DecodeSnapshotDelta(base, delta.data(), size), DeviceIoException) << size;
+    }
+
+    auto trailing = delta;
+    trailing.push_back(0);
+    EXPECT_THROW((void)DecodeSnapshotDelta(base, trailing), DeviceIoException);
+
+    auto badMagic = delta;
+    badMagic[0] ^= 0xFF;
+    EXPECT_THROW((void)DecodeSnapshotDelta(base, badMagic), DeviceIoException);
+
+    EXPECT_THROW((void)DecodeSnapshotDelta(base, nullptr, 0), DeviceIoException);
+}
+
+TEST_F(SnapshotDeltaTest, SyntheticFleet_ReportsDeltaSize)
+{
+    // A large inventory where a few devices come and go and a few change between scans
+    std::mt19937 rng(42);
+    unsigned int nextIndex = 10000;
+    const DeviceSnapshot base = MakeFleet(1, 2000);
+    const DeviceSnapshot target = Mutate(Mutate(base, rng, nextIndex), rng, nextIndex);
+
+    // Reference: the same snapshot encoded against an empty base (every device added)
+    const auto full = EncodeSnapshotDelta(DeviceSnapshot{}, target);
+    const auto delta = EncodeSnapshotDelta(base, target);
+    ExpectSameSnapshot(target, DecodeSnapshotDelta(base, delta));
+
+    const double ratio = static_cast<double>(full.size()) / static_cast<double>(delta.size());
+    RecordProperty("FullBytes", std::to_string(full.size()));
+    RecordProperty("DeltaBytes", std::to_string(delta.size()));
+    RecordProperty("Ratio", std::to_string(static_cast<int>(ratio)));
+
+    EXPECT_GT(ratio, 50.0);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "SnapshotFile.h"
+#include "DeviceChange.h"
+#include "DeviceResultantInfo.h"
+#include "Exceptions.h"
+#include "fixtures/TestDevices.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for the in-place binary snapshot format (SnapshotFileWriter,
+/// SnapshotFileView, SnapshotFileReader).
+/// </summary>
+class SnapshotFileTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path_ = std::filesystem::temp_directory_path() /
+            (std::string("kdm_snapshot_") + info->name() + ".bin");
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(path_);
+    }
+
+    std::filesystem::path path_;
+};
+
+TEST_F(SnapshotFileTest, Serialize_RoundTripsEveryField)
+{
+    auto snapshot = MakeFleet(5, 3);
+    snapshot.devices[1].SetSetupClassGuid({ 0x36fc9e60, 0xc465, 0x11cf, { 0x80, 0x56, 0x44, 0x45, 0x53, 0x54, 0, 0 } });
+
+    auto buffer = SnapshotFileWriter::Serialize(snapshot);
+    SnapshotFileView view(buffer.data(), buffer.size());
+
+    EXPECT_EQ(view.GetSnapshotVersion(), 5u);
+    ASSERT_EQ(view.size(), 3u);
+    EXPECT_EQ(view.ToSnapshot().devices, snapshot.devices);
+    EXPECT_EQ(view[2].GetRecord().deviceKey, DeviceKeyOf(snapshot.devices[2]));
+}
+
+TEST_F(SnapshotFileTest, View_StringsPointIntoTheBuffer)
+{
+    auto buffer = SnapshotFileWriter::Serialize(MakeFleet(1, 2));
+    SnapshotFileView view(buffer.data(), buffer.size());
+
+    std::wstring_view product = view[1].GetProduct();
+    EXPECT_EQ(product, L"Device 2");
+
+    const auto* begin = reinterpret_cast<const uint8_t*>(product.data());
+    EXPECT_GE(begin, buffer.data());
+    EXPECT_LE(begin + product.size() * sizeof(wchar_t), buffer.data() + buffer.size());
+}
+
+TEST_F(SnapshotFileTest, EmptySnapshot_HasHeaderOnly)
+{
+    auto buffer = SnapshotFileWriter::Serialize(MakeFleet(1, 0));
+    EXPECT_EQ(buffer.size(), sizeof(SnapshotFormat::FileHeader));
+
+    SnapshotFileView view(buffer.data(), buffer.size());
+    EXPECT_TRUE(view.empty());
+}
+
+TEST_F(SnapshotFileTest, CorruptData_Throws)
+{
+    auto buffer = SnapshotFileWriter::Serialize(MakeFleet(1, 2));
+
+    EXPECT_THROW(SnapshotFileView(buffer.data(), buffer.size() - 8), DeviceIoException);
+
+    auto badMagic = buffer;
+    badMagic[0] ^= 0xFF;
+    EXPECT_THROW(SnapshotFileView(badMagic.data(), badMagic.size()), DeviceIoException);
+
+    auto badString = buffer;
+    auto* records = reinterpret_cast<SnapshotFormat::Record*>(badString.data() + sizeof(SnapshotFormat::FileHeader));
+    records[1].product.offset = 0x7FFFFFFF;
+    EXPECT_THROW(SnapshotFileView(badString.data(), badString.size()), DeviceIoException);
+
+    auto badProductId = buffer;
+    records = reinterpret_cast<SnapshotFormat::Record*>(badProductId.data() + sizeof(SnapshotFormat::FileHeader));
+    records[0].productId = 0x10000;
+    EXPECT_THROW(SnapshotFileView(badProductId.data(), badProductId.size()), DeviceIoException);
+}
+
+TEST_F(SnapshotFileTest, CorruptHeader_OffsetsCannotWrapOrLeaveTheBuffer)
+{
+    const auto buffer = SnapshotFileWriter::Serialize(MakeFleet(1, 40));
+    auto patched = [&](auto&& patch) {
+        auto copy = buffer;
+        patch(*reinterpret_cast<SnapshotFormat::FileHeader*>(copy.data()));
+        return copy;
+    };
+
+    // recordsOffset + deviceCount * sizeof(Record) wraps around to below stringsOffset
+    auto wrapped = patched([](SnapshotFormat::FileHeader& header) {
+        header.recordsOffset = 0xFFFFFFFFFFFFFF00ull;
+        header.deviceCount = 32;
+    });
+    EXPECT_THROW(SnapshotFileView(wrapped.data(), wrapped.size()), DeviceIoException);
+
+    auto pastEnd = patched([](SnapshotFormat::FileHeader& header) {
+        constexpr uint64_t alignment = alignof(SnapshotFormat::Record);
+        header.recordsOffset = (header.fileSize / alignment + 1) * alignment;
+        header.deviceCount = 0;
+    });
+    EXPECT_THROW(SnapshotFileView(pastEnd.data(), pastEnd.size()), DeviceIoException);
+
+    auto tooManyRecords = patched([](SnapshotFormat::FileHeader& header) {
+        header.deviceCount = (header.fileSize - header.recordsOffset) / sizeof(SnapshotFormat::Record) + 1;
+    });
+    EXPECT_THROW(SnapshotFileView(tooManyRecords.data(), tooManyRecords.size()), DeviceIoException);
+}
+
+TEST_F(SnapshotFileTest, File_ReaderMapsWrittenSnapshot)
+{
+    auto snapshot = MakeFleet(9, 4);
+    SnapshotFileWriter::WriteFile(path_.wstring(), snapshot);
+
+    SnapshotFileReader reader(path_.wstring());
+    const auto& view = reader.GetView();
+    EXPECT_EQ(view.GetSnapshotVersion(), 9u);
+    ASSERT_EQ(view.size(), 4u);
+    EXPECT_EQ(view[3].GetSerialNumber(), L"SN4");
+}
+
+TEST_F(SnapshotFileTest, File_MissingThrows)
+{
+    EXPECT_THROW(SnapshotFileReader reader(path_.wstring()), DeviceIoException);
+}
+
+TEST_F(SnapshotFileTest, LargeSnapshot_WritesAndMaps)
+{
+    auto snapshot = MakeFleet(1, 100000);
+
+    const auto writeStart = std::chrono::steady_clock::now();
+    SnapshotFileWriter::WriteFile(path_.wstring(), snapshot);
+    const auto writeElapsed = std::chrono::steady_clock::now() - writeStart;
+
+    const auto readStart = std::chrono::steady_clock::now();
+    SnapshotFileReader reader(path_.wstring());
+    const auto& view = reader.GetView();
+    size_t productUnits = 0;
+    for (size_t i = 0; i < view.size(); ++i) {
+        productUnits += view[i].GetProduct().size();
+    }
+    const auto readElapsed = std::chrono::steady_clock::now() - readStart;
+
+    EXPECT_EQ(view.size(), 100000u);
+    EXPECT_GT(productUnits, 0u);
+    // Time limits are checked by WinDevicesBenchmarks (BUILD_BENCHMARKS)
+    RecordProperty("WriteMs", std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(writeElapsed).count()));
+    RecordProperty("ReadMs", std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(readElapsed).count()));
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "SnapshotHistory.h"
+#include "DeviceChange.h"
+#include "DeviceResultantInfo.h"
+#include "fixtures/TestDevices.h"
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for SnapshotHistory: sharing of identical records across snapshots,
+/// oldest-first eviction under the byte and count limits, and footprint reporting.
+/// </summary>
+class SnapshotHistoryTest : public ::testing::Test
+{
+};
+
+TEST_F(SnapshotHistoryTest, Get_RebuildsRetainedSnapshots)
+{
+    SnapshotHistory history{ SnapshotHistoryPolicy{ 0, 0 } };
+    DeviceSnapshot first = MakeFleet(1, 3);
+    DeviceSnapshot second = MakeFleet(2, 3);
+    second.devices[1].SetProduct(L"Renamed");
+
+    EXPECT_TRUE(history.Add(first));
+    EXPECT_TRUE(history.Add(second));
+    EXPECT_FALSE(history.Add(first));       // not newer than the newest
+
+    auto restored = history.Get(2);
+    ASSERT_NE(restored, nullptr);
+    EXPECT_EQ(restored->version, 2u);
+    EXPECT_EQ(restored->devices, second.devices);
+    EXPECT_EQ(history.Get(1)->devices, first.devices);
+    EXPECT_EQ(history.Get(3), nullptr);
+    EXPECT_EQ(history.GetVersions(), (std::vector<uint64_t>{ 1, 2 }));
+}
+
+TEST_F(SnapshotHistoryTest, IdenticalRecords_StoredOnce)
+{
+    SnapshotHistory history{ SnapshotHistoryPolicy{ 0, 0 } };
+    for (uint64_t version = 1; version <= 10; ++version) {
+        DeviceSnapshot snapshot = MakeFleet(version, 20);
+        snapshot.devices[0].SetProduct(L"Changes every scan " + std::to_wstring(version));
+        history.Add(snapshot);
+    }
+
+    const SnapshotHistoryFootprint footprint = history.GetFootprint();
+    EXPECT_EQ(footprint.snapshots, 10u);
+    EXPECT_EQ(footprint.deviceReferences, 200u);
+    EXPECT_EQ(footprint.uniqueDevices, 19u + 10u);
+    EXPECT_LT(footprint.bytes * 3, footprint.bytesWithoutSharing);
+
+    // Records equal in everything but one field are not shared
+    DeviceSnapshot last = MakeFleet(11, 20);
+    last.devices[5].SetLocationKey(0x42);
+    history.Add(last);
+    EXPECT_EQ(history.GetFootprint().uniqueDevices, 29u + 2u);
+    EXPECT_EQ(history.Get(11)->devices[5].GetLocationKey(), 0x42u);
+}
+
+TEST_F(SnapshotHistoryTest, ByteBudget_EvictsOldestFirst)
+{
+    SnapshotHistory history{ SnapshotHistoryPolicy{ 0, 0 } };
+
+    // Disjoint device sets, so every snapshot adds the same number of bytes
+    history.Add(MakeFleet(1, 50, 1000));
+    const size_t perSnapshot = history.GetFootprint().bytes;
+    history.SetPolicy(SnapshotHistoryPolicy{ perSnapshot * 3, 0 });
+
+    for (uint64_t version = 2; version <= 6; ++version) {
+        history.Add(MakeFleet(version, 50, 1000 * static_cast<unsigned int>(version)));
+        EXPECT_LE(history.GetFootprint().bytes, perSnapshot * 3);
+    }
+
+    const SnapshotHistoryFootprint footprint = history.GetFootprint();
+    EXPECT_EQ(history.GetVersions(), (std::vector<uint64_t>{ 4, 5, 6 }));
+    EXPECT_EQ(footprint.evictedSnapshots, 3u);
+    EXPECT_EQ(footprint.uniqueDevices, 150u);
+    EXPECT_EQ(history.Get(3), nullptr);
+}
+
+TEST_F(SnapshotHistoryTest, Eviction_KeepsRecordsStillReferenced)
+{
+    SnapshotHistory history{ SnapshotHistoryPolicy{ 0, 2 } };
+    history.Add(MakeFleet(1, 4));
+    history.Add(MakeFleet(2, 4, 3));     // shares products 3 and 4
+    history.Add(MakeFleet(3, 4, 5));     // evicts 1, shares nothing with it
+
+    EXPECT_EQ(history.GetVersions(), (std::vector<uint64_t>{ 2, 3 }));
+    EXPECT_EQ(history.GetFootprint().uniqueDevices, 6u);
+    EXPECT_EQ(history.Get(2)->devices, MakeFleet(2, 4, 3).devices);
+
+    // The newest snapshot is kept even when it alone exceeds the budget
+    history.SetPolicy(SnapshotHistoryPolicy{ 1, 0 });
+    EXPECT_EQ(history.GetVersions(), (std::vector<uint64_t>{ 3 }));
+    EXPECT_EQ(history.GetFootprint().uniqueDevices, 4u);
+
+    history.Clear();
+    const SnapshotHistoryFootprint footprint = history.GetFootprint();
+    EXPECT_EQ(footprint.snapshots, 0u);
+    EXPECT_EQ(footprint.bytes, 0u);
+    EXPECT_EQ(footprint.evictedSnapshots, 3u);
+}
+
+TEST_F(SnapshotHistoryTest, Records_DetachedFromScanArena)
+{
+    auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>();
+    DeviceSnapshot snapshot;
+    snapshot.version = 1;
+    snapshot.arena = arena;
+    snapshot.devices.emplace_back(MakeFleetDevice(7), arena.get());
+
+    SnapshotHistory history;
+    history.Add(snapshot);
+    snapshot = {};
+    std::weak_ptr<std::pmr::memory_resource> weakArena = arena;
+    arena.reset();
+
+    EXPECT_TRUE(weakArena.expired());
+    auto restored = history.Get(1);
+    ASSERT_NE(restored, nullptr);
+    EXPECT_EQ(restored->devices[0], MakeFleetDevice(7));
+    EXPECT_EQ(restored->devices[0].get_allocator().resource(), std::pmr::get_default_resource());
+}
+
+TEST_F(SnapshotHistoryTest, ContentHash_CoversEveryField)
+{
+    const DeviceResultantInfo base = MakeFleetDevice(1);
+    DeviceResultantInfo changed = base;
+    EXPECT_EQ(DeviceContentHashOf(changed), DeviceContentHashOf(base));
+
+    changed.SetFriendlyName(L"Friendly");
+    EXPECT_NE(DeviceContentHashOf(changed), DeviceContentHashOf(base));
+    changed = base;
+    changed.SetInterfaceClass(0x03);
+    EXPECT_NE(DeviceContentHashOf(changed), DeviceContentHashOf(base));
+    changed = base;
+    changed.SetSetupClassGuid(GUID{ 1 });
+    EXPECT_NE(DeviceContentHashOf(changed), DeviceContentHashOf(base));
+}
+
+TEST_F(SnapshotHistoryTest, Footprint_ChurningFleet)
+{
+    // 500 devices, 1% replaced per scan, 200 scans retained
+    SnapshotHistory history{ SnapshotHistoryPolicy{ 0, 200 } };
+    DeviceSnapshot snapshot = MakeFleet(1, 500);
+    unsigned int nextIndex = 501;
+    for (uint64_t version = 1; version <= 400; ++version) {
+        snapshot.version = version;
+        for (int i = 0; i < 5; ++i) {
+            snapshot.devices[(version * 5 + i) % snapshot.devices.size()] = MakeFleetDevice(nextIndex++);
+        }
+        history.Add(snapshot);
+    }
+
+    const SnapshotHistoryFootprint footprint = history.GetFootprint();
+    RecordProperty("HistoryBytes", std::to_string(footprint.bytes));
+    RecordProperty("UnsharedBytes", std::to_string(footprint.bytesWithoutSharing));
+    RecordProperty("UniqueRecords", std::to_string(footprint.uniqueDevices));
+
+    EXPECT_EQ(footprint.snapshots, 200u);
+    EXPECT_EQ(footprint.evictedSnapshots, 200u);
+    EXPECT_LE(footprint.uniqueDevices, 500u + 200u * 5u);
+    EXPECT_LT(footprint.bytes * 20, footprint.bytesWithoutSharing);
+}
+
+} // namespace Testing
+} // namespace KDM
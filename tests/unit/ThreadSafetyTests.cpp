@@ -10,6 +10,8 @@
 #include "DevicesManager.h"
 #include "DeviceResultantInfo.h"
 #include "DeviceEnumerator.h"
+#include "DeviceSnapshot.h"
+#include "mocks/MockUsbBackend.h"
 #include <thread>
 #include <vector>
 #include <atomic>
@@ -39,47 +41,43 @@ protected:
 
 /// <summary>
 /// Tests concurrent USB device enumeration from multiple threads.
-/// Each thread creates its own DevicesManager and enumerates devices.
+/// Each thread creates its own DevicesManager over a simulated bus and enumerates devices.
 /// </summary>
-// TEST_F(ThreadSafetyTest, ConcurrentEnumeration_NoThrow)
-// {
-//     constexpr int numThreads = 4;
-//     std::vector<std::thread> threads;
-//     std::atomic<int> successCount{0};
-//     std::atomic<int> exceptionCount{0};
-
-//     for (int i = 0; i < numThreads; ++i)
-//     {
-//         threads.emplace_back([&successCount, &exceptionCount]() {
-//             try
-//             {
-//                 DevicesManager manager;
-//                 manager.EnumerateUsbDevices();
-
-//                 // Verify we got some devices
-//                 const auto& devices = manager.GetDevices();
-//                 if (!devices.empty())
-//                 {
-//                     ++successCount;
-//                 }
-//             }
-//             catch (const std::exception&)
-//             {
-//                 ++exceptionCount;
-//             }
-//         });
-//     }
-
-//     // Wait for all threads to complete
-//     for (auto& t : threads)
-//     {
-//         t.join();
-//     }
-
-//     // All threads should succeed without exceptions
-//     EXPECT_EQ(exceptionCount.load(), 0) << "No exceptions should occur during concurrent enumeration";
-//     EXPECT_GT(successCount.load(), 0) << "At least one thread should successfully enumerate devices";
-// }
+TEST_F(ThreadSafetyTest, ConcurrentEnumeration_NoThrow)
+{
+    constexpr int numThreads = 4;
+    std::vector<std::thread> threads;
+    std::atomic<int> successCount{0};
+    std::atomic<int> exceptionCount{0};
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([&successCount, &exceptionCount]() {
+            try
+            {
+                DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 2, 4)));
+                manager.EnumerateUsbDevices();
+
+                if (manager.GetSnapshot()->devices.size() == 16)
+                {
+                    ++successCount;
+                }
+            }
+            catch (const std::exception&)
+            {
+                ++exceptionCount;
+            }
+        });
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(exceptionCount.load(), 0) << "No exceptions should occur during concurrent enumeration";
+    EXPECT_EQ(successCount.load(), numThreads) << "Every thread should see the whole simulated bus";
+}
 
 /// <summary>
 /// Tests that concurrent DeviceEnumerator operations don't crash.
@@ -133,53 +131,142 @@ TEST_F(ThreadSafetyTest, RapidSequentialEnumeration_NoResourceLeak)
         EXPECT_NO_THROW(manager.EnumerateUsbDevices());
 
         // Verify results are consistent
-        const auto& devices = manager.GetDevices();
+        DeviceSnapshotPtr snapshot = manager.GetDevices();
+        const auto& devices = snapshot->devices;
         // Just verify we don't crash - device count may vary
         (void)devices.size();
     }
 }
 
 /// <summary>
-/// Tests that results from concurrent enumeration are consistent.
-/// All threads should see the same set of connected devices.
+/// Tests that concurrent enumerations on one shared manager are safe: every call
+/// observes a complete snapshot, and overlapping calls share scans instead of
+/// each walking the bus.
+/// </summary>
+TEST_F(ThreadSafetyTest, SharedManager_ConcurrentEnumerations_PublishCompleteSnapshots)
+{
+    constexpr int numThreads = 4;
+    constexpr int scansPerThread = 5;
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 2, 4)));
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> anyFailed{false};
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([&manager, &anyFailed]() {
+            try
+            {
+                for (int scan = 0; scan < scansPerThread; ++scan)
+                {
+                    manager.EnumerateUsbDevices();
+                    if (manager.GetSnapshot()->devices.size() != 16) {
+                        anyFailed = true;
+                    }
+                }
+            }
+            catch (const std::exception&)
+            {
+                anyFailed = true;
+            }
+        });
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_FALSE(anyFailed.load()) << "Every published snapshot should contain the whole bus";
+    EXPECT_GE(manager.GetSnapshot()->version, static_cast<uint64_t>(scansPerThread));
+    EXPECT_LE(manager.GetSnapshot()->version, static_cast<uint64_t>(numThreads * scansPerThread));
+}
+
+/// <summary>
+/// Readers take snapshots while a writer keeps re-enumerating a bus whose topology
+/// changes between scans. Every snapshot must be one of the published topologies
+/// in full, and versions seen by a reader must never go backwards.
+/// </summary>
+TEST_F(ThreadSafetyTest, ReadersDuringRefresh_SeeConsistentSnapshots)
+{
+    constexpr int numReaders = 4;
+    constexpr int refreshes = 40;
+
+    auto backend = std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4));
+    MockUsbBackend* bus = backend.get();
+    DevicesManager manager(std::move(backend));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> tornSnapshots{0};
+    std::atomic<int> versionRegressions{0};
+    std::atomic<uint64_t> snapshotsRead{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < numReaders; ++i)
+    {
+        readers.emplace_back([&]() {
+            uint64_t lastVersion = 0;
+            while (!done.load(std::memory_order_acquire))
+            {
+                DeviceSnapshotPtr snapshot = manager.GetSnapshot();
+                if (snapshot->version < lastVersion) {
+                    ++versionRegressions;
+                }
+                lastVersion = snapshot->version;
+
+                // Simulated product IDs are 1..N, so a complete snapshot ends with N
+                const auto& devices = snapshot->devices;
+                const size_t count = devices.size();
+                if ((count != 0 && count != 3 && count != 8) ||
+                    (count != 0 && devices.back().GetProductId() != count)) {
+                    ++tornSnapshots;
+                }
+                ++snapshotsRead;
+            }
+        });
+    }
+
+    std::thread writer([&]() {
+        for (int i = 0; i < refreshes; ++i)
+        {
+            bus->SetRootHubs(i % 2 == 0 ? MakeSimulatedBus(2, 1, 4) : MakeSimulatedBus(1, 1, 3));
+            manager.EnumerateUsbDevices();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    writer.join();
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(tornSnapshots.load(), 0);
+    EXPECT_EQ(versionRegressions.load(), 0);
+    EXPECT_GT(snapshotsRead.load(), 0u);
+    EXPECT_EQ(manager.GetSnapshot()->version, static_cast<uint64_t>(refreshes));
+    EXPECT_EQ(manager.GetDeviceCount(), 3u);
+}
+
+/// <summary>
+/// A snapshot held by a reader is unaffected by later publications.
 /// </summary>
-// TEST_F(ThreadSafetyTest, ConcurrentEnumeration_ConsistentResults)
-// {
-//     constexpr int numThreads = 3;
-//     std::vector<std::thread> threads;
-//     std::vector<size_t> deviceCounts(numThreads);
-//     std::atomic<bool> anyFailed{false};
-
-//     for (int i = 0; i < numThreads; ++i)
-//     {
-//         threads.emplace_back([i, &deviceCounts, &anyFailed]() {
-//             try
-//             {
-//                 DevicesManager manager;
-//                 manager.EnumerateUsbDevices();
-//                 deviceCounts[i] = manager.GetDevices().size();
-//             }
-//             catch (const std::exception&)
-//             {
-//                 anyFailed = true;
-//             }
-//         });
-//     }
-
-//     for (auto& t : threads)
-//     {
-//         t.join();
-//     }
-
-//     EXPECT_FALSE(anyFailed.load()) << "No thread should fail";
-
-//     // All threads should see the same device count (assuming no hot-plug during test)
-//     for (int i = 1; i < numThreads; ++i)
-//     {
-//         EXPECT_EQ(deviceCounts[0], deviceCounts[i])
-//             << "Thread " << i << " saw different device count than thread 0";
-//     }
-// }
+TEST_F(ThreadSafetyTest, HeldSnapshot_SurvivesRepublication)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)));
+    EXPECT_EQ(manager.GetSnapshot()->version, 0u);
+
+    manager.EnumerateUsbDevices();
+    DeviceSnapshotPtr held = manager.GetSnapshot();
+
+    std::thread clearer([&manager]() { manager.ClearDevices(); });
+    clearer.join();
+
+    EXPECT_EQ(held->devices.size(), 8u);
+    EXPECT_EQ(held->version, 1u);
+    EXPECT_EQ(manager.GetDeviceCount(), 0u);
+    EXPECT_EQ(manager.GetSnapshot()->version, 2u);
+}
 
 /// <summary>
 /// Tests that DevicesManager destruction during enumeration doesn't crash.
@@ -227,7 +314,7 @@ TEST_F(ThreadSafetyTest, MoveSemantics_AcrossThreads)
 
     // Access results in this thread
     EXPECT_NO_THROW({
-        deviceCount = manager->GetDevices().size();
+        deviceCount = manager->GetDevices()->devices.size();
     });
 
     // Cleanup
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usbspec.h>
+#include "TopologyExporter.h"
+#include "EnumerationOptions.h"
+#include "Exceptions.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for TopologyExporter: DOT statements, JSON adjacency lists, chunked
+/// output and export time of a large synthetic topology.
+/// </summary>
+class TopologyExporterTest : public ::testing::Test
+{
+protected:
+    JsonSink Collect()
+    {
+        return [this](const char* data, size_t size) {
+            output_.append(data, size);
+            ++chunks_;
+        };
+    }
+
+    static UsbTopologyNode MakeNode(UsbTopologyNodeKind kind, uint32_t parent, uint32_t portNumber = 0)
+    {
+        UsbTopologyNode node;
+        node.kind = kind;
+        node.parent = parent;
+        node.portNumber = portNumber;
+        return node;
+    }
+
+    static UsbTopologyNode MakeAttached(UsbTopologyNodeKind kind, uint32_t port, uint32_t portNumber, uint16_t productId)
+    {
+        UsbTopologyNode node = MakeNode(kind, port, portNumber);
+        node.vendorId = 0x1234;
+        node.productId = productId;
+        node.deviceClass = kind == UsbTopologyNodeKind::Hub ? 0x09 : 0x03;
+        node.speed = UsbHighSpeed;
+        node.openPipes = 2;
+        node.deviceAddress = 5;
+        node.correlation = static_cast<uint8_t>(CorrelationRule::VidPid);
+        return node;
+    }
+
+    // controller(0) -> root hub(1) -> port 1(2) -> device(3)
+    //                              -> port 2(4)
+    static DeviceSnapshot MakeSnapshot()
+    {
+        DeviceSnapshot snapshot;
+        auto& topology = snapshot.topology;
+        const auto controller = topology.Add(MakeNode(UsbTopologyNodeKind::Controller, UsbTopology::NoNode));
+        UsbTopologyNode rootHub = MakeNode(UsbTopologyNodeKind::Hub, controller);
+        rootHub.path = L"\\\\.\\ROOT";
+        const auto hub = topology.Add(std::move(rootHub));
+        const auto port = topology.Add(MakeNode(UsbTopologyNodeKind::Port, hub, 1));
+        const auto device = topology.Add(MakeAttached(UsbTopologyNodeKind::Device, port, 1, 0x10));
+        topology.Add(MakeNode(UsbTopologyNodeKind::Port, hub, 2));
+
+        DeviceResultantInfo info;
+        info.SetProduct(L"Keyboard \"K1\"");
+        snapshot.devices.push_back(info);
+        topology.SetDeviceIndex(device, 0);
+        return snapshot;
+    }
+
+    // rootHubs controllers, each with a root hub of width ports carrying hubs of width ports with devices
+    static UsbTopology MakeLargeTopology(uint32_t rootHubs, uint32_t width)
+    {
+        UsbTopology topology;
+        uint16_t productId = 0;
+        for (uint32_t r = 0; r < rootHubs; ++r)
+        {
+            const auto controller = topology.Add(MakeNode(UsbTopologyNodeKind::Controller, UsbTopology::NoNode));
+            const auto root = topology.Add(MakeNode(UsbTopologyNodeKind::Hub, controller));
+            for (uint32_t p = 1; p <= width; ++p)
+            {
+                const auto rootPort = topology.Add(MakeNode(UsbTopologyNodeKind::Port, root, p));
+                const auto hub = topology.Add(MakeAttached(UsbTopologyNodeKind::Hub, rootPort, p, productId++));
+                for (uint32_t q = 1; q <= width; ++q)
+                {
+                    const auto port = topology.Add(MakeNode(UsbTopologyNodeKind::Port, hub, q));
+                    topology.Add(MakeAttached(UsbTopologyNodeKind::Device, port, q, productId++));
+                }
+            }
+        }
+        return topology;
+    }
+
+    std::string output_;
+    int chunks_ = 0;
+};
+
+TEST_F(TopologyExporterTest, Dot_WritesNodesAndEdges)
+{
+    TopologyExporter exporter(Collect(), TopologyFormat::Dot);
+    exporter.Write(MakeSnapshot());
+    exporter.Flush();
+
+    EXPECT_EQ(output_.rfind("digraph usb {\n", 0), 0u);
+    EXPECT_NE(output_.find("  n0 [shape=doubleoctagon,label=\"Controller 1\"];\n"), std::string::npos) << output_;
+    EXPECT_NE(output_.find("  n1 [shape=box3d,label=\"Root hub\\n1/2 ports in use\"];\n  n0 -> n1;\n"), std::string::npos) << output_;
+    EXPECT_NE(output_.find("  n3 [shape=box,label=\"Keyboard \\\"K1\\\"\\n1234:0010 class 0x03\\n1-1, high speed, 2 pipes\"];\n"
+        "  n2 -> n3;\n"), std::string::npos) << output_;
+    EXPECT_NE(output_.find("  n4 [shape=circle,style=dashed,label=\"2\"];\n"), std::string::npos) << output_;
+    EXPECT_EQ(output_.substr(output_.size() - 2), "}\n");
+}
+
+TEST_F(TopologyExporterTest, Json_WritesAdjacencyList)
+{
+    TopologyExporter exporter(Collect(), TopologyFormat::Json);
+    exporter.Write(MakeSnapshot());
+    exporter.Flush();
+
+    EXPECT_EQ(output_,
+        "{\"nodes\":["
+        "{\"id\":0,\"kind\":\"controller\",\"parent\":null,\"children\":[1],\"location\":\"1\",\"hubDepth\":0},"
+        "{\"id\":1,\"kind\":\"hub\",\"parent\":0,\"children\":[2,4],\"location\":\"1\",\"hubDepth\":1,"
+        "\"portsTotal\":2,\"portsInUse\":1,\"path\":\"\\\\\\\\.\\\\ROOT\"},"
+        "{\"id\":2,\"kind\":\"port\",\"parent\":1,\"children\":[3],\"location\":\"1-1\",\"hubDepth\":1,\"port\":1},"
+        "{\"id\":3,\"kind\":\"device\",\"parent\":2,\"children\":[],\"location\":\"1-1\",\"hubDepth\":1,\"port\":1,"
+        "\"vendorId\":4660,\"productId\":16,\"deviceClass\":3,\"speed\":\"high\",\"openPipes\":2,\"address\":5,"
+        "\"match\":\"vidPid\","
+        "\"deviceIndex\":0,\"product\":\"Keyboard \\\"K1\\\"\"},"
+        "{\"id\":4,\"kind\":\"port\",\"parent\":1,\"children\":[],\"location\":\"1-2\",\"hubDepth\":1,\"port\":2}"
+        "]}");
+    EXPECT_EQ(exporter.GetBytesWritten(), output_.size());
+}
+
+TEST_F(TopologyExporterTest, SmallBuffer_ProducesSameOutputInChunks)
+{
+    const UsbTopology topology = MakeLargeTopology(2, 4);
+
+    for (auto format : { TopologyFormat::Dot, TopologyFormat::Json })
+    {
+        std::string large;
+        TopologyExporter reference([&](const char* data, size_t size) { large.append(data, size); }, format);
+        reference.Write(topology);
+        reference.Flush();
+
+        output_.clear();
+        chunks_ = 0;
+        TopologyExporter exporter(Collect(), format, 64);
+        exporter.Write(topology);
+        exporter.Flush();
+
+        EXPECT_EQ(output_, large);
+        EXPECT_GT(chunks_, 10);
+    }
+}
+
+TEST_F(TopologyExporterTest, InvalidArguments_Throw)
+{
+    EXPECT_THROW(TopologyExporter(JsonSink{}, TopologyFormat::Dot), InvalidDeviceArgumentException);
+    EXPECT_THROW(TopologyExporter(Collect(), TopologyFormat::Json, 16), InvalidDeviceArgumentException);
+}
+
+TEST_F(TopologyExporterTest, LargeTopology_Exports)
+{
+    // 4 controllers x (root hub + 35 x (port + hub + 35 x (port + device))) = 10,088 nodes
+    const UsbTopology topology = MakeLargeTopology(4, 35);
+    ASSERT_GT(topology.size(), 10000u);
+
+    for (auto format : { TopologyFormat::Dot, TopologyFormat::Json })
+    {
+        uint64_t bytes = 0;
+        TopologyExporter exporter([&](const char*, size_t size) { bytes += size; }, format);
+
+        const auto start = std::chrono::steady_clock::now();
+        exporter.Write(topology);
+        exporter.Flush();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const char* name = format == TopologyFormat::Dot ? "Dot" : "Json";
+        RecordProperty(std::string(name) + "Bytes", std::to_string(bytes));
+        RecordProperty(std::string(name) + "Ms", std::to_string(static_cast<int>(seconds * 1000)));
+
+        EXPECT_EQ(bytes, exporter.GetBytesWritten());
+    }
+    // The one-second limit is checked by WinDevicesBenchmarks (BUILD_BENCHMARKS)
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include "UsbLocation.h"
+#include "DeviceChange.h"
+#include "DeviceResultantInfo.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for UsbLocation keys: packing, text form, ordering and their use in
+/// device identity.
+/// </summary>
+class UsbLocationTest : public ::testing::Test
+{
+protected:
+    static uint64_t MakeLocation(uint32_t controller, std::initializer_list<uint32_t> ports)
+    {
+        uint64_t location = UsbLocation::ForController(controller);
+        for (uint32_t port : ports) {
+            location = UsbLocation::AppendPort(location, port);
+        }
+        return location;
+    }
+};
+
+TEST_F(UsbLocationTest, Format_WritesControllerAndPortChain)
+{
+    EXPECT_EQ(UsbLocation::Format(MakeLocation(2, { 1, 4, 3 })), L"2-1.4.3");
+    EXPECT_EQ(UsbLocation::Format(MakeLocation(1, { 12 })), L"1-12");
+    EXPECT_EQ(UsbLocation::Format(MakeLocation(3, {})), L"3");
+    EXPECT_EQ(UsbLocation::Format(UsbLocation::Unknown), L"");
+}
+
+TEST_F(UsbLocationTest, Parse_RoundTripsAndRejectsMalformedText)
+{
+    for (const wchar_t* text : { L"2-1.4.3", L"1-12", L"3", L"255-255.1.2.3.4.5.6" }) {
+        EXPECT_EQ(UsbLocation::Format(UsbLocation::Parse(text)), text);
+    }
+
+    for (const wchar_t* text : { L"", L"0", L"256", L"2-", L"2-0", L"2-1..3", L"2.1", L"2-1-3", L"2-300", L"x", L"1-1.1.1.1.1.1.1.1" }) {
+        EXPECT_EQ(UsbLocation::Parse(text), UsbLocation::Unknown) << text;
+    }
+}
+
+TEST_F(UsbLocationTest, AppendPort_RejectsOutOfRangeAndFullChains)
+{
+    const uint64_t full = MakeLocation(1, { 1, 2, 3, 4, 5, 6, 7 });
+    EXPECT_EQ(UsbLocation::ChainLength(full), 7u);
+    EXPECT_EQ(UsbLocation::AppendPort(full, 1), UsbLocation::Unknown);
+
+    EXPECT_EQ(UsbLocation::AppendPort(MakeLocation(1, {}), 0), UsbLocation::Unknown);
+    EXPECT_EQ(UsbLocation::AppendPort(MakeLocation(1, {}), 256), UsbLocation::Unknown);
+    EXPECT_EQ(UsbLocation::AppendPort(UsbLocation::Unknown, 1), UsbLocation::Unknown);
+    EXPECT_EQ(UsbLocation::ForController(0), UsbLocation::Unknown);
+}
+
+TEST_F(UsbLocationTest, Keys_SortLikePortChains)
+{
+    std::vector<uint64_t> keys = {
+        MakeLocation(2, {}), MakeLocation(1, { 2 }), MakeLocation(1, { 1, 3 }),
+        MakeLocation(1, { 1 }), MakeLocation(1, {}), MakeLocation(1, { 1, 2 }),
+    };
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<std::wstring> texts;
+    for (uint64_t key : keys) {
+        texts.push_back(UsbLocation::Format(key));
+    }
+    EXPECT_EQ(texts, (std::vector<std::wstring>{ L"1", L"1-1", L"1-1.2", L"1-1.3", L"1-2", L"2" }));
+}
+
+TEST_F(UsbLocationTest, DeviceKey_DistinguishesIdenticalDevicesOnDifferentPorts)
+{
+    DeviceResultantInfo first;
+    first.SetVendorId(0x1234);
+    first.SetProductId(0x5678);
+    first.SetLocationKey(MakeLocation(1, { 1 }));
+
+    DeviceResultantInfo second = first;
+    second.SetLocationKey(MakeLocation(1, { 2 }));
+
+    EXPECT_NE(DeviceKeyOf(first), DeviceKeyOf(second));
+    EXPECT_FALSE(first == second);
+
+    // Moving a device to another port reads as removal plus arrival
+    DeviceSnapshot before;
+    before.devices = { first };
+    DeviceSnapshot after;
+    after.version = 1;
+    after.devices = { second };
+    const auto changes = DiffSnapshots(before, after);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].type, DeviceChangeType::Removed);
+    EXPECT_EQ(changes[1].type, DeviceChangeType::Arrived);
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "UsbTopology.h"
+#include "UsbLocation.h"
+#include "DevicesManager.h"
+#include "Exceptions.h"
+#include "mocks/MockUsbBackend.h"
+#include <memory>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Tests for UsbTopology: pre-order construction, O(1) navigation, subtree
+/// ranges, and the topology captured by a scan of a simulated bus.
+/// </summary>
+class UsbTopologyTest : public ::testing::Test
+{
+protected:
+    static UsbTopologyNode MakeNode(UsbTopologyNodeKind kind, uint32_t parent, uint32_t portNumber = 0)
+    {
+        UsbTopologyNode node;
+        node.kind = kind;
+        node.parent = parent;
+        node.portNumber = portNumber;
+        return node;
+    }
+
+    // controller(0) -> root hub(1) -> port 1(2) -> hub(3) -> port 1(4) -> device(5)
+    //                                                    -> port 2(6)
+    //                              -> port 2(7) -> device(8)
+    static UsbTopology MakeTopology()
+    {
+        UsbTopology topology;
+        const auto controller = topology.Add(MakeNode(UsbTopologyNodeKind::Controller, UsbTopology::NoNode));
+        const auto rootHub = topology.Add(MakeNode(UsbTopologyNodeKind::Hub, controller));
+        const auto rootPort1 = topology.Add(MakeNode(UsbTopologyNodeKind::Port, rootHub, 1));
+        const auto hub = topology.Add(MakeNode(UsbTopologyNodeKind::Hub, rootPort1, 1));
+        const auto hubPort1 = topology.Add(MakeNode(UsbTopologyNodeKind::Port, hub, 1));
+        topology.Add(MakeNode(UsbTopologyNodeKind::Device, hubPort1, 1));
+        topology.Add(MakeNode(UsbTopologyNodeKind::Port, hub, 2));
+        const auto rootPort2 = topology.Add(MakeNode(UsbTopologyNodeKind::Port, rootHub, 2));
+        topology.Add(MakeNode(UsbTopologyNodeKind::Device, rootPort2, 2));
+        return topology;
+    }
+
+    static std::vector<uint32_t> Children(const UsbTopology& topology, uint32_t node)
+    {
+        std::vector<uint32_t> children;
+        for (auto child = topology.GetFirstChild(node); child != UsbTopology::NoNode; child = topology.GetNextSibling(child)) {
+            children.push_back(child);
+        }
+        return children;
+    }
+};
+
+TEST_F(UsbTopologyTest, Navigation_FollowsParentChildAndSiblingLinks)
+{
+    const UsbTopology topology = MakeTopology();
+    ASSERT_EQ(topology.size(), 9u);
+
+    EXPECT_EQ(topology.GetParent(0), UsbTopology::NoNode);
+    EXPECT_EQ(topology.GetParent(5), 4u);
+    EXPECT_EQ(topology.GetParent(7), 1u);
+
+    EXPECT_EQ(Children(topology, 1), (std::vector<uint32_t>{ 2, 7 }));
+    EXPECT_EQ(Children(topology, 3), (std::vector<uint32_t>{ 4, 6 }));
+    EXPECT_TRUE(Children(topology, 5).empty());
+    EXPECT_EQ(topology.GetNextSibling(0), UsbTopology::NoNode);
+}
+
+TEST_F(UsbTopologyTest, Subtree_IsContiguousPreOrderRange)
+{
+    const UsbTopology topology = MakeTopology();
+
+    const auto subtree = topology.GetSubtree(3);
+    ASSERT_EQ(subtree.size(), 4u);
+    EXPECT_EQ(topology.IndexOf(*subtree.begin()), 3u);
+    EXPECT_EQ(subtree.begin()[2].kind, UsbTopologyNodeKind::Device);
+
+    EXPECT_EQ(topology.GetSubtree(0).size(), topology.size());
+    EXPECT_EQ(topology.GetSubtree(8).size(), 1u);
+}
+
+TEST_F(UsbTopologyTest, HubDepth_CountsHubsFromController)
+{
+    const UsbTopology topology = MakeTopology();
+
+    EXPECT_EQ(topology[0].hubDepth, 0u);
+    EXPECT_EQ(topology[1].hubDepth, 1u);
+    EXPECT_EQ(topology[2].hubDepth, 1u);
+    EXPECT_EQ(topology[3].hubDepth, 2u);
+    EXPECT_EQ(topology[5].hubDepth, 2u);
+    EXPECT_EQ(topology[8].hubDepth, 1u);
+}
+
+TEST_F(UsbTopologyTest, Location_FollowsPortChain)
+{
+    const UsbTopology topology = MakeTopology();
+
+    EXPECT_EQ(UsbLocation::Format(topology[1].locationKey), L"1");
+    EXPECT_EQ(UsbLocation::Format(topology[4].locationKey), L"1-1.1");
+    EXPECT_EQ(topology[5].locationKey, topology[4].locationKey);
+    EXPECT_EQ(UsbLocation::Format(topology[8].locationKey), L"1-2");
+
+    EXPECT_EQ(topology.FindByLocation(UsbLocation::Parse(L"1-1.1")), 5u);
+    EXPECT_EQ(topology.FindByLocation(UsbLocation::Parse(L"1-1")), 3u);
+    EXPECT_EQ(topology.FindByLocation(UsbLocation::Parse(L"1")), 1u);
+    EXPECT_EQ(topology.FindByLocation(UsbLocation::Parse(L"1-1.2")), UsbTopology::NoNode);
+}
+
+TEST_F(UsbTopologyTest, Add_RejectsParentWithClosedSubtree)
+{
+    UsbTopology topology = MakeTopology();
+
+    // The external hub's subtree ended when root port 2 was added
+    EXPECT_THROW(topology.Add(MakeNode(UsbTopologyNodeKind::Port, 3, 3)), InvalidDeviceArgumentException);
+    EXPECT_THROW(topology.Add(MakeNode(UsbTopologyNodeKind::Port, 42, 3)), InvalidDeviceArgumentException);
+
+    // A new root is always allowed
+    EXPECT_EQ(topology.Add(MakeNode(UsbTopologyNodeKind::Controller, UsbTopology::NoNode)), 9u);
+    EXPECT_EQ(topology.GetNextSibling(0), 9u);
+}
+
+TEST_F(UsbTopologyTest, DeviceIndex_MapsBothWays)
+{
+    UsbTopology topology = MakeTopology();
+    topology.SetDeviceIndex(5, 1);
+    topology.SetDeviceIndex(8, 0);
+
+    EXPECT_EQ(topology[5].deviceIndex, 1u);
+    EXPECT_EQ(topology.GetDeviceNode(0), 8u);
+    EXPECT_EQ(topology.GetDeviceNode(1), 5u);
+    EXPECT_EQ(topology.GetDeviceNode(2), UsbTopology::NoNode);
+    EXPECT_THROW(topology.SetDeviceIndex(100, 0), InvalidDeviceArgumentException);
+}
+
+TEST_F(UsbTopologyTest, Scan_CapturesSimulatedBus)
+{
+    DevicesManager manager(std::make_unique<MockUsbBackend>(MakeSimulatedBus(2, 1, 4)));
+    manager.EnumerateUsbDevices();
+
+    const auto snapshot = manager.GetSnapshot();
+    const UsbTopology& topology = snapshot->topology;
+
+    // Per root: controller, root hub, 1 port, hub, 4 ports, 4 devices
+    ASSERT_EQ(topology.size(), 2u * 12u);
+    EXPECT_EQ(Children(topology, 0).size(), 1u);
+    EXPECT_EQ(topology.GetNextSibling(0), 12u);
+
+    const UsbTopologyNode& externalHub = topology[3];
+    EXPECT_EQ(externalHub.kind, UsbTopologyNodeKind::Hub);
+    EXPECT_EQ(externalHub.hubDepth, 2u);
+    EXPECT_EQ(externalHub.vendorId, 0x05E3);
+    EXPECT_FALSE(externalHub.path.empty());
+
+    // Every published device points at the node of the port it was found on, and back
+    ASSERT_EQ(snapshot->devices.size(), 8u);
+    for (size_t i = 0; i < snapshot->devices.size(); ++i)
+    {
+        const uint32_t node = topology.GetDeviceNode(i);
+        ASSERT_NE(node, UsbTopology::NoNode);
+        EXPECT_EQ(topology[node].kind, UsbTopologyNodeKind::Device);
+        EXPECT_EQ(topology[node].deviceIndex, i);
+        EXPECT_EQ(topology[node].productId, snapshot->devices[i].GetProductId());
+        EXPECT_EQ(topology[topology.GetParent(node)].kind, UsbTopologyNodeKind::Port);
+        EXPECT_EQ(snapshot->devices[i].GetLocationKey(), topology[node].locationKey);
+    }
+
+    // Second controller, external hub on root port 1, fourth device
+    EXPECT_EQ(UsbLocation::Format(snapshot->devices[7].GetLocationKey()), L"2-1.4");
+}
+
+} // namespace Testing
+} // namespace KDM
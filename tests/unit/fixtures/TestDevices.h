@@ -0,0 +1,73 @@
+#pragma once
+
+#include "DeviceResultantInfo.h"
+#include "DeviceSnapshot.h"
+#include "UsbLocation.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+// Device and snapshot factories shared by the inventory, journal, export and
+// persistence tests. MakeDevice fills in only what identifies a device;
+// MakeFleetDevice fills in what a real scan would, for tests that measure
+// sizes or round-trip every field.
+
+/// @brief USB device 0x1234:productId with serial "SN<productId>" and the given product name.
+inline DeviceResultantInfo MakeDevice(uint16_t productId, const std::wstring& product = L"Device")
+{
+    DeviceResultantInfo device;
+    device.SetVendorId(0x1234);
+    device.SetProductId(productId);
+    device.SetSerialNumber(L"SN" + std::to_wstring(productId));
+    device.SetProduct(product);
+    device.SetIsUsbDevice(true);
+    return device;
+}
+
+/// @brief Connected HID device number index, with manufacturer, interface path and hub port set.
+///
+/// Serial number and path carry the full index, so devices stay distinct in fleets of more
+/// than 65535; the product ID is the index modulo 65536. Product names repeat every 16
+/// devices, as the models of a real fleet do.
+inline DeviceResultantInfo MakeFleetDevice(uint32_t index)
+{
+    DeviceResultantInfo device = MakeDevice(static_cast<uint16_t>(index), L"Device " + std::to_wstring(index % 16));
+    device.SetSerialNumber(L"SN" + std::to_wstring(index));
+    device.SetManufacturer(L"Contoso Peripherals");
+    device.SetDevicePath(L"\\\\?\\usb#vid_1234&pid_" + std::to_wstring(index) +
+        L"#{a5dcbf10-6530-11d2-901f-00c04fb951ed}");
+    device.SetDeviceClass(0x03);
+    device.SetIsConnected(true);
+    device.SetLocationKey(UsbLocation::AppendPort(UsbLocation::ForController(1), index % 255 + 1));
+    return device;
+}
+
+inline DeviceSnapshot MakeSnapshot(uint64_t version, std::vector<DeviceResultantInfo> devices)
+{
+    DeviceSnapshot snapshot;
+    snapshot.version = version;
+    snapshot.devices = std::move(devices);
+    return snapshot;
+}
+
+/// @brief Snapshot of count fleet devices with consecutive indices from firstIndex.
+inline DeviceSnapshot MakeFleet(uint64_t version, size_t count, uint32_t firstIndex = 1)
+{
+    DeviceSnapshot snapshot;
+    snapshot.version = version;
+    snapshot.devices.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        snapshot.devices.push_back(MakeFleetDevice(firstIndex + static_cast<uint32_t>(i)));
+    }
+    return snapshot;
+}
+
+} // namespace Testing
+} // namespace KDM
@@ -0,0 +1,419 @@
+#pragma once
+
+#include <Windows.h>
+#include <usb.h>
+#include <usbioctl.h>
+#include "IUsbBackend.h"
+#include "IDeviceCommunication.h"
+#include "DevInfoData.h"
+#include "HubNodeInfo.h"
+#include "HubNodeInfoEx.h"
+#include "HubNodeCapabilitiesEx.h"
+#include "HubPortInfo.h"
+#include "HubConnectionInfo.h"
+#include "usbdesc.h"
+#include <cstring>
+#include <cwchar>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace KDM
+{
+namespace Testing
+{
+
+/// <summary>
+/// Description of a simulated USB device. A device with isHub set exposes its
+/// children on ports 1..children.size().
+/// </summary>
+struct SimulatedDevice
+{
+    USHORT vendorId = 0;
+    USHORT productId = 0;
+    UCHAR deviceClass = 0;
+    UCHAR interfaceClass = 0;
+    std::wstring manufacturer;
+    std::wstring product;
+    std::wstring serialNumber;
+    bool isHub = false;
+    std::vector<SimulatedDevice> children;
+
+    static SimulatedDevice Hub(std::vector<SimulatedDevice> ports)
+    {
+        SimulatedDevice hub;
+        hub.vendorId = 0x05E3;
+        hub.productId = 0x0610;
+        hub.deviceClass = 0x09;
+        hub.interfaceClass = 0x09;
+        hub.isHub = true;
+        hub.children = std::move(ports);
+        return hub;
+    }
+
+    static SimulatedDevice Device(USHORT vid, USHORT pid, UCHAR interfaceClass,
+        std::wstring manufacturer, std::wstring product, std::wstring serialNumber = L"")
+    {
+        SimulatedDevice device;
+        device.vendorId = vid;
+        device.productId = pid;
+        device.interfaceClass = interfaceClass;
+        device.manufacturer = std::move(manufacturer);
+        device.product = std::move(product);
+        device.serialNumber = std::move(serialNumber);
+        return device;
+    }
+};
+
+/// <summary>
+/// Simulated bus: root hubs plus the driver key / hub path assigned to every node.
+/// Immutable once built so hub communications can share it across threads.
+/// </summary>
+class SimulatedBus
+{
+public:
+    explicit SimulatedBus(std::vector<SimulatedDevice> rootHubs)
+        : rootHubs_(std::move(rootHubs))
+    {
+        for (size_t i = 0; i < rootHubs_.size(); ++i)
+        {
+            rootHubPaths_.push_back(L"\\\\.\\USB#ROOT_HUB30#SIM" + std::to_wstring(i));
+            Register(rootHubs_[i], rootHubPaths_.back());
+        }
+    }
+
+    // Non-copyable, non-movable: the lookup maps point into rootHubs_
+    SimulatedBus(const SimulatedBus&) = delete;
+    SimulatedBus& operator=(const SimulatedBus&) = delete;
+
+    [[nodiscard]] const std::vector<SimulatedDevice>& RootHubs() const noexcept { return rootHubs_; }
+    [[nodiscard]] const std::vector<std::wstring>& RootHubPaths() const noexcept { return rootHubPaths_; }
+    [[nodiscard]] const std::vector<DevInfoData>& DeviceNodes() const noexcept { return deviceNodes_; }
+    [[nodiscard]] size_t DeviceCount() const noexcept { return deviceNodes_.size(); }
+
+    [[nodiscard]] const SimulatedDevice* FindHub(const std::wstring& hubPath) const
+    {
+        auto it = hubsByPath_.find(hubPath);
+        return it != hubsByPath_.end() ? it->second : nullptr;
+    }
+
+    [[nodiscard]] std::wstring DriverKeyOf(const SimulatedDevice& device) const
+    {
+        auto it = driverKeys_.find(&device);
+        return it != driverKeys_.end() ? it->second : std::wstring{};
+    }
+
+    [[nodiscard]] std::wstring HubPathOfDriverKey(const std::wstring& driverKey) const
+    {
+        auto it = hubPathsByDriverKey_.find(driverKey);
+        return it != hubPathsByDriverKey_.end() ? it->second : std::wstring{};
+    }
+
+private:
+    void Register(const SimulatedDevice& hub, std::wstring hubPath)
+    {
+        hubsByPath_.emplace(std::move(hubPath), &hub);
+
+        for (const auto& child : hub.children)
+        {
+            wchar_t driverKey[64]{};
+            swprintf(driverKey, 64, L"{36fc9e60-c465-11cf-8056-444553540000}\\%04u",
+                static_cast<unsigned>(deviceNodes_.size()));
+            driverKeys_.emplace(&child, driverKey);
+
+            wchar_t hardwareId[64]{};
+            swprintf(hardwareId, 64, L"USB\\VID_%04X&PID_%04X&REV_0100", child.vendorId, child.productId);
+
+            SP_DEVINFO_DATA devInfoData{};
+            devInfoData.cbSize = sizeof(SP_DEVINFO_DATA);
+            devInfoData.DevInst = static_cast<DWORD>(deviceNodes_.size() + 1);
+
+            DevInfoData node(nullptr, devInfoData);
+            node.SetHardwareId(hardwareId);
+            node.SetDriverKeyName(driverKey);
+            node.SetDeviceDescription(child.product);
+            deviceNodes_.push_back(std::move(node));
+
+            if (child.isHub)
+            {
+                std::wstring childPath = L"\\\\?\\USB#SIM_HUB#" + std::to_wstring(hubsByPath_.size());
+                hubPathsByDriverKey_.emplace(driverKey, childPath);
+                Register(child, childPath);
+            }
+        }
+    }
+
+    std::vector<SimulatedDevice> rootHubs_;
+    std::vector<std::wstring> rootHubPaths_;
+    std::vector<DevInfoData> deviceNodes_;
+    std::map<std::wstring, const SimulatedDevice*> hubsByPath_;
+    std::map<const SimulatedDevice*, std::wstring> driverKeys_;
+    std::map<std::wstring, std::wstring> hubPathsByDriverKey_;
+};
+
+/// <summary>
+/// IDeviceCommunication that answers hub IOCTLs from a SimulatedBus hub.
+/// Descriptor buffers are allocated with new BYTE[] like DeviceCommunication does.
+/// </summary>
+class SimulatedHubCommunication : public IDeviceCommunication
+{
+public:
+    SimulatedHubCommunication(std::shared_ptr<const SimulatedBus> bus, const SimulatedDevice& hub)
+        : bus_(std::move(bus)), hub_(hub)
+    {
+    }
+
+    void GetUsbHubNodeInformation(HubNodeInfo& nodeInfo) override
+    {
+        nodeInfo.type = L"UsbHub";
+        nodeInfo.numbersOfPorts = static_cast<UCHAR>(hub_.children.size());
+    }
+
+    void GetUsbHubNodeInformationEx(HubNodeInfoEx& nodeInfo) override
+    {
+        nodeInfo._highestPortNumber = static_cast<USHORT>(hub_.children.size());
+        nodeInfo._isHubInfoExSupport = true;
+    }
+
+    void GetUsbHubNodeCapabilitiesEx(HubNodeCapabilitiesEx& /*nodeInfo*/) override
+    {
+    }
+
+    void GetUsbExternalHubName(DWORD /*index*/, std::wstring& hubName) override
+    {
+        hubName.clear();
+    }
+
+    void EnumeratePorts(ULONG numberOfPorts, std::map<size_t, HubPortInfo>& portConnectorPropsList) override
+    {
+        portConnectorPropsList.clear();
+        for (ULONG i = 1; i <= numberOfPorts; ++i)
+        {
+            HubPortInfo portInfo;
+            portInfo._connectionIndex = i;
+            portInfo._isFilled = true;
+            portConnectorPropsList.try_emplace(i, std::move(portInfo));
+        }
+    }
+
+    void EnumeratePortsConnectionInfo(ULONG numberOfPorts, std::map<size_t, HubConnectionInfo>& hubConnectionInfoList) override
+    {
+        hubConnectionInfoList.clear();
+        for (ULONG i = 1; i <= numberOfPorts; ++i)
+        {
+            HubConnectionInfo connInfo;
+            connInfo._connectionIndex = i;
+
+            if (const SimulatedDevice* device = DeviceAt(i))
+            {
+                auto& descriptor = connInfo._deviceDescriptor;
+                descriptor.bLength = sizeof(USB_DEVICE_DESCRIPTOR);
+                descriptor.bDescriptorType = USB_DEVICE_DESCRIPTOR_TYPE;
+                descriptor.idVendor = device->vendorId;
+                descriptor.idProduct = device->productId;
+                descriptor.bDeviceClass = device->deviceClass;
+                descriptor.bNumConfigurations = 1;
+                descriptor.iManufacturer = device->manufacturer.empty() ? 0 : 1;
+                descriptor.iProduct = device->product.empty() ? 0 : 2;
+                descriptor.iSerialNumber = device->serialNumber.empty() ? 0 : 3;
+
+                connInfo._connectionStatus = DeviceConnected;
+                connInfo._deviceIsHub = device->isHub ? TRUE : FALSE;
+                connInfo._deviceAddress = static_cast<USHORT>(i);
+                connInfo._driverKeyName = bus_->DriverKeyOf(*device);
+            }
+            else
+            {
+                connInfo._connectionStatus = NoDeviceConnected;
+            }
+
+            hubConnectionInfoList.try_emplace(i, std::move(connInfo));
+        }
+    }
+
+    [[nodiscard]] std::wstring GetDriverKeyName(ULONG connectionIndex) override
+    {
+        const SimulatedDevice* device = DeviceAt(connectionIndex);
+        return device ? bus_->DriverKeyOf(*device) : std::wstring{};
+    }
+
+    [[nodiscard]] PUSB_DESCRIPTOR_REQUEST GetConfigDescriptor(ULONG connectionIndex, UCHAR /*descriptorIndex*/) override
+    {
+        const SimulatedDevice* device = DeviceAt(connectionIndex);
+        if (!device) {
+            return nullptr;
+        }
+
+        // USB_DESCRIPTOR_REQUEST header followed by configuration + interface descriptors
+        constexpr size_t descriptorsLength = sizeof(USB_CONFIGURATION_DESCRIPTOR) + sizeof(USB_INTERFACE_DESCRIPTOR);
+        auto* buffer = new BYTE[sizeof(USB_DESCRIPTOR_REQUEST) + descriptorsLength]{};
+        auto* request = reinterpret_cast<PUSB_DESCRIPTOR_REQUEST>(buffer);
+        request->ConnectionIndex = connectionIndex;
+
+        auto* config = reinterpret_cast<PUSB_CONFIGURATION_DESCRIPTOR>(request + 1);
+        config->bLength = sizeof(USB_CONFIGURATION_DESCRIPTOR);
+        config->bDescriptorType = USB_CONFIGURATION_DESCRIPTOR_TYPE;
+        config->wTotalLength = static_cast<USHORT>(descriptorsLength);
+        config->bNumInterfaces = 1;
+        config->bConfigurationValue = 1;
+
+        auto* iface = reinterpret_cast<PUSB_INTERFACE_DESCRIPTOR>(config + 1);
+        iface->bLength = sizeof(USB_INTERFACE_DESCRIPTOR);
+        iface->bDescriptorType = USB_INTERFACE_DESCRIPTOR_TYPE;
+        iface->bInterfaceClass = device->interfaceClass;
+
+        return request;
+    }
+
+    [[nodiscard]] PSTRING_DESCRIPTOR_NODE GetStringDescriptor(ULONG connectionIndex, UCHAR descriptorIndex, USHORT /*languageId*/) override
+    {
+        const SimulatedDevice* device = DeviceAt(connectionIndex);
+        if (!device) {
+            return nullptr;
+        }
+
+        if (descriptorIndex == 0)
+        {
+            const WCHAR languages[] = { 0x0409 };
+            return MakeStringNode(descriptorIndex, languages, 1);
+        }
+
+        const std::wstring* text = nullptr;
+        switch (descriptorIndex)
+        {
+        case 1: text = &device->manufacturer; break;
+        case 2: text = &device->product; break;
+        case 3: text = &device->serialNumber; break;
+        default: return nullptr;
+        }
+
+        return MakeStringNode(descriptorIndex, text->c_str(), text->size());
+    }
+
+    [[nodiscard]] HANDLE GetFileHandle() override
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+
+private:
+    [[nodiscard]] const SimulatedDevice* DeviceAt(ULONG connectionIndex) const noexcept
+    {
+        if (connectionIndex == 0 || connectionIndex > hub_.children.size()) {
+            return nullptr;
+        }
+        return &hub_.children[connectionIndex - 1];
+    }
+
+    // Allocates a zero-terminated string descriptor node (callers read bString as a C string)
+    static PSTRING_DESCRIPTOR_NODE MakeStringNode(UCHAR descriptorIndex, const WCHAR* chars, size_t length)
+    {
+        auto* buffer = new BYTE[sizeof(STRING_DESCRIPTOR_NODE) + (length + 1) * sizeof(WCHAR)]{};
+        auto* node = reinterpret_cast<PSTRING_DESCRIPTOR_NODE>(buffer);
+        node->DescriptorIndex = descriptorIndex;
+        node->LanguageID = 0x0409;
+        node->StringDescriptor->bLength = static_cast<UCHAR>(2 + length * sizeof(WCHAR));
+        node->StringDescriptor->bDescriptorType = USB_STRING_DESCRIPTOR_TYPE;
+        std::memcpy(node->StringDescriptor->bString, chars, length * sizeof(WCHAR));
+        return node;
+    }
+
+    std::shared_ptr<const SimulatedBus> bus_;
+    const SimulatedDevice& hub_;
+};
+
+/// <summary>
+/// IUsbBackend serving a simulated bus, so full DevicesManager scans run
+/// without USB hardware. The bus can be replaced at any time (hot-plug).
+/// </summary>
+class MockUsbBackend : public IUsbBackend
+{
+public:
+    explicit MockUsbBackend(std::vector<SimulatedDevice> rootHubs)
+        : bus_(std::make_shared<const SimulatedBus>(std::move(rootHubs)))
+    {
+    }
+
+    /// Replaces the simulated bus; subsequent scans observe the new topology.
+    void SetRootHubs(std::vector<SimulatedDevice> rootHubs)
+    {
+        auto bus = std::make_shared<const SimulatedBus>(std::move(rootHubs));
+        std::lock_guard<std::mutex> lock(mutex_);
+        bus_ = std::move(bus);
+    }
+
+    [[nodiscard]] std::shared_ptr<const SimulatedBus> GetBus() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bus_;
+    }
+
+    [[nodiscard]] std::vector<DevInfoData> GetDeviceInstances() override
+    {
+        return GetBus()->DeviceNodes();
+    }
+
+    [[nodiscard]] std::vector<std::wstring> GetRootHubPaths() override
+    {
+        return GetBus()->RootHubPaths();
+    }
+
+    [[nodiscard]] std::unique_ptr<IDeviceCommunication> OpenHub(const std::wstring& hubPath) override
+    {
+        auto bus = GetBus();
+        const SimulatedDevice* hub = bus->FindHub(hubPath);
+        if (!hub) {
+            throw std::runtime_error("MockUsbBackend: unknown hub path");
+        }
+        return std::make_unique<SimulatedHubCommunication>(std::move(bus), *hub);
+    }
+
+    [[nodiscard]] std::wstring GetHubDevicePath(const DevInfoData& hubDevice) override
+    {
+        std::wstring hubPath = GetBus()->HubPathOfDriverKey(std::wstring(hubDevice.GetDriverKeyName()));
+        if (hubPath.empty()) {
+            throw std::runtime_error("MockUsbBackend: device is not a hub");
+        }
+        return hubPath;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const SimulatedBus> bus_;
+};
+
+/// <summary>
+/// Builds a bus of rootHubCount root hubs, each with hubsPerRoot external hubs
+/// carrying devicesPerHub devices (mix of HID, mass storage and vendor classes).
+/// </summary>
+inline std::vector<SimulatedDevice> MakeSimulatedBus(size_t rootHubCount, size_t hubsPerRoot, size_t devicesPerHub)
+{
+    static constexpr UCHAR classes[] = { 0x03, 0x08, 0xFF, 0x0E };
+    std::vector<SimulatedDevice> roots;
+    USHORT nextPid = 1;
+
+    for (size_t r = 0; r < rootHubCount; ++r)
+    {
+        std::vector<SimulatedDevice> rootPorts;
+        for (size_t h = 0; h < hubsPerRoot; ++h)
+        {
+            std::vector<SimulatedDevice> hubPorts;
+            for (size_t d = 0; d < devicesPerHub; ++d, ++nextPid)
+            {
+                hubPorts.push_back(SimulatedDevice::Device(
+                    0x1234, nextPid, classes[nextPid % 4],
+                    L"Simulated Vendor", L"Simulated Device " + std::to_wstring(nextPid),
+                    L"SN" + std::to_wstring(nextPid)));
+            }
+            rootPorts.push_back(SimulatedDevice::Hub(std::move(hubPorts)));
+        }
+        roots.push_back(SimulatedDevice::Hub(std::move(rootPorts)));
+    }
+
+    return roots;
+}
+
+} // namespace Testing
+} // namespace KDM